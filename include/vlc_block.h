@@ -69,6 +69,7 @@
 #define BLOCK_FLAG_TOP_FIELD_FIRST VLC_FRAME_FLAG_TOP_FIELD_FIRST
 #define BLOCK_FLAG_BOTTOM_FIELD_FIRST VLC_FRAME_FLAG_BOTTOM_FIELD_FIRST
 #define BLOCK_FLAG_SINGLE_FIELD VLC_FRAME_FLAG_SINGLE_FIELD
+#define BLOCK_FLAG_NON_REFERENCE VLC_FRAME_FLAG_NON_REFERENCE
 #define BLOCK_FLAG_INTERLACED_MASK VLC_FRAME_FLAG_INTERLACED_MASK
 #define BLOCK_FLAG_TYPE_MASK VLC_FRAME_FLAG_TYPE_MASK
 #define BLOCK_FLAG_CORE_PRIVATE_MASK VLC_FRAME_FLAG_CORE_PRIVATE_MASK
@@ -86,6 +87,10 @@
 #define block_Release vlc_frame_Release
 #define block_CopyProperties vlc_frame_CopyProperties
 #define block_Duplicate vlc_frame_Duplicate
+#define block_Share vlc_frame_Share
+#define block_Slice vlc_frame_Slice
+#define block_IsShared vlc_frame_IsShared
+#define block_GetAllocCount vlc_frame_GetAllocCount
 #define block_heap_Alloc vlc_frame_heap_Alloc
 #define block_mmap_Alloc vlc_frame_mmap_Alloc
 #define block_shm_Alloc vlc_frame_shm_Alloc
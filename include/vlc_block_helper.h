@@ -228,6 +228,38 @@ static inline int block_SkipByte( block_bytestream_t *p_bytestream )
     return block_GetBytes( p_bytestream, NULL, 1 );
 }
 
+/**
+ * Extracts the next bytes of a byte stream into a new block.
+ *
+ * If the data lies within a single shareable block (see block_Share()), the
+ * returned block is a slice of it and no copy is performed.
+ */
+VLC_USED
+static inline block_t *block_BytestreamGetBlock( block_bytestream_t *p_bytestream,
+                                                 size_t i_data )
+{
+    if( block_BytestreamRemaining( p_bytestream ) < i_data )
+        return NULL;
+
+    block_t *p_block = p_bytestream->p_block;
+    size_t i_offset = p_bytestream->i_block_offset;
+    block_t *p_out;
+
+    if( p_block != NULL && block_IsShared( p_block )
+     && p_block->i_buffer - i_offset >= i_data )
+    {
+        p_out = block_Slice( p_block, i_offset, i_data );
+        if( p_out != NULL )
+            block_SkipBytes( p_bytestream, i_data );
+        return p_out;
+    }
+
+    p_out = block_Alloc( i_data );
+    if( p_out != NULL )
+        block_GetBytes( p_bytestream, p_out->p_buffer, i_data );
+    return p_out;
+}
+
 static inline int block_PeekOffsetBytes( block_bytestream_t *p_bytestream,
     size_t i_peek_offset, uint8_t *p_data, size_t i_data )
 {
@@ -43,6 +43,32 @@
 
 typedef struct decoder_cc_desc_t decoder_cc_desc_t;
 
+/**
+ * Frame dropping stages requested to video decoders that cannot keep up,
+ * from the least to the most aggressive. Each stage implies the previous ones.
+ */
+enum vlc_decoder_drop_level
+{
+    VLC_DECODER_DROP_NONE,       /**< decode everything */
+    VLC_DECODER_DROP_NONREF,     /**< skip all non-reference frames */
+    VLC_DECODER_DROP_BIDIR,      /**< also skip the bidirectional (B) frames
+                                      used as reference, with artefacts
+                                      until the next keyframe */
+    VLC_DECODER_DROP_LOOPFILTER, /**< also skip the in-loop filters */
+    VLC_DECODER_DROP_NONKEY,     /**< decode keyframes only */
+};
+#define VLC_DECODER_DROP_MAX VLC_DECODER_DROP_NONKEY
+
+/**
+ * Threading preferred by the decoder owner
+ */
+enum vlc_decoder_threading
+{
+    VLC_DECODER_THREADING_AUTO,  /**< let the decoder choose */
+    VLC_DECODER_THREADING_FRAME, /**< prefer throughput (frame threading) */
+    VLC_DECODER_THREADING_SLICE, /**< prefer latency (slice/tile threading) */
+};
+
 struct decoder_owner_callbacks
 {
     union
@@ -66,6 +92,11 @@ struct decoder_owner_callbacks
             /* Display rate
              * cf. decoder_GetDisplayRate */
             float       (*get_display_rate)( decoder_t * );
+            /* Frame dropping policy
+             * cf. decoder_GetDropLevel */
+            enum vlc_decoder_drop_level (*get_drop_level)( decoder_t * );
+            /* cf. decoder_NotifyDropped */
+            void        (*notify_dropped)( decoder_t *, unsigned );
         } video;
         struct
         {
@@ -121,6 +152,33 @@ struct decoder_t
      */
     int                 i_extra_picture_buffers;
 
+    /**
+     * Smallest picture size needed by the decoder owner, 0 if unspecified.
+     *
+     * Decoders able to decode at a reduced size with less work (like JPEG
+     * DCT scaling) may output pictures smaller than the coded size, but not
+     * smaller than this size, the owner scaling the rest of the way. The size
+     * applies before orientation; if one dimension is 0, it is not
+     * constrained. Other decoders can ignore it.
+     */
+    unsigned            i_target_width;
+    unsigned            i_target_height;
+
+    /**
+     * Maximum number of threads the decoder should use, 0 to let the
+     * decoder use its own default.
+     *
+     * This is the share of the input thread budget given to this video
+     * decoder, so that several decoders running at the same time do not each
+     * use all the CPUs. It is computed when the decoder is created, from the
+     * audio and video decoders running at that time, and is not updated
+     * afterwards. The decoder defaults and limits still apply, and explicit
+     * per-module thread options take precedence.
+     */
+    unsigned            i_threads;
+    /** Threading preferred by the owner */
+    enum vlc_decoder_threading threading;
+
     union
     {
 #       define VLCDEC_SUCCESS   VLC_SUCCESS
@@ -556,6 +614,36 @@ static inline vlc_tick_t decoder_GetDisplayDate( decoder_t *dec,
     return dec->cbs->video.get_display_date( dec, system_now, i_ts );
 }
 
+/**
+ * This function returns the frame dropping stage the decoder should apply to
+ * catch up with the playback, as decided by the core from the lateness of the
+ * queued pictures.
+ *
+ * It is only relevant if b_frame_drop_allowed is set.
+ */
+VLC_USED
+static inline enum vlc_decoder_drop_level decoder_GetDropLevel( decoder_t *dec )
+{
+    vlc_assert( dec->fmt_in->i_cat == VIDEO_ES && dec->cbs != NULL );
+
+    if( !dec->b_frame_drop_allowed || !dec->cbs->video.get_drop_level )
+        return VLC_DECODER_DROP_NONE;
+
+    return dec->cbs->video.get_drop_level( dec );
+}
+
+/**
+ * This function notifies the core that frames were dropped by the decoder to
+ * apply the decoder_GetDropLevel() stage. It is used for statistics only.
+ */
+static inline void decoder_NotifyDropped( decoder_t *dec, unsigned count )
+{
+    vlc_assert( dec->fmt_in->i_cat == VIDEO_ES && dec->cbs != NULL );
+
+    if( dec->cbs->video.notify_dropped )
+        dec->cbs->video.notify_dropped( dec, count );
+}
+
 /**
  * This function returns the current input rate.
  * You MUST use it *only* for gathering statistics about speed.
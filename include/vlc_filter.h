@@ -397,6 +397,50 @@ VLC_API void filter_DelProxyCallbacks( vlc_object_t *obj, filter_t *filter,
 # define filter_DelProxyCallbacks(a, b, c) \
     filter_DelProxyCallbacks(VLC_OBJECT(a), b, c)
 
+/** Maximum number of slices of filter_ExecuteSlices() */
+#define VLC_FILTER_SLICES_MAX 32
+
+/**
+ * Row band processed by a slice callback.
+ */
+struct vlc_filter_slice
+{
+    unsigned index; /**< slice index, below VLC_FILTER_SLICES_MAX */
+    unsigned first; /**< first row to output */
+    unsigned count; /**< number of rows to output */
+    unsigned start; /**< first row that may be read (with the overlap) */
+    unsigned end; /**< row past the last one that may be read */
+};
+
+typedef void (*vlc_filter_slice_cb)(void *opaque,
+                                    const struct vlc_filter_slice *slice);
+
+/**
+ * Processes a picture in horizontal bands, in parallel.
+ *
+ * The rows are split into contiguous bands that are run on the threads shared
+ * by all the video filters of the instance (see the "filter-threads" option),
+ * the calling thread included. The function returns once all the bands are
+ * done.
+ *
+ * The bands only depend on the number of rows and on the alignment, not on
+ * the number of threads, so that the output is the same whatever the
+ * machine. The callback must only write the rows of its band, and each band
+ * may be run on any thread.
+ *
+ * \param filter the calling filter
+ * \param rows number of rows to process
+ * \param align the band boundaries are multiple of this number of rows
+ * (e.g. 2 for subsampled chroma or fields), 1 or more
+ * \param overlap number of rows above and below the band that the callback
+ * reads, which extends the vlc_filter_slice::start and end rows
+ * \param cb callback processing a band
+ * \param opaque callback data
+ */
+VLC_API void filter_ExecuteSlices(filter_t *filter, unsigned rows,
+                                  unsigned align, unsigned overlap,
+                                  vlc_filter_slice_cb cb, void *opaque);
+
 typedef filter_t vlc_blender_t;
 
 /**
@@ -97,6 +97,8 @@ typedef struct vlc_frame_t vlc_frame_t;
 #define VLC_FRAME_FLAG_BOTTOM_FIELD_FIRST 0x2000
 /** This frame contains a single field from interlaced picture. */
 #define VLC_FRAME_FLAG_SINGLE_FIELD  0x4000
+/** This frame is not used as a reference by any other frame */
+#define VLC_FRAME_FLAG_NON_REFERENCE 0x8000
 
 /** This frame contains an interlaced picture */
 #define VLC_FRAME_FLAG_INTERLACED_MASK \
@@ -292,6 +294,60 @@ static inline vlc_frame_t *vlc_frame_Duplicate( const vlc_frame_t *frame )
     return p_dup;
 }
 
+/**
+ * Makes a frame shareable.
+ *
+ * Wraps a frame so that slices of its payload can be created with
+ * vlc_frame_Slice() without copying. The frame is released once the returned
+ * frame and all its slices are released.
+ *
+ * The returned frame has no headroom nor tailroom: growing it with
+ * vlc_frame_Realloc() copies the payload.
+ *
+ * @param frame frame to share (ownership is transferred)
+ * @return the shareable frame, or NULL on error (frame is released)
+ */
+VLC_API vlc_frame_t *vlc_frame_Share(vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Creates a slice of a frame.
+ *
+ * Returns a new frame whose payload is a subset of the payload of the given
+ * frame. If the frame is shareable (see vlc_frame_Share()), the slice
+ * references the same memory and keeps it alive; otherwise, the payload is
+ * copied.
+ *
+ * The slice has default properties (no timestamps nor flags), and
+ * shares memory with its parent: writing into its payload is visible
+ * through the parent.
+ *
+ * @param frame parent frame (ownership is not transferred)
+ * @param offset offset of the slice within the parent payload
+ * @param length length of the slice (offset + length must not exceed
+ *               the parent payload length)
+ * @return the slice, or NULL on memory error
+ */
+VLC_API vlc_frame_t *vlc_frame_Slice(vlc_frame_t *frame, size_t offset,
+                                     size_t length) VLC_USED;
+
+/**
+ * Checks if a frame payload is shared.
+ *
+ * @return true if the frame was created by vlc_frame_Share() or
+ * vlc_frame_Slice() from a shareable frame
+ */
+VLC_API bool vlc_frame_IsShared(const vlc_frame_t *frame) VLC_USED;
+
+/**
+ * Counts frame buffer allocations.
+ *
+ * Returns the number of frame buffers allocated by the calling thread so far,
+ * including the implicit allocations of vlc_frame_Realloc(),
+ * vlc_frame_Duplicate() and vlc_frame_Slice() fallbacks. Sampling it around
+ * a processing step measures the copies performed by that step.
+ */
+VLC_API uint64_t vlc_frame_GetAllocCount(void) VLC_USED;
+
 /**
  * Wraps heap in a frame.
  *
@@ -541,6 +541,10 @@ struct input_stats_t
     /* Decoders */
     uint64_t i_decoded_audio;
     uint64_t i_decoded_video;
+    /** Frames skipped by the video decoders to catch up */
+    uint64_t i_dropped_video;
+    /** Current frame dropping stage, cf. enum vlc_decoder_drop_level */
+    unsigned i_video_drop_level;
 
     /* Vout */
     uint64_t i_displayed_pictures;
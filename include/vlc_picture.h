@@ -395,6 +395,20 @@ VLC_API void picture_Reset( picture_t * );
 VLC_API void picture_CopyPixels( picture_t *p_dst, const picture_t *p_src );
 VLC_API void plane_CopyPixels( plane_t *p_dst, const plane_t *p_src );
 
+/**
+ * This function will copy the picture pixels like picture_CopyPixels(), but
+ * the very large pictures (8K) are copied in bands on the threads shared by
+ * the video filters.
+ *
+ * \param obj an object of the instance whose threads are used
+ * \param p_dst pointer to the destination picture.
+ * \param p_src pointer to the source picture.
+ */
+VLC_API void picture_CopyPixelsThreaded( vlc_object_t *obj, picture_t *p_dst,
+                                         const picture_t *p_src );
+#define picture_CopyPixelsThreaded(o, d, s) \
+    picture_CopyPixelsThreaded(VLC_OBJECT(o), d, s)
+
 /**
  * This function will copy both picture dynamic properties and pixels.
  * You have to notice that sometime a simple picture_Hold may do what
@@ -51,6 +51,7 @@ typedef size_t vlc_preparser_req_id;
 #define VLC_PREPARSER_TYPE_FETCHMETA_NET    0x04
 #define VLC_PREPARSER_TYPE_THUMBNAIL        0x08
 #define VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES 0x10
+#define VLC_PREPARSER_TYPE_TRICKPLAY        0x20
 #define VLC_PREPARSER_TYPE_FETCHMETA_ALL \
     (VLC_PREPARSER_TYPE_FETCHMETA_LOCAL|VLC_PREPARSER_TYPE_FETCHMETA_NET)
 
@@ -215,6 +216,88 @@ struct vlc_thumbnailer_output
     unsigned int creat_mode;
 };
 
+/**
+ * Trickplay argument
+ *
+ * Used by vlc_preparser_GenerateTrickplay()
+ */
+struct vlc_trickplay_arg
+{
+    /** Time between two thumbnails, 0 for the default (10 seconds) */
+    vlc_tick_t interval;
+
+    /** Width of a thumbnail in the sprite sheet, must be > 0 */
+    unsigned tile_width;
+    /**
+     * Height of a thumbnail in the sprite sheet, 0 to deduce it from the
+     * width and the video aspect ratio
+     */
+    unsigned tile_height;
+
+    /** Number of thumbnails per row in a sprite sheet, must be > 0 */
+    unsigned columns;
+    /** Number of rows in a sprite sheet, must be > 0 */
+    unsigned rows;
+
+    /** Format of the sprite sheets */
+    enum vlc_thumbnailer_format format;
+
+    /**
+     * Path prefix of the outputs
+     *
+     * The sprite sheets are written to "<prefix>-<index>.<ext>" and the
+     * WebVTT index to "<prefix>.vtt". The index references the sprite sheets
+     * by their file name, relative to the index.
+     */
+    const char *prefix;
+    /** File mode bits (cf. "mode_t mode" in `man 2 open`) */
+    unsigned int creat_mode;
+
+    /** True to enable hardware decoder (false by default) */
+    bool hw_dec;
+};
+
+/**
+ * Trickplay generation report
+ */
+struct vlc_trickplay_report
+{
+    /** Number of thumbnails composed into the sprite sheets */
+    size_t thumbnail_count;
+    /** Number of sprite sheets written */
+    size_t sprite_count;
+    /** Time spent generating the thumbnails, exporting included */
+    vlc_tick_t elapsed;
+};
+
+/**
+ * Preparser trickplay callbacks
+ *
+ * Used by vlc_preparser_GenerateTrickplay()
+ */
+struct vlc_trickplay_cbs
+{
+    /**
+     * Event received on trickplay generation completion or error
+     *
+     * This callback will always be called, provided
+     * vlc_preparser_GenerateTrickplay() returned a valid request, and
+     * provided the request is not cancelled before its completion.
+     *
+     * @note This callback is mandatory if calling
+     * vlc_preparser_GenerateTrickplay()
+     *
+     * @param item item used for the thumbnailer
+     * @param status VLC_SUCCESS in case of success, VLC_ETIMEOUT in case of
+     * timeout, -EINTR if cancelled, an error otherwise
+     * @param report generation report, valid only for the callback scope, the
+     * counts can be non-zero in case of failure
+     * @param data opaque pointer passed by vlc_preparser_GenerateTrickplay()
+     */
+    void (*on_ended)(input_item_t *item, int status,
+                     const struct vlc_trickplay_report *report, void *data);
+};
+
 /**
  * Preparser creation configuration
  */
@@ -347,6 +430,32 @@ vlc_preparser_GenerateThumbnailToFiles( vlc_preparser_t *preparser, input_item_t
                                         const struct vlc_thumbnailer_to_files_cbs *cbs,
                                         void *cbs_userdata );
 
+/**
+ * This function generates trickplay sprite sheets and their WebVTT index
+ *
+ * A single input and decoder are used for all positions: the input is
+ * fast-seeked to the keyframe preceding each position, and the decoder is
+ * told to skip all non keyframes. The preparser timeout, if any, applies to
+ * each position.
+ *
+ * @param preparser the preparser object
+ * @param item a valid item to generate the sprite sheets for
+ * @param arg pointer to the arg struct (can't be NULL)
+ * @param cbs callback to listen to events (can't be NULL)
+ * @param cbs_userdata opaque pointer used by the callbacks
+ * @return VLC_PREPARSER_REQ_ID_INVALID in case of error, or a valid id if the
+ * item was scheduled for thumbnailing. If this returns an
+ * error, the trickplay.on_ended callback will *not* be invoked
+ *
+ * The provided input_item will be held by the thumbnailer and can safely be
+ * released safely after calling this function.
+ */
+VLC_API vlc_preparser_req_id
+vlc_preparser_GenerateTrickplay( vlc_preparser_t *preparser, input_item_t *item,
+                                 const struct vlc_trickplay_arg *arg,
+                                 const struct vlc_trickplay_cbs *cbs,
+                                 void *cbs_userdata );
+
 /**
  * This function cancel all preparsing requests for a given id
  *
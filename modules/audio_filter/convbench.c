@@ -0,0 +1,219 @@
+/*****************************************************************************
+ * convbench.c : audio sample format conversion benchmark plugin for vlc
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_filter.h>
+#include <vlc_rand.h>
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+static int Create( vlc_object_t * );
+static void Destroy( filter_t * );
+
+static block_t *Filter( filter_t *, block_t * );
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+
+#define LOOPS_TEXT N_("Number of time to convert")
+#define LOOPS_LONGTEXT N_("The number of time each conversion will be performed")
+
+#define SAMPLES_TEXT N_("Samples per buffer")
+#define SAMPLES_LONGTEXT N_("Number of samples of the converted buffers")
+
+#define CFG_PREFIX "convbench-"
+
+vlc_module_begin ()
+    set_description( N_("Audio conversion benchmark filter") )
+    set_shortname( N_("Convbench") )
+    set_subcategory( SUBCAT_AUDIO_AFILTER )
+
+    set_section( N_("Benchmarking"), NULL )
+    add_integer( CFG_PREFIX "loops", 1000, LOOPS_TEXT, LOOPS_LONGTEXT )
+    add_integer_with_range( CFG_PREFIX "samples", 8192, 16, 1 << 20,
+                            SAMPLES_TEXT, SAMPLES_LONGTEXT )
+
+    set_capability( "audio filter", 0 )
+    set_callback( Create )
+vlc_module_end ()
+
+/*****************************************************************************
+ * filter_sys_t: filter method descriptor
+ *****************************************************************************/
+typedef struct
+{
+    bool b_done;
+    int i_loops;
+    unsigned i_samples;
+} filter_sys_t;
+
+static const vlc_fourcc_t formats[] = {
+    VLC_CODEC_U8, VLC_CODEC_S16N, VLC_CODEC_S32N, VLC_CODEC_FL32, VLC_CODEC_FL64,
+};
+
+static const struct vlc_filter_operations filter_ops =
+{
+    .filter_audio = Filter, .close = Destroy,
+};
+
+/*****************************************************************************
+ * Create: allocates the benchmark filter
+ *****************************************************************************/
+static int Create( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+    filter_sys_t *p_sys = malloc( sizeof( filter_sys_t ) );
+    if( p_sys == NULL )
+        return VLC_ENOMEM;
+
+    p_sys->b_done = false;
+    p_sys->i_loops = var_InheritInteger( p_filter, CFG_PREFIX "loops" );
+    p_sys->i_samples = var_InheritInteger( p_filter, CFG_PREFIX "samples" );
+
+    p_filter->fmt_out.audio = p_filter->fmt_in.audio;
+    p_filter->p_sys = p_sys;
+    p_filter->ops = &filter_ops;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Destroy: destroys the benchmark filter
+ *****************************************************************************/
+static void Destroy( filter_t *p_filter )
+{
+    free( p_filter->p_sys );
+}
+
+/* Fills a buffer with full scale noise, with some clipping for floats */
+static void FillSamples( block_t *p_block, vlc_fourcc_t i_format,
+                         unsigned i_samples )
+{
+    vlc_rand_bytes( p_block->p_buffer, p_block->i_buffer );
+
+    if( i_format == VLC_CODEC_FL32 )
+    {
+        float *p = (float *)p_block->p_buffer;
+        for( unsigned i = 0; i < i_samples; i++ )
+            p[i] = sinf( i * .01f ) * 1.1f;
+    }
+    else if( i_format == VLC_CODEC_FL64 )
+    {
+        double *p = (double *)p_block->p_buffer;
+        for( unsigned i = 0; i < i_samples; i++ )
+            p[i] = sin( i * .01 ) * 1.1;
+    }
+}
+
+static void Bench( filter_t *p_filter, vlc_fourcc_t i_src, vlc_fourcc_t i_dst )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    filter_t *p_conv = vlc_object_create( p_filter, sizeof(filter_t) );
+    if( p_conv == NULL )
+        return;
+
+    es_format_Init( &p_conv->fmt_in, AUDIO_ES, i_src );
+    p_conv->fmt_in.audio = p_filter->fmt_in.audio;
+    p_conv->fmt_in.audio.i_format = i_src;
+    aout_FormatPrepare( &p_conv->fmt_in.audio );
+    es_format_Init( &p_conv->fmt_out, AUDIO_ES, i_dst );
+    p_conv->fmt_out.audio = p_conv->fmt_in.audio;
+    p_conv->fmt_out.audio.i_format = i_dst;
+    aout_FormatPrepare( &p_conv->fmt_out.audio );
+
+    p_conv->p_module = vlc_filter_LoadModule( p_conv, "audio converter",
+                                              NULL, false );
+    if( p_conv->p_module == NULL )
+    {
+        msg_Warn( p_filter, "no converter for %4.4s->%4.4s",
+                  (const char *)&i_src, (const char *)&i_dst );
+        vlc_object_delete( p_conv );
+        return;
+    }
+    assert( p_conv->ops != NULL && p_conv->ops->filter_audio != NULL );
+
+    unsigned i_frames = p_sys->i_samples / p_conv->fmt_in.audio.i_channels;
+    size_t i_size = i_frames * p_conv->fmt_in.audio.i_bytes_per_frame;
+    block_t *p_ref = block_Alloc( i_size );
+    if( p_ref == NULL )
+        goto out;
+    FillSamples( p_ref, i_src, i_size / (aout_BitsPerSample( i_src ) / 8) );
+
+    vlc_tick_t time = 0;
+    for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
+    {
+        block_t *p_block = block_Alloc( i_size );
+        if( p_block == NULL )
+            break;
+        memcpy( p_block->p_buffer, p_ref->p_buffer, i_size );
+        p_block->i_nb_samples = i_frames;
+
+        vlc_tick_t start = vlc_tick_now();
+        p_block = p_conv->ops->filter_audio( p_conv, p_block );
+        time += vlc_tick_now() - start;
+
+        if( p_block != NULL )
+            block_Release( p_block );
+    }
+    block_Release( p_ref );
+
+    if( time > 0 )
+        msg_Info( p_filter, "%4.4s->%4.4s: %f Msamples/second, %f MB/second",
+                  (const char *)&i_src, (const char *)&i_dst,
+                  (double) p_sys->i_loops * i_frames *
+                      p_conv->fmt_in.audio.i_channels / time * CLOCK_FREQ / 1e6,
+                  (double) p_sys->i_loops * i_size / time * CLOCK_FREQ / 1e6 );
+out:
+    vlc_filter_Delete( p_conv );
+}
+
+/*****************************************************************************
+ * Filter: runs the benchmark once, then passes the audio through
+ *****************************************************************************/
+static block_t *Filter( filter_t *p_filter, block_t *p_block )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_sys->b_done )
+        return p_block;
+
+    for( size_t i = 0; i < ARRAY_SIZE(formats); i++ )
+        for( size_t j = 0; j < ARRAY_SIZE(formats); j++ )
+            if( i != j )
+                Bench( p_filter, formats[i], formats[j] );
+
+    p_sys->b_done = true;
+    return p_block;
+}
@@ -37,6 +37,7 @@
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
 #include <vlc_block.h>
+#include <vlc_cpu.h>
 #include <vlc_filter.h>
 
 /*****************************************************************************
@@ -44,10 +45,17 @@
  *****************************************************************************/
 static int  Open(vlc_object_t *);
 
+#define DITHER_TEXT N_("Dither 16-bit conversions")
+#define DITHER_LONGTEXT N_( \
+    "Add triangular probability density (TPDF) noise when converting " \
+    "floating point samples to 16-bit integers, so that the quantization " \
+    "error does not correlate with the signal.")
+
 vlc_module_begin()
     set_description(N_("Audio filter for PCM format conversion"))
     set_subcategory(SUBCAT_AUDIO_AFILTER)
     set_capability("audio converter", 1)
+    add_bool("audio-format-dither", false, DITHER_TEXT, DITHER_LONGTEXT)
     set_callback(Open)
 vlc_module_end()
 
@@ -57,6 +65,7 @@ vlc_module_end()
 
 typedef block_t *(*cvt_t)(filter_t *, block_t *);
 static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_fourcc_t dst);
+static int OpenVector(filter_t *, bool dither);
 
 static int Open(vlc_object_t *object)
 {
@@ -70,6 +79,10 @@ static int Open(vlc_object_t *object)
     if (src->i_codec == dst->i_codec)
         return VLC_EGENERIC;
 
+    bool dither = var_InheritBool(filter, "audio-format-dither");
+    if (OpenVector(filter, dither) == VLC_SUCCESS)
+        return VLC_SUCCESS;
+
     const struct vlc_filter_operations *filter_ops = FindConversion(src->i_codec, dst->i_codec);
     if (filter_ops == NULL)
         return VLC_EGENERIC;
@@ -250,49 +263,55 @@ static block_t *Fl32toU8(filter_t *filter, block_t *b)
     return b;
 }
 
+static inline int16_t fl32_to_s16(float s)
+{
+#if 0
+    /* Slow version. */
+    if (s >= 1.0) return 32767;
+    else if (s < -1.0) return -32768;
+    else return lroundf(s * 32768.f);
+#else
+    /* This is Walken's trick based on IEEE float format. */
+    union { float f; int32_t i; } u;
+    u.f = s + 384.f;
+    if (u.i > 0x43c07fff)
+        return 32767;
+    else if (u.i < 0x43bf8000)
+        return -32768;
+    else
+        return u.i - 0x43c00000;
+#endif
+}
+
 static block_t *Fl32toS16(filter_t *filter, block_t *b)
 {
     VLC_UNUSED(filter);
     float   *src = (float *)b->p_buffer;
     int16_t *dst = (int16_t *)src;
-    for (int i = b->i_buffer / 4; i--;) {
-#if 0
-        /* Slow version. */
-        if (*src >= 1.0) *dst = 32767;
-        else if (*src < -1.0) *dst = -32768;
-        else *dst = lroundf(*src * 32768.f);
-        src++; dst++;
-#else
-        /* This is Walken's trick based on IEEE float format. */
-        union { float f; int32_t i; } u;
-        u.f = *src++ + 384.f;
-        if (u.i > 0x43c07fff)
-            *dst++ = 32767;
-        else if (u.i < 0x43bf8000)
-            *dst++ = -32768;
-        else
-            *dst++ = u.i - 0x43c00000;
-#endif
-    }
+    for (int i = b->i_buffer / 4; i--;)
+        *dst++ = fl32_to_s16(*src++);
     b->i_buffer /= 2;
     return b;
 }
 
+static inline int32_t fl32_to_s32(float s)
+{
+    s *= -((float)INT32_MIN);
+    if (s >= ((float)INT32_MAX))
+        return INT32_MAX;
+    else
+    if (s <= ((float)INT32_MIN))
+        return INT32_MIN;
+    else
+        return lroundf(s);
+}
+
 static block_t *Fl32toS32(filter_t *filter, block_t *b)
 {
     float   *src = (float *)b->p_buffer;
     int32_t *dst = (int32_t *)src;
     for (size_t i = b->i_buffer / 4; i--;)
-    {
-        float s = *(src++) * -((float)INT32_MIN);
-        if (s >= ((float)INT32_MAX))
-            *(dst++) = INT32_MAX;
-        else
-        if (s <= ((float)INT32_MIN))
-            *(dst++) = INT32_MIN;
-        else
-            *(dst++) = lroundf(s);
-    }
+        *(dst++) = fl32_to_s32(*(src++));
     VLC_UNUSED(filter);
     return b;
 }
@@ -485,3 +504,736 @@ static const struct vlc_filter_operations *FindConversion(vlc_fourcc_t src, vlc_
     }
     return NULL;
 }
+
+/*****************************************************************************
+ * Vectorized conversions
+ *****************************************************************************
+ * The kernels convert as many samples as possible with vectors, then finish
+ * with the same per-sample code as the scalar conversions above, so that the
+ * results do not depend on the CPU. Conversions to integers saturate.
+ *****************************************************************************/
+#define DITHER_LANES 8
+
+typedef struct
+{
+    void (*convert)(void *, void *, const void *, size_t);
+    uint8_t src_size;
+    uint8_t dst_size;
+    uint32_t dither[DITHER_LANES]; /* xorshift32 states */
+} filter_sys_t;
+
+static inline uint32_t xorshift32(uint32_t *state)
+{
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+/* Triangular noise in ]-1, +1[ LSB, as the difference of two uniform noises */
+static inline float tpdf(uint32_t *state)
+{
+    int32_t a = xorshift32(state) >> 8;
+    int32_t b = xorshift32(state) >> 8;
+    return (a - b) * (1.f / 16777216.f);
+}
+
+static inline int16_t fl32_to_s16_dither(float s, uint32_t *state)
+{
+    return fl32_to_s16(s + tpdf(state) * (1.f / 32768.f));
+}
+
+static void S16toFl32_C(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int16_t *src = inp;
+    float *dst = outp;
+
+    VLC_UNUSED(sys);
+    for (size_t i = 0; i < n; i++)
+        dst[i] = src[i] * (1.f / 32768.f);
+}
+
+static void S32toFl32_C(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    float *dst = outp;
+
+    VLC_UNUSED(sys);
+    for (size_t i = 0; i < n; i++)
+        dst[i] = (float)src[i] / -((float)INT32_MIN);
+}
+
+static void S32toS16_C(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    int16_t *dst = outp;
+
+    VLC_UNUSED(sys);
+    for (size_t i = 0; i < n; i++)
+        dst[i] = src[i] >> 16;
+}
+
+static void Fl32toS16_C(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int16_t *dst = outp;
+
+    VLC_UNUSED(sys);
+    for (size_t i = 0; i < n; i++)
+        dst[i] = fl32_to_s16(src[i]);
+}
+
+static void Fl32toS16Dither_C(void *opaque, void *outp, const void *inp, size_t n)
+{
+    filter_sys_t *sys = opaque;
+    const float *src = inp;
+    int16_t *dst = outp;
+
+    for (size_t i = 0; i < n; i++)
+        dst[i] = fl32_to_s16_dither(src[i], &sys->dither[i % DITHER_LANES]);
+}
+
+static void Fl32toS32_C(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int32_t *dst = outp;
+
+    VLC_UNUSED(sys);
+    for (size_t i = 0; i < n; i++)
+        dst[i] = fl32_to_s32(src[i]);
+}
+
+static void Fl64toFl32_C(void *sys, void *outp, const void *inp, size_t n)
+{
+    const double *src = inp;
+    float *dst = outp;
+
+    VLC_UNUSED(sys);
+    for (size_t i = 0; i < n; i++)
+        dst[i] = src[i];
+}
+
+#ifdef CAN_COMPILE_SSE2
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("sse2")))
+static void S16toFl32_SSE2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int16_t *src = inp;
+    float *dst = outp;
+    const __m128 scale = _mm_set1_ps(1.f / 32768.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)&src[i]);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+        _mm_storeu_ps(&dst[i + 4], _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+    S16toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void S32toFl32_SSE2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    float *dst = outp;
+    const __m128 scale = _mm_set1_ps(1.f / 2147483648.f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)&src[i]);
+        _mm_storeu_ps(&dst[i], _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    S32toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void S32toS16_SSE2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    int16_t *dst = outp;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i a = _mm_loadu_si128((const __m128i *)&src[i]);
+        __m128i b = _mm_loadu_si128((const __m128i *)&src[i + 4]);
+
+        a = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+        _mm_storeu_si128((__m128i *)&dst[i], a);
+    }
+    S32toS16_C(sys, &dst[i], &src[i], n - i);
+}
+
+/* Same float trick as fl32_to_s16(), with the bounds compared as integers */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i fl32_to_s16x4(__m128 v)
+{
+    __m128i u = _mm_castps_si128(_mm_add_ps(v, _mm_set1_ps(384.f)));
+    __m128i hi = _mm_cmpgt_epi32(u, _mm_set1_epi32(0x43c07fff));
+    __m128i lo = _mm_cmplt_epi32(u, _mm_set1_epi32(0x43bf8000));
+
+    u = _mm_sub_epi32(u, _mm_set1_epi32(0x43c00000));
+    u = _mm_andnot_si128(_mm_or_si128(hi, lo), u);
+    u = _mm_or_si128(u, _mm_and_si128(hi, _mm_set1_epi32(32767)));
+    return _mm_or_si128(u, _mm_and_si128(lo, _mm_set1_epi32(-32768)));
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void Fl32toS16_SSE2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int16_t *dst = outp;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_packs_epi32(fl32_to_s16x4(_mm_loadu_ps(&src[i])),
+                                    fl32_to_s16x4(_mm_loadu_ps(&src[i + 4])));
+        _mm_storeu_si128((__m128i *)&dst[i], v);
+    }
+    Fl32toS16_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static inline __m128 tpdf_x4(__m128i *state)
+{
+    __m128i r[2];
+
+    for (int k = 0; k < 2; k++)
+    {
+        __m128i x = *state;
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+        x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+        x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+        *state = x;
+        r[k] = _mm_srli_epi32(x, 8);
+    }
+    __m128 noise = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(r[0], r[1])),
+                              _mm_set1_ps(1.f / 16777216.f));
+    return _mm_mul_ps(noise, _mm_set1_ps(1.f / 32768.f));
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void Fl32toS16Dither_SSE2(void *opaque, void *outp, const void *inp,
+                                 size_t n)
+{
+    filter_sys_t *sys = opaque;
+    const float *src = inp;
+    int16_t *dst = outp;
+    __m128i state0 = _mm_loadu_si128((const __m128i *)&sys->dither[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i *)&sys->dither[4]);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_add_ps(_mm_loadu_ps(&src[i]), tpdf_x4(&state0));
+        __m128 b = _mm_add_ps(_mm_loadu_ps(&src[i + 4]), tpdf_x4(&state1));
+        __m128i v = _mm_packs_epi32(fl32_to_s16x4(a), fl32_to_s16x4(b));
+        _mm_storeu_si128((__m128i *)&dst[i], v);
+    }
+    _mm_storeu_si128((__m128i *)&sys->dither[0], state0);
+    _mm_storeu_si128((__m128i *)&sys->dither[4], state1);
+    Fl32toS16Dither_C(sys, &dst[i], &src[i], n - i);
+}
+
+/* Saturates and rounds half away from zero, like lroundf() */
+__attribute__ ((__target__ ("sse2")))
+static inline __m128i fl32_to_s32x4(__m128 s)
+{
+    const __m128 max = _mm_set1_ps(2147483648.f);
+    const __m128 half = _mm_set1_ps(.5f);
+
+    __m128i t = _mm_cvttps_epi32(s);
+    __m128 f = _mm_sub_ps(s, _mm_cvtepi32_ps(t));
+    t = _mm_sub_epi32(t, _mm_castps_si128(_mm_cmpge_ps(f, half)));
+    t = _mm_add_epi32(t, _mm_castps_si128(_mm_cmple_ps(f, _mm_sub_ps(_mm_setzero_ps(), half))));
+
+    __m128i hi = _mm_castps_si128(_mm_cmpge_ps(s, max));
+    __m128i lo = _mm_castps_si128(_mm_cmple_ps(s, _mm_sub_ps(_mm_setzero_ps(), max)));
+    t = _mm_andnot_si128(_mm_or_si128(hi, lo), t);
+    t = _mm_or_si128(t, _mm_and_si128(hi, _mm_set1_epi32(INT32_MAX)));
+    return _mm_or_si128(t, _mm_and_si128(lo, _mm_set1_epi32(INT32_MIN)));
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void Fl32toS32_SSE2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int32_t *dst = outp;
+    const __m128 scale = _mm_set1_ps(2147483648.f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 s = _mm_mul_ps(_mm_loadu_ps(&src[i]), scale);
+        _mm_storeu_si128((__m128i *)&dst[i], fl32_to_s32x4(s));
+    }
+    Fl32toS32_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void Fl64toFl32_SSE2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const double *src = inp;
+    float *dst = outp;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 a = _mm_cvtpd_ps(_mm_loadu_pd(&src[i]));
+        __m128 b = _mm_cvtpd_ps(_mm_loadu_pd(&src[i + 2]));
+        _mm_storeu_ps(&dst[i], _mm_movelh_ps(a, b));
+    }
+    Fl64toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+__attribute__ ((__target__ ("avx2")))
+static void S16toFl32_AVX2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int16_t *src = inp;
+    float *dst = outp;
+    const __m256 scale = _mm256_set1_ps(1.f / 32768.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)&src[i]));
+        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    S16toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void S32toFl32_AVX2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    float *dst = outp;
+    const __m256 scale = _mm256_set1_ps(1.f / 2147483648.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)&src[i]);
+        _mm256_storeu_ps(&dst[i], _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    S32toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void S32toS16_AVX2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    int16_t *dst = outp;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i a = _mm256_loadu_si256((const __m256i *)&src[i]);
+        __m256i b = _mm256_loadu_si256((const __m256i *)&src[i + 8]);
+
+        /* packs works per 128-bits lane */
+        a = _mm256_packs_epi32(_mm256_srai_epi32(a, 16), _mm256_srai_epi32(b, 16));
+        a = _mm256_permute4x64_epi64(a, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)&dst[i], a);
+    }
+    S32toS16_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i fl32_to_s16x8(__m256 v)
+{
+    __m256i u = _mm256_castps_si256(_mm256_add_ps(v, _mm256_set1_ps(384.f)));
+
+    u = _mm256_min_epi32(u, _mm256_set1_epi32(0x43c07fff));
+    u = _mm256_max_epi32(u, _mm256_set1_epi32(0x43bf8000));
+    return _mm256_sub_epi32(u, _mm256_set1_epi32(0x43c00000));
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void Fl32toS16_AVX2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int16_t *dst = outp;
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v = _mm256_packs_epi32(fl32_to_s16x8(_mm256_loadu_ps(&src[i])),
+                                       fl32_to_s16x8(_mm256_loadu_ps(&src[i + 8])));
+        v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)&dst[i], v);
+    }
+    Fl32toS16_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void Fl32toS16Dither_AVX2(void *opaque, void *outp, const void *inp,
+                                 size_t n)
+{
+    filter_sys_t *sys = opaque;
+    const float *src = inp;
+    int16_t *dst = outp;
+    const __m256 unit = _mm256_set1_ps(1.f / 16777216.f);
+    const __m256 lsb = _mm256_set1_ps(1.f / 32768.f);
+    __m256i state = _mm256_loadu_si256((const __m256i *)sys->dither);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i r[2];
+
+        for (int k = 0; k < 2; k++)
+        {
+            state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 13));
+            state = _mm256_xor_si256(state, _mm256_srli_epi32(state, 17));
+            state = _mm256_xor_si256(state, _mm256_slli_epi32(state, 5));
+            r[k] = _mm256_srli_epi32(state, 8);
+        }
+
+        __m256 noise = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(r[0], r[1])),
+                                     unit);
+        noise = _mm256_mul_ps(noise, lsb);
+
+        __m256i v = fl32_to_s16x8(_mm256_add_ps(_mm256_loadu_ps(&src[i]), noise));
+        v = _mm256_permute4x64_epi64(_mm256_packs_epi32(v, v),
+                                     _MM_SHUFFLE(3, 1, 2, 0));
+        _mm_storeu_si128((__m128i *)&dst[i], _mm256_castsi256_si128(v));
+    }
+    _mm256_storeu_si256((__m256i *)sys->dither, state);
+    Fl32toS16Dither_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void Fl32toS32_AVX2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int32_t *dst = outp;
+    const __m256 max = _mm256_set1_ps(2147483648.f);
+    const __m256 min = _mm256_set1_ps(-2147483648.f);
+    const __m256 half = _mm256_set1_ps(.5f);
+    const __m256 mhalf = _mm256_set1_ps(-.5f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 s = _mm256_mul_ps(_mm256_loadu_ps(&src[i]), max);
+
+        /* round half away from zero, like lroundf() */
+        __m256i t = _mm256_cvttps_epi32(s);
+        __m256 f = _mm256_sub_ps(s, _mm256_cvtepi32_ps(t));
+        t = _mm256_sub_epi32(t, _mm256_castps_si256(_mm256_cmp_ps(f, half, _CMP_GE_OQ)));
+        t = _mm256_add_epi32(t, _mm256_castps_si256(_mm256_cmp_ps(f, mhalf, _CMP_LE_OQ)));
+
+        __m256 hi = _mm256_cmp_ps(s, max, _CMP_GE_OQ);
+        __m256 lo = _mm256_cmp_ps(s, min, _CMP_LE_OQ);
+        __m256 v = _mm256_blendv_ps(_mm256_castsi256_ps(t),
+                       _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MAX)), hi);
+        v = _mm256_blendv_ps(v, _mm256_castsi256_ps(_mm256_set1_epi32(INT32_MIN)), lo);
+        _mm256_storeu_ps((float *)&dst[i], v);
+    }
+    Fl32toS32_C(sys, &dst[i], &src[i], n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void Fl64toFl32_AVX2(void *sys, void *outp, const void *inp, size_t n)
+{
+    const double *src = inp;
+    float *dst = outp;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm256_cvtpd_ps(_mm256_loadu_pd(&src[i]));
+        __m128 b = _mm256_cvtpd_ps(_mm256_loadu_pd(&src[i + 4]));
+        _mm256_storeu_ps(&dst[i], _mm256_set_m128(b, a));
+    }
+    Fl64toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+#endif
+
+#ifdef __aarch64__
+# include <arm_neon.h>
+
+static void S16toFl32_NEON(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int16_t *src = inp;
+    float *dst = outp;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x8_t v = vld1q_s16(&src[i]);
+        vst1q_f32(&dst[i], vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(v)), 15));
+        vst1q_f32(&dst[i + 4], vcvtq_n_f32_s32(vmovl_high_s16(v), 15));
+    }
+    S16toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+
+static void S32toFl32_NEON(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    float *dst = outp;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(&dst[i], vcvtq_n_f32_s32(vld1q_s32(&src[i]), 31));
+    S32toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+
+static void S32toS16_NEON(void *sys, void *outp, const void *inp, size_t n)
+{
+    const int32_t *src = inp;
+    int16_t *dst = outp;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x4_t a = vshrn_n_s32(vld1q_s32(&src[i]), 16);
+        int16x4_t b = vshrn_n_s32(vld1q_s32(&src[i + 4]), 16);
+        vst1q_s16(&dst[i], vcombine_s16(a, b));
+    }
+    S32toS16_C(sys, &dst[i], &src[i], n - i);
+}
+
+/* Same float trick as fl32_to_s16(), with the bounds compared as integers */
+static inline int16x4_t fl32_to_s16x4(float32x4_t v)
+{
+    int32x4_t u = vreinterpretq_s32_f32(vaddq_f32(v, vdupq_n_f32(384.f)));
+
+    u = vminq_s32(u, vdupq_n_s32(0x43c07fff));
+    u = vmaxq_s32(u, vdupq_n_s32(0x43bf8000));
+    return vmovn_s32(vsubq_s32(u, vdupq_n_s32(0x43c00000)));
+}
+
+static void Fl32toS16_NEON(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int16_t *dst = outp;
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x4_t a = fl32_to_s16x4(vld1q_f32(&src[i]));
+        int16x4_t b = fl32_to_s16x4(vld1q_f32(&src[i + 4]));
+        vst1q_s16(&dst[i], vcombine_s16(a, b));
+    }
+    Fl32toS16_C(sys, &dst[i], &src[i], n - i);
+}
+
+static inline float32x4_t tpdf_neon(uint32x4_t *state)
+{
+    uint32x4_t r[2];
+
+    for (int k = 0; k < 2; k++)
+    {
+        uint32x4_t x = *state;
+        x = veorq_u32(x, vshlq_n_u32(x, 13));
+        x = veorq_u32(x, vshrq_n_u32(x, 17));
+        x = veorq_u32(x, vshlq_n_u32(x, 5));
+        *state = x;
+        r[k] = vshrq_n_u32(x, 8);
+    }
+    int32x4_t d = vsubq_s32(vreinterpretq_s32_u32(r[0]),
+                            vreinterpretq_s32_u32(r[1]));
+    return vmulq_n_f32(vcvtq_n_f32_s32(d, 24), 1.f / 32768.f);
+}
+
+static void Fl32toS16Dither_NEON(void *opaque, void *outp, const void *inp,
+                                 size_t n)
+{
+    filter_sys_t *sys = opaque;
+    const float *src = inp;
+    int16_t *dst = outp;
+    uint32x4_t state0 = vld1q_u32(&sys->dither[0]);
+    uint32x4_t state1 = vld1q_u32(&sys->dither[4]);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        float32x4_t a = vaddq_f32(vld1q_f32(&src[i]), tpdf_neon(&state0));
+        float32x4_t b = vaddq_f32(vld1q_f32(&src[i + 4]), tpdf_neon(&state1));
+        vst1q_s16(&dst[i], vcombine_s16(fl32_to_s16x4(a), fl32_to_s16x4(b)));
+    }
+    vst1q_u32(&sys->dither[0], state0);
+    vst1q_u32(&sys->dither[4], state1);
+    Fl32toS16Dither_C(sys, &dst[i], &src[i], n - i);
+}
+
+static void Fl32toS32_NEON(void *sys, void *outp, const void *inp, size_t n)
+{
+    const float *src = inp;
+    int32_t *dst = outp;
+    size_t i = 0;
+
+    /* rounds half away from zero, like lroundf(), and saturates */
+    for (; i + 4 <= n; i += 4)
+        vst1q_s32(&dst[i], vcvtaq_s32_f32(vmulq_n_f32(vld1q_f32(&src[i]),
+                                                      2147483648.f)));
+    Fl32toS32_C(sys, &dst[i], &src[i], n - i);
+}
+
+static void Fl64toFl32_NEON(void *sys, void *outp, const void *inp, size_t n)
+{
+    const double *src = inp;
+    float *dst = outp;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x2_t a = vcvt_f32_f64(vld1q_f64(&src[i]));
+        float32x2_t b = vcvt_f32_f64(vld1q_f64(&src[i + 2]));
+        vst1q_f32(&dst[i], vcombine_f32(a, b));
+    }
+    Fl64toFl32_C(sys, &dst[i], &src[i], n - i);
+}
+#endif
+
+typedef void (*cvt_vector_t)(void *, void *, const void *, size_t);
+
+static const struct {
+    vlc_fourcc_t src;
+    vlc_fourcc_t dst;
+    bool dither;
+    uint8_t src_size;
+    uint8_t dst_size;
+    cvt_vector_t c; /* only used if the scalar conversion lacks a feature */
+    cvt_vector_t sse2;
+    cvt_vector_t avx2;
+    cvt_vector_t neon;
+} cvt_vectors[] = {
+#define CVT(src, dst, dither, ssize, dsize, name, c) \
+    { VLC_CODEC_##src, VLC_CODEC_##dst, dither, ssize, dsize, c, \
+      CVT_SSE2(name), CVT_AVX2(name), CVT_NEON(name) }
+#ifdef CAN_COMPILE_SSE2
+# define CVT_SSE2(name) name##_SSE2
+#else
+# define CVT_SSE2(name) NULL
+#endif
+#ifdef CAN_COMPILE_AVX2
+# define CVT_AVX2(name) name##_AVX2
+#else
+# define CVT_AVX2(name) NULL
+#endif
+#ifdef __aarch64__
+# define CVT_NEON(name) name##_NEON
+#else
+# define CVT_NEON(name) NULL
+#endif
+    CVT(S16N, FL32, false, 2, 4, S16toFl32, NULL),
+    CVT(S32N, FL32, false, 4, 4, S32toFl32, NULL),
+    CVT(S32N, S16N, false, 4, 2, S32toS16, NULL),
+    CVT(FL32, S16N, false, 4, 2, Fl32toS16, NULL),
+    CVT(FL32, S16N, true,  4, 2, Fl32toS16Dither, Fl32toS16Dither_C),
+    CVT(FL32, S32N, false, 4, 4, Fl32toS32, NULL),
+    CVT(FL64, FL32, false, 8, 4, Fl64toFl32, NULL),
+#undef CVT_NEON
+#undef CVT_AVX2
+#undef CVT_SSE2
+#undef CVT
+};
+
+static block_t *ConvertVector(filter_t *filter, block_t *bsrc)
+{
+    filter_sys_t *sys = filter->p_sys;
+    size_t samples = bsrc->i_buffer / sys->src_size;
+    block_t *bdst = bsrc;
+
+    if (sys->dst_size > sys->src_size)
+    {
+        bdst = block_Alloc(samples * sys->dst_size);
+        if (unlikely(bdst == NULL))
+            goto out;
+        block_CopyProperties(bdst, bsrc);
+    }
+
+    /* In place conversions never overwrite samples not converted yet, as
+     * destination samples are not larger than source ones. */
+    sys->convert(sys, bdst->p_buffer, bsrc->p_buffer, samples);
+    bdst->i_buffer = samples * sys->dst_size;
+out:
+    if (bdst != bsrc)
+        block_Release(bsrc);
+    return bdst;
+}
+
+static void CloseVector(filter_t *filter)
+{
+    free(filter->p_sys);
+}
+
+static const struct vlc_filter_operations vector_ops = {
+    .filter_audio = ConvertVector, .close = CloseVector,
+};
+
+static int OpenVector(filter_t *filter, bool dither)
+{
+    vlc_fourcc_t src = filter->fmt_in.i_codec, dst = filter->fmt_out.i_codec;
+
+    /* Dithering only applies to 16-bit output */
+    if (dst != VLC_CODEC_S16N || (src != VLC_CODEC_FL32))
+        dither = false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(cvt_vectors); i++)
+    {
+        if (cvt_vectors[i].src != src || cvt_vectors[i].dst != dst
+         || cvt_vectors[i].dither != dither)
+            continue;
+
+        cvt_vector_t convert = NULL;
+        const char *isa = "C";
+#ifdef CAN_COMPILE_AVX2
+        if (convert == NULL && vlc_CPU_AVX2())
+        {
+            convert = cvt_vectors[i].avx2;
+            isa = "AVX2";
+        }
+#endif
+#ifdef CAN_COMPILE_SSE2
+        if (convert == NULL && vlc_CPU_SSE2())
+        {
+            convert = cvt_vectors[i].sse2;
+            isa = "SSE2";
+        }
+#endif
+#ifdef __aarch64__
+        if (convert == NULL)
+        {
+            convert = cvt_vectors[i].neon;
+            isa = "NEON";
+        }
+#endif
+        if (convert == NULL)
+        {
+            convert = cvt_vectors[i].c;
+            isa = "C";
+        }
+        if (convert == NULL)
+            return VLC_EGENERIC;
+
+        filter_sys_t *sys = malloc(sizeof (*sys));
+        if (unlikely(sys == NULL))
+            return VLC_ENOMEM;
+
+        sys->convert = convert;
+        sys->src_size = cvt_vectors[i].src_size;
+        sys->dst_size = cvt_vectors[i].dst_size;
+        for (unsigned lane = 0; lane < DITHER_LANES; lane++)
+            sys->dither[lane] = UINT32_C(0x9E3779B9) * (lane + 1);
+
+        filter->p_sys = sys;
+        filter->ops = &vector_ops;
+        msg_Dbg(filter, "%4.4s->%4.4s using %s%s", (const char *)&src,
+                (const char *)&dst, isa, dither ? " with TPDF dither" : "");
+        return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
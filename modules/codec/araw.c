@@ -34,6 +34,7 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 #include <vlc_aout.h>
+#include <vlc_cpu.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -66,13 +67,23 @@ vlc_module_end ()
 static int DecodeBlock( decoder_t *, block_t * );
 static void Flush( decoder_t * );
 
+struct pcm_unpack;
+typedef size_t (*pcm_unpack_fn)( const struct pcm_unpack *, void *,
+                                 const uint8_t *, unsigned );
+
 typedef struct
 {
     void (*decode) (void *, const uint8_t *, unsigned);
+    const struct pcm_unpack *unpack;
+    pcm_unpack_fn unpack_simd;
     size_t framebits;
     date_t end_date;
 } decoder_sys_t;
 
+static void Unpack( decoder_sys_t *, void *, const uint8_t *, unsigned );
+static const struct pcm_unpack *GetUnpack( void (*)(void *, const uint8_t *, unsigned),
+                                           pcm_unpack_fn * );
+
 static void S8Decode( void *, const uint8_t *, unsigned );
 static void U16BDecode( void *, const uint8_t *, unsigned );
 static void U16LDecode( void *, const uint8_t *, unsigned );
@@ -282,6 +293,7 @@ static int DecoderOpen( vlc_object_t *p_this )
     aout_FormatPrepare( &p_dec->fmt_out.audio );
 
     p_sys->decode = decode;
+    p_sys->unpack = GetUnpack( decode, &p_sys->unpack_simd );
     p_sys->framebits = bits * p_dec->fmt_out.audio.i_channels;
     assert( p_sys->framebits );
 
@@ -343,8 +355,8 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
         if( p_out == NULL )
             goto skip;
 
-        p_sys->decode( p_out->p_buffer, p_block->p_buffer,
-                       samples * p_dec->fmt_in->audio.i_channels );
+        Unpack( p_sys, p_out->p_buffer, p_block->p_buffer,
+                samples * p_dec->fmt_in->audio.i_channels );
         block_Release( p_block );
         p_block = p_out;
     }
@@ -639,6 +651,294 @@ static void DAT12Decode( void *outp, const uint8_t *in, unsigned samples )
         *(out++) = dat12tos16(U16_AT(in) >> 4);
 }
 
+/*****************************************************************************
+ * Vectorized unpacking
+ *****************************************************************************
+ * Most conversions are a byte shuffle into a 16 bytes vector of output
+ * samples, followed by a XOR of the sign bits. The scalar decode function
+ * converts the remaining samples.
+ *****************************************************************************/
+#define PCM_S20 0x1 /* 20-bit pairs: mask even samples, shift odd ones */
+#define PCM_F32 0x2 /* replace non-finite floats with zeros */
+#define PCM_F64 0x4 /* replace non-finite doubles with zeros */
+
+struct pcm_unpack
+{
+    void (*decode) (void *, const uint8_t *, unsigned); /* scalar version */
+    uint8_t in_step; /* input bytes per vector of output */
+    uint8_t samples; /* output samples per vector */
+    uint8_t flags;
+    uint8_t shuffle[16];
+    uint8_t xor[16];
+};
+
+#define Z 0x80 /* zeroed byte */
+#define SWAP16 { 1,0, 3,2, 5,4, 7,6, 9,8, 11,10, 13,12, 15,14 }
+#define SWAP32 { 3,2,1,0, 7,6,5,4, 11,10,9,8, 15,14,13,12 }
+#define SWAP64 { 7,6,5,4,3,2,1,0, 15,14,13,12,11,10,9,8 }
+#define IDENTITY { 0,1,2,3,4,5,6,7, 8,9,10,11,12,13,14,15 }
+#define SIGN8  { [0 ... 15] = 0x80 }
+#define SIGN16 { [1] = 0x80, [3] = 0x80, [5] = 0x80, [7] = 0x80, \
+                 [9] = 0x80, [11] = 0x80, [13] = 0x80, [15] = 0x80 }
+#define SIGN32 { [3] = 0x80, [7] = 0x80, [11] = 0x80, [15] = 0x80 }
+
+static const struct pcm_unpack pcm_unpacks[] = {
+    { S8Decode,     16, 16, 0, IDENTITY, SIGN8 },
+    { U16BDecode,   16,  8, 0, SWAP16, SIGN16 },
+    { U16LDecode,   16,  8, 0, IDENTITY, SIGN16 },
+    { S16IDecode,   16,  8, 0, SWAP16, { 0 } },
+    { S20BDecode,   10,  4, PCM_S20,
+      { Z,2,1,0, Z,4,3,2, Z,7,6,5, Z,9,8,7 }, { 0 } },
+    { U24BDecode,   12,  4, 0,
+      { Z,2,1,0, Z,5,4,3, Z,8,7,6, Z,11,10,9 }, SIGN32 },
+    { U24LDecode,   12,  4, 0,
+      { Z,0,1,2, Z,3,4,5, Z,6,7,8, Z,9,10,11 }, SIGN32 },
+    { S24BDecode,   12,  4, 0,
+      { Z,2,1,0, Z,5,4,3, Z,8,7,6, Z,11,10,9 }, { 0 } },
+    { S24LDecode,   12,  4, 0,
+      { Z,0,1,2, Z,3,4,5, Z,6,7,8, Z,9,10,11 }, { 0 } },
+    { S24B32Decode, 16,  4, 0,
+      { Z,3,2,1, Z,7,6,5, Z,11,10,9, Z,15,14,13 }, { 0 } },
+    { S24L32Decode, 16,  4, 0,
+      { Z,0,1,2, Z,4,5,6, Z,8,9,10, Z,12,13,14 }, { 0 } },
+    { U32BDecode,   16,  4, 0, SWAP32, SIGN32 },
+    { U32LDecode,   16,  4, 0, IDENTITY, SIGN32 },
+    { S32IDecode,   16,  4, 0, SWAP32, { 0 } },
+    { F32NDecode,   16,  4, PCM_F32, IDENTITY, { 0 } },
+    { F32IDecode,   16,  4, PCM_F32, SWAP32, { 0 } },
+    { F64NDecode,   16,  2, PCM_F64, IDENTITY, { 0 } },
+    { F64IDecode,   16,  2, PCM_F64, SWAP64, { 0 } },
+};
+
+#undef SIGN32
+#undef SIGN16
+#undef SIGN8
+#undef IDENTITY
+#undef SWAP64
+#undef SWAP32
+#undef SWAP16
+#undef Z
+
+#if defined(CAN_COMPILE_SSE2) && !defined(WORDS_BIGENDIAN)
+# include <immintrin.h>
+# define PCM_UNPACK_X86
+
+__attribute__ ((__target__ ("ssse3")))
+static inline __m128i pcm_Fixup128( unsigned flags, __m128i v )
+{
+    if( flags & PCM_S20 )
+    {
+        const __m128i even = _mm_set_epi32( 0, 0xFFFFF000, 0, 0xFFFFF000 );
+        const __m128i odd = _mm_set_epi32( -1, 0, -1, 0 );
+
+        v = _mm_or_si128( _mm_and_si128( v, even ),
+                          _mm_and_si128( _mm_slli_epi32( v, 4 ), odd ) );
+    }
+    if( flags & PCM_F32 )
+    {
+        const __m128i exp = _mm_set1_epi32( 0x7F800000 );
+        __m128i bad = _mm_cmpeq_epi32( _mm_and_si128( v, exp ), exp );
+
+        v = _mm_andnot_si128( bad, v );
+    }
+    if( flags & PCM_F64 )
+    {
+        const __m128i exp = _mm_set1_epi64x( INT64_C(0x7FF0000000000000) );
+        __m128i bad = _mm_cmpeq_epi32( _mm_and_si128( v, exp ), exp );
+
+        /* the exponent is in the upper half of each double */
+        bad = _mm_shuffle_epi32( bad, _MM_SHUFFLE(3, 3, 1, 1) );
+        v = _mm_andnot_si128( bad, v );
+    }
+    return v;
+}
+
+__attribute__ ((__target__ ("ssse3")))
+static size_t pcm_UnpackSSSE3( const struct pcm_unpack *u, void *outp,
+                               const uint8_t *in, unsigned samples )
+{
+    const uint8_t *end = in + (size_t)samples * u->in_step / u->samples;
+    const __m128i shuffle = _mm_loadu_si128( (const __m128i *)u->shuffle );
+    const __m128i sign = _mm_loadu_si128( (const __m128i *)u->xor );
+    uint8_t *out = outp;
+    size_t done = 0;
+
+    while( end - in >= 16 )
+    {
+        __m128i v = _mm_loadu_si128( (const __m128i *)in );
+
+        v = _mm_xor_si128( _mm_shuffle_epi8( v, shuffle ), sign );
+        v = pcm_Fixup128( u->flags, v );
+        _mm_storeu_si128( (__m128i *)out, v );
+        in += u->in_step;
+        out += 16;
+        done += u->samples;
+    }
+    return done;
+}
+
+# ifdef CAN_COMPILE_AVX2
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i pcm_Fixup256( unsigned flags, __m256i v )
+{
+    if( flags & PCM_S20 )
+    {
+        const __m256i even = _mm256_set1_epi64x( INT64_C(0xFFFFF000) );
+        const __m256i odd = _mm256_set1_epi64x( INT64_C(0xFFFFFFFF00000000) );
+
+        v = _mm256_or_si256( _mm256_and_si256( v, even ),
+                             _mm256_and_si256( _mm256_slli_epi32( v, 4 ), odd ) );
+    }
+    if( flags & PCM_F32 )
+    {
+        const __m256i exp = _mm256_set1_epi32( 0x7F800000 );
+        __m256i bad = _mm256_cmpeq_epi32( _mm256_and_si256( v, exp ), exp );
+
+        v = _mm256_andnot_si256( bad, v );
+    }
+    if( flags & PCM_F64 )
+    {
+        const __m256i exp = _mm256_set1_epi64x( INT64_C(0x7FF0000000000000) );
+        __m256i bad = _mm256_cmpeq_epi64( _mm256_and_si256( v, exp ), exp );
+
+        v = _mm256_andnot_si256( bad, v );
+    }
+    return v;
+}
+
+__attribute__ ((__target__ ("avx2")))
+static size_t pcm_UnpackAVX2( const struct pcm_unpack *u, void *outp,
+                              const uint8_t *in, unsigned samples )
+{
+    const uint8_t *end = in + (size_t)samples * u->in_step / u->samples;
+    const __m256i shuffle = _mm256_broadcastsi128_si256(
+                            _mm_loadu_si128( (const __m128i *)u->shuffle ) );
+    const __m256i sign = _mm256_broadcastsi128_si256(
+                            _mm_loadu_si128( (const __m128i *)u->xor ) );
+    uint8_t *out = outp;
+    size_t done = 0;
+
+    /* vpshufb does not cross lanes: load each half separately */
+    while( end - in >= u->in_step + 16 )
+    {
+        __m256i v = _mm256_inserti128_si256( _mm256_castsi128_si256(
+                        _mm_loadu_si128( (const __m128i *)in ) ),
+                        _mm_loadu_si128( (const __m128i *)(in + u->in_step) ), 1 );
+
+        v = _mm256_xor_si256( _mm256_shuffle_epi8( v, shuffle ), sign );
+        v = pcm_Fixup256( u->flags, v );
+        _mm256_storeu_si256( (__m256i *)out, v );
+        in += 2 * u->in_step;
+        out += 32;
+        done += 2 * u->samples;
+    }
+
+    return done + pcm_UnpackSSSE3( u, out, in, samples - done );
+}
+# endif
+#endif
+
+#if defined(__aarch64__) && !defined(WORDS_BIGENDIAN)
+# include <arm_neon.h>
+# define PCM_UNPACK_NEON
+
+static size_t pcm_UnpackNEON( const struct pcm_unpack *u, void *outp,
+                              const uint8_t *in, unsigned samples )
+{
+    const uint8_t *end = in + (size_t)samples * u->in_step / u->samples;
+    const uint8x16_t shuffle = vld1q_u8( u->shuffle );
+    const uint8x16_t sign = vld1q_u8( u->xor );
+    uint8_t *out = outp;
+    size_t done = 0;
+
+    while( end - in >= 16 )
+    {
+        /* out of range indices, such as 0x80, give zeros */
+        uint8x16_t v = veorq_u8( vqtbl1q_u8( vld1q_u8( in ), shuffle ), sign );
+
+        if( u->flags & PCM_S20 )
+        {
+            const uint64x2_t even = vdupq_n_u64( UINT64_C(0xFFFFF000) );
+            const uint64x2_t odd = vdupq_n_u64( UINT64_C(0xFFFFFFFF00000000) );
+            uint32x4_t w = vreinterpretq_u32_u8( v );
+
+            w = vorrq_u32( vandq_u32( w, vreinterpretq_u32_u64( even ) ),
+                           vandq_u32( vshlq_n_u32( w, 4 ),
+                                      vreinterpretq_u32_u64( odd ) ) );
+            v = vreinterpretq_u8_u32( w );
+        }
+        if( u->flags & PCM_F32 )
+        {
+            const uint32x4_t exp = vdupq_n_u32( 0x7F800000 );
+            uint32x4_t w = vreinterpretq_u32_u8( v );
+
+            w = vbicq_u32( w, vceqq_u32( vandq_u32( w, exp ), exp ) );
+            v = vreinterpretq_u8_u32( w );
+        }
+        if( u->flags & PCM_F64 )
+        {
+            const uint64x2_t exp = vdupq_n_u64( UINT64_C(0x7FF0000000000000) );
+            uint64x2_t w = vreinterpretq_u64_u8( v );
+
+            w = vbicq_u64( w, vceqq_u64( vandq_u64( w, exp ), exp ) );
+            v = vreinterpretq_u8_u64( w );
+        }
+
+        vst1q_u8( out, v );
+        in += u->in_step;
+        out += 16;
+        done += u->samples;
+    }
+    return done;
+}
+#endif
+
+static const struct pcm_unpack *GetUnpack( void (*decode)(void *, const uint8_t *, unsigned),
+                                           pcm_unpack_fn *simd )
+{
+    pcm_unpack_fn fn = NULL;
+
+#ifdef PCM_UNPACK_X86
+# ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        fn = pcm_UnpackAVX2;
+    else
+# endif
+    if( vlc_CPU_SSSE3() )
+        fn = pcm_UnpackSSSE3;
+#endif
+#ifdef PCM_UNPACK_NEON
+    fn = pcm_UnpackNEON;
+#endif
+    if( fn == NULL )
+        return NULL;
+
+    for( size_t i = 0; i < ARRAY_SIZE(pcm_unpacks); i++ )
+        if( pcm_unpacks[i].decode == decode )
+        {
+            *simd = fn;
+            return &pcm_unpacks[i];
+        }
+    return NULL;
+}
+
+static void Unpack( decoder_sys_t *p_sys, void *outp, const uint8_t *in,
+                    unsigned samples )
+{
+    const struct pcm_unpack *u = p_sys->unpack;
+    uint8_t *out = outp;
+
+    if( u != NULL )
+    {
+        size_t done = p_sys->unpack_simd( u, out, in, samples );
+
+        out += done * (16 / u->samples);
+        in += done * u->in_step / u->samples;
+        samples -= done;
+    }
+    p_sys->decode( out, in, samples );
+}
+
 #ifdef ENABLE_SOUT
 /* NOTE: Output buffers are always aligned since they are allocated by the araw plugin.
  * Contrary to the decoder, the encoder can also assume that input buffers are aligned,
@@ -70,6 +70,8 @@ struct frame_info_s
 #endif
     bool b_eos;
     bool b_display;
+    bool b_pending;  /* sent, but not received yet */
+    bool b_dropping; /* sent while a frame dropping stage was active */
 };
 
 /*****************************************************************************
@@ -89,9 +91,12 @@ typedef struct
     /* for frame skipping algo */
     bool b_hurry_up;
     bool b_show_corrupted;
-    bool b_from_preroll;
     bool b_hardware_only;
     enum AVDiscard i_skip_frame;
+    enum AVDiscard i_skip_loop_filter;
+    bool b_dropping;
+    /* frames discarded by libavcodec while dropping, not notified yet */
+    atomic_uint i_dropped;
 
 #if OPAQUE_REF_ONLY
     uint64_t i_next_sequence_number;
@@ -100,17 +105,6 @@ typedef struct
     struct frame_info_s frame_info[FRAME_INFO_DEPTH];
 #endif
 
-    enum
-    {
-        FRAMEDROP_NONE,
-        FRAMEDROP_NONREF,
-        FRAMEDROP_AGGRESSIVE_RECOVER,
-    } framedrop;
-    /* how many decoded frames are late */
-    int     i_late_frames;
-    int64_t i_last_output_frame;
-    vlc_tick_t i_last_late_delay;
-
     /* for direct rendering */
     bool        b_direct_rendering;
     bool        b_dr_failure; /* Protected by lock */
@@ -165,36 +159,82 @@ static void FrameInfoInit( decoder_sys_t *p_sys )
 #else
     AVCodecContext *p_context = p_sys->p_context;
     p_context->reordered_opaque = 0;
+    memset( p_sys->frame_info, 0, sizeof(p_sys->frame_info) );
 #endif
+    atomic_init( &p_sys->i_dropped, 0 );
+}
+
+/* Frames that were sent but not received are discarded by libavcodec,
+ * count those skipped because of the frame dropping stage */
+static void FrameInfoDiscarded( decoder_sys_t *p_sys,
+                                const struct frame_info_s *p_frame_info )
+{
+    if( p_frame_info->b_pending && p_frame_info->b_dropping )
+        atomic_fetch_add_explicit( &p_sys->i_dropped, 1,
+                                   memory_order_relaxed );
+}
+
+static void FrameInfoFlush( decoder_sys_t *p_sys )
+{
+#if !OPAQUE_REF_ONLY
+    for( size_t i = 0; i < FRAME_INFO_DEPTH; i++ )
+        p_sys->frame_info[i].b_pending = false;
+#endif
+    /* The frames flushed were not skipped */
+    atomic_store_explicit( &p_sys->i_dropped, 0, memory_order_relaxed );
 }
 
 static struct frame_info_s * FrameInfoGet( decoder_sys_t *p_sys, AVFrame *frame )
 {
+    struct frame_info_s *p_frame_info;
 #if OPAQUE_REF_ONLY
     (void)p_sys;
     /* There's no pkt to frame opaque mapping guarantee */
-    return (struct frame_info_s *) frame->opaque_ref->data;
+    p_frame_info = (struct frame_info_s *) frame->opaque_ref->data;
 #else
-    return &p_sys->frame_info[frame->reordered_opaque % FRAME_INFO_DEPTH];
+    p_frame_info = &p_sys->frame_info[frame->reordered_opaque % FRAME_INFO_DEPTH];
 #endif
+    p_frame_info->b_pending = false;
+    return p_frame_info;
 }
 
+#if OPAQUE_REF_ONLY
+static void FrameInfoRelease( void *opaque, uint8_t *data )
+{
+    /* May be called from the libavcodec threads */
+    FrameInfoDiscarded( opaque, (const struct frame_info_s *) data );
+    av_free( data );
+}
+#endif
+
 static struct frame_info_s * FrameInfoAdd( decoder_sys_t *p_sys, AVPacket *pkt )
 {
+    struct frame_info_s *p_frame_info;
 #if OPAQUE_REF_ONLY
-    AVBufferRef *bufref = av_buffer_allocz(sizeof(struct frame_info_s));
+    p_frame_info = av_mallocz( sizeof(*p_frame_info) );
+    if( !p_frame_info )
+        return NULL;
+    AVBufferRef *bufref = av_buffer_create( (uint8_t *) p_frame_info,
+                                            sizeof(*p_frame_info),
+                                            FrameInfoRelease, p_sys, 0 );
     if( !bufref )
+    {
+        av_free( p_frame_info );
         return NULL;
+    }
     pkt->opaque_ref = bufref;
 
-    struct frame_info_s *p_frame_info = (struct frame_info_s *) bufref->data;
     p_frame_info->i_sequence_number = p_sys->i_next_sequence_number++;
-    return p_frame_info;
 #else
-    VLC_UNUSED(pkt);
     AVCodecContext *p_context = p_sys->p_context;
-    return &p_sys->frame_info[p_context->reordered_opaque++ % FRAME_INFO_DEPTH];
+    p_frame_info = &p_sys->frame_info[p_context->reordered_opaque++ % FRAME_INFO_DEPTH];
+    /* The slot is reused FRAME_INFO_DEPTH packets later */
+    FrameInfoDiscarded( p_sys, p_frame_info );
 #endif
+    /* No frame is expected from the drain packet */
+    p_frame_info->b_pending = pkt->size > 0;
+    p_frame_info->b_dropping = p_sys->b_dropping;
+    return p_frame_info;
 }
 
 static bool FrameCanStoreInfo( const AVFrame *frame )
@@ -216,27 +256,6 @@ static picture_t * FrameGetPicture( AVFrame *frame )
     return frame->opaque;
 }
 
-static int64_t NextPktSequenceNumber( decoder_sys_t *p_sys )
-{
-#if OPAQUE_REF_ONLY
-    return p_sys->i_next_sequence_number;
-#else
-    AVCodecContext *p_context = p_sys->p_context;
-    return p_context->reordered_opaque;
-#endif
-}
-
-static int64_t FrameSequenceNumber( const AVFrame *frame, const struct frame_info_s *info )
-{
-#if OPAQUE_REF_ONLY
-    VLC_UNUSED(frame);
-    return info->i_sequence_number;
-#else
-    VLC_UNUSED(info);
-    return frame->reordered_opaque;
-#endif
-}
-
 static void lavc_Frame8PaletteCopy( video_palette_t *dst, const uint8_t *src )
 {
     // (A << 24) | (R << 16) | (G << 8) | B
@@ -582,6 +601,7 @@ static int InitVideoDecCommon( decoder_t *p_dec )
     else if( i_val == 2 ) p_context->skip_loop_filter = AVDISCARD_BIDIR;
     else if( i_val == 1 ) p_context->skip_loop_filter = AVDISCARD_NONREF;
     else p_context->skip_loop_filter = AVDISCARD_DEFAULT;
+    p_sys->i_skip_loop_filter = p_context->skip_loop_filter;
 
     /* ***** libavcodec frame skipping ***** */
     p_sys->b_hurry_up = var_CreateGetBool( p_dec, "avcodec-hurry-up" );
@@ -643,6 +663,9 @@ static int InitVideoDecCommon( decoder_t *p_dec )
         max_thread_count = 6 ;
 # endif
 #endif
+        /* Share of the input budget, within the same limits */
+        if( p_dec->i_threads > 0 )
+            i_thread_count = __MIN( i_thread_count, (int)p_dec->i_threads );
     }
     else
         max_thread_count = p_codec->id == AV_CODEC_ID_HEVC ? 32 : 16;
@@ -667,6 +690,19 @@ static int InitVideoDecCommon( decoder_t *p_dec )
             break;
     }
 
+    switch( p_dec->threading )
+    {
+        case VLC_DECODER_THREADING_FRAME:
+            /* Keep slice threading for codecs without frame threading */
+            if( p_codec->capabilities & AV_CODEC_CAP_FRAME_THREADS )
+                p_context->thread_type &= ~FF_THREAD_SLICE;
+            break;
+        case VLC_DECODER_THREADING_SLICE:
+            p_context->thread_type &= ~FF_THREAD_FRAME;
+            break;
+        default:
+            break;
+    }
     if( var_InheritBool(p_dec, "low-delay") )
         p_context->thread_type &= ~FF_THREAD_FRAME;
 
@@ -676,10 +712,6 @@ static int InitVideoDecCommon( decoder_t *p_dec )
     /* ***** misc init ***** */
     date_Init(&p_sys->pts, 1, 30001);
     p_sys->b_first_frame = true;
-    p_sys->i_late_frames = 0;
-    p_sys->b_from_preroll = false;
-    p_sys->i_last_output_frame = -1;
-    p_sys->framedrop = FRAMEDROP_NONE;
 
     /* Set output properties */
     if (GetVlcChroma( &p_dec->fmt_out.video, p_context->pix_fmt ) == VLC_SUCCESS)
@@ -924,61 +956,53 @@ static void Flush( decoder_t *p_dec )
     decoder_sys_t *p_sys = p_dec->p_sys;
     AVCodecContext *p_context = p_sys->p_context;
 
-    p_sys->i_late_frames = 0;
-    p_sys->framedrop = FRAMEDROP_NONE;
     cc_Flush( &p_sys->cc );
 
     /* do not flush buffers if codec hasn't been opened (theora/vorbis/VC1) */
     if( avcodec_is_open( p_context ) )
         avcodec_flush_buffers( p_context );
+    FrameInfoFlush( p_sys );
 
     date_Set(&p_sys->pts, VLC_TICK_INVALID); /* To make sure we recover properly */
 }
 
-static block_t * filter_earlydropped_blocks( decoder_t *p_dec, block_t *block )
+/* Applies the frame dropping stage requested by the core, returns NULL if the
+ * block is dropped before decoding */
+static block_t * apply_drop_level( decoder_t *p_dec, block_t *block )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
+    AVCodecContext *p_context = p_sys->p_context;
 
-    if( !block )
-        return NULL;
-
-    if( block->i_flags & BLOCK_FLAG_PREROLL )
-    {
-        /* Do not care about late frames when prerolling
-         * TODO avoid decoding of non reference frame
-         * (ie all B except for H264 where it depends only on nal_ref_idc) */
-        p_sys->i_late_frames = 0;
-        p_sys->framedrop = FRAMEDROP_NONE;
-        p_sys->b_from_preroll = true;
-        p_sys->i_last_late_delay = VLC_TICK_MAX;
-    }
-
-    if( p_sys->i_late_frames == 0 )
-        p_sys->framedrop = FRAMEDROP_NONE;
+    enum vlc_decoder_drop_level level = decoder_GetDropLevel( p_dec );
 
-    if( p_sys->framedrop == FRAMEDROP_NONE && p_sys->i_late_frames < 11 )
+    p_context->skip_loop_filter = p_sys->i_skip_loop_filter;
+    if( level == VLC_DECODER_DROP_NONE )
         return block;
+    p_sys->b_dropping = true;
+
+    static const enum AVDiscard skip[] = {
+        [VLC_DECODER_DROP_NONREF] = AVDISCARD_NONREF,
+        [VLC_DECODER_DROP_BIDIR] = AVDISCARD_BIDIR,
+        [VLC_DECODER_DROP_LOOPFILTER] = AVDISCARD_BIDIR,
+        [VLC_DECODER_DROP_NONKEY] = AVDISCARD_NONKEY,
+    };
+    p_context->skip_frame = __MAX( p_context->skip_frame, skip[level] );
+    if( level >= VLC_DECODER_DROP_LOOPFILTER )
+        p_context->skip_loop_filter = AVDISCARD_ALL;
 
-    if( p_sys->i_last_output_frame >= 0 &&
-        NextPktSequenceNumber( p_sys ) - p_sys->i_last_output_frame > 24 )
-    {
-        p_sys->framedrop = FRAMEDROP_AGGRESSIVE_RECOVER;
-    }
+    if( !block )
+        return NULL;
 
-    /* A good idea could be to decode all I pictures and see for the other */
-    if( p_sys->framedrop == FRAMEDROP_AGGRESSIVE_RECOVER )
+    if( level == VLC_DECODER_DROP_NONKEY )
     {
+        /* Do not even parse what will be discarded */
         if( !(block->i_flags & BLOCK_FLAG_TYPE_I) )
         {
-            msg_Err( p_dec, "more than %"PRId64" frames of late video -> "
-                            "dropping frame (computer too slow ?)",
-                     NextPktSequenceNumber( p_sys ) - p_sys->i_last_output_frame );
-
             vlc_mutex_lock(&p_sys->lock);
             date_Set( &p_sys->pts, VLC_TICK_INVALID ); /* To make sure we recover properly */
             vlc_mutex_unlock(&p_sys->lock);
             block_Release( block );
-            p_sys->i_late_frames--;
+            decoder_NotifyDropped( p_dec, 1 );
             return NULL;
         }
     }
@@ -1003,41 +1027,6 @@ static vlc_tick_t interpolate_next_pts( decoder_t *p_dec, AVFrame *frame )
     return date_Increment( &p_sys->pts, i_tick + frame->repeat_pict );
 }
 
-static void update_late_frame_count( decoder_t *p_dec, block_t *p_block,
-                                     vlc_tick_t current_time, vlc_tick_t i_pts,
-                                     vlc_tick_t i_next_pts, int64_t i_fnum )
-{
-    decoder_sys_t *p_sys = p_dec->p_sys;
-   /* Update frame late count (except when doing preroll) */
-   vlc_tick_t i_display_date = VLC_TICK_INVALID;
-   if( !p_block || !(p_block->i_flags & BLOCK_FLAG_PREROLL) )
-       i_display_date = decoder_GetDisplayDate( p_dec, current_time, i_pts );
-
-   vlc_tick_t i_threshold = i_next_pts != VLC_TICK_INVALID
-                          ? (i_next_pts - i_pts) / 2 : VLC_TICK_FROM_MS(20);
-
-   if( i_display_date != VLC_TICK_INVALID && i_display_date + i_threshold <= current_time )
-   {
-       /* Out of preroll, consider only late frames on rising delay */
-       if( p_sys->b_from_preroll )
-       {
-           if( p_sys->i_last_late_delay > current_time - i_display_date )
-           {
-               p_sys->i_last_late_delay = current_time - i_display_date;
-               return;
-           }
-           p_sys->b_from_preroll = false;
-       }
-
-       p_sys->i_late_frames++;
-   }
-   else
-   {
-       p_sys->i_last_output_frame = i_fnum;
-       p_sys->i_late_frames = 0;
-   }
-}
-
 #if LIBAVUTIL_VERSION_CHECK( 57, 16, 100 )
 static void map_dovi_metadata( vlc_video_dovi_metadata_t *out,
                                const AVDOVIMetadata *data )
@@ -1324,17 +1313,17 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
         b_need_output_picture = false;
 
     /* Change skip_frame config only if hurry_up is enabled */
+    p_sys->b_dropping = false;
     if( p_sys->b_hurry_up )
     {
         p_context->skip_frame = p_sys->i_skip_frame;
 
-        /* Check also if we should/can drop the block and move to next block
-            as trying to catchup the speed*/
-        if( p_dec->b_frame_drop_allowed )
-            p_block = filter_earlydropped_blocks( p_dec, p_block );
+        /* Skip frames as requested by the core to catch up the speed */
+        if( b_need_output_picture )
+            p_block = apply_drop_level( p_dec, p_block );
     }
 
-    if( !b_need_output_picture || p_sys->framedrop == FRAMEDROP_NONREF )
+    if( !b_need_output_picture )
     {
         p_context->skip_frame = __MAX( p_context->skip_frame, AVDISCARD_NONREF );
     }
@@ -1358,7 +1347,6 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
 
     bool b_drain = ( pp_block == NULL );
     bool b_drained = false;
-    bool b_first_output_sequence = true;
 
     do
     {
@@ -1501,15 +1489,7 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
         if( i_pts != VLC_TICK_INVALID )
             date_Set( &p_sys->pts, i_pts );
 
-        const vlc_tick_t i_next_pts = interpolate_next_pts(p_dec, frame);
-
-        if( b_first_output_sequence )
-        {
-            if( p_frame_info )
-                update_late_frame_count( p_dec, p_block, vlc_tick_now(), i_pts,
-                                        i_next_pts, FrameSequenceNumber( frame, p_frame_info ) );
-            b_first_output_sequence = false;
-        }
+        interpolate_next_pts( p_dec, frame );
 
         if( (p_frame_info && !p_frame_info->b_display) ||
            ( !p_sys->p_va && !frame->linesize[0] ) ||
@@ -1641,6 +1621,11 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
     if( b_drained )
         avcodec_flush_buffers( p_sys->p_context );
 
+    unsigned i_dropped = atomic_exchange_explicit( &p_sys->i_dropped, 0,
+                                                   memory_order_relaxed );
+    if( i_dropped > 0 )
+        decoder_NotifyDropped( p_dec, i_dropped );
+
     if( p_block )
         block_Release( p_block );
 
@@ -1655,10 +1640,6 @@ static int DecodeVideo( decoder_t *p_dec, block_t *p_block )
     if( p_block &&
         p_block->i_flags & (BLOCK_FLAG_DISCONTINUITY|BLOCK_FLAG_CORRUPTED) )
     {
-        p_sys->i_late_frames = 0;
-        p_sys->i_last_output_frame = -1;
-        p_sys->framedrop = FRAMEDROP_NONE;
-
         vlc_mutex_lock(&p_sys->lock);
         date_Set( &p_sys->pts, VLC_TICK_INVALID ); /* To make sure we recover properly */
         vlc_mutex_unlock(&p_sys->lock);
@@ -436,7 +436,12 @@ static int OpenDecoder(vlc_object_t *p_this)
 #if DAV1D_API_VERSION_MAJOR >= 6
     p_sys->s.n_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
     if (p_sys->s.n_threads == 0)
+    {
         p_sys->s.n_threads = __MAX(1, vlc_GetCPUCount());
+        /* Share of the input budget */
+        if (dec->i_threads > 0)
+            p_sys->s.n_threads = __MIN(p_sys->s.n_threads, (int)dec->i_threads);
+    }
 
 #if DAV1D_API_VERSION_MAJOR > 6 || DAV1D_API_VERSION_MINOR >= 7
     // after dav1d 1.0.0
@@ -457,6 +462,10 @@ static int OpenDecoder(vlc_object_t *p_this)
     else
         p_sys->s.max_frame_delay = fc_lut[p_sys->s.n_threads - 1];
 #endif
+    /* A single frame in flight: the threads work on tiles and post-filters
+     * of the same frame, without adding latency */
+    if (dec->threading == VLC_DECODER_THREADING_SLICE)
+        p_sys->s.max_frame_delay = 1;
 
 #else // before dav1d 1.0.0
     p_sys->s.n_tile_threads = var_InheritInteger(p_this, "dav1d-thread-tiles");
@@ -464,7 +473,17 @@ static int OpenDecoder(vlc_object_t *p_this)
         p_sys->s.n_tile_threads = VLC_CLIP(vlc_GetCPUCount(), 1, 4);
     p_sys->s.n_frame_threads = var_InheritInteger(p_this, "dav1d-thread-frames");
     if (p_sys->s.n_frame_threads == 0)
-        p_sys->s.n_frame_threads = __MAX(1, vlc_GetCPUCount());
+    {
+        if (dec->threading == VLC_DECODER_THREADING_SLICE)
+            p_sys->s.n_frame_threads = 1;
+        else
+        {
+            p_sys->s.n_frame_threads = __MAX(1, vlc_GetCPUCount());
+            if (dec->i_threads > 0)
+                p_sys->s.n_frame_threads = __MIN(p_sys->s.n_frame_threads,
+                                                 (int)dec->i_threads);
+        }
+    }
 #endif
     p_sys->s.all_layers = var_InheritBool( p_this, "dav1d-all-layers" );
     p_sys->s.allocator.cookie = dec;
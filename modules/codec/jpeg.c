@@ -473,6 +473,38 @@ static int jpeg_GetOrientation( j_decompress_ptr cinfo )
     return orientation;
 }
 
+/*
+ * Selects the smallest DCT scaling keeping the output at least as large as
+ * the size requested by the decoder owner: the IDCT, upsampling and color
+ * conversion work shrinks with the output.
+ */
+static void jpeg_SetScale( decoder_t *p_dec, j_decompress_ptr cinfo )
+{
+    unsigned i_width = p_dec->i_target_width;
+    unsigned i_height = p_dec->i_target_height;
+
+    if( i_width == 0 && i_height == 0 )
+        return;
+
+    cinfo->scale_denom = 8;
+    for( unsigned i_num = 1; i_num < 8; i_num++ )
+    {
+#if JPEG_LIB_VERSION < 70 && !defined(LIBJPEG_TURBO_VERSION)
+        /* Only 1/8, 1/4 and 1/2 are supported by older libjpeg */
+        if( i_num & (i_num - 1) )
+            continue;
+#endif
+        /* libjpeg rounds the scaled dimensions up */
+        if( (cinfo->image_width * i_num + 7) / 8 >= i_width &&
+            (cinfo->image_height * i_num + 7) / 8 >= i_height )
+        {
+            cinfo->scale_num = i_num;
+            return;
+        }
+    }
+    cinfo->scale_num = 8;
+}
+
 /*
  * This function must be fed with a complete compressed frame.
  */
@@ -507,6 +539,7 @@ static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
     jpeg_read_header(&p_sys->p_jpeg, TRUE);
 
     p_sys->p_jpeg.out_color_space = JCS_RGB;
+    jpeg_SetScale(p_dec, &p_sys->p_jpeg);
 
     jpeg_start_decompress(&p_sys->p_jpeg);
 
@@ -39,6 +39,7 @@
 #include <vlc_input.h>
 #include <vlc_dialog.h>
 #include <vlc_stream.h>
+#include <vlc_cpu.h>
 
 #include <ass/ass.h>
 
@@ -89,6 +90,19 @@ typedef struct
 
     /* */
     ASS_Track      *p_track;
+
+    /* Subpicture updates statistics, protected by lock */
+    struct
+    {
+        unsigned   i_updates;
+        unsigned   i_unchanged;
+        unsigned   i_regions_reused;
+        unsigned   i_regions_partial;
+        unsigned   i_regions_full;
+        vlc_tick_t i_render_time;
+        vlc_tick_t i_draw_time;
+        vlc_tick_t i_max_time;
+    } stats;
 } decoder_sys_t;
 static void DecSysRelease( decoder_sys_t *p_sys );
 static void DecSysHold( decoder_sys_t *p_sys );
@@ -100,12 +114,6 @@ static void SubpictureUpdate( subpicture_t *,
                               vlc_tick_t );
 static void SubpictureDestroy( subpicture_t * );
 
-typedef struct
-{
-    decoder_sys_t *p_dec_sys;
-    vlc_tick_t    i_pts;
-} libass_spu_updater_sys_t;
-
 typedef struct
 {
     int x0;
@@ -114,8 +122,32 @@ typedef struct
     int y1;
 } rectangle_t;
 
+/* Summary of an ASS_Image, used to find what changed between two frames */
+typedef struct
+{
+    rectangle_t r;
+    uint32_t    i_color;
+    uint64_t    i_hash;
+} image_desc_t;
+
+typedef struct
+{
+    decoder_sys_t *p_dec_sys;
+    vlc_tick_t    i_pts;
+
+    /* Images of the last drawn frame */
+    image_desc_t  *p_desc;
+    int           i_desc;
+} libass_spu_updater_sys_t;
+
+static int r_surface( const rectangle_t *r );
 static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_img_list, int i_width, int i_height );
-static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img );
+static int BuildDescs( image_desc_t **pp_desc, ASS_Image *p_img_list );
+static bool RegionDirty( rectangle_t *p_dirty, const rectangle_t *p_region,
+                         const image_desc_t *p_old, int i_old,
+                         const image_desc_t *p_new, int i_new );
+static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img,
+                        const rectangle_t *p_clip );
 static void OldEngineClunkyRollInfoPatch( decoder_t *p_dec, ASS_Track * );
 
 //#define DEBUG_REGION
@@ -146,6 +178,7 @@ static int Create( vlc_object_t *p_this )
     p_sys->p_library  = NULL;
     p_sys->p_renderer = NULL;
     p_sys->p_track    = NULL;
+    memset( &p_sys->stats, 0, sizeof(p_sys->stats) );
 
     /* Create libass library */
     ASS_Library *p_library = p_sys->p_library = ass_library_init();
@@ -286,8 +319,23 @@ static int Create( vlc_object_t *p_this )
 static void Destroy( vlc_object_t *p_this )
 {
     decoder_t *p_dec = (decoder_t *)p_this;
+    decoder_sys_t *p_sys = p_dec->p_sys;
 
-    DecSysRelease( p_dec->p_sys );
+    vlc_mutex_lock( &p_sys->lock );
+    const unsigned i_updates = p_sys->stats.i_updates;
+    if( i_updates > 0 )
+        msg_Dbg( p_dec, "%u subpicture updates (%u unchanged), regions: "
+                 "%u reused, %u partially and %u fully drawn, "
+                 "render %"PRId64" us, draw %"PRId64" us on average, "
+                 "%"PRId64" us at most", i_updates, p_sys->stats.i_unchanged,
+                 p_sys->stats.i_regions_reused, p_sys->stats.i_regions_partial,
+                 p_sys->stats.i_regions_full,
+                 US_FROM_VLC_TICK( p_sys->stats.i_render_time / i_updates ),
+                 US_FROM_VLC_TICK( p_sys->stats.i_draw_time / i_updates ),
+                 US_FROM_VLC_TICK( p_sys->stats.i_max_time ) );
+    vlc_mutex_unlock( &p_sys->lock );
+
+    DecSysRelease( p_sys );
 }
 
 static void DecSysHold( decoder_sys_t *p_sys )
@@ -385,6 +433,8 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
 
         p_spu_sys->p_dec_sys = p_sys;
         p_spu_sys->i_pts = p_block->i_pts;
+        p_spu_sys->p_desc = NULL;
+        p_spu_sys->i_desc = 0;
         p_spu->i_start = p_block->i_pts;
         p_spu->i_stop = __MAX( p_sys->i_max_stop, p_block->i_pts + p_block->i_length );
         p_spu->b_ephemer = true;
@@ -445,19 +495,42 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     }
 
     /* */
+    const vlc_tick_t i_start = vlc_tick_now();
     const vlc_tick_t i_stream_date = p_spusys->i_pts + (i_ts - p_subpic->i_start);
     int i_changed;
     ASS_Image *p_img = ass_render_frame( p_sys->p_renderer, p_sys->p_track,
                                          MS_FROM_VLC_TICK( i_stream_date ), &i_changed );
+    const vlc_tick_t i_rendered = vlc_tick_now();
+
+    p_sys->stats.i_updates++;
+    p_sys->stats.i_render_time += i_rendered - i_start;
 
     if( !i_changed && !b_fmt_src && !b_fmt_dst &&
         (p_img != NULL) == (!vlc_spu_regions_is_empty(&p_subpic->regions)) )
     {
+        p_sys->stats.i_unchanged++;
         vlc_mutex_unlock( &p_sys->lock );
         return;
     }
 
-    vlc_spu_regions_Clear( &p_subpic->regions );
+    /* Keep the current regions, they can be reused as long as the images
+     * drawn inside did not change */
+    vlc_spu_regions old_regions;
+    vlc_spu_regions_init( &old_regions );
+    if( !b_fmt_src && !b_fmt_dst )
+    {
+        subpicture_region_t *r;
+        vlc_spu_regions_foreach( r, &p_subpic->regions )
+        {
+            vlc_spu_regions_remove( &p_subpic->regions, r );
+            vlc_spu_regions_push( &old_regions, r );
+        }
+    }
+    else
+        vlc_spu_regions_Clear( &p_subpic->regions );
+
+    image_desc_t *p_desc;
+    int i_desc = BuildDescs( &p_desc, p_img );
 
     /* */
     p_subpic->i_original_picture_height = p_fmt_dst->i_visible_height;
@@ -473,12 +546,6 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     rectangle_t region[i_max_region];
     const int i_region = BuildRegions( region, i_max_region, p_img, p_fmt_dst->i_width, p_fmt_dst->i_height );
 
-    if( i_region <= 0 )
-    {
-        vlc_mutex_unlock( &p_sys->lock );
-        return;
-    }
-
     /* Allocate the regions and draw them */
     video_format_t fmt_region;
     fmt_region = *p_fmt_dst;
@@ -488,6 +555,8 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
     for( int i = 0; i < i_region; i++ )
     {
         subpicture_region_t *r;
+        subpicture_region_t *p_old = NULL;
+        rectangle_t dirty;
 
         /* */
         fmt_region.i_width =
@@ -495,6 +564,31 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         fmt_region.i_height =
         fmt_region.i_visible_height = region[i].y1 - region[i].y0;
 
+        if( p_spusys->p_desc != NULL && p_desc != NULL )
+        {
+            vlc_spu_regions_foreach( r, &old_regions )
+            {
+                if( r->i_x == region[i].x0 && r->i_y == region[i].y0 &&
+                    r->p_picture->format.i_width == fmt_region.i_width &&
+                    r->p_picture->format.i_height == fmt_region.i_height )
+                {
+                    p_old = r;
+                    break;
+                }
+            }
+        }
+
+        if( p_old != NULL &&
+            !RegionDirty( &dirty, &region[i], p_spusys->p_desc, p_spusys->i_desc,
+                          p_desc, i_desc ) )
+        {
+            /* Nothing changed inside, the region can be used as is */
+            vlc_spu_regions_remove( &old_regions, p_old );
+            vlc_spu_regions_push( &p_subpic->regions, p_old );
+            p_sys->stats.i_regions_reused++;
+            continue;
+        }
+
         r = subpicture_region_New( &fmt_region );
         if( !r )
             break;
@@ -503,12 +597,33 @@ static void SubpictureUpdate( subpicture_t *p_subpic,
         r->i_y = region[i].y0;
         r->i_align = SUBPICTURE_ALIGN_TOP | SUBPICTURE_ALIGN_LEFT;
 
-        /* */
-        RegionDraw( r, p_img );
+        /* The region in use may still be displayed, so only the dirty
+         * rectangle is redrawn into a copy of it */
+        if( p_old != NULL && r_surface( &dirty ) < r_surface( &region[i] ) )
+        {
+            plane_CopyPixels( &r->p_picture->p[0], &p_old->p_picture->p[0] );
+            RegionDraw( r, p_img, &dirty );
+            p_sys->stats.i_regions_partial++;
+        }
+        else
+        {
+            RegionDraw( r, p_img, NULL );
+            p_sys->stats.i_regions_full++;
+        }
 
         /* */
         vlc_spu_regions_push(&p_subpic->regions, r);
     }
+    vlc_spu_regions_Clear( &old_regions );
+
+    free( p_spusys->p_desc );
+    p_spusys->p_desc = p_desc;
+    p_spusys->i_desc = i_desc;
+
+    const vlc_tick_t i_drawn = vlc_tick_now();
+    p_sys->stats.i_draw_time += i_drawn - i_rendered;
+    p_sys->stats.i_max_time = __MAX( p_sys->stats.i_max_time, i_drawn - i_start );
+
     vlc_mutex_unlock( &p_sys->lock );
 
 }
@@ -517,6 +632,7 @@ static void SubpictureDestroy( subpicture_t *p_subpic )
     libass_spu_updater_sys_t *p_spusys = p_subpic->updater.sys;
 
     DecSysRelease( p_spusys->p_dec_sys );
+    free( p_spusys->p_desc );
     free( p_spusys );
 }
 
@@ -674,15 +790,259 @@ static int BuildRegions( rectangle_t *p_region, int i_max_region, ASS_Image *p_i
     return i_region;
 }
 
-static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
+static uint64_t BitmapHash( const ASS_Image *p_img )
+{
+    const uint64_t i_mul = UINT64_C(0x9e3779b97f4a7c15);
+    uint64_t h = ((uint64_t)p_img->w << 32) | (unsigned)p_img->h;
+    const uint8_t *p_row = p_img->bitmap;
+
+    for( int y = 0; y < p_img->h; y++, p_row += p_img->stride )
+    {
+        int x = 0;
+        for( ; x + 8 <= p_img->w; x += 8 )
+        {
+            uint64_t v;
+            memcpy( &v, &p_row[x], sizeof(v) );
+            h = (h ^ v) * i_mul;
+            h ^= h >> 29;
+        }
+        for( ; x < p_img->w; x++ )
+        {
+            h = (h ^ p_row[x]) * i_mul;
+            h ^= h >> 29;
+        }
+    }
+    return h;
+}
+
+/* Returns the number of drawable images, and their descriptions in *pp_desc,
+ * NULL on allocation error */
+static int BuildDescs( image_desc_t **pp_desc, ASS_Image *p_img_list )
+{
+    int i_count = 0;
+    for( ASS_Image *p_tmp = p_img_list; p_tmp != NULL; p_tmp = p_tmp->next )
+        if( p_tmp->w > 0 && p_tmp->h > 0 )
+            i_count++;
+
+    image_desc_t *p_desc = vlc_alloc( i_count ? i_count : 1, sizeof(*p_desc) );
+    *pp_desc = p_desc;
+    if( !p_desc )
+        return 0;
+
+    int i = 0;
+    for( ASS_Image *p_tmp = p_img_list; p_tmp != NULL; p_tmp = p_tmp->next )
+    {
+        if( p_tmp->w <= 0 || p_tmp->h <= 0 )
+            continue;
+        p_desc[i].r = r_img( p_tmp );
+        p_desc[i].i_color = p_tmp->color;
+        p_desc[i].i_hash = BitmapHash( p_tmp );
+        i++;
+    }
+    return i_count;
+}
+
+static bool r_inside( const rectangle_t *r, const rectangle_t *p_region )
+{
+    return r->x0 >= p_region->x0 && r->x1 <= p_region->x1 &&
+           r->y0 >= p_region->y0 && r->y1 <= p_region->y1;
+}
+
+static bool desc_equal( const image_desc_t *a, const image_desc_t *b )
+{
+    return a->r.x0 == b->r.x0 && a->r.y0 == b->r.y0 &&
+           a->r.x1 == b->r.x1 && a->r.y1 == b->r.y1 &&
+           a->i_color == b->i_color && a->i_hash == b->i_hash;
+}
+
+static void dirty_add( rectangle_t *p_dirty, bool *pb_dirty, const rectangle_t *r )
+{
+    if( *pb_dirty )
+        r_add( p_dirty, r );
+    else
+        *p_dirty = *r;
+    *pb_dirty = true;
+}
+
+/* Computes the area of a region that differs between the old and new images,
+ * returns false if there is none.
+ * Only the images fully inside the region are drawn into it, in order, so a
+ * pixel that no mismatching pair of images covers keeps its value. */
+static bool RegionDirty( rectangle_t *p_dirty, const rectangle_t *p_region,
+                         const image_desc_t *p_old, int i_old,
+                         const image_desc_t *p_new, int i_new )
+{
+    bool b_dirty = false;
+    int i = 0, j = 0;
+
+    for( ;; )
+    {
+        while( i < i_old && !r_inside( &p_old[i].r, p_region ) )
+            i++;
+        while( j < i_new && !r_inside( &p_new[j].r, p_region ) )
+            j++;
+
+        if( i < i_old && j < i_new )
+        {
+            if( !desc_equal( &p_old[i], &p_new[j] ) )
+            {
+                dirty_add( p_dirty, &b_dirty, &p_old[i].r );
+                dirty_add( p_dirty, &b_dirty, &p_new[j].r );
+            }
+            i++;
+            j++;
+        }
+        else if( i < i_old )
+            dirty_add( p_dirty, &b_dirty, &p_old[i++].r );
+        else if( j < i_new )
+            dirty_add( p_dirty, &b_dirty, &p_new[j++].r );
+        else
+            break;
+    }
+    return b_dirty;
+}
+
+typedef void (*blend_row_t)( uint8_t *, const uint8_t *, int,
+                             unsigned, unsigned, unsigned, unsigned );
+
+static void BlendRow( uint8_t *dst, const uint8_t *src, int i_width,
+                      unsigned r, unsigned g, unsigned b, unsigned a )
+{
+    for( int x = 0; x < i_width; x++ )
+    {
+        unsigned opacity = *src++; /* 1 Bpp channel */
+        if( opacity != 0 ) /* we need to blend only non transparent content */
+        {
+            unsigned i_an = a * opacity / 255U;
+            unsigned i_ao = dst[3];
+            if( i_ao == 0 )
+            {
+                dst[0] = r;
+                dst[1] = g;
+                dst[2] = b;
+                dst[3] = i_an;
+            }
+            else
+            {
+                unsigned i_ani = 255 - i_an;
+                dst[3] = 255 - (255 - i_ao) * i_ani / 255;
+                if( dst[3] != 0 )
+                {
+                    unsigned i_aoni = i_ao * i_ani / 255;
+                    dst[0] = ( dst[0] * i_aoni + r * i_an ) / dst[3];
+                    dst[1] = ( dst[1] * i_aoni + g * i_an ) / dst[3];
+                    dst[2] = ( dst[2] * i_aoni + b * i_an ) / dst[3];
+                }
+            }
+        }
+        dst += 4;
+    }
+}
+
+#if defined(CAN_COMPILE_SSE2) && !defined(WORDS_BIGENDIAN)
+# include <emmintrin.h>
+
+/* All the products are below 2^17 and the divisors at most 255, so a
+ * truncated single precision quotient is the exact integer quotient: this
+ * matches BlendRow() bit for bit, 4 pixels at a time. */
+__attribute__ ((__target__ ("sse2")))
+static void BlendRowSSE2( uint8_t *dst, const uint8_t *src, int i_width,
+                          unsigned r, unsigned g, unsigned b, unsigned a )
+{
+#define TRUNC(v) _mm_cvtepi32_ps( _mm_cvttps_epi32( v ) )
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i mask = _mm_set1_epi32( 0xff );
+    const __m128 f255 = _mm_set1_ps( 255.f );
+    const __m128 f1 = _mm_set1_ps( 1.f );
+    const __m128 fa = _mm_set1_ps( a );
+    const __m128 fr = _mm_set1_ps( r );
+    const __m128 fg = _mm_set1_ps( g );
+    const __m128 fb = _mm_set1_ps( b );
+    const __m128i color = _mm_set1_epi32( r | (g << 8) | (b << 16) );
+    int x = 0;
+
+    for( ; x + 4 <= i_width; x += 4 )
+    {
+        uint32_t i_op;
+        memcpy( &i_op, &src[x], sizeof(i_op) );
+        if( i_op == 0 )
+            continue;
+
+        __m128i op = _mm_cvtsi32_si128( i_op );
+        op = _mm_unpacklo_epi16( _mm_unpacklo_epi8( op, zero ), zero );
+        __m128i d = _mm_loadu_si128( (const __m128i *)&dst[4 * x] );
+        __m128i ao = _mm_srli_epi32( d, 24 );
+
+        __m128 f_ao = _mm_cvtepi32_ps( ao );
+        __m128 f_an = TRUNC( _mm_div_ps( _mm_mul_ps( fa, _mm_cvtepi32_ps( op ) ), f255 ) );
+        __m128 f_ani = _mm_sub_ps( f255, f_an );
+        __m128 f_na = _mm_sub_ps( f255, TRUNC( _mm_div_ps(
+                        _mm_mul_ps( _mm_sub_ps( f255, f_ao ), f_ani ), f255 ) ) );
+        __m128 f_aoni = TRUNC( _mm_div_ps( _mm_mul_ps( f_ao, f_ani ), f255 ) );
+        __m128 f_div = _mm_max_ps( f_na, f1 );
+
+#define CHANNEL(c, shift) \
+        _mm_slli_epi32( _mm_cvttps_epi32( _mm_div_ps( _mm_add_ps( \
+            _mm_mul_ps( _mm_cvtepi32_ps( _mm_and_si128( _mm_srli_epi32( d, shift ), mask ) ), f_aoni ), \
+            _mm_mul_ps( c, f_an ) ), f_div ) ), shift )
+
+        __m128i i_na = _mm_cvttps_epi32( f_na );
+        __m128i blended = _mm_or_si128( _mm_or_si128( CHANNEL( fr, 0 ), CHANNEL( fg, 8 ) ),
+                                        CHANNEL( fb, 16 ) );
+#undef CHANNEL
+        /* Fully transparent results keep their color */
+        __m128i transparent = _mm_cmpeq_epi32( i_na, zero );
+        blended = _mm_or_si128( _mm_and_si128( transparent, _mm_andnot_si128( _mm_set1_epi32( 0xff000000 ), d ) ),
+                                _mm_andnot_si128( transparent, blended ) );
+        blended = _mm_or_si128( blended, _mm_slli_epi32( i_na, 24 ) );
+
+        /* Transparent destinations take the color as is */
+        __m128i empty = _mm_cmpeq_epi32( ao, zero );
+        __m128i filled = _mm_or_si128( color, _mm_slli_epi32( _mm_cvttps_epi32( f_an ), 24 ) );
+        blended = _mm_or_si128( _mm_and_si128( empty, filled ),
+                                _mm_andnot_si128( empty, blended ) );
+
+        /* Transparent source pixels are left untouched */
+        __m128i skip = _mm_cmpeq_epi32( op, zero );
+        blended = _mm_or_si128( _mm_and_si128( skip, d ),
+                                _mm_andnot_si128( skip, blended ) );
+
+        _mm_storeu_si128( (__m128i *)&dst[4 * x], blended );
+    }
+#undef TRUNC
+
+    BlendRow( &dst[4 * x], &src[x], i_width - x, r, g, b, a );
+}
+#endif
+
+/* Draws the images inside the region, restricted to p_clip if not NULL,
+ * in absolute coordinates */
+static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img,
+                        const rectangle_t *p_clip )
 {
     const plane_t *p = &p_region->p_picture->p[0];
     const int i_x = p_region->i_x;
     const int i_y = p_region->i_y;
     const int i_width  = p_region->p_picture->format.i_width;
     const int i_height = p_region->p_picture->format.i_height;
+    const rectangle_t clip = p_clip != NULL ? *p_clip :
+        r_create( i_x, i_y, i_x + i_width, i_y + i_height );
+
+    blend_row_t blend = BlendRow;
+#if defined(CAN_COMPILE_SSE2) && !defined(WORDS_BIGENDIAN)
+    if( vlc_CPU_SSE2() )
+        blend = BlendRowSSE2;
+#endif
+
+    if( p_clip == NULL )
+        memset( p->p_pixels, 0x00, p->i_pitch * p->i_visible_lines );
+    else
+    {
+        for( int y = clip.y0; y < clip.y1; y++ )
+            memset( &p->p_pixels[(y - i_y) * p->i_pitch + 4 * (clip.x0 - i_x)],
+                    0x00, 4 * (clip.x1 - clip.x0) );
+    }
 
-    memset( p->p_pixels, 0x00, p->i_pitch * p->i_visible_lines );
     for( ; p_img != NULL; p_img = p_img->next )
     {
         int i_dst_x = p_img->dst_x - i_x;
@@ -700,45 +1060,23 @@ static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
         const unsigned g = (p_img->color >> 16)&0xff;
         const unsigned b = (p_img->color >>  8)&0xff;
 
-        const uint8_t *srcrow = p_img->bitmap;
+        /* Clip the image, in absolute coordinates */
+        const int x0 = __MAX( p_img->dst_x, clip.x0 );
+        const int y0 = __MAX( p_img->dst_y, clip.y0 );
+        const int x1 = __MIN( p_img->dst_x + p_img->w, clip.x1 );
+        const int y1 = __MIN( p_img->dst_y + p_img->h, clip.y1 );
+        if( x0 >= x1 || y0 >= y1 )
+            continue;
+
         int i_pitch_src = p_img->stride;
         int i_pitch_dst = p->i_pitch;
-        uint8_t *dstrow = &p->p_pixels[i_dst_y * i_pitch_dst + 4 * i_dst_x];
+        const uint8_t *srcrow = &p_img->bitmap[(y0 - p_img->dst_y) * i_pitch_src +
+                                               (x0 - p_img->dst_x)];
+        uint8_t *dstrow = &p->p_pixels[(y0 - i_y) * i_pitch_dst + 4 * (x0 - i_x)];
 
-        for( int y = 0; y < p_img->h; y++ )
+        for( int y = y0; y < y1; y++ )
         {
-            const uint8_t *src = srcrow;
-            uint8_t *dst = dstrow;
-
-            for( int x = 0; x < p_img->w; x++ )
-            {
-                unsigned opacity = *src++; /* 1 Bpp channel */
-                if( opacity != 0 ) /* we need to blend only non transparent content */
-                {
-                    unsigned i_an = a * opacity / 255U;
-                    unsigned i_ao = dst[3];
-                    if( i_ao == 0 )
-                    {
-                        dst[0] = r;
-                        dst[1] = g;
-                        dst[2] = b;
-                        dst[3] = i_an;
-                    }
-                    else
-                    {
-                        unsigned i_ani = 255 - i_an;
-                        dst[3] = 255 - (255 - i_ao) * i_ani / 255;
-                        if( dst[3] != 0 )
-                        {
-                            unsigned i_aoni = i_ao * i_ani / 255;
-                            dst[0] = ( dst[0] * i_aoni + r * i_an ) / dst[3];
-                            dst[1] = ( dst[1] * i_aoni + g * i_an ) / dst[3];
-                            dst[2] = ( dst[2] * i_aoni + b * i_an ) / dst[3];
-                        }
-                    }
-                }
-                dst += 4;
-            }
+            blend( dstrow, srcrow, x1 - x0, r, g, b, a );
             srcrow += i_pitch_src;
             dstrow += i_pitch_dst;
         }
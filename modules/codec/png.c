@@ -240,6 +240,67 @@ static int make_xmp_packet( const video_format_t *fmt, png_textp chunk )
 
 #endif
 
+/*
+ * Returns the power of two decimation keeping the output at least as large as
+ * the size requested by the decoder owner. Interlaced images are not
+ * decimated, as their rows are not read in order.
+ */
+static unsigned GetDecimation( const decoder_t *p_dec, png_uint_32 i_width,
+                               png_uint_32 i_height, int i_interlace_type )
+{
+    unsigned i_shift = 0;
+
+    if( (p_dec->i_target_width == 0 && p_dec->i_target_height == 0) ||
+        i_interlace_type != PNG_INTERLACE_NONE )
+        return 0;
+
+    while( i_shift < 4 )
+    {
+        unsigned i_next = i_shift + 1;
+        if( ((i_width + (1u << i_next) - 1) >> i_next) < p_dec->i_target_width ||
+            ((i_height + (1u << i_next) - 1) >> i_next) < p_dec->i_target_height )
+            break;
+        i_shift = i_next;
+    }
+    return i_shift;
+}
+
+/*
+ * Reads the rows one by one, box filtering them into the decimated picture,
+ * so that the full size picture is neither allocated nor scaled afterwards.
+ */
+static void ReadDecimated( png_structp p_png, picture_t *p_pic,
+                           png_bytep p_row, uint32_t *p_acc,
+                           png_uint_32 i_width, png_uint_32 i_height,
+                           unsigned i_pixel, unsigned i_shift )
+{
+    const unsigned i_factor = 1u << i_shift;
+    const unsigned i_out_width = (i_width + i_factor - 1) >> i_shift;
+
+    for( png_uint_32 y = 0; y < i_height; y += i_factor )
+    {
+        unsigned i_rows = __MIN( i_factor, i_height - y );
+
+        memset( p_acc, 0, i_out_width * i_pixel * sizeof(*p_acc) );
+        for( unsigned r = 0; r < i_rows; r++ )
+        {
+            png_read_row( p_png, p_row, NULL );
+            for( png_uint_32 x = 0; x < i_width; x++ )
+                for( unsigned c = 0; c < i_pixel; c++ )
+                    p_acc[(x >> i_shift) * i_pixel + c] += p_row[x * i_pixel + c];
+        }
+
+        uint8_t *p_dst = &p_pic->p->p_pixels[(y >> i_shift) * p_pic->p->i_pitch];
+        for( unsigned x = 0; x < i_out_width; x++ )
+        {
+            unsigned i_count = i_rows * __MIN( i_factor, i_width - (x << i_shift) );
+            for( unsigned c = 0; c < i_pixel; c++ )
+                p_dst[x * i_pixel + c] =
+                    (p_acc[x * i_pixel + c] + i_count / 2) / i_count;
+        }
+    }
+}
+
 /****************************************************************************
  * DecodeBlock: the whole thing
  ****************************************************************************
@@ -257,6 +318,8 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     png_structp p_png;
     png_infop p_info, p_end_info;
     png_bytep *volatile p_row_pointers = NULL;
+    uint8_t *volatile p_scratch = NULL;
+    unsigned i_shift;
 
     if( !p_block ) /* No Drain */
         return VLCDEC_SUCCESS;
@@ -307,10 +370,14 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
                   &i_compression_type, &i_filter_type);
     if( p_sys->b_error ) goto error;
 
+    i_shift = GetDecimation( p_dec, i_width, i_height, i_interlace_type );
+
     /* Set output properties */
     p_dec->fmt_out.i_codec = VLC_CODEC_RGBA;
-    p_dec->fmt_out.video.i_visible_width = p_dec->fmt_out.video.i_width = i_width;
-    p_dec->fmt_out.video.i_visible_height = p_dec->fmt_out.video.i_height = i_height;
+    p_dec->fmt_out.video.i_visible_width = p_dec->fmt_out.video.i_width =
+        (i_width + (1u << i_shift) - 1) >> i_shift;
+    p_dec->fmt_out.video.i_visible_height = p_dec->fmt_out.video.i_height =
+        (i_height + (1u << i_shift) - 1) >> i_shift;
     p_dec->fmt_out.video.i_sar_num = 1;
     p_dec->fmt_out.video.i_sar_den = 1;
 
@@ -382,19 +449,43 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
 
 
     /* Decode picture */
-    p_row_pointers = vlc_alloc( i_height, sizeof(png_bytep) );
-    if( !p_row_pointers )
-        goto error;
-    for( i = 0; i < (int)i_height; i++ )
-        p_row_pointers[i] = p_pic->p->p_pixels + p_pic->p->i_pitch * i;
+    if( i_shift > 0 )
+    {
+        png_read_update_info( p_png, p_info );
+        if( p_sys->b_error ) goto error;
 
-    png_read_image( p_png, p_row_pointers );
-    if( p_sys->b_error ) goto error;
+        size_t i_rowbytes = png_get_rowbytes( p_png, p_info );
+        unsigned i_pixel = p_dec->fmt_out.i_codec == VLC_CODEC_RGBA ? 4 : 3;
+        size_t i_accoffset = (i_rowbytes + 3) & ~(size_t)3;
+        size_t i_accsize = p_dec->fmt_out.video.i_width * i_pixel;
+        if( i_rowbytes != (size_t)i_width * i_pixel )
+            goto error;
+
+        p_scratch = malloc( i_accoffset + i_accsize * sizeof(uint32_t) );
+        if( !p_scratch )
+            goto error;
+        ReadDecimated( p_png, p_pic, p_scratch,
+                       (uint32_t *)&p_scratch[i_accoffset],
+                       i_width, i_height, i_pixel, i_shift );
+        if( p_sys->b_error ) goto error;
+    }
+    else
+    {
+        p_row_pointers = vlc_alloc( i_height, sizeof(png_bytep) );
+        if( !p_row_pointers )
+            goto error;
+        for( i = 0; i < (int)i_height; i++ )
+            p_row_pointers[i] = p_pic->p->p_pixels + p_pic->p->i_pitch * i;
+
+        png_read_image( p_png, p_row_pointers );
+        if( p_sys->b_error ) goto error;
+    }
     png_read_end( p_png, p_end_info );
     if( p_sys->b_error ) goto error;
 
     png_destroy_read_struct( &p_png, &p_info, &p_end_info );
     free( p_row_pointers );
+    free( p_scratch );
 
     p_pic->date = p_block->i_pts != VLC_TICK_INVALID ? p_block->i_pts : p_block->i_dts;
 
@@ -407,6 +498,7 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     if( p_pic )
         picture_Release( p_pic );
     free( p_row_pointers );
+    free( p_scratch );
     png_destroy_read_struct( &p_png, &p_info, &p_end_info );
     block_Release( p_block );
     return VLCDEC_SUCCESS;
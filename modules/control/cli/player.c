@@ -922,6 +922,10 @@ static int Statistics(struct cli_client *cl, const char *const *args,
                    item->p_stats->i_late_pictures);
         cli_printf(cl, _("| frames lost      :    %5"PRIi64),
                    item->p_stats->i_lost_pictures);
+        cli_printf(cl, _("| frames dropped   :    %5"PRIi64),
+                   item->p_stats->i_dropped_video);
+        cli_printf(cl, _("| dropping stage   :    %5u"),
+                   item->p_stats->i_video_drop_level);
         cli_printf(cl, "|");
 
         /* Audio*/
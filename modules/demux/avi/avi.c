@@ -29,7 +29,10 @@
 #endif
 #include <assert.h>
 #include <ctype.h>
+#include <errno.h>
 #include <limits.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
 
 #include <vlc_common.h>
 #include <vlc_arrays.h>
@@ -39,6 +42,10 @@
 #include <vlc_aout.h>
 
 #include <vlc_dialog.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+#include <vlc_configuration.h>
 
 #include <vlc_meta.h>
 #include <vlc_codecs.h>
@@ -60,17 +67,25 @@
 #define INDEX_TEXT N_("Force index creation")
 #define INDEX_LONGTEXT N_( \
     "Recreate a index for the AVI file. Use this if your AVI file is damaged "\
-    "or incomplete (not seekable)." )
+    "or incomplete (not seekable). The index of local files is read while " \
+    "playing, and the action is taken once it is found to be incomplete." )
+
+#define INDEX_CACHE_TEXT N_("Cache created indexes")
+#define INDEX_CACHE_LONGTEXT N_( \
+    "Store the indexes created for damaged or incomplete local AVI files in " \
+    "the cache directory, so that they do not need to be created again. " \
+    "The oldest indexes are removed when the cache grows too large." )
 
 static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
-static const int pi_index[] = {0,1,2,3};
+static const int pi_index[] = {0,1,2,3,4};
 
 static const char *const ppsz_indexes[] = { N_("Ask for action"),
                                             N_("Always fix"),
                                             N_("Never fix"),
-                                            N_("Fix when necessary")};
+                                            N_("Fix when necessary"),
+                                            N_("Fix in background")};
 
 vlc_module_begin ()
     set_shortname( "AVI" )
@@ -84,6 +99,8 @@ vlc_module_begin ()
     add_integer( "avi-index", 0,
               INDEX_TEXT, INDEX_LONGTEXT )
         change_integer_list( pi_index, ppsz_indexes )
+    add_bool( "avi-index-cache", true,
+              INDEX_CACHE_TEXT, INDEX_CACHE_LONGTEXT )
 
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -186,6 +203,8 @@ typedef struct
 
 } avi_track_t;
 
+typedef struct avi_index_builder_t avi_index_builder_t;
+
 typedef struct
 {
     vlc_tick_t i_time;
@@ -204,6 +223,8 @@ typedef struct
     uint64_t i_movi_begin;
     uint64_t i_movi_lastchunk_pos;   /* XXX position of last valid chunk */
 
+    avi_index_builder_t *p_index_builder; /* index read or created in background */
+
     /* number of streams and information */
     unsigned int i_track;
     avi_track_t  **track;
@@ -231,14 +252,21 @@ static int AVI_StreamBytesSet ( demux_t *, avi_track_t *, uint64_t i_byte );
 vlc_fourcc_t AVI_FourccGetCodec( unsigned int i_cat, vlc_fourcc_t );
 static int   AVI_GetKeyFlag    ( const avi_track_t *, const uint8_t * );
 
-static int AVI_PacketGetHeader( demux_t *, avi_packet_t *p_pk );
-static int AVI_PacketNext     ( demux_t * );
-static int AVI_PacketSearch   ( demux_t * );
+static int AVI_PacketGetHeader( stream_t *, avi_packet_t *p_pk );
+static int AVI_PacketNext     ( stream_t * );
+static int AVI_PacketSearch   ( demux_t *, stream_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
 static void AVI_IndexCreate  ( demux_t * );
+static void AVI_IndexFix     ( demux_t * );
+static int  AVI_IndexCheck   ( demux_t *, bool b_playing );
+static int  AVI_IndexCacheLoad( demux_t * );
+static int  AVI_IndexBuilderStart( demux_t *, bool b_load );
+static int  AVI_IndexBuilderCollect( demux_t *, bool b_wait );
+static void AVI_IndexBuilderStop( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
+static void AVI_TrackFixBeOS( demux_t * );
 static avi_track_t * AVI_GetVideoTrackForXsub( demux_sys_t * );
 static int AVI_SeekSubtitleTrack( demux_sys_t *, avi_track_t * );
 
@@ -331,6 +359,8 @@ static void Close ( vlc_object_t * p_this )
     demux_t *    p_demux = (demux_t *)p_this;
     demux_sys_t *p_sys = p_demux->p_sys  ;
 
+    AVI_IndexBuilderStop( p_demux );
+
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         if( p_sys->track[i] )
@@ -361,7 +391,7 @@ static int Open( vlc_object_t * p_this )
     demux_t  *p_demux = (demux_t *)p_this;
     demux_sys_t     *p_sys;
 
-    bool       b_index = false, b_aborted = false;
+    bool       b_index_pending = false, b_aborted = false;
     int              i_do_index;
 
     avi_chunk_list_t    *p_riff;
@@ -773,19 +803,13 @@ static int Open( vlc_object_t * p_this )
     i_do_index = var_InheritInteger( p_demux, "avi-index" );
     if( i_do_index == 1 ) /* Always fix */
     {
-aviindex:
-        if( p_sys->b_fastseekable )
-        {
-            AVI_IndexCreate( p_demux );
-        }
-        else if( p_sys->b_seekable )
-        {
-            AVI_IndexLoad( p_demux );
-        }
-        else
-        {
-            msg_Warn( p_demux, "cannot create index (unseekable stream)" );
-        }
+        AVI_IndexFix( p_demux );
+    }
+    else if( p_sys->b_fastseekable && !p_demux->b_preparsing &&
+             AVI_IndexBuilderStart( p_demux, true ) == VLC_SUCCESS )
+    {
+        /* Play right away, the index is checked once read */
+        b_index_pending = true;
     }
     else if( p_sys->b_seekable )
     {
@@ -795,100 +819,14 @@ aviindex:
     /* *** movie length in vlc_tick_t *** */
     p_sys->i_length = AVI_MovieGetLength( p_demux );
 
-    /* Check the index completeness */
-    unsigned int i_idx_totalframes = 0;
-    for( unsigned int i = 0; i < p_sys->i_track; i++ )
-    {
-        const avi_track_t *tk = p_sys->track[i];
-        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
-            i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
-    }
-    if( i_idx_totalframes != p_avih->i_totalframes &&
-        p_sys->i_length < VLC_TICK_FROM_US( p_avih->i_totalframes *
-                                            p_avih->i_microsecperframe ) )
+    if( !b_index_pending )
     {
-        msg_Warn( p_demux, "broken or missing index, 'seek' will be "
-                           "approximative or will exhibit strange behavior" );
-        if( (i_do_index == 0 || i_do_index == 3) && !b_index )
+        if( AVI_IndexCheck( p_demux, false ) )
         {
-            if( !p_sys->b_fastseekable ) {
-                b_index = true;
-                goto aviindex;
-            }
-            if( i_do_index == 0 )
-            {
-                const char *psz_msg = _(
-                    "Because this file index is broken or missing, "
-                    "seeking will not work correctly.\n"
-                    "VLC won't repair your file but can temporary fix this "
-                    "problem by building an index in memory.\n"
-                    "This step might take a long time on a large file.\n"
-                    "What do you want to do?");
-                switch( vlc_dialog_wait_question( p_demux,
-                                                  VLC_DIALOG_QUESTION_NORMAL,
-                                                  _("Do not play"),
-                                                  _("Build index then play"),
-                                                  _("Play as is"),
-                                                  _("Broken or missing Index"),
-                                                  "%s", psz_msg ) )
-                {
-                    case 0:
-                        b_aborted = true;
-                        goto error;
-                    case 1:
-                        b_index = true;
-                        msg_Dbg( p_demux, "Fixing AVI index" );
-                        goto aviindex;
-                }
-            }
-            else
-            {
-                b_index = true;
-                msg_Dbg( p_demux, "Fixing AVI index" );
-                goto aviindex;
-            }
-        }
-    }
-
-    /* fix some BeOS MediaKit generated file */
-    for( unsigned i = 0 ; i < p_sys->i_track; i++ )
-    {
-        avi_track_t         *tk = p_sys->track[i];
-        avi_chunk_list_t    *p_strl;
-        avi_chunk_strf_auds_t    *p_auds;
-
-        if( tk->fmt.i_cat != AUDIO_ES )
-        {
-            continue;
-        }
-        if( tk->idx.i_size < 1 ||
-            tk->i_scale != 1 ||
-            tk->i_samplesize != 0 )
-        {
-            continue;
-        }
-        p_strl = AVI_ChunkFind( p_hdrl, AVIFOURCC_strl, tk->fmt.i_id, true );
-        p_auds = AVI_ChunkFind( p_strl, AVIFOURCC_strf, 0, false );
-
-        if( p_auds &&
-            p_auds->p_wf->wFormatTag != WAVE_FORMAT_PCM &&
-            tk->i_rate == p_auds->p_wf->nSamplesPerSec )
-        {
-            int64_t i_track_length =
-                tk->idx.p_entry[tk->idx.i_size-1].i_length +
-                tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
-            vlc_tick_t i_length = VLC_TICK_FROM_US( p_avih->i_totalframes *
-                                                    p_avih->i_microsecperframe );
-
-            if( i_length == 0 )
-            {
-                msg_Warn( p_demux, "track[%u] cannot be fixed (BeOS MediaKit generated)", i );
-                continue;
-            }
-            tk->i_samplesize = 1;
-            tk->i_rate       = i_track_length  * CLOCK_FREQ / i_length;
-            msg_Warn( p_demux, "track[%u] fixed with rate=%u scale=%u (BeOS MediaKit generated)", i, tk->i_rate, tk->i_scale );
+            b_aborted = true;
+            goto error;
         }
+        AVI_TrackFixBeOS( p_demux );
     }
 
     if( p_sys->b_seekable )
@@ -1083,6 +1021,10 @@ static int Demux_Seekable( demux_t *p_demux )
 
     unsigned int i_track_count = 0;
 
+    /* The user may choose not to play once the index is read */
+    if( AVI_IndexBuilderCollect( p_demux, false ) )
+        return VLC_DEMUXER_EOF;
+
     /* detect new selected/unselected streams */
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
@@ -1244,7 +1186,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
                     return VLC_DEMUXER_EGENERIC;
 
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return( AVI_TrackStopFinishedStreams( p_demux ) ? 0 : 1 );
                 }
@@ -1259,7 +1201,7 @@ static int Demux_Seekable( demux_t *p_demux )
             {
                 avi_packet_t avi_pk;
 
-                if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+                if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
                 {
                     msg_Warn( p_demux,
                              "cannot get packet header, track disabled" );
@@ -1268,7 +1210,7 @@ static int Demux_Seekable( demux_t *p_demux )
                 if( avi_pk.i_stream >= p_sys->i_track ||
                     ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
                 {
-                    if( AVI_PacketNext( p_demux ) )
+                    if( AVI_PacketNext( p_demux->s ) )
                     {
                         msg_Warn( p_demux,
                                   "cannot skip packet, track disabled" );
@@ -1302,7 +1244,7 @@ static int Demux_Seekable( demux_t *p_demux )
                     }
                     else
                     {
-                        if( AVI_PacketNext( p_demux ) )
+                        if( AVI_PacketNext( p_demux->s ) )
                         {
                             msg_Warn( p_demux,
                                       "cannot skip packet, track disabled" );
@@ -1488,7 +1430,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
     {
         avi_packet_t    avi_pk;
 
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             return VLC_DEMUXER_EOF;
         }
@@ -1505,18 +1447,18 @@ static int Demux_UnSeekable( demux_t *p_demux )
                 case AVIFOURCC_JUNK:
                 case AVIFOURCC_LIST:
                 case AVIFOURCC_RIFF:
-                    return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                    return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                 case AVIFOURCC_idx1:
                     if( p_sys->b_odml )
                     {
-                        return( !AVI_PacketNext( p_demux ) ? 1 : 0 );
+                        return( !AVI_PacketNext( p_demux->s ) ? 1 : 0 );
                     }
                     return VLC_DEMUXER_EOF;
                 default:
                     msg_Warn( p_demux,
                               "seems to have lost position @%"PRIu64", resync",
                               vlc_stream_Tell(p_demux->s) );
-                    if( AVI_PacketSearch( p_demux ) )
+                    if( AVI_PacketSearch( p_demux, p_demux->s ) )
                     {
                         msg_Err( p_demux, "resync failed" );
                         return VLC_DEMUXER_EGENERIC;
@@ -1547,7 +1489,7 @@ static int Demux_UnSeekable( demux_t *p_demux )
             }
             else
             {
-                if( AVI_PacketNext( p_demux ) )
+                if( AVI_PacketNext( p_demux->s ) )
                 {
                     return VLC_DEMUXER_EOF;
                 }
@@ -1587,6 +1529,10 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
     {
         uint64_t i_pos_backup = vlc_stream_Tell( p_demux->s );
 
+        /* The index being read is needed to seek */
+        if( AVI_IndexBuilderCollect( p_demux, true ) )
+            return VLC_EGENERIC;
+
         /* Check and lazy load indexes if it was not done (not fastseekable) */
         if ( !p_sys->b_indexloaded && ( p_sys->i_avih_flags & AVIF_HASINDEX ) )
         {
@@ -1960,7 +1906,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, avi_track_t *tk )
     {
         if (vlc_stream_Seek(p_demux->s, p_sys->i_movi_lastchunk_pos))
             return VLC_EGENERIC;
-        if( AVI_PacketNext( p_demux ) )
+        if( AVI_PacketNext( p_demux->s ) )
         {
             return VLC_EGENERIC;
         }
@@ -1973,7 +1919,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, avi_track_t *tk )
 
     for( ;; )
     {
-        if( AVI_PacketGetHeader( p_demux, &avi_pk ) )
+        if( AVI_PacketGetHeader( p_demux->s, &avi_pk ) )
         {
             msg_Warn( p_demux, "cannot get packet header" );
             return VLC_EGENERIC;
@@ -1981,7 +1927,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, avi_track_t *tk )
         if( avi_pk.i_stream >= p_sys->i_track ||
             ( avi_pk.i_cat != AUDIO_ES && avi_pk.i_cat != VIDEO_ES ) )
         {
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -2006,7 +1952,7 @@ static int AVI_StreamChunkFind( demux_t *p_demux, avi_track_t *tk )
                 return VLC_SUCCESS;
             }
 
-            if( AVI_PacketNext( p_demux ) )
+            if( AVI_PacketNext( p_demux->s ) )
             {
                 return VLC_EGENERIC;
             }
@@ -2318,17 +2264,17 @@ static void AVI_ParseStreamHeader( vlc_fourcc_t i_id,
 /****************************************************************************
  *
  ****************************************************************************/
-static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
+static int AVI_PacketGetHeader( stream_t *s, avi_packet_t *p_pk )
 {
     const uint8_t *p_peek;
 
-    if( vlc_stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+    if( vlc_stream_Peek( s, &p_peek, 16 ) < 16 )
     {
         return VLC_EGENERIC;
     }
     p_pk->i_fourcc  = VLC_FOURCC( p_peek[0], p_peek[1], p_peek[2], p_peek[3] );
     p_pk->i_size    = GetDWLE( p_peek + 4 );
-    p_pk->i_pos     = vlc_stream_Tell( p_demux->s );
+    p_pk->i_pos     = vlc_stream_Tell( s );
     if( p_pk->i_fourcc == AVIFOURCC_LIST || p_pk->i_fourcc == AVIFOURCC_RIFF )
     {
         p_pk->i_type = VLC_FOURCC( p_peek[8],  p_peek[9],
@@ -2345,12 +2291,12 @@ static int AVI_PacketGetHeader( demux_t *p_demux, avi_packet_t *p_pk )
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketNext( demux_t *p_demux )
+static int AVI_PacketNext( stream_t *s )
 {
     avi_packet_t    avi_ck;
     uint32_t        i_skip = 0;
 
-    if( AVI_PacketGetHeader( p_demux, &avi_ck ) )
+    if( AVI_PacketGetHeader( s, &avi_ck ) )
     {
         return VLC_EGENERIC;
     }
@@ -2377,14 +2323,14 @@ static int AVI_PacketNext( demux_t *p_demux )
         return VLC_EGENERIC;
 #endif
 
-    if( vlc_stream_Read( p_demux->s, NULL, i_skip ) != i_skip )
+    if( vlc_stream_Read( s, NULL, i_skip ) != i_skip )
     {
         return VLC_EGENERIC;
     }
     return VLC_SUCCESS;
 }
 
-static int AVI_PacketSearch( demux_t *p_demux )
+static int AVI_PacketSearch( demux_t *p_demux, stream_t *s )
 {
     demux_sys_t     *p_sys = p_demux->p_sys;
     avi_packet_t    avi_pk;
@@ -2392,11 +2338,11 @@ static int AVI_PacketSearch( demux_t *p_demux )
 
     for( ;; )
     {
-        if( vlc_stream_Read( p_demux->s, NULL, 1 ) != 1 )
+        if( vlc_stream_Read( s, NULL, 1 ) != 1 )
         {
             return VLC_EGENERIC;
         }
-        AVI_PacketGetHeader( p_demux, &avi_pk );
+        AVI_PacketGetHeader( s, &avi_pk );
         if( avi_pk.i_stream < p_sys->i_track &&
             ( avi_pk.i_cat == AUDIO_ES || avi_pk.i_cat == VIDEO_ES ) )
         {
@@ -2472,21 +2418,22 @@ static int64_t avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
     return p_index->i_size - 1;
 }
 
-static int AVI_IndexFind_idx1( demux_t *p_demux,
-                               avi_chunk_idx1_t **pp_idx1,
+/* Reads the idx1 entries into a copy of its chunk, to be released with
+ * AVI_ChunkUnload_idx1() */
+static int AVI_IndexFind_idx1( demux_t *p_demux, stream_t *s,
+                               avi_chunk_idx1_t *p_idx1,
                                uint64_t *pi_offset )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
     avi_chunk_list_t *p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true);
-    avi_chunk_idx1_t *p_idx1 = AVI_ChunkFind( p_riff, AVIFOURCC_idx1, 0, false);
+    avi_chunk_idx1_t *p_chunk = AVI_ChunkFind( p_riff, AVIFOURCC_idx1, 0, false);
 
-    if( !p_idx1 )
+    if( !p_chunk )
     {
         msg_Warn( p_demux, "cannot find idx1 chunk, no index defined" );
         return VLC_EGENERIC;
     }
-    *pp_idx1 = p_idx1;
 
     /* The offset in the index should be from the start of the movi content,
      * but some broken files use offset from the start of the file. Just
@@ -2496,6 +2443,13 @@ static int AVI_IndexFind_idx1( demux_t *p_demux,
     avi_chunk_list_t *p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
     if( !p_movi )
         return VLC_EGENERIC;
+
+    *p_idx1 = *p_chunk;
+    if( AVI_ChunkLoad_idx1( s, p_idx1 ) )
+    {
+        msg_Warn( p_demux, "cannot read idx1 chunk" );
+        return VLC_EGENERIC;
+    }
     uint64_t i_first_pos = UINT64_MAX;
     for( unsigned i = 0; i < __MIN( p_idx1->i_entry_count, 100 ); i++ )
     {
@@ -2511,8 +2465,8 @@ static int AVI_IndexFind_idx1( demux_t *p_demux,
     else if( p_sys->b_seekable && i_first_pos < UINT64_MAX )
     {
         const uint8_t *p_peek;
-        if( !vlc_stream_Seek( p_demux->s, i_movi_content + i_first_pos ) &&
-            vlc_stream_Peek( p_demux->s, &p_peek, 4 ) >= 4 &&
+        if( !vlc_stream_Seek( s, i_movi_content + i_first_pos ) &&
+            vlc_stream_Peek( s, &p_peek, 4 ) >= 4 &&
             ( !isdigit( p_peek[0] ) || !isdigit( p_peek[1] ) ||
               !isalpha( p_peek[2] ) || !isalpha( p_peek[3] ) ) )
             *pi_offset = 0;
@@ -2537,33 +2491,31 @@ static int AVI_IndexFind_idx1( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int AVI_IndexLoad_idx1( demux_t *p_demux,
+static int AVI_IndexLoad_idx1( demux_t *p_demux, stream_t *s,
                                avi_index_t p_index[], uint64_t *pi_last_offset )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
-    avi_chunk_idx1_t *p_idx1;
+    avi_chunk_idx1_t idx1;
     uint64_t         i_offset;
-    if( AVI_IndexFind_idx1( p_demux, &p_idx1, &i_offset ) )
+    if( AVI_IndexFind_idx1( p_demux, s, &idx1, &i_offset ) )
         return VLC_EGENERIC;
 
-    p_sys->b_indexloaded = true;
-
-    for( unsigned i_index = 0; i_index < p_idx1->i_entry_count; i_index++ )
+    for( unsigned i_index = 0; i_index < idx1.i_entry_count; i_index++ )
     {
         enum es_format_category_e i_cat;
         unsigned i_stream;
 
-        AVI_ParseStreamHeader( p_idx1->entry[i_index].i_fourcc,
+        AVI_ParseStreamHeader( idx1.entry[i_index].i_fourcc,
                                &i_stream,
                                &i_cat );
         if( i_stream < p_sys->i_track &&
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
-            index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
-            index.i_length = p_idx1->entry[i_index].i_length;
+            index.i_flags  = idx1.entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
+            index.i_pos    = idx1.entry[i_index].i_pos + i_offset;
+            index.i_length = idx1.entry[i_index].i_length;
             index.i_lengthtotal = index.i_length;
 
             avi_index_Append( &p_index[i_stream], pi_last_offset, &index );
@@ -2571,7 +2523,7 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
     }
 
 #ifdef AVI_DEBUG
-    for( unsigned i_index = 0; i_index< p_idx1->i_entry_count && i_index < p_sys->i_track; i_index++ )
+    for( unsigned i_index = 0; i_index< idx1.i_entry_count && i_index < p_sys->i_track; i_index++ )
     {
         for( unsigned i = 0; i < p_index[i_index].i_size; i++ )
         {
@@ -2590,17 +2542,15 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
         }
     }
 #endif
+    AVI_ChunkUnload_idx1( &idx1 );
     return VLC_SUCCESS;
 }
 
 static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_max_offset,
                           avi_chunk_indx_t *p_indx )
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
     avi_entry_t index;
 
-    p_sys->b_indexloaded = true;
-
     msg_Dbg( p_demux, "loading subindex(0x%x) %d entries", p_indx->i_indextype, p_indx->i_entriesinuse );
     if( p_indx->i_indexsubtype == 0 )
     {
@@ -2632,10 +2582,12 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     }
 }
 
-static void AVI_IndexLoad_indx( demux_t *p_demux,
+/* Returns true if an ODML index was found */
+static bool AVI_IndexLoad_indx( demux_t *p_demux, stream_t *s,
                                 avi_index_t p_index[], uint64_t *pi_last_offset )
 {
     demux_sys_t         *p_sys = p_demux->p_sys;
+    bool                b_found = false;
 
     avi_chunk_list_t    *p_riff;
     avi_chunk_list_t    *p_hdrl;
@@ -2662,24 +2614,27 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
         if( p_indx->i_indextype == AVI_INDEX_OF_CHUNKS )
         {
             __Parse_indx( p_demux, &p_index[i_stream], pi_last_offset, p_indx );
+            b_found = true;
         }
         else if( p_indx->i_indextype == AVI_INDEX_OF_INDEXES )
         {
             if ( !p_sys->b_seekable )
-                return;
+                return b_found;
             avi_chunk_t    ck_sub;
             for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
             {
-                if( vlc_stream_Seek( p_demux->s,
-                                     p_indx->idx.super[i].i_offset ) ||
-                    AVI_ChunkRead( p_demux->s, &ck_sub, NULL  ) )
+                if( vlc_stream_Seek( s, p_indx->idx.super[i].i_offset ) ||
+                    AVI_ChunkRead( s, &ck_sub, NULL  ) )
                 {
                     break;
                 }
                 if( ck_sub.common.i_chunk_fourcc == AVIFOURCC_indx &&
                      ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS )
+                {
                     __Parse_indx( p_demux, &p_index[i_stream], pi_last_offset, &ck_sub.indx );
-                AVI_ChunkClean( p_demux->s, &ck_sub );
+                    b_found = true;
+                }
+                AVI_ChunkClean( s, &ck_sub );
             }
         }
         else
@@ -2687,9 +2642,14 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
             msg_Warn( p_demux, "unknown type index(0x%x)", p_indx->i_indextype );
         }
     }
+    return b_found;
 }
 
-static void AVI_IndexLoad( demux_t *p_demux )
+/* Reads the ODML and standard indexes, keeping the longest one of each track.
+ * This does not touch the tracks and may run out of the demux thread.
+ * Returns true if an index was found. */
+static bool AVI_IndexRead( demux_t *p_demux, stream_t *s,
+                           avi_index_t p_index[], uint64_t *pi_last_pos )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
@@ -2702,12 +2662,13 @@ static void AVI_IndexLoad( demux_t *p_demux )
         avi_index_Init( &p_idx_indx[i] );
         avi_index_Init( &p_idx_idx1[i] );
     }
-    uint64_t i_indx_last_pos = p_sys->i_movi_lastchunk_pos;
-    uint64_t i_idx1_last_pos = p_sys->i_movi_lastchunk_pos;
+    uint64_t i_indx_last_pos = *pi_last_pos;
+    uint64_t i_idx1_last_pos = *pi_last_pos;
 
-    AVI_IndexLoad_indx( p_demux, p_idx_indx, &i_indx_last_pos );
-    if( !p_sys->b_odml )
-        AVI_IndexLoad_idx1( p_demux, p_idx_idx1, &i_idx1_last_pos );
+    bool b_found = AVI_IndexLoad_indx( p_demux, s, p_idx_indx, &i_indx_last_pos );
+    if( !p_sys->b_odml &&
+        AVI_IndexLoad_idx1( p_demux, s, p_idx_idx1, &i_idx1_last_pos ) == VLC_SUCCESS )
+        b_found = true;
 
     /* Select the longest index */
     for( unsigned i = 0; i < p_sys->i_track; i++ )
@@ -2715,103 +2676,124 @@ static void AVI_IndexLoad( demux_t *p_demux )
         if( p_idx_indx[i].i_size > p_idx_idx1[i].i_size )
         {
             msg_Dbg( p_demux, "selected ODML index for stream[%u]", i );
-            free(p_sys->track[i]->idx.p_entry);
-            p_sys->track[i]->idx = p_idx_indx[i];
+            p_index[i] = p_idx_indx[i];
             avi_index_Clean( &p_idx_idx1[i] );
         }
         else
         {
             msg_Dbg( p_demux, "selected standard index for stream[%u]", i );
-            free(p_sys->track[i]->idx.p_entry);
-            p_sys->track[i]->idx = p_idx_idx1[i];
+            p_index[i] = p_idx_idx1[i];
             avi_index_Clean( &p_idx_indx[i] );
         }
     }
-    p_sys->i_movi_lastchunk_pos = __MAX( i_indx_last_pos, i_idx1_last_pos );
+    *pi_last_pos = __MAX( i_indx_last_pos, i_idx1_last_pos );
 
     for( unsigned i = 0; i < p_sys->i_track; i++ )
     {
-        avi_index_t *p_index = &p_sys->track[i]->idx;
-
         /* Fix key flag */
         bool b_key = false;
-        for( unsigned j = 0; !b_key && j < p_index->i_size; j++ )
-            b_key = p_index->p_entry[j].i_flags & AVIIF_KEYFRAME;
+        for( unsigned j = 0; !b_key && j < p_index[i].i_size; j++ )
+            b_key = p_index[i].p_entry[j].i_flags & AVIIF_KEYFRAME;
         if( !b_key )
         {
             msg_Warn( p_demux, "no key frame set for track %u", i );
-            for( unsigned j = 0; j < p_index->i_size; j++ )
-                p_index->p_entry[j].i_flags |= AVIIF_KEYFRAME;
+            for( unsigned j = 0; j < p_index[i].i_size; j++ )
+                p_index[i].p_entry[j].i_flags |= AVIIF_KEYFRAME;
         }
 
         /* */
         msg_Dbg( p_demux, "stream[%d] created %d index entries",
-                 i, p_index->i_size );
+                 i, p_index[i].i_size );
     }
+    return b_found;
 }
 
-static void AVI_IndexCreate( demux_t *p_demux )
+static void AVI_IndexLoad( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
-    avi_chunk_list_t *p_riff;
-    avi_chunk_list_t *p_movi;
+    assert( p_sys->i_track <= 100 );
+    avi_index_t p_index[p_sys->i_track];
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Init( &p_index[i] );
+    uint64_t i_last_pos = p_sys->i_movi_lastchunk_pos;
 
-    unsigned int i_stream;
-    uint32_t i_movi_end;
+    if( AVI_IndexRead( p_demux, p_demux->s, p_index, &i_last_pos ) )
+        p_sys->b_indexloaded = true;
 
-    vlc_tick_t i_dialog_update;
-    vlc_dialog_id *p_dialog_id = NULL;
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_index_Clean( &p_sys->track[i]->idx );
+        p_sys->track[i]->idx = p_index[i];
+    }
+    p_sys->i_movi_lastchunk_pos = i_last_pos;
+}
 
-    p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
-    p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
+typedef struct
+{
+    uint64_t i_movi_pos;
+    uint64_t i_movi_end;
+    uint64_t i_avix_pos; /* second RIFF chunk (OpenDML), 0 if none */
+} avi_movi_info_t;
+
+static int AVI_MoviInfo( demux_t *p_demux, avi_movi_info_t *p_info )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    avi_chunk_list_t *p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
+    avi_chunk_list_t *p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
 
     if( !p_movi )
     {
         msg_Err( p_demux, "cannot find p_movi" );
-        return;
+        return VLC_EGENERIC;
     }
 
-    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
-
-    i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
-                        stream_Size( p_demux->s ) );
+    p_info->i_movi_pos = p_movi->i_chunk_pos;
+    p_info->i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
+                                stream_Size( p_demux->s ) );
 
-    vlc_stream_Seek( p_demux->s, p_movi->i_chunk_pos + 12 );
-    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+    avi_chunk_list_t *p_sysx = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 1, true );
+    p_info->i_avix_pos = p_sysx ? p_sysx->i_chunk_pos : 0;
+    return VLC_SUCCESS;
+}
 
+/* Scans the LIST-movi of the stream s, and appends its chunks to the
+ * per-track indexes. Returns VLC_SUCCESS if the whole movi was scanned. */
+static int AVI_IndexScan( demux_t *p_demux, stream_t *s,
+                          const avi_movi_info_t *p_info,
+                          avi_index_t p_index[], uint64_t *pi_last_pos,
+                          vlc_dialog_id *p_dialog_id,
+                          atomic_bool *pb_cancel )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    vlc_tick_t i_dialog_update = vlc_tick_now();
+    const double f_size = stream_Size( s );
 
-    /* Only show dialog if AVI is > 10MB */
-    i_dialog_update = vlc_tick_now();
-    if( stream_Size( p_demux->s ) > 10000000 )
-    {
-        p_dialog_id =
-            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
-                                         _("Broken or missing AVI Index"),
-                                         _("Fixing AVI Index...") );
-    }
+    if( vlc_stream_Seek( s, p_info->i_movi_pos + 12 ) )
+        return VLC_EGENERIC;
 
     for( ;; )
     {
         avi_packet_t pk;
 
+        if( pb_cancel != NULL && atomic_load_explicit( pb_cancel, memory_order_relaxed ) )
+            return VLC_EGENERIC;
+
         /* Don't update/check dialog too often */
         if( p_dialog_id != NULL && vlc_tick_now() - i_dialog_update > VLC_TICK_FROM_MS(100) )
         {
             if( vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
-                break;
+                return VLC_EGENERIC;
 
-            double f_current = vlc_stream_Tell( p_demux->s );
-            double f_size    = stream_Size( p_demux->s );
-            double f_pos     = f_current / f_size;
-            vlc_dialog_update_progress( p_demux, p_dialog_id, f_pos );
+            double f_current = vlc_stream_Tell( s );
+            vlc_dialog_update_progress( p_demux, p_dialog_id, f_current / f_size );
 
             i_dialog_update = vlc_tick_now();
         }
 
-        if( AVI_PacketGetHeader( p_demux, &pk ) )
-            break;
+        if( AVI_PacketGetHeader( s, &pk ) )
+            return VLC_SUCCESS;
 
         if( pk.i_stream < p_sys->i_track &&
             pk.i_cat == p_sys->track[pk.i_stream]->fmt.i_cat )
@@ -2823,7 +2805,7 @@ static void AVI_IndexCreate( demux_t *p_demux )
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
             index.i_lengthtotal = pk.i_size;
-            avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
+            avi_index_Append( &p_index[pk.i_stream], pi_last_pos, &index );
         }
         else
         {
@@ -2832,17 +2814,13 @@ static void AVI_IndexCreate( demux_t *p_demux )
             case AVIFOURCC_idx1:
                 if( p_sys->b_odml )
                 {
-                    avi_chunk_list_t *p_sysx;
-                    p_sysx = AVI_ChunkFind( &p_sys->ck_root,
-                                            AVIFOURCC_RIFF, 1, true );
-
                     msg_Dbg( p_demux, "looking for new RIFF chunk" );
-                    if( !p_sysx || vlc_stream_Seek( p_demux->s,
-                                         p_sysx->i_chunk_pos + 24 ) )
-                        goto print_stat;
+                    if( !p_info->i_avix_pos ||
+                        vlc_stream_Seek( s, p_info->i_avix_pos + 24 ) )
+                        return VLC_SUCCESS;
                     break;
                 }
-                goto print_stat;
+                return VLC_SUCCESS;
 
             case AVIFOURCC_RIFF:
                     msg_Dbg( p_demux, "new RIFF chunk found" );
@@ -2854,30 +2832,794 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
             default:
                 msg_Warn( p_demux, "need resync, probably broken avi" );
-                if( AVI_PacketSearch( p_demux ) )
+                if( AVI_PacketSearch( p_demux, s ) )
                 {
                     msg_Warn( p_demux, "lost sync, abord index creation" );
-                    goto print_stat;
+                    return VLC_EGENERIC;
                 }
             }
         }
 
-        if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= i_movi_end ) ||
-            AVI_PacketNext( p_demux ) )
+        if( ( !p_sys->b_odml && pk.i_pos + pk.i_size >= p_info->i_movi_end ) ||
+            AVI_PacketNext( s ) )
+        {
+            return VLC_SUCCESS;
+        }
+    }
+}
+
+/* Returns the first entry of the index at or after the file position */
+static uint32_t AVI_IndexLowerBound( const avi_index_t *p_index, uint64_t i_pos )
+{
+    uint32_t i_low = 0, i_high = p_index->i_size;
+    while( i_low < i_high )
+    {
+        uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_entry[i_mid].i_pos < i_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low;
+}
+
+/* Replaces the indexes of the tracks, which keep their current chunk, found
+ * by its file position, if they already started */
+static void AVI_IndexInstall( demux_t *p_demux, avi_index_t p_index[],
+                              uint64_t i_last_pos )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_track_t *tk = p_sys->track[i];
+        avi_index_t *p_new = &p_index[i];
+
+        if( tk->i_idxposc > 0 && tk->idx.i_size > 0 )
+        {
+            const uint32_t i_last = tk->idx.i_size - 1;
+            const uint32_t i_cur = __MIN( tk->i_idxposc, i_last );
+            uint32_t i_new = AVI_IndexLowerBound( p_new,
+                                                  tk->idx.p_entry[i_cur].i_pos );
+            if( tk->i_idxposc > i_last )
+                i_new += tk->i_idxposc - i_last;
+            tk->i_idxposc = __MIN( i_new, p_new->i_size );
+        }
+
+        avi_index_Clean( &tk->idx );
+        tk->idx = *p_new;
+        avi_index_Init( p_new );
+    }
+    p_sys->i_movi_lastchunk_pos = __MAX( p_sys->i_movi_lastchunk_pos,
+                                         i_last_pos );
+}
+
+/****************************************************************************
+ * Index cache: indexes created from the LIST-movi of local files are stored
+ * in the user cache directory, so that the next opening does not need to
+ * scan again. The least recently written indexes are removed beyond
+ * AVI_INDEX_CACHE_MAX_FILES files or AVI_INDEX_CACHE_MAX_SIZE bytes.
+ ****************************************************************************/
+#define AVI_INDEX_CACHE_MAGIC "VLCAVIX2"
+#define AVI_INDEX_CACHE_HEADER_SIZE (8 + 8 + 8 + 8 + 4)
+#define AVI_INDEX_CACHE_ENTRY_SIZE  (8 + 4 + 4)
+#define AVI_INDEX_CACHE_MAX_FILES   64
+#define AVI_INDEX_CACHE_MAX_SIZE    (64 << 20)
+
+typedef struct
+{
+    uint64_t i_file_size;
+    int64_t  i_mtime;
+    uint64_t i_movi_pos;
+    uint32_t i_track;
+} avi_cache_key_t;
+
+static char *AVI_IndexCachePath( demux_t *p_demux )
+{
+    if( !var_InheritBool( p_demux, "avi-index-cache" ) ||
+        p_demux->psz_url == NULL || p_demux->psz_filepath == NULL )
+        return NULL;
+
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    if( unlikely(psz_cachedir == NULL) )
+        return NULL;
+
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, p_demux->psz_url, strlen( p_demux->psz_url ) );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    char *psz_path;
+    if( asprintf( &psz_path, "%s" DIR_SEP "avi-index" DIR_SEP "%s.idx",
+                  psz_cachedir, psz_hash ) == -1 )
+        psz_path = NULL;
+    free( psz_cachedir );
+    return psz_path;
+}
+
+static int AVI_IndexCacheKey( demux_t *p_demux, avi_cache_key_t *p_key )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_movi_info_t info;
+    struct stat st;
+
+    /* The modification time catches files rewritten with the same size */
+    if( p_demux->psz_filepath == NULL ||
+        vlc_stat( p_demux->psz_filepath, &st ) ||
+        AVI_MoviInfo( p_demux, &info ) ||
+        vlc_stream_GetSize( p_demux->s, &p_key->i_file_size ) )
+        return VLC_EGENERIC;
+
+    p_key->i_mtime = st.st_mtime;
+    p_key->i_movi_pos = info.i_movi_pos;
+    p_key->i_track = p_sys->i_track;
+    return VLC_SUCCESS;
+}
+
+typedef struct
+{
+    char     *psz_path;
+    time_t   i_mtime;
+    uint64_t i_size;
+} avi_cache_file_t;
+
+static int AVI_IndexCacheFileCmp( const void *a, const void *b )
+{
+    const avi_cache_file_t *fa = a, *fb = b;
+
+    /* Most recently written first */
+    return (fa->i_mtime < fb->i_mtime) - (fa->i_mtime > fb->i_mtime);
+}
+
+/* Removes the oldest indexes beyond the cache limits, except \p psz_keep */
+static void AVI_IndexCachePrune( vlc_object_t *p_obj, const char *psz_dir,
+                                 const char *psz_keep )
+{
+    vlc_DIR *p_dir = vlc_opendir( psz_dir );
+    if( p_dir == NULL )
+        return;
+
+    avi_cache_file_t *p_files = NULL;
+    size_t i_files = 0, i_alloc = 0;
+    size_t i_kept = 0;
+    uint64_t i_total = 0;
+    const char *psz_name;
+
+    while( (psz_name = vlc_readdir( p_dir )) != NULL )
+    {
+        const size_t i_len = strlen( psz_name );
+        if( i_len < 4 || strcmp( &psz_name[i_len - 4], ".idx" ) )
+            continue;
+
+        if( i_files == i_alloc )
         {
+            i_alloc = i_alloc ? i_alloc * 2 : 32;
+            avi_cache_file_t *p_realloc =
+                vlc_reallocarray( p_files, i_alloc, sizeof(*p_files) );
+            if( unlikely(p_realloc == NULL) )
+                break;
+            p_files = p_realloc;
+        }
+
+        avi_cache_file_t *p_file = &p_files[i_files];
+        struct stat st;
+        if( asprintf( &p_file->psz_path, "%s" DIR_SEP "%s",
+                      psz_dir, psz_name ) == -1 )
             break;
+        if( vlc_stat( p_file->psz_path, &st ) || !S_ISREG( st.st_mode ) )
+        {
+            free( p_file->psz_path );
+            continue;
+        }
+        if( !strcmp( p_file->psz_path, psz_keep ) )
+        {
+            free( p_file->psz_path );
+            i_kept++;
+            i_total += st.st_size;
+            continue;
+        }
+        p_file->i_mtime = st.st_mtime;
+        p_file->i_size = st.st_size;
+        i_files++;
+    }
+    vlc_closedir( p_dir );
+
+    if( i_files > 0 )
+        qsort( p_files, i_files, sizeof(*p_files), AVI_IndexCacheFileCmp );
+
+    for( size_t i = 0; i < i_files; i++ )
+    {
+        avi_cache_file_t *p_file = &p_files[i];
+
+        if( i_kept < AVI_INDEX_CACHE_MAX_FILES &&
+            i_total + p_file->i_size <= AVI_INDEX_CACHE_MAX_SIZE )
+        {
+            i_kept++;
+            i_total += p_file->i_size;
+        }
+        else
+        {
+            msg_Dbg( p_obj, "removing index cache %s", p_file->psz_path );
+            vlc_unlink( p_file->psz_path );
+        }
+        free( p_file->psz_path );
+    }
+    free( p_files );
+}
+
+static void AVI_IndexCacheStore( vlc_object_t *p_obj, const char *psz_path,
+                                 const avi_cache_key_t *p_key,
+                                 const avi_index_t p_index[] )
+{
+    char *psz_dir = strdup( psz_path );
+    if( unlikely(psz_dir == NULL) )
+        return;
+    char *psz_sep = strrchr( psz_dir, DIR_SEP_CHAR );
+    if( psz_sep != NULL )
+    {
+        *psz_sep = '\0';
+        vlc_mkdir_parent( psz_dir, 0700 );
+    }
+
+    FILE *p_file = vlc_fopen( psz_path, "wb" );
+    if( p_file == NULL )
+    {
+        msg_Warn( p_obj, "cannot write index cache %s: %s", psz_path,
+                  vlc_strerror_c( errno ) );
+        free( psz_dir );
+        return;
+    }
+
+    uint8_t p_header[AVI_INDEX_CACHE_HEADER_SIZE];
+    memcpy( p_header, AVI_INDEX_CACHE_MAGIC, 8 );
+    SetQWLE( &p_header[8], p_key->i_file_size );
+    SetQWLE( &p_header[16], p_key->i_mtime );
+    SetQWLE( &p_header[24], p_key->i_movi_pos );
+    SetDWLE( &p_header[32], p_key->i_track );
+    bool b_error = fwrite( p_header, sizeof(p_header), 1, p_file ) != 1;
+
+    for( uint32_t i = 0; i < p_key->i_track && !b_error; i++ )
+    {
+        uint8_t p_count[4];
+        SetDWLE( p_count, p_index[i].i_size );
+        b_error = fwrite( p_count, sizeof(p_count), 1, p_file ) != 1;
+
+        for( uint32_t j = 0; j < p_index[i].i_size && !b_error; j++ )
+        {
+            const avi_entry_t *p_entry = &p_index[i].p_entry[j];
+            uint8_t p_buf[AVI_INDEX_CACHE_ENTRY_SIZE];
+
+            SetQWLE( &p_buf[0], p_entry->i_pos );
+            SetDWLE( &p_buf[8], p_entry->i_flags );
+            SetDWLE( &p_buf[12], p_entry->i_length );
+            b_error = fwrite( p_buf, sizeof(p_buf), 1, p_file ) != 1;
+        }
+    }
+
+    if( fclose( p_file ) || b_error )
+    {
+        msg_Warn( p_obj, "cannot write index cache %s", psz_path );
+        vlc_unlink( psz_path );
+    }
+    else
+    {
+        msg_Dbg( p_obj, "index cache written to %s", psz_path );
+        if( psz_sep != NULL )
+            AVI_IndexCachePrune( p_obj, psz_dir, psz_path );
+    }
+    free( psz_dir );
+}
+
+static int AVI_IndexCacheRead( FILE *p_file, const avi_cache_key_t *p_key,
+                               avi_index_t p_index[], uint64_t *pi_last_pos )
+{
+    uint8_t p_header[AVI_INDEX_CACHE_HEADER_SIZE];
+    if( fread( p_header, sizeof(p_header), 1, p_file ) != 1 ||
+        memcmp( p_header, AVI_INDEX_CACHE_MAGIC, 8 ) ||
+        GetQWLE( &p_header[8] ) != p_key->i_file_size ||
+        (int64_t)GetQWLE( &p_header[16] ) != p_key->i_mtime ||
+        GetQWLE( &p_header[24] ) != p_key->i_movi_pos ||
+        GetDWLE( &p_header[32] ) != p_key->i_track )
+        return VLC_EGENERIC;
+
+    for( uint32_t i = 0; i < p_key->i_track; i++ )
+    {
+        uint8_t p_count[4];
+        if( fread( p_count, sizeof(p_count), 1, p_file ) != 1 )
+            return VLC_EGENERIC;
+
+        const uint32_t i_count = GetDWLE( p_count );
+        for( uint32_t j = 0; j < i_count; j++ )
+        {
+            uint8_t p_buf[AVI_INDEX_CACHE_ENTRY_SIZE];
+            if( fread( p_buf, sizeof(p_buf), 1, p_file ) != 1 )
+                return VLC_EGENERIC;
+
+            avi_entry_t index;
+            index.i_pos    = GetQWLE( &p_buf[0] );
+            index.i_flags  = GetDWLE( &p_buf[8] );
+            index.i_length = GetDWLE( &p_buf[12] );
+            index.i_lengthtotal = index.i_length;
+            if( index.i_pos >= p_key->i_file_size ||
+                avi_index_Append( &p_index[i], pi_last_pos, &index ) < 0 )
+                return VLC_EGENERIC;
         }
     }
+    return VLC_SUCCESS;
+}
+
+static int AVI_IndexCacheLoad( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_cache_key_t key;
+
+    char *psz_path = AVI_IndexCachePath( p_demux );
+    if( psz_path == NULL )
+        return VLC_EGENERIC;
+
+    FILE *p_file = NULL;
+    if( AVI_IndexCacheKey( p_demux, &key ) == VLC_SUCCESS )
+        p_file = vlc_fopen( psz_path, "rb" );
+    if( p_file == NULL )
+    {
+        free( psz_path );
+        return VLC_EGENERIC;
+    }
+
+    avi_index_t *p_index = vlc_alloc( p_sys->i_track, sizeof(*p_index) );
+    if( unlikely(p_index == NULL) )
+    {
+        fclose( p_file );
+        free( psz_path );
+        return VLC_ENOMEM;
+    }
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Init( &p_index[i] );
+
+    uint64_t i_last_pos = p_sys->i_movi_lastchunk_pos;
+    int i_ret = AVI_IndexCacheRead( p_file, &key, p_index, &i_last_pos );
+    fclose( p_file );
+
+    if( i_ret == VLC_SUCCESS )
+    {
+        msg_Dbg( p_demux, "index loaded from cache %s", psz_path );
+        AVI_IndexInstall( p_demux, p_index, i_last_pos );
+    }
+    else
+    {
+        msg_Warn( p_demux, "discarding invalid index cache %s", psz_path );
+        for( unsigned i = 0; i < p_sys->i_track; i++ )
+            avi_index_Clean( &p_index[i] );
+        vlc_unlink( psz_path );
+    }
+
+    free( p_index );
+    free( psz_path );
+    return i_ret;
+}
+
+static void AVI_IndexCreate( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    unsigned int i_stream;
+    avi_movi_info_t info;
+
+    vlc_dialog_id *p_dialog_id = NULL;
+
+    if( AVI_MoviInfo( p_demux, &info ) )
+        return;
+
+    avi_index_t *p_index = vlc_alloc( p_sys->i_track, sizeof(*p_index) );
+    if( unlikely(p_index == NULL) )
+        return;
+
+    for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
+    {
+        avi_index_Clean( &p_sys->track[i_stream]->idx );
+        avi_index_Init( &p_sys->track[i_stream]->idx );
+        avi_index_Init( &p_index[i_stream] );
+    }
+
+    msg_Warn( p_demux, "creating index from LIST-movi, will take time !" );
+
+    /* Only show dialog if AVI is > 10MB */
+    if( stream_Size( p_demux->s ) > 10000000 )
+    {
+        p_dialog_id =
+            vlc_dialog_display_progress( p_demux, false, 0.0, _("Cancel"),
+                                         _("Broken or missing AVI Index"),
+                                         _("Fixing AVI Index...") );
+    }
+
+    int i_ret = AVI_IndexScan( p_demux, p_demux->s, &info, p_index,
+                               &p_sys->i_movi_lastchunk_pos, p_dialog_id, NULL );
 
-print_stat:
     if( p_dialog_id != NULL )
         vlc_dialog_release( p_demux, p_dialog_id );
 
+    if( i_ret == VLC_SUCCESS )
+    {
+        avi_cache_key_t key;
+        char *psz_path = AVI_IndexCachePath( p_demux );
+        if( psz_path != NULL && AVI_IndexCacheKey( p_demux, &key ) == VLC_SUCCESS )
+            AVI_IndexCacheStore( VLC_OBJECT(p_demux), psz_path, &key, p_index );
+        free( psz_path );
+    }
+
     for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
     {
+        p_sys->track[i_stream]->idx = p_index[i_stream];
         msg_Dbg( p_demux, "stream[%d] creating %d index entries",
                 i_stream, p_sys->track[i_stream]->idx.i_size );
     }
+    free( p_index );
+}
+
+/* Creates or reads the index again, depending on the stream capabilities */
+static void AVI_IndexFix( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_sys->b_fastseekable )
+    {
+        if( AVI_IndexCacheLoad( p_demux ) )
+            AVI_IndexCreate( p_demux );
+    }
+    else if( p_sys->b_seekable )
+    {
+        AVI_IndexLoad( p_demux );
+    }
+    else
+    {
+        msg_Warn( p_demux, "cannot create index (unseekable stream)" );
+    }
+}
+
+/* Checks that the index covers the whole movie, and acts according to
+ * avi-index otherwise. Once playing, the index is fixed in background.
+ * Returns VLC_ETIMEOUT if the user chose not to play. */
+static int AVI_IndexCheck( demux_t *p_demux, bool b_playing )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const int i_do_index = var_InheritInteger( p_demux, "avi-index" );
+
+    avi_chunk_list_t *p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
+    avi_chunk_list_t *p_hdrl = AVI_ChunkFind( p_riff, AVIFOURCC_hdrl, 0, true );
+    avi_chunk_avih_t *p_avih = AVI_ChunkFind( p_hdrl, AVIFOURCC_avih, 0, false );
+    if( !p_avih )
+        return VLC_SUCCESS;
+
+    unsigned int i_idx_totalframes = 0;
+    for( unsigned int i = 0; i < p_sys->i_track; i++ )
+    {
+        const avi_track_t *tk = p_sys->track[i];
+        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
+            i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
+    }
+    if( i_idx_totalframes == p_avih->i_totalframes ||
+        p_sys->i_length >= VLC_TICK_FROM_US( p_avih->i_totalframes *
+                                             p_avih->i_microsecperframe ) )
+        return VLC_SUCCESS;
+
+    msg_Warn( p_demux, "broken or missing index, 'seek' will be "
+                       "approximative or will exhibit strange behavior" );
+    if( i_do_index == 1 || i_do_index == 2 )
+        return VLC_SUCCESS;
+
+    if( p_sys->b_fastseekable &&
+        AVI_IndexCacheLoad( p_demux ) == VLC_SUCCESS )
+    {
+        p_sys->i_length = AVI_MovieGetLength( p_demux );
+        return VLC_SUCCESS;
+    }
+
+    if( i_do_index == 4 )
+    {
+        if( p_demux->b_preparsing )
+            return VLC_SUCCESS;
+        /* Play right away, the index will be completed in background */
+        if( p_sys->b_fastseekable )
+        {
+            if( AVI_IndexBuilderStart( p_demux, false ) )
+                msg_Warn( p_demux, "cannot create index in background" );
+            return VLC_SUCCESS;
+        }
+    }
+    else if( i_do_index == 0 && p_sys->b_fastseekable )
+    {
+        const char *psz_msg = _(
+            "Because this file index is broken or missing, "
+            "seeking will not work correctly.\n"
+            "VLC won't repair your file but can temporary fix this "
+            "problem by building an index in memory.\n"
+            "This step might take a long time on a large file.\n"
+            "What do you want to do?");
+        switch( vlc_dialog_wait_question( p_demux,
+                                          VLC_DIALOG_QUESTION_NORMAL,
+                                          _("Do not play"),
+                                          _("Build index then play"),
+                                          _("Play as is"),
+                                          _("Broken or missing Index"),
+                                          "%s", psz_msg ) )
+        {
+            case 0:
+                return VLC_ETIMEOUT;
+            case 1:
+                break;
+            default:
+                return VLC_SUCCESS;
+        }
+    }
+    else if( i_do_index != 0 && i_do_index != 3 )
+    {
+        return VLC_SUCCESS;
+    }
+
+    msg_Dbg( p_demux, "Fixing AVI index" );
+    if( b_playing )
+    {
+        /* The playback started with the partial index, which is replaced
+         * once created */
+        if( AVI_IndexBuilderStart( p_demux, false ) )
+            msg_Warn( p_demux, "cannot create index in background" );
+    }
+    else
+    {
+        AVI_IndexFix( p_demux );
+        p_sys->i_length = AVI_MovieGetLength( p_demux );
+    }
+    return VLC_SUCCESS;
+}
+
+/* fix some BeOS MediaKit generated file */
+static void AVI_TrackFixBeOS( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    avi_chunk_list_t *p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
+    avi_chunk_list_t *p_hdrl = AVI_ChunkFind( p_riff, AVIFOURCC_hdrl, 0, true );
+    avi_chunk_avih_t *p_avih = AVI_ChunkFind( p_hdrl, AVIFOURCC_avih, 0, false );
+    if( !p_avih )
+        return;
+
+    for( unsigned i = 0 ; i < p_sys->i_track; i++ )
+    {
+        avi_track_t         *tk = p_sys->track[i];
+        avi_chunk_list_t    *p_strl;
+        avi_chunk_strf_auds_t    *p_auds;
+
+        if( tk->fmt.i_cat != AUDIO_ES )
+        {
+            continue;
+        }
+        if( tk->idx.i_size < 1 ||
+            tk->i_scale != 1 ||
+            tk->i_samplesize != 0 )
+        {
+            continue;
+        }
+        p_strl = AVI_ChunkFind( p_hdrl, AVIFOURCC_strl, tk->fmt.i_id, true );
+        p_auds = AVI_ChunkFind( p_strl, AVIFOURCC_strf, 0, false );
+
+        if( p_auds &&
+            p_auds->p_wf->wFormatTag != WAVE_FORMAT_PCM &&
+            tk->i_rate == p_auds->p_wf->nSamplesPerSec )
+        {
+            int64_t i_track_length =
+                tk->idx.p_entry[tk->idx.i_size-1].i_length +
+                tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
+            vlc_tick_t i_length = VLC_TICK_FROM_US( p_avih->i_totalframes *
+                                                    p_avih->i_microsecperframe );
+
+            if( i_length == 0 )
+            {
+                msg_Warn( p_demux, "track[%u] cannot be fixed (BeOS MediaKit generated)", i );
+                continue;
+            }
+            tk->i_samplesize = 1;
+            tk->i_rate       = i_track_length  * CLOCK_FREQ / i_length;
+            msg_Warn( p_demux, "track[%u] fixed with rate=%u scale=%u (BeOS MediaKit generated)", i, tk->i_rate, tk->i_scale );
+        }
+    }
+}
+
+/****************************************************************************
+ * Background index creation: the idx1/ODML indexes are read, or the
+ * LIST-movi is scanned, by a thread with its own stream, while the playback
+ * starts using the partial index built by Demux_Seekable(). The complete
+ * index replaces it once available.
+ ****************************************************************************/
+struct avi_index_builder_t
+{
+    vlc_thread_t    thread;
+    demux_t         *p_demux;
+    stream_t        *s;
+    bool            b_load; /* read the indexes instead of scanning */
+
+    avi_movi_info_t info;
+    avi_index_t     *p_index; /* one per track */
+    uint64_t        i_last_pos;
+    bool            b_complete;
+    bool            b_found; /* an index was read */
+
+    char            *psz_cache;
+    avi_cache_key_t key;
+
+    atomic_bool     b_done;
+    atomic_bool     b_cancel;
+};
+
+static void *AVI_IndexBuilderThread( void *data )
+{
+    avi_index_builder_t *p_builder = data;
+    demux_t *p_demux = p_builder->p_demux;
+
+    vlc_thread_set_name( "vlc-avi-index" );
+
+    const vlc_tick_t i_start = vlc_tick_now();
+    if( p_builder->b_load )
+    {
+        p_builder->b_found =
+            AVI_IndexRead( p_demux, p_builder->s, p_builder->p_index,
+                           &p_builder->i_last_pos );
+        p_builder->b_complete = true;
+        msg_Dbg( p_demux, "index read in background in %"PRId64" ms",
+                 MS_FROM_VLC_TICK( vlc_tick_now() - i_start ) );
+        atomic_store_explicit( &p_builder->b_done, true, memory_order_release );
+        return NULL;
+    }
+
+    p_builder->b_complete =
+        AVI_IndexScan( p_demux, p_builder->s, &p_builder->info,
+                       p_builder->p_index, &p_builder->i_last_pos,
+                       NULL, &p_builder->b_cancel ) == VLC_SUCCESS;
+
+    if( p_builder->b_complete )
+    {
+        msg_Dbg( p_demux, "index created in background in %"PRId64" ms",
+                 MS_FROM_VLC_TICK( vlc_tick_now() - i_start ) );
+        if( p_builder->psz_cache != NULL )
+            AVI_IndexCacheStore( VLC_OBJECT(p_demux), p_builder->psz_cache,
+                                 &p_builder->key, p_builder->p_index );
+    }
+
+    atomic_store_explicit( &p_builder->b_done, true, memory_order_release );
+    return NULL;
+}
+
+static void AVI_IndexBuilderDelete( demux_t *p_demux, avi_index_builder_t *p_builder )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( p_builder->p_index != NULL )
+    {
+        for( unsigned i = 0; i < p_sys->i_track; i++ )
+            avi_index_Clean( &p_builder->p_index[i] );
+        free( p_builder->p_index );
+    }
+    if( p_builder->s != NULL )
+        vlc_stream_Delete( p_builder->s );
+    free( p_builder->psz_cache );
+    free( p_builder );
+}
+
+static int AVI_IndexBuilderStart( demux_t *p_demux, bool b_load )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    uint64_t i_size, i_builder_size;
+
+    if( p_demux->psz_url == NULL ||
+        vlc_stream_GetSize( p_demux->s, &i_size ) )
+        return VLC_EGENERIC;
+
+    avi_index_builder_t *p_builder = calloc( 1, sizeof(*p_builder) );
+    if( unlikely(p_builder == NULL) )
+        return VLC_ENOMEM;
+
+    p_builder->p_demux = p_demux;
+    p_builder->b_load = b_load;
+    p_builder->i_last_pos = p_sys->i_movi_lastchunk_pos;
+    atomic_init( &p_builder->b_done, false );
+    atomic_init( &p_builder->b_cancel, false );
+
+    p_builder->p_index = vlc_alloc( p_sys->i_track, sizeof(*p_builder->p_index) );
+    if( unlikely(p_builder->p_index == NULL) )
+    {
+        AVI_IndexBuilderDelete( p_demux, p_builder );
+        return VLC_ENOMEM;
+    }
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        avi_index_Init( &p_builder->p_index[i] );
+
+    if( !b_load && AVI_MoviInfo( p_demux, &p_builder->info ) )
+    {
+        AVI_IndexBuilderDelete( p_demux, p_builder );
+        return VLC_EGENERIC;
+    }
+
+    /* The demux stream cannot be shared with the thread */
+    p_builder->s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( p_builder->s == NULL ||
+        vlc_stream_GetSize( p_builder->s, &i_builder_size ) ||
+        i_builder_size != i_size )
+    {
+        msg_Warn( p_demux, "cannot open a second stream to create the index" );
+        AVI_IndexBuilderDelete( p_demux, p_builder );
+        return VLC_EGENERIC;
+    }
+
+    if( !b_load )
+    {
+        p_builder->psz_cache = AVI_IndexCachePath( p_demux );
+        if( p_builder->psz_cache != NULL &&
+            AVI_IndexCacheKey( p_demux, &p_builder->key ) )
+        {
+            free( p_builder->psz_cache );
+            p_builder->psz_cache = NULL;
+        }
+    }
+
+    if( vlc_clone( &p_builder->thread, AVI_IndexBuilderThread, p_builder ) )
+    {
+        AVI_IndexBuilderDelete( p_demux, p_builder );
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg( p_demux, b_load ? "reading index in background"
+                             : "creating index in background" );
+    p_sys->p_index_builder = p_builder;
+    return VLC_SUCCESS;
+}
+
+/* Replaces the partial indexes by the ones read or created in background,
+ * if finished, or waiting for the indexes being read if b_wait is set.
+ * Returns VLC_ETIMEOUT if the user chose not to play once the index read. */
+static int AVI_IndexBuilderCollect( demux_t *p_demux, bool b_wait )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_builder_t *p_builder = p_sys->p_index_builder;
+
+    if( p_builder == NULL )
+        return VLC_SUCCESS;
+    if( !atomic_load_explicit( &p_builder->b_done, memory_order_acquire ) &&
+        !( b_wait && p_builder->b_load ) )
+        return VLC_SUCCESS;
+
+    vlc_join( p_builder->thread, NULL );
+    p_sys->p_index_builder = NULL;
+
+    const bool b_load = p_builder->b_load;
+    if( p_builder->b_complete )
+    {
+        AVI_IndexInstall( p_demux, p_builder->p_index, p_builder->i_last_pos );
+        if( p_builder->b_found )
+            p_sys->b_indexloaded = true;
+        p_sys->i_length = AVI_MovieGetLength( p_demux );
+        msg_Dbg( p_demux, "background index installed" );
+    }
+
+    AVI_IndexBuilderDelete( p_demux, p_builder );
+
+    if( !b_load )
+        return VLC_SUCCESS;
+    AVI_TrackFixBeOS( p_demux );
+    return AVI_IndexCheck( p_demux, true );
+}
+
+static void AVI_IndexBuilderStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    avi_index_builder_t *p_builder = p_sys->p_index_builder;
+
+    if( p_builder == NULL )
+        return;
+
+    atomic_store( &p_builder->b_cancel, true );
+    vlc_join( p_builder->thread, NULL );
+    p_sys->p_index_builder = NULL;
+    AVI_IndexBuilderDelete( p_demux, p_builder );
 }
 
 /* */
@@ -3054,16 +3796,16 @@ static void AVI_ExtractSubtitle( demux_t *p_demux,
     }
     else
     {
-        avi_chunk_idx1_t *p_idx1;
+        avi_chunk_idx1_t idx1;
         uint64_t         i_offset;
 
-        if( AVI_IndexFind_idx1( p_demux, &p_idx1, &i_offset ) )
+        if( AVI_IndexFind_idx1( p_demux, p_demux->s, &idx1, &i_offset ) )
             goto exit;
 
         i_size = 0;
-        for( unsigned i = 0; i < p_idx1->i_entry_count; i++ )
+        for( unsigned i = 0; i < idx1.i_entry_count; i++ )
         {
-            const idx1_entry_t *e = &p_idx1->entry[i];
+            const idx1_entry_t *e = &idx1.entry[i];
             enum es_format_category_e i_cat;
             unsigned i_stream_idx;
 
@@ -3075,6 +3817,7 @@ static void AVI_ExtractSubtitle( demux_t *p_demux,
                 break;
             }
         }
+        AVI_ChunkUnload_idx1( &idx1 );
         if( i_size <= 0 )
             goto exit;
     }
@@ -602,43 +602,76 @@ static void AVI_ChunkFree_strd( avi_chunk_t *p_chk )
 
 static int AVI_ChunkRead_idx1( stream_t *s, avi_chunk_t *p_chk )
 {
-    unsigned int i_count, i_index;
+    /* The entries are read on demand by AVI_ChunkLoad_idx1(), as the index
+     * can be large and is not needed to start playing */
+    p_chk->idx1.i_entry_count = 0;
+    p_chk->idx1.i_entry_max   = 0;
+    p_chk->idx1.entry = NULL;
+#ifdef AVI_DEBUG
+    msg_Dbg( s, "idx1: index entry:%"PRIu64, p_chk->common.i_chunk_size / 16 );
+#endif
+    return AVI_NextChunk( s, p_chk );
+}
 
-    AVI_READCHUNK_ENTER;
+static void AVI_ChunkFree_idx1( avi_chunk_t *p_chk )
+{
+    AVI_ChunkUnload_idx1( &p_chk->idx1 );
+}
+
+int AVI_ChunkLoad_idx1( stream_t *s, avi_chunk_idx1_t *p_idx1 )
+{
+    const uint64_t i_size = p_idx1->i_chunk_size;
+    if( i_size > 100000000 )
+    {
+        msg_Err( s, "Big chunk ignored" );
+        return VLC_EGENERIC;
+    }
 
-    i_count = __MIN( (int64_t)p_chk->common.i_chunk_size, i_read ) / 16;
+    const unsigned i_count = i_size / 16;
+    p_idx1->i_entry_count = 0;
+    p_idx1->i_entry_max   = 0;
+    p_idx1->entry = NULL;
+    if( i_count == 0 )
+        return VLC_SUCCESS;
+
+    if( vlc_stream_Seek( s, p_idx1->i_chunk_pos + 8 ) )
+        return VLC_EGENERIC;
 
-    p_chk->idx1.i_entry_count = i_count;
-    p_chk->idx1.i_entry_max   = i_count;
-    if( i_count > 0 )
+    uint8_t *p_buff = malloc( i_count * 16 );
+    if( !p_buff )
+        return VLC_EGENERIC;
+    if( vlc_stream_Read( s, p_buff, i_count * 16 ) != (ssize_t)i_count * 16 )
     {
-        p_chk->idx1.entry = calloc( i_count, sizeof( idx1_entry_t ) );
-        if( !p_chk->idx1.entry )
-            AVI_READCHUNK_EXIT( VLC_EGENERIC );
+        free( p_buff );
+        return VLC_EGENERIC;
+    }
 
-        for( i_index = 0; i_index < i_count ; i_index++ )
-        {
-            AVI_READFOURCC( p_chk->idx1.entry[i_index].i_fourcc );
-            AVI_READ4BYTES( p_chk->idx1.entry[i_index].i_flags );
-            AVI_READ4BYTES( p_chk->idx1.entry[i_index].i_pos );
-            AVI_READ4BYTES( p_chk->idx1.entry[i_index].i_length );
-        }
+    p_idx1->entry = calloc( i_count, sizeof( idx1_entry_t ) );
+    if( !p_idx1->entry )
+    {
+        free( p_buff );
+        return VLC_EGENERIC;
     }
-    else
+    for( unsigned i_index = 0; i_index < i_count; i_index++ )
     {
-        p_chk->idx1.entry = NULL;
+        const uint8_t *p_read = &p_buff[16 * i_index];
+        p_idx1->entry[i_index].i_fourcc = GetFOURCC( p_read );
+        p_idx1->entry[i_index].i_flags  = GetDWLE( p_read + 4 );
+        p_idx1->entry[i_index].i_pos    = GetDWLE( p_read + 8 );
+        p_idx1->entry[i_index].i_length = GetDWLE( p_read + 12 );
     }
-#ifdef AVI_DEBUG
-    msg_Dbg( s, "idx1: index entry:%d", i_count );
-#endif
-    AVI_READCHUNK_EXIT( VLC_SUCCESS );
+    p_idx1->i_entry_count = i_count;
+    p_idx1->i_entry_max   = i_count;
+
+    free( p_buff );
+    return VLC_SUCCESS;
 }
 
-static void AVI_ChunkFree_idx1( avi_chunk_t *p_chk )
+void AVI_ChunkUnload_idx1( avi_chunk_idx1_t *p_idx1 )
 {
-    p_chk->idx1.i_entry_count = 0;
-    p_chk->idx1.i_entry_max   = 0;
-    FREENULL( p_chk->idx1.entry );
+    p_idx1->i_entry_count = 0;
+    p_idx1->i_entry_max   = 0;
+    FREENULL( p_idx1->entry );
 }
 
 
@@ -260,6 +260,9 @@ void   *AVI_ChunkFind_ ( avi_chunk_t *, vlc_fourcc_t, int, bool );
 int     AVI_ChunkReadRoot( stream_t *, avi_chunk_t *p_root );
 void    AVI_ChunkFreeRoot( stream_t *, avi_chunk_t *p_chk  );
 int     AVI_ChunkFetchIndexes( stream_t *, avi_chunk_t *p_riff );
+/* Reads the entries of an idx1 chunk, which are not read with the tree */
+int     AVI_ChunkLoad_idx1( stream_t *, avi_chunk_idx1_t * );
+void    AVI_ChunkUnload_idx1( avi_chunk_idx1_t * );
 
 #define AVI_ChunkCount( p_chk, i_fourcc, b_list ) \
     AVI_ChunkCount_( AVI_CHUNK(p_chk), i_fourcc, b_list )
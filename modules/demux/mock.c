@@ -207,7 +207,8 @@ var_Read_float(const char *psz)
     Y(video, frame_rate_base, unsigned, add_integer, Unsigned, 1, NO_FREE) \
     Y(video, colorbar, bool, add_bool, Bool, false, NO_FREE) \
     Y(video, orientation, unsigned, add_integer, Unsigned, ORIENT_NORMAL, NO_FREE) \
-    Y(video, image_count, unsigned, add_integer, Unsigned, 0, NO_FREE)
+    Y(video, image_count, unsigned, add_integer, Unsigned, 0, NO_FREE) \
+    Y(video, keyframe_interval, vlc_tick_t, add_integer, Integer, 0, NO_FREE)
 
 #define OPTIONS_SUB(Y) \
     Y(sub, packetized, bool, add_bool, Bool, true, NO_FREE) \
@@ -561,10 +562,24 @@ Control(demux_t *demux, int query, va_list args)
             *va_arg(args, vlc_tick_t *) = sys->pts;
             return VLC_SUCCESS;
         case DEMUX_SET_TIME:
+        {
             if (!sys->can_seek)
                 return VLC_EGENERIC;
-            sys->pts = sys->video_pts = sys->audio_pts = va_arg(args, vlc_tick_t);
+            vlc_tick_t time = va_arg(args, vlc_tick_t);
+            bool precise = va_arg(args, int);
+            /* Seek to the previous keyframe, and preroll up to the target */
+            const vlc_tick_t interval = sys->video.keyframe_interval;
+            if (interval > 0 && time >= 0)
+            {
+                vlc_tick_t keyframe = time / interval * interval;
+                if (precise && keyframe < time)
+                    es_out_Control(demux->out, ES_OUT_SET_NEXT_DISPLAY_TIME,
+                                   VLC_TICK_0 + time);
+                time = VLC_TICK_0 + keyframe;
+            }
+            sys->pts = sys->video_pts = sys->audio_pts = time;
             return VLC_SUCCESS;
+        }
         case DEMUX_GET_TITLE_INFO:
             if (sys->title_count > 0)
             {
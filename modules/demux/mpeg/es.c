@@ -889,6 +889,10 @@ static bool Parse( demux_t *p_demux, block_t **pp_output )
             block_Release( old );
         }
 
+        /* Let the packetizer slice frames out of the read buffer */
+        if( p_block_in )
+            p_block_in = block_Share( p_block_in );
+
         if( p_block_in )
         {
             p_block_in->i_pts =
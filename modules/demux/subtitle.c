@@ -53,6 +53,12 @@ static void Close( vlc_object_t *p_this );
     N_("Force the subtitles format. Selecting \"auto\" means autodetection and should always work.")
 #define SUB_DESCRIPTION_LONGTEXT \
     N_("Override the default track description.")
+#define SUB_INDEX_TEXT N_("Indexed loading threshold (MiB)")
+#define SUB_INDEX_LONGTEXT \
+    N_("Subtitle files larger than this size are only indexed when opened, " \
+       "and the text of each subtitle is read from the file when it is " \
+       "displayed. This keeps memory usage low with very large files. " \
+       "0 always loads the whole file.")
 
 static const char *const ppsz_sub_type[] =
 {
@@ -72,6 +78,9 @@ vlc_module_begin ()
         change_string_list( ppsz_sub_type, ppsz_sub_type )
     add_string( "sub-description", NULL, N_("Subtitle description"),
                 SUB_DESCRIPTION_LONGTEXT )
+    add_integer( "sub-index-threshold", 32, SUB_INDEX_TEXT,
+                 SUB_INDEX_LONGTEXT )
+        change_integer_range( 0, 4096 )
     set_callbacks( Open, Close )
 
     add_shortcut( "subtitle" )
@@ -111,10 +120,19 @@ typedef struct
     size_t  i_line_count;
     size_t  i_line;
     char    **line;
+
+    /* Indexed mode: lines are read from the stream on demand, and only the
+     * last one is kept so that TextPreviousLine() can step back once. */
+    stream_t *s;
+    char     *psz_stream_line;
+    uint64_t  i_stream_line_pos;
+    bool      b_stream_replay;
 } text_t;
 
 static int  TextLoad( text_t *, stream_t *s );
+static void TextStreamInit( text_t *, stream_t *s );
 static void TextUnload( text_t * );
+static uint64_t TextTell( text_t * );
 
 typedef struct
 {
@@ -168,6 +186,7 @@ typedef struct
     struct
     {
         subtitle_t *p_array;
+        uint64_t   *pi_offset; /* indexed mode only */
         size_t      i_count;
         size_t      i_current;
     } subtitles;
@@ -177,6 +196,12 @@ typedef struct
     /* */
     subs_properties_t props;
 
+    /* Indexed mode: psz_text is not kept in the subtitles array, and is
+     * parsed again from the stream when the subtitle is sent */
+    bool        b_indexed;
+    text_t      txt;
+    int  (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t*, size_t );
+
     block_t * (*pf_convert)( const subtitle_t * );
 } demux_sys_t;
 
@@ -239,6 +264,44 @@ static int Control( demux_t *, int, va_list );
 static void Fix( demux_t * );
 static char * get_language_from_filename( const char * );
 
+/*****************************************************************************
+ * Indexed mode
+ *****************************************************************************/
+
+/* Formats whose parser is stateless between two subtitles, and that can
+ * thus be parsed again starting from the first line of any subtitle. */
+static bool CanIndex( enum subtitle_type_e i_type )
+{
+    switch( i_type )
+    {
+        case SUB_TYPE_MICRODVD:
+        case SUB_TYPE_SUBRIP:
+        case SUB_TYPE_SUBVIEWER:
+        case SUB_TYPE_VPLAYER:
+        case SUB_TYPE_MPL2:
+        case SUB_TYPE_SBV:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool UseIndexedMode( demux_t *p_demux, enum subtitle_type_e i_type )
+{
+    const int64_t i_threshold = var_InheritInteger( p_demux, "sub-index-threshold" );
+    if( i_threshold <= 0 || !CanIndex( i_type ) )
+        return false;
+
+    bool b_can_seek;
+    uint64_t i_size;
+    if( vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_can_seek ) ||
+        !b_can_seek ||
+        vlc_stream_GetSize( p_demux->s, &i_size ) )
+        return false;
+
+    return i_size >= (uint64_t)i_threshold * 1024 * 1024;
+}
+
 /*****************************************************************************
  * Decoder format output function
  *****************************************************************************/
@@ -319,6 +382,11 @@ static int Open ( vlc_object_t *p_this )
     p_sys->subtitles.i_current= 0;
     p_sys->subtitles.i_count  = 0;
     p_sys->subtitles.p_array  = NULL;
+    p_sys->subtitles.pi_offset = NULL;
+
+    p_sys->b_indexed = false;
+    p_sys->pf_read = NULL;
+    TextStreamInit( &p_sys->txt, NULL );
 
     p_sys->props.psz_header         = NULL;
     p_sys->props.psz_lang           = NULL;
@@ -628,7 +696,11 @@ static int Open ( vlc_object_t *p_this )
         }
     }
 
-    msg_Dbg( p_demux, "loading all subtitles..." );
+    p_sys->b_indexed = UseIndexedMode( p_demux, p_sys->props.i_type );
+    if( p_sys->b_indexed )
+        msg_Dbg( p_demux, "indexing all subtitles..." );
+    else
+        msg_Dbg( p_demux, "loading all subtitles..." );
 
     if( e_bom == UTF8BOM && /* skip BOM */
         vlc_stream_Read( p_demux->s, NULL, 3 ) != 3 )
@@ -637,9 +709,12 @@ static int Open ( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
-    /* Load the whole file */
+    /* Load the whole file, or read it line by line in indexed mode */
     text_t txtlines;
-    TextLoad( &txtlines, p_demux->s );
+    if( p_sys->b_indexed )
+        TextStreamInit( &txtlines, p_demux->s );
+    else
+        TextLoad( &txtlines, p_demux->s );
 
     /* Parse it */
     for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
@@ -655,19 +730,49 @@ static int Open ( vlc_object_t *p_this )
                 return VLC_ENOMEM;
             }
             p_sys->subtitles.p_array = p_realloc;
+
+            if( p_sys->b_indexed )
+            {
+                uint64_t *pi_realloc = realloc( p_sys->subtitles.pi_offset,
+                                                sizeof(uint64_t) * i_max );
+                if( pi_realloc == NULL )
+                {
+                    TextUnload( &txtlines );
+                    Close( p_this );
+                    return VLC_ENOMEM;
+                }
+                p_sys->subtitles.pi_offset = pi_realloc;
+            }
         }
 
+        subtitle_t *p_subtitle = &p_sys->subtitles.p_array[p_sys->subtitles.i_count];
+        const uint64_t i_offset = p_sys->b_indexed ? TextTell( &txtlines ) : 0;
+
         if( pf_read( VLC_OBJECT(p_demux), &p_sys->props, &txtlines,
-                     &p_sys->subtitles.p_array[p_sys->subtitles.i_count],
-                     p_sys->subtitles.i_count ) )
+                     p_subtitle, p_sys->subtitles.i_count ) )
             break;
 
+        if( p_sys->b_indexed )
+        {
+            /* Only keep the timings, the text is parsed again on demand */
+            free( p_subtitle->psz_text );
+            p_subtitle->psz_text = NULL;
+            p_sys->subtitles.pi_offset[p_sys->subtitles.i_count] = i_offset;
+        }
+
         p_sys->subtitles.i_count++;
     }
     /* Unload */
     TextUnload( &txtlines );
 
-    msg_Dbg(p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
+    if( p_sys->b_indexed )
+    {
+        p_sys->pf_read = pf_read;
+        TextStreamInit( &p_sys->txt, p_demux->s );
+        msg_Dbg( p_demux, "indexed %zu subtitles", p_sys->subtitles.i_count );
+    }
+    else
+        msg_Dbg( p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
 
     /* *** add subtitle ES *** */
     if( p_sys->props.i_type == SUB_TYPE_SSA1 ||
@@ -739,7 +844,9 @@ static void Close( vlc_object_t *p_this )
     for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
         free( p_sys->subtitles.p_array[i].psz_text );
     free( p_sys->subtitles.p_array );
+    free( p_sys->subtitles.pi_offset );
     free( p_sys->props.psz_header );
+    TextUnload( &p_sys->txt );
 
     free( p_sys );
 }
@@ -844,6 +951,46 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     return VLC_EGENERIC;
 }
 
+/*****************************************************************************
+ * ConvertSubtitle: build the block of a subtitle, reading its text back
+ * from the stream in indexed mode
+ *****************************************************************************/
+static block_t *ConvertSubtitle( demux_t *p_demux, size_t i_index )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const subtitle_t *p_subtitle = &p_sys->subtitles.p_array[i_index];
+
+    if( !p_sys->b_indexed )
+        return p_sys->pf_convert( p_subtitle );
+
+    /* Sequential playback does not need any seek, as the stream is left
+     * at the start of the next subtitle by the previous parsing */
+    const uint64_t i_offset = p_sys->subtitles.pi_offset[i_index];
+    if( TextTell( &p_sys->txt ) != i_offset )
+    {
+        TextUnload( &p_sys->txt );
+        if( vlc_stream_Seek( p_demux->s, i_offset ) )
+            return NULL;
+        TextStreamInit( &p_sys->txt, p_demux->s );
+    }
+
+    subtitle_t sub = { .psz_text = NULL };
+    if( p_sys->pf_read( VLC_OBJECT(p_demux), &p_sys->props, &p_sys->txt,
+                        &sub, i_index ) )
+    {
+        msg_Warn( p_demux, "failed to read subtitle %zu", i_index );
+        return NULL;
+    }
+
+    /* Timings always come from the index */
+    sub.i_start = p_subtitle->i_start;
+    sub.i_stop = p_subtitle->i_stop;
+
+    block_t *p_block = p_sys->pf_convert( &sub );
+    free( sub.psz_text );
+    return p_block;
+}
+
 /*****************************************************************************
  * Demux: Send subtitle to decoder
  *****************************************************************************/
@@ -867,7 +1014,7 @@ static int Demux( demux_t *p_demux )
 
         if( p_subtitle->i_start >= 0 )
         {
-            block_t *p_block = p_sys->pf_convert( p_subtitle );
+            block_t *p_block = ConvertSubtitle( p_demux, p_sys->subtitles.i_current );
             if( p_block )
             {
                 p_block->i_dts =
@@ -918,9 +1065,8 @@ static int TextLoad( text_t *txt, stream_t *s )
     size_t i_line_max;
 
     /* init txt */
+    TextStreamInit( txt, NULL );
     i_line_max          = 500;
-    txt->i_line_count   = 0;
-    txt->i_line         = 0;
     txt->line           = calloc( i_line_max, sizeof( char * ) );
     if( !txt->line )
         return VLC_ENOMEM;
@@ -953,6 +1099,17 @@ static int TextLoad( text_t *txt, stream_t *s )
 
     return VLC_SUCCESS;
 }
+static void TextStreamInit( text_t *txt, stream_t *s )
+{
+    txt->i_line_count = 0;
+    txt->i_line       = 0;
+    txt->line         = NULL;
+
+    txt->s                 = s;
+    txt->psz_stream_line   = NULL;
+    txt->i_stream_line_pos = 0;
+    txt->b_stream_replay   = false;
+}
 static void TextUnload( text_t *txt )
 {
     if( txt->i_line_count )
@@ -963,10 +1120,37 @@ static void TextUnload( text_t *txt )
     }
     txt->i_line       = 0;
     txt->i_line_count = 0;
+
+    free( txt->psz_stream_line );
+    txt->psz_stream_line = NULL;
+    txt->b_stream_replay = false;
+}
+
+/* Position of the next line TextGetLine() will return (indexed mode) */
+static uint64_t TextTell( text_t *txt )
+{
+    assert( txt->s != NULL );
+    if( txt->b_stream_replay )
+        return txt->i_stream_line_pos;
+    return vlc_stream_Tell( txt->s );
 }
 
 static char *TextGetLine( text_t *txt )
 {
+    if( txt->s != NULL )
+    {
+        if( txt->b_stream_replay )
+        {
+            txt->b_stream_replay = false;
+            return txt->psz_stream_line;
+        }
+
+        free( txt->psz_stream_line );
+        txt->i_stream_line_pos = vlc_stream_Tell( txt->s );
+        txt->psz_stream_line = vlc_stream_ReadLine( txt->s );
+        return txt->psz_stream_line;
+    }
+
     if( txt->i_line >= txt->i_line_count )
         return( NULL );
 
@@ -974,6 +1158,13 @@ static char *TextGetLine( text_t *txt )
 }
 static void TextPreviousLine( text_t *txt )
 {
+    if( txt->s != NULL )
+    {
+        if( txt->psz_stream_line != NULL )
+            txt->b_stream_replay = true;
+        return;
+    }
+
     if( txt->i_line > 0 )
         txt->i_line--;
 }
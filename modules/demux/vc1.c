@@ -142,6 +142,9 @@ static int Demux( demux_t *p_demux)
     bool b_eof = false;
 
     p_block_in = vlc_stream_Block( p_demux->s, VC1_PACKET_SIZE );
+    /* Let the packetizer slice frames out of the read buffer */
+    if( p_block_in != NULL )
+        p_block_in = block_Share( p_block_in );
     if( p_block_in == NULL )
     {
         b_eof = true;
@@ -573,6 +573,10 @@ InputStatsPanel::InputStatsPanel( QWidget *parent ): QWidget( parent )
                            "0", video, qtr("frames") );
     CREATE_AND_ADD_TO_CAT( vlost_frames_stat, qtr("Lost"),
                            "0", video, qtr("frames") );
+    CREATE_AND_ADD_TO_CAT( vdropped_stat, qtr("Dropped by the decoder"),
+                           "0", video, qtr("frames") );
+    CREATE_AND_ADD_TO_CAT( vdrop_level_stat, qtr("Frame dropping stage"),
+                           "0", video, "" );
 
     CREATE_AND_ADD_TO_CAT( adecoded_stat, qtr("Decoded"),
                            "0", audio, qtr("blocks") );
@@ -639,6 +643,8 @@ void InputStatsPanel::update( const input_stats_t& stats )
     UPDATE_INT( vdisplayed_stat,   stats.i_displayed_pictures );
     UPDATE_INT( vlate_stat,        stats.i_late_pictures );
     UPDATE_INT( vlost_frames_stat, stats.i_lost_pictures );
+    UPDATE_INT( vdropped_stat,     stats.i_dropped_video );
+    UPDATE_INT( vdrop_level_stat,  stats.i_video_drop_level );
 
     /* Audio*/
     UPDATE_INT( adecoded_stat, stats.i_decoded_audio );
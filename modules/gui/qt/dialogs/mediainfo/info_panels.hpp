@@ -129,6 +129,8 @@ private:
     QTreeWidgetItem *vdisplayed_stat;
     QTreeWidgetItem *vlate_stat;
     QTreeWidgetItem *vlost_frames_stat;
+    QTreeWidgetItem *vdropped_stat;
+    QTreeWidgetItem *vdrop_level_stat;
     QTreeWidgetItem *vfps_stat;
 
     QTreeWidgetItem *audio;
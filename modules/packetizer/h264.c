@@ -992,6 +992,9 @@ static block_t *OutputPicture( decoder_t *p_dec )
             break;
     }
 
+    if( h264_get_nal_ref_idc( p_sys->p_slice ) == 0 )
+        p_pic->i_flags |= BLOCK_FLAG_NON_REFERENCE;
+
     if( !p_sys->b_recovered )
     {
         if( p_sys->i_recoveryfnum != UINT_MAX ) /* recovering from SEI */
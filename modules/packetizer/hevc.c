@@ -775,6 +775,14 @@ static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
             break;
         }
 
+        /* Sub-layer non-reference pictures of the highest sub-layer are not
+         * referenced by any other picture */
+        if(i_nal_type <= HEVC_NAL_RSV_VCL_N14 && !(i_nal_type & 1) &&
+           i_layer == 0 && p_sys->p_active_sps &&
+           hevc_getNALTemporalId(p_buffer) + 1 ==
+           hevc_get_sps_max_sub_layers(p_sys->p_active_sps))
+            p_frag->i_flags |= BLOCK_FLAG_NON_REFERENCE;
+
         if(p_sli)
             hevc_rbsp_release_slice_header(p_sli);
     }
@@ -1005,6 +1005,11 @@ uint8_t hevc_get_sps_vps_id( const hevc_sequence_parameter_set_t *p_sps )
     return p_sps->sps_video_parameter_set_id;
 }
 
+uint8_t hevc_get_sps_max_sub_layers( const hevc_sequence_parameter_set_t *p_sps )
+{
+    return p_sps->sps_max_sub_layers_minus1 + 1;
+}
+
 uint8_t hevc_get_pps_sps_id( const hevc_picture_parameter_set_t *p_pps )
 {
     return p_pps->pps_seq_parameter_set_id;
@@ -250,6 +250,11 @@ static inline uint8_t hevc_getNALLayer( const uint8_t *p_buf )
     return ((p_buf[0] & 0x01) << 6) | (p_buf[1] >> 3);
 }
 
+static inline uint8_t hevc_getNALTemporalId( const uint8_t *p_buf )
+{
+    return (p_buf[1] & 0x07) - 1;
+}
+
 /* NAL decoding */
 typedef struct hevc_video_parameter_set_t hevc_video_parameter_set_t;
 typedef struct hevc_sequence_parameter_set_t hevc_sequence_parameter_set_t;
@@ -275,6 +280,7 @@ void hevc_rbsp_release_slice_header( hevc_slice_segment_header_t * );
 
 /* set specific */
 uint8_t hevc_get_sps_vps_id( const hevc_sequence_parameter_set_t * );
+uint8_t hevc_get_sps_max_sub_layers( const hevc_sequence_parameter_set_t * );
 uint8_t hevc_get_pps_sps_id( const hevc_picture_parameter_set_t * );
 uint8_t hevc_get_slice_pps_id( const hevc_slice_segment_header_t * );
 bool hevc_get_slice_no_output_of_prior_pics_flag( const hevc_slice_segment_header_t * );
@@ -19,9 +19,24 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 #include <vlc_bits.h>
+#include "startcode_helper.h"
 
 static inline uint8_t *hxxx_ep3b_to_rbsp( uint8_t *p, uint8_t *end, unsigned *pi_prev, size_t i_count )
 {
+    /* Large forwards: skip with a vector lookup up to the first 0x00 0x00 0x03.
+     * Only valid if the current byte can't be part of an escape sequence. */
+    if( i_count >= 16 && !(*pi_prev & 1) && (size_t)(end - p) > i_count + 1 )
+    {
+        const uint8_t *ep3b = startcode_Find3B( p + 1, p + 1 + i_count, 0x03 );
+        size_t i_skip = ep3b ? (size_t)(ep3b - (p + 1)) : i_count;
+        if( i_skip >= 2 )
+        {
+            p += i_skip;
+            i_count -= i_skip;
+            *pi_prev = ((!p[-1]) << 1) | (!*p);
+        }
+    }
+
     for( size_t i=0; i<i_count; i++ )
     {
         if( ++p >= end )
@@ -73,7 +88,7 @@ struct hxxx_bsfw_ep3b_ctx_s
     size_t i_bytepos;
 };
 
-static void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
+static inline void hxxx_bsfw_ep3b_ctx_init( struct hxxx_bsfw_ep3b_ctx_s *ctx )
 {
     ctx->i_prev = 0;
     ctx->i_bytepos = 0;
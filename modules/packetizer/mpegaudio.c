@@ -103,10 +103,16 @@ static void Flush( decoder_t *p_dec )
 /*****************************************************************************
  * GetOutBuffer:
  *****************************************************************************/
-static uint8_t *GetOutBuffer( decoder_t *p_dec, block_t **pp_out_buffer )
+static block_t *GetOutBuffer( decoder_t *p_dec )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
 
+    /* Extract the whole frame, without copy if the input is shared */
+    block_t *p_block = block_BytestreamGetBlock( &p_sys->bytestream,
+                                                 p_sys->header.i_frame_size );
+    if( p_block == NULL )
+        return NULL;
+
     if( p_dec->fmt_out.audio.i_rate != p_sys->header.i_sample_rate ||
         date_Get( &p_sys->end_date ) == VLC_TICK_INVALID )
     {
@@ -132,16 +138,11 @@ static uint8_t *GetOutBuffer( decoder_t *p_dec, block_t **pp_out_buffer )
 
     p_dec->fmt_out.i_bitrate = p_sys->header.i_bit_rate * 1000U;
 
-    block_t *p_block = block_Alloc( p_sys->header.i_frame_size );
-    if( p_block == NULL )
-        return NULL;
-
     p_block->i_pts = p_block->i_dts = date_Get( &p_sys->end_date );
     p_block->i_length =
         date_Increment( &p_sys->end_date, p_sys->header.i_samples_per_frame ) - p_block->i_pts;
 
-    *pp_out_buffer = p_block;
-    return p_block->p_buffer;
+    return p_block;
 }
 
 /****************************************************************************
@@ -154,7 +155,6 @@ static block_t *DecodeBlock( decoder_t *p_dec, block_t **pp_block )
     decoder_sys_t *p_sys = p_dec->p_sys;
     uint8_t p_header[MAD_BUFFER_GUARD];
     uint32_t i_header;
-    uint8_t *p_buf;
     block_t *p_out_buffer;
 
     block_t *p_block = pp_block ? *pp_block : NULL;
@@ -397,7 +397,7 @@ static block_t *DecodeBlock( decoder_t *p_dec, block_t **pp_block )
             /* fallthrough */
 
         case STATE_SEND_DATA:
-            if( !(p_buf = GetOutBuffer( p_dec, &p_out_buffer )) )
+            if( !(p_out_buffer = GetOutBuffer( p_dec )) )
             {
                 return NULL;
             }
@@ -408,15 +408,6 @@ static block_t *DecodeBlock( decoder_t *p_dec, block_t **pp_block )
                 p_sys->i_free_frame_size = p_sys->header.i_frame_size;
             }
 
-            /* Copy the whole frame into the buffer. */
-            if ( block_GetBytes( &p_sys->bytestream, p_buf,
-                                 __MIN( p_sys->header.i_frame_size,
-                                        p_out_buffer->i_buffer ) ) )
-            {
-                block_Release(p_out_buffer);
-                return NULL;
-            }
-
             p_sys->i_state = STATE_NOSYNC;
 
             /* Make sure we don't reuse the same pts twice */
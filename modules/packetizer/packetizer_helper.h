@@ -180,26 +180,34 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+            /* Do not wait for next sync code if notified block ends AU */
+            bool b_au_end = (p_block_bytestream->i_flags & BLOCK_FLAG_AU_END) &&
+                             p_block_bytestream->i_buffer == p_pack->i_offset;
+            vlc_tick_t i_pts = p_block_bytestream->i_pts;
+            vlc_tick_t i_dts = p_block_bytestream->i_dts;
+
+            if( p_pack->i_au_prepend > 0 )
+            {
+                p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+                if( p_pic != NULL )
+                {
+                    memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
+                    block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
+                                    p_pack->i_offset );
+                }
+            }
+            else /* slice shared input blocks instead of copying */
+                p_pic = block_BytestreamGetBlock( &p_pack->bytestream, p_pack->i_offset );
+
             if( p_pic == NULL )
             {
                 p_pack->i_state = STATE_NOSYNC;
                 return NULL;
             }
-            p_pic->i_pts = p_block_bytestream->i_pts;
-            p_pic->i_dts = p_block_bytestream->i_dts;
-
-            /* Do not wait for next sync code if notified block ends AU */
-            if( (p_block_bytestream->i_flags & BLOCK_FLAG_AU_END) &&
-                 p_block_bytestream->i_buffer == p_pack->i_offset )
-            {
+            p_pic->i_pts = i_pts;
+            p_pic->i_dts = i_dts;
+            if( b_au_end )
                 p_pic->i_flags |= BLOCK_FLAG_AU_END;
-            }
-
-            block_GetBytes( &p_pack->bytestream, &p_pic->p_buffer[p_pack->i_au_prepend],
-                            p_pic->i_buffer - p_pack->i_au_prepend );
-            if( p_pack->i_au_prepend > 0 )
-                memcpy( p_pic->p_buffer, p_pack->p_au_prepend, p_pack->i_au_prepend );
 
             p_pack->i_offset = 0;
 
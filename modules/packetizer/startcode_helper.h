@@ -150,16 +150,146 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
+/* Wide vector lookups of the 3 bytes sequence 0x00 0x00 <last>.
+ * A position matches if the 3 overlapping unaligned loads at p, p+1 and p+2
+ * respectively equal 0, 0 and <last>, so no lane needs a second pass. */
+static inline const uint8_t * startcode_Find3B_C( const uint8_t *p, const uint8_t *end,
+                                                   uint8_t last )
+{
+    for (end -= 2; p < end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == last)
+            return p;
+    }
+    return NULL;
+}
+
+#ifdef CAN_COMPILE_AVX2
+#  include <immintrin.h>
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_Find3B_AVX2( const uint8_t *p, const uint8_t *end,
+                                                      uint8_t last )
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i vlast = _mm256_set1_epi8( last );
+
+    for( ; end - p >= 32 + 2; p += 32 )
+    {
+        __m256i a = _mm256_loadu_si256( (const __m256i *) p );
+        __m256i b = _mm256_loadu_si256( (const __m256i *) (p + 1) );
+        __m256i c = _mm256_loadu_si256( (const __m256i *) (p + 2) );
+        __m256i m = _mm256_and_si256( _mm256_cmpeq_epi8( a, zero ),
+                                      _mm256_cmpeq_epi8( b, zero ) );
+        m = _mm256_and_si256( m, _mm256_cmpeq_epi8( c, vlast ) );
+
+        uint32_t match = _mm256_movemask_epi8( m );
+        if( match )
+            return p + ctz( match );
+    }
+
+    return startcode_Find3B_C( p, end, last );
+}
+
+__attribute__ ((__target__ ("avx512f,avx512bw")))
+static inline const uint8_t * startcode_Find3B_AVX512( const uint8_t *p, const uint8_t *end,
+                                                        uint8_t last )
+{
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i vlast = _mm512_set1_epi8( last );
+
+    for( ; end - p >= 64 + 2; p += 64 )
+    {
+        __m512i a = _mm512_loadu_si512( p );
+        __m512i b = _mm512_loadu_si512( p + 1 );
+        __m512i c = _mm512_loadu_si512( p + 2 );
+
+        uint64_t match = _mm512_cmpeq_epi8_mask( a, zero )
+                       & _mm512_cmpeq_epi8_mask( b, zero )
+                       & _mm512_cmpeq_epi8_mask( c, vlast );
+        if( match )
+            return p + ctz( match );
+    }
+
+    return startcode_Find3B_C( p, end, last );
+}
+
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find3B_AVX2( p, end, 0x01 );
+}
+
+static inline const uint8_t * startcode_FindAnnexB_AVX512( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find3B_AVX512( p, end, 0x01 );
+}
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  include <arm_neon.h>
+#  define STARTCODE_HAVE_NEON
+
+static inline const uint8_t * startcode_Find3B_NEON( const uint8_t *p, const uint8_t *end,
+                                                      uint8_t last )
+{
+    const uint8x16_t zero = vdupq_n_u8( 0 );
+    const uint8x16_t vlast = vdupq_n_u8( last );
+
+    for( ; end - p >= 16 + 2; p += 16 )
+    {
+        uint8x16_t m = vandq_u8( vceqq_u8( vld1q_u8( p ), zero ),
+                                 vceqq_u8( vld1q_u8( p + 1 ), zero ) );
+        m = vandq_u8( m, vceqq_u8( vld1q_u8( p + 2 ), vlast ) );
+
+        /* narrow to one nibble per byte, as there is no movemask */
+        uint64_t match = vget_lane_u64( vreinterpret_u64_u8(
+                            vshrn_n_u16( vreinterpretq_u16_u8( m ), 4 ) ), 0 );
+        if( match )
+            return p + ctz( match ) / 4;
+    }
+
+    return startcode_Find3B_C( p, end, last );
+}
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    return startcode_Find3B_NEON( p, end, 0x01 );
+}
+#endif
+
+/* Looks up the first 0x00 0x00 <last> sequence with the best kernel */
+static inline const uint8_t * startcode_Find3B( const uint8_t *p, const uint8_t *end,
+                                                 uint8_t last )
+{
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX512())
+        return startcode_Find3B_AVX512(p, end, last);
+    if (vlc_CPU_AVX2())
+        return startcode_Find3B_AVX2(p, end, last);
+#endif
+#ifdef STARTCODE_HAVE_NEON
+    return startcode_Find3B_NEON(p, end, last);
+#else
+    return startcode_Find3B_C(p, end, last);
+#endif
+}
+
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX512())
+        return startcode_FindAnnexB_AVX512(p, end);
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#endif
+#ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
-}
+#endif
+#ifdef STARTCODE_HAVE_NEON
+    return startcode_FindAnnexB_NEON(p, end);
 #else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
+    return startcode_FindAnnexB_Bits(p, end);
 #endif
+}
 
 #endif
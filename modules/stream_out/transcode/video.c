@@ -481,7 +481,8 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
             picture_t *p_tmp = video_new_buffer_encoder( id->encoder );
             if( likely( p_tmp ) )
             {
-                picture_Copy( p_tmp, p_pic );
+                picture_CopyPixelsThreaded( id->p_spu, p_tmp, p_pic );
+                picture_CopyProperties( p_tmp, p_pic );
                 picture_Release( p_pic );
                 p_pic = p_tmp;
             }
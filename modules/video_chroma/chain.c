@@ -33,6 +33,7 @@
 #include <vlc_filter.h>
 #include <vlc_mouse.h>
 #include <vlc_picture.h>
+#include <vlc_tick.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -60,6 +61,10 @@ static int BuildChromaResize( filter_t * );
 static int BuildChromaChain( filter_t *p_filter );
 static int BuildFilterChain( filter_t *p_filter );
 
+static int BuildWithPlan( filter_t *p_filter, const char *psz_builder,
+                          int (*pf_attempt)( filter_t *, unsigned ),
+                          unsigned i_attempts );
+
 static int CreateChain( filter_t *p_filter, const es_format_t *p_fmt_mid );
 static int CreateResizeChromaChain( filter_t *p_filter, const es_format_t *p_fmt_mid );
 static void EsFormatMergeSize( es_format_t *p_dst,
@@ -305,88 +310,293 @@ static void Flush( filter_t *p_filter )
 }
 
 /*****************************************************************************
- * Builders
+ * Plans cache
+ *****************************************************************************
+ * Building a chain probes the converters for each candidate intermediate
+ * format in turn, loading and opening modules that mostly refuse. The
+ * attempt that succeeded is remembered per formats for the whole process,
+ * and tried first when the same conversion is requested again, as when
+ * the vout is reconfigured or for each input of a mosaic.
+ *
+ * The converters accept or refuse depending on the whole formats, not only
+ * on the chromas, so the key holds everything they look at: sizes, crop,
+ * aspect ratio, orientation, colorimetry and the type of the input video
+ * context. For the same key the attempts that failed before the stored one
+ * fail again, so starting with it builds the same modules as the regular
+ * order would.
  *****************************************************************************/
+#define PLANS_MAX 32
+#define PLAN_BUILDER_MAX 32
 
-static int BuildTransformChain( filter_t *p_filter )
+typedef struct
+{
+    char psz_builder[PLAN_BUILDER_MAX]; /* builder or filter name */
+    video_format_t fmt_in; /* without palette */
+    video_format_t fmt_out;
+    int i_vctx_in; /* video context type, or -1 without context */
+    bool b_allow_fmt_out_change;
+
+    unsigned i_attempt; /* the one that succeeded */
+    vlc_tick_t i_duration; /* of the build without the plan */
+    uint64_t i_last_use;
+} chain_plan_t;
+
+static struct
 {
+    vlc_mutex_t lock;
+    chain_plan_t plans[PLANS_MAX];
+    size_t i_plans;
+    uint64_t i_lookups;
+    uint64_t i_hits;
+    vlc_tick_t i_saved;
+} plans_cache = { .lock = VLC_STATIC_MUTEX };
+
+static bool PlanFormatMatches( const video_format_t *a, const video_format_t *b )
+{
+    return a->i_chroma == b->i_chroma
+        && a->i_width == b->i_width && a->i_height == b->i_height
+        && a->i_x_offset == b->i_x_offset && a->i_y_offset == b->i_y_offset
+        && a->i_visible_width == b->i_visible_width
+        && a->i_visible_height == b->i_visible_height
+        && a->i_sar_num == b->i_sar_num && a->i_sar_den == b->i_sar_den
+        && a->orientation == b->orientation
+        && a->primaries == b->primaries
+        && a->transfer == b->transfer
+        && a->space == b->space
+        && a->color_range == b->color_range
+        && a->chroma_location == b->chroma_location
+        && a->multiview_mode == b->multiview_mode
+        && a->projection_mode == b->projection_mode;
+}
 
-    es_format_t fmt_mid;
-    int i_ret;
+static bool PlanMatches( const chain_plan_t *p_plan, const chain_plan_t *p_key )
+{
+    return !strcmp( p_plan->psz_builder, p_key->psz_builder )
+        && PlanFormatMatches( &p_plan->fmt_in, &p_key->fmt_in )
+        && PlanFormatMatches( &p_plan->fmt_out, &p_key->fmt_out )
+        && p_plan->i_vctx_in == p_key->i_vctx_in
+        && p_plan->b_allow_fmt_out_change == p_key->b_allow_fmt_out_change;
+}
 
-    /* Lets try transform first, then (potentially) resize+chroma */
-    msg_Dbg( p_filter, "Trying to build transform, then chroma+resize" );
-    es_format_Copy( &fmt_mid, &p_filter->fmt_in );
-    video_format_TransformTo(&fmt_mid.video, p_filter->fmt_out.video.orientation);
-    i_ret = CreateChain( p_filter, &fmt_mid );
-    es_format_Clean( &fmt_mid );
-    if( i_ret == VLC_SUCCESS )
+/* Returns the plan matching the key, or NULL. Called with the lock held. */
+static chain_plan_t *FindPlan( const chain_plan_t *p_key )
+{
+    for( size_t i = 0; i < plans_cache.i_plans; i++ )
+        if( PlanMatches( &plans_cache.plans[i], p_key ) )
+            return &plans_cache.plans[i];
+    return NULL;
+}
+
+static bool LookupPlan( const chain_plan_t *p_key, unsigned *pi_attempt )
+{
+    vlc_mutex_lock( &plans_cache.lock );
+    plans_cache.i_lookups++;
+
+    const chain_plan_t *p_plan = FindPlan( p_key );
+    if( p_plan != NULL )
+        *pi_attempt = p_plan->i_attempt;
+    vlc_mutex_unlock( &plans_cache.lock );
+    return p_plan != NULL;
+}
+
+static void StorePlan( const chain_plan_t *p_key, unsigned i_attempt,
+                       vlc_tick_t i_duration )
+{
+    vlc_mutex_lock( &plans_cache.lock );
+
+    chain_plan_t *p_plan = FindPlan( p_key );
+    if( p_plan == NULL )
+    {
+        if( plans_cache.i_plans < PLANS_MAX )
+            p_plan = &plans_cache.plans[plans_cache.i_plans++];
+        else
+        {
+            /* Replace the least recently used plan */
+            p_plan = &plans_cache.plans[0];
+            for( size_t i = 1; i < PLANS_MAX; i++ )
+                if( plans_cache.plans[i].i_last_use < p_plan->i_last_use )
+                    p_plan = &plans_cache.plans[i];
+        }
+        *p_plan = *p_key;
+    }
+    p_plan->i_attempt = i_attempt;
+    p_plan->i_duration = i_duration;
+    p_plan->i_last_use = plans_cache.i_lookups;
+
+    vlc_mutex_unlock( &plans_cache.lock );
+}
+
+/* Accounts a hit, and returns the total time saved */
+static vlc_tick_t HitPlan( const chain_plan_t *p_key, vlc_tick_t i_duration,
+                           uint64_t *pi_hits, uint64_t *pi_lookups )
+{
+    vlc_mutex_lock( &plans_cache.lock );
+
+    chain_plan_t *p_plan = FindPlan( p_key );
+    if( p_plan != NULL )
+    {
+        p_plan->i_last_use = plans_cache.i_lookups;
+        if( p_plan->i_duration > i_duration )
+            plans_cache.i_saved += p_plan->i_duration - i_duration;
+    }
+    plans_cache.i_hits++;
+    *pi_hits = plans_cache.i_hits;
+    *pi_lookups = plans_cache.i_lookups;
+    vlc_tick_t i_saved = plans_cache.i_saved;
+
+    vlc_mutex_unlock( &plans_cache.lock );
+    return i_saved;
+}
+
+/* Runs the attempts of a builder in order, starting with the one that
+ * succeeded last time for the same formats, if any */
+static int BuildWithPlan( filter_t *p_filter, const char *psz_builder,
+                          int (*pf_attempt)( filter_t *, unsigned ),
+                          unsigned i_attempts )
+{
+    chain_plan_t key = {
+        .fmt_in = p_filter->fmt_in.video,
+        .fmt_out = p_filter->fmt_out.video,
+        .i_vctx_in = p_filter->vctx_in != NULL ?
+            (int)vlc_video_context_GetType( p_filter->vctx_in ) : -1,
+        .b_allow_fmt_out_change = p_filter->b_allow_fmt_out_change,
+    };
+    key.fmt_in.p_palette = key.fmt_out.p_palette = NULL;
+    const bool b_cacheable = strlen( psz_builder ) < PLAN_BUILDER_MAX;
+    const vlc_tick_t i_start = vlc_tick_now();
+    unsigned i_hint = 0;
+    bool b_hint = false;
+
+    if( b_cacheable )
+    {
+        strcpy( key.psz_builder, psz_builder );
+        b_hint = LookupPlan( &key, &i_hint ) && i_hint < i_attempts;
+    }
+
+    if( b_hint && pf_attempt( p_filter, i_hint ) == VLC_SUCCESS )
+    {
+        uint64_t i_hits, i_lookups;
+        vlc_tick_t i_saved = HitPlan( &key, vlc_tick_now() - i_start,
+                                      &i_hits, &i_lookups );
+        msg_Dbg( p_filter, "reused the %s chain plan (%"PRIu64"/%"PRIu64
+                 " hits, %"PRId64" ms saved)", psz_builder, i_hits, i_lookups,
+                 MS_FROM_VLC_TICK( i_saved ) );
         return VLC_SUCCESS;
+    }
+
+    for( unsigned i = 0; i < i_attempts; i++ )
+    {
+        if( b_hint && i == i_hint )
+            continue;
+        if( pf_attempt( p_filter, i ) == VLC_SUCCESS )
+        {
+            if( b_cacheable )
+                StorePlan( &key, i, vlc_tick_now() - i_start );
+            return VLC_SUCCESS;
+        }
+    }
+    return VLC_EGENERIC;
+}
 
-    /* Lets try resize+chroma first, then transform */
-    msg_Dbg( p_filter, "Trying to build chroma+resize" );
-    EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
+/*****************************************************************************
+ * Builders
+ *****************************************************************************/
+
+static int TryTransformChain( filter_t *p_filter, unsigned i_attempt )
+{
+    es_format_t fmt_mid;
+    int i_ret;
+
+    if( i_attempt == 0 )
+    {
+        /* Lets try transform first, then (potentially) resize+chroma */
+        msg_Dbg( p_filter, "Trying to build transform, then chroma+resize" );
+        es_format_Copy( &fmt_mid, &p_filter->fmt_in );
+        video_format_TransformTo(&fmt_mid.video, p_filter->fmt_out.video.orientation);
+    }
+    else
+    {
+        /* Lets try resize+chroma first, then transform */
+        msg_Dbg( p_filter, "Trying to build chroma+resize" );
+        EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
+    }
     i_ret = CreateChain( p_filter, &fmt_mid );
     es_format_Clean( &fmt_mid );
     return i_ret;
 }
 
-static int BuildChromaResize( filter_t *p_filter )
+static int BuildTransformChain( filter_t *p_filter )
+{
+    return BuildWithPlan( p_filter, "transform", TryTransformChain, 2 );
+}
+
+static int TryChromaResize( filter_t *p_filter, unsigned i_attempt )
 {
     es_format_t fmt_mid;
     int i_ret;
 
-    /* Lets try resizing and then doing the chroma conversion */
-    msg_Dbg( p_filter, "Trying to build resize+chroma" );
-    EsFormatMergeSize( &fmt_mid, &p_filter->fmt_in, &p_filter->fmt_out );
-    i_ret = CreateResizeChromaChain( p_filter, &fmt_mid );
+    if( i_attempt == 0 )
+    {
+        /* Lets try resizing and then doing the chroma conversion */
+        msg_Dbg( p_filter, "Trying to build resize+chroma" );
+        EsFormatMergeSize( &fmt_mid, &p_filter->fmt_in, &p_filter->fmt_out );
+        i_ret = CreateResizeChromaChain( p_filter, &fmt_mid );
+    }
+    else
+    {
+        /* Lets try it the other way around (chroma and then resize) */
+        msg_Dbg( p_filter, "Trying to build chroma+resize" );
+        EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
+        i_ret = CreateChain( p_filter, &fmt_mid );
+    }
     es_format_Clean( &fmt_mid );
+    return i_ret;
+}
 
-    if( i_ret == VLC_SUCCESS )
-        return VLC_SUCCESS;
+static int BuildChromaResize( filter_t *p_filter )
+{
+    return BuildWithPlan( p_filter, "chroma+resize", TryChromaResize, 2 );
+}
 
-    /* Lets try it the other way around (chroma and then resize) */
-    msg_Dbg( p_filter, "Trying to build chroma+resize" );
-    EsFormatMergeSize( &fmt_mid, &p_filter->fmt_out, &p_filter->fmt_in );
-    i_ret = CreateChain( p_filter, &fmt_mid );
-    es_format_Clean( &fmt_mid );
-    if( i_ret == VLC_SUCCESS )
-        return VLC_SUCCESS;
+static unsigned CountAllowedChromas( filter_t *p_filter )
+{
+    const vlc_fourcc_t *pi_allowed_chromas = get_allowed_chromas( p_filter );
+    unsigned i_count = 0;
 
-    return VLC_EGENERIC;
+    while( pi_allowed_chromas[i_count] )
+        i_count++;
+    return i_count;
 }
 
-static int BuildChromaChain( filter_t *p_filter )
+static int TryChromaChain( filter_t *p_filter, unsigned i_attempt )
 {
     es_format_t fmt_mid;
-    int i_ret = VLC_EGENERIC;
-
-    /* Now try chroma format list */
-    const vlc_fourcc_t *pi_allowed_chromas = get_allowed_chromas( p_filter );
-    for( int i = 0; pi_allowed_chromas[i]; i++ )
-    {
-        const vlc_fourcc_t i_chroma = pi_allowed_chromas[i];
-        if( i_chroma == p_filter->fmt_in.i_codec ||
-            i_chroma == p_filter->fmt_out.i_codec )
-            continue;
-
-        msg_Dbg( p_filter, "Trying to use chroma %4.4s as middle man",
-                 (char*)&i_chroma );
+    int i_ret;
 
-        es_format_Copy( &fmt_mid, &p_filter->fmt_in );
-        fmt_mid.i_codec        =
-        fmt_mid.video.i_chroma = i_chroma;
+    const vlc_fourcc_t i_chroma = get_allowed_chromas( p_filter )[i_attempt];
+    if( i_chroma == p_filter->fmt_in.i_codec ||
+        i_chroma == p_filter->fmt_out.i_codec )
+        return VLC_EGENERIC;
 
-        i_ret = CreateChain( p_filter, &fmt_mid );
-        es_format_Clean( &fmt_mid );
+    msg_Dbg( p_filter, "Trying to use chroma %4.4s as middle man",
+             (char*)&i_chroma );
 
-        if( i_ret == VLC_SUCCESS )
-            break;
-    }
+    es_format_Copy( &fmt_mid, &p_filter->fmt_in );
+    fmt_mid.i_codec        =
+    fmt_mid.video.i_chroma = i_chroma;
 
+    i_ret = CreateChain( p_filter, &fmt_mid );
+    es_format_Clean( &fmt_mid );
     return i_ret;
 }
 
+static int BuildChromaChain( filter_t *p_filter )
+{
+    /* Now try chroma format list */
+    return BuildWithPlan( p_filter, "chroma", TryChromaChain,
+                          CountAllowedChromas( p_filter ) );
+}
+
 static int ChainMouse( filter_t *p_filter, vlc_mouse_t *p_mouse,
                        const vlc_mouse_t *p_old )
 {
@@ -394,55 +604,56 @@ static int ChainMouse( filter_t *p_filter, vlc_mouse_t *p_mouse,
     return filter_chain_MouseFilter( p_sys->p_chain, p_mouse, p_old );
 }
 
-static int BuildFilterChain( filter_t *p_filter )
+static int TryFilterChain( filter_t *p_filter, unsigned i_attempt )
 {
     es_format_t fmt_mid;
-    es_format_Init(&fmt_mid, p_filter->fmt_in.i_cat, p_filter->fmt_in.i_codec);
     int i_ret = VLC_EGENERIC;
 
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    /* Now try chroma format list */
-    const vlc_fourcc_t *pi_allowed_chromas = get_allowed_chromas( p_filter );
-    for( int i = 0; pi_allowed_chromas[i]; i++ )
-    {
-        filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in, &p_filter->fmt_out );
-
-        const vlc_fourcc_t i_chroma = pi_allowed_chromas[i];
-        if( i_chroma == p_filter->fmt_in.i_codec ||
-            i_chroma == p_filter->fmt_out.i_codec )
-            continue;
+    filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in, &p_filter->fmt_out );
 
-        msg_Dbg( p_filter, "Trying to use chroma %4.4s as middle man in chain (%p)",
-                 (char*)&i_chroma, (void*)p_sys->p_chain );
+    const vlc_fourcc_t i_chroma = get_allowed_chromas( p_filter )[i_attempt];
+    if( i_chroma == p_filter->fmt_in.i_codec ||
+        i_chroma == p_filter->fmt_out.i_codec )
+        return VLC_EGENERIC;
 
-        es_format_Clean( &fmt_mid );
-        es_format_Copy( &fmt_mid, &p_filter->fmt_in );
-        fmt_mid.i_codec        =
-        fmt_mid.video.i_chroma = i_chroma;
+    msg_Dbg( p_filter, "Trying to use chroma %4.4s as middle man in chain (%p)",
+             (char*)&i_chroma, (void*)p_sys->p_chain );
 
-        if( filter_chain_AppendConverter( p_sys->p_chain,
-                                          &fmt_mid ) != VLC_SUCCESS )
-            continue;
+    es_format_Copy( &fmt_mid, &p_filter->fmt_in );
+    fmt_mid.i_codec        =
+    fmt_mid.video.i_chroma = i_chroma;
 
-        p_sys->p_video_filter =
-            filter_chain_AppendFilter( p_sys->p_chain,
-                                       p_filter->psz_name, p_filter->p_cfg,
-                                       &fmt_mid );
-        if( p_sys->p_video_filter == NULL)
-            continue;
+    if( filter_chain_AppendConverter( p_sys->p_chain,
+                                      &fmt_mid ) != VLC_SUCCESS )
+        goto out;
 
-        filter_AddProxyCallbacks( p_filter,
-                                  p_sys->p_video_filter,
-                                  RestartFilterCallback );
+    p_sys->p_video_filter =
+        filter_chain_AppendFilter( p_sys->p_chain,
+                                   p_filter->psz_name, p_filter->p_cfg,
+                                   &fmt_mid );
+    if( p_sys->p_video_filter == NULL)
+        goto out;
 
-        i_ret = VLC_SUCCESS;
-        p_filter->vctx_out = filter_chain_GetVideoCtxOut( p_sys->p_chain );
-        break;
-    }
+    filter_AddProxyCallbacks( p_filter,
+                              p_sys->p_video_filter,
+                              RestartFilterCallback );
 
+    i_ret = VLC_SUCCESS;
+    p_filter->vctx_out = filter_chain_GetVideoCtxOut( p_sys->p_chain );
+out:
     es_format_Clean( &fmt_mid );
+    return i_ret;
+}
+
+static int BuildFilterChain( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
 
+    /* Now try chroma format list */
+    int i_ret = BuildWithPlan( p_filter, p_filter->psz_name, TryFilterChain,
+                               CountAllowedChromas( p_filter ) );
     if( i_ret != VLC_SUCCESS )
         filter_chain_Reset( p_sys->p_chain, &p_filter->fmt_in, p_filter->vctx_in, &p_filter->fmt_out );
 
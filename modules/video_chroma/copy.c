@@ -35,6 +35,11 @@
 #include <assert.h>
 
 #include "copy.h"
+
+/* Planes from this size are written with non-temporal stores, so that they
+ * do not evict the working set of the decoder from the caches */
+#define COPY_STREAM_MIN_SIZE (4 << 20)
+
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
                       unsigned height, int bitshift);
@@ -233,6 +238,26 @@ static void Copy2d(uint8_t *dst, size_t dst_pitch,
     }
 }
 
+/* Copy from cacheable memory, with non-temporal stores */
+VLC_SSE
+static void SSE_StreamPlane(uint8_t *dst, size_t dst_pitch,
+                            const uint8_t *src, size_t src_pitch,
+                            size_t width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++) {
+        size_t x = __MIN((-(uintptr_t)dst) & 0x0f, width);
+
+        memcpy(dst, src, x);
+        for (; x+63 < width; x += 64)
+            COPY64(&dst[x], &src[x], "movdqu", "movntdq");
+        memcpy(&dst[x], &src[x], width - x);
+
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+    asm volatile ("sfence" ::: "memory");
+}
+
 VLC_SSE
 static void
 SSE_InterleaveUV(uint8_t *dst, size_t dst_pitch,
@@ -474,7 +499,7 @@ static void SSE_CopyPlane(uint8_t *dst, size_t dst_pitch,
 
     /* If SSE4.1: CopyFromUswc is faster than memcpy */
     if (!vlc_CPU_SSE4_1() && bitshift == 0 && src_pitch == dst_pitch)
-        memcpy(dst, src, copy_pitch * height);
+        CopyPlane(dst, dst_pitch, src, src_pitch, height, 0);
     else
     for (unsigned y = 0; y < height; y += hstep) {
         const unsigned hblock =  __MIN(hstep, height - y);
@@ -631,6 +656,15 @@ static void CopyPlane(uint8_t *dst, size_t dst_pitch,
             dst += dst_pitch;
         }
     }
+#ifdef CAN_COMPILE_SSE2
+    else if (vlc_CPU_SSE2() && copy_pitch * height >= COPY_STREAM_MIN_SIZE)
+    {
+        if (src_pitch == dst_pitch)
+            SSE_StreamPlane(dst, 0, src, 0, copy_pitch * height, 1);
+        else
+            SSE_StreamPlane(dst, dst_pitch, src, src_pitch, copy_pitch, height);
+    }
+#endif
     else if (src_pitch == dst_pitch)
         memcpy(dst, src, copy_pitch * height);
     else
@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * i420_10_rgb.c : high bit depth YUV 4:2:0 to RGB conversion module for vlc
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+
+#include "yuv_rgb.h"
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+static int  Open ( filter_t * );
+
+vlc_module_begin ()
+    set_description( N_("I420 10 bits and P010 to RGBA and RGB10A2 "
+                        "conversions") )
+    /* Above swscale, which does not handle the 10 bits RGB output */
+    set_callback_video_converter( Open, 160 )
+vlc_module_end ()
+
+/*****************************************************************************
+ * Filter
+ *****************************************************************************/
+enum i420_10_rgb_layout
+{
+    LAYOUT_I420,
+    LAYOUT_I420_10,
+    LAYOUT_P010,
+};
+
+typedef struct
+{
+    struct yuv_rgb_params params;
+    yuv_rgb_row_fn convert;
+    enum i420_10_rgb_layout layout;
+    int black; /* black level in 10 bits */
+    int16_t *lines; /* unpacked Y, U and V rows */
+} filter_sys_t;
+
+/* Unpacks the row of a picture to 10 bits samples, upsampling the chroma */
+static void UnpackRow( const filter_sys_t *p_sys, const picture_t *p_src,
+                       unsigned x0, unsigned row, unsigned width,
+                       int16_t *restrict y, int16_t *restrict u,
+                       int16_t *restrict v )
+{
+    const plane_t *py = &p_src->p[Y_PLANE];
+    const plane_t *pu = &p_src->p[U_PLANE];
+    const int black = p_sys->black;
+    const unsigned c0 = x0 & 1;
+
+    switch( p_sys->layout )
+    {
+        case LAYOUT_I420:
+        {
+            const uint8_t *sy = &py->p_pixels[row * py->i_pitch + x0];
+            const uint8_t *su = &pu->p_pixels[(row / 2) * pu->i_pitch + x0 / 2];
+            const plane_t *pv = &p_src->p[V_PLANE];
+            const uint8_t *sv = &pv->p_pixels[(row / 2) * pv->i_pitch + x0 / 2];
+
+            for( unsigned i = 0; i < width; i++ )
+            {
+                y[i] = (sy[i] << 2) - black;
+                u[i] = (su[(i + c0) / 2] << 2) - 512;
+                v[i] = (sv[(i + c0) / 2] << 2) - 512;
+            }
+            break;
+        }
+        case LAYOUT_I420_10:
+        {
+            const uint16_t *sy = (const uint16_t *)
+                &py->p_pixels[row * py->i_pitch] + x0;
+            const uint16_t *su = (const uint16_t *)
+                &pu->p_pixels[(row / 2) * pu->i_pitch] + x0 / 2;
+            const plane_t *pv = &p_src->p[V_PLANE];
+            const uint16_t *sv = (const uint16_t *)
+                &pv->p_pixels[(row / 2) * pv->i_pitch] + x0 / 2;
+
+            for( unsigned i = 0; i < width; i++ )
+            {
+                y[i] = (sy[i] & 0x3ff) - black;
+                u[i] = (su[(i + c0) / 2] & 0x3ff) - 512;
+                v[i] = (sv[(i + c0) / 2] & 0x3ff) - 512;
+            }
+            break;
+        }
+        case LAYOUT_P010:
+        {
+            const uint16_t *sy = (const uint16_t *)
+                &py->p_pixels[row * py->i_pitch] + x0;
+            const uint16_t *suv = (const uint16_t *)
+                &pu->p_pixels[(row / 2) * pu->i_pitch] + (x0 & ~1u);
+
+            for( unsigned i = 0; i < width; i++ )
+            {
+                unsigned c = (i + c0) & ~1u;
+
+                y[i] = (sy[i] >> 6) - black;
+                u[i] = (suv[c] >> 6) - 512;
+                v[i] = (suv[c + 1] >> 6) - 512;
+            }
+            break;
+        }
+    }
+}
+
+static void I420_10_RGB( filter_t *p_filter, picture_t *p_src,
+                         picture_t *p_dst )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+    const unsigned width = fmt_in->i_visible_width;
+    int16_t *y = p_sys->lines;
+    int16_t *u = y + width;
+    int16_t *v = u + width;
+
+    for( unsigned row = 0; row < fmt_in->i_visible_height; row++ )
+    {
+        uint32_t *dst = (uint32_t *)
+            &p_dst->p->p_pixels[(fmt_out->i_y_offset + row) * p_dst->p->i_pitch]
+            + fmt_out->i_x_offset;
+
+        UnpackRow( p_sys, p_src, fmt_in->i_x_offset, fmt_in->i_y_offset + row,
+                   width, y, u, v );
+        p_sys->convert( dst, y, u, v, width, &p_sys->params );
+    }
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE( I420_10_RGB, Close )
+
+static int Open( filter_t *p_filter )
+{
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+
+    if( fmt_in->i_visible_width != fmt_out->i_visible_width
+     || fmt_in->i_visible_height != fmt_out->i_visible_height
+     || fmt_in->orientation != fmt_out->orientation )
+        return VLC_EGENERIC;
+
+    enum i420_10_rgb_layout layout;
+    switch( fmt_in->i_chroma )
+    {
+        case VLC_CODEC_I420:
+            /* The 8 bits conversions are handled by i420_rgb and swscale,
+             * unless the AVX2 kernel can be used */
+            if( !vlc_CPU_AVX2() )
+                return VLC_EGENERIC;
+            layout = LAYOUT_I420;
+            break;
+#ifndef WORDS_BIGENDIAN
+        case VLC_CODEC_I420_10L:
+            layout = LAYOUT_I420_10;
+            break;
+        case VLC_CODEC_P010:
+            layout = LAYOUT_P010;
+            break;
+#endif
+        default:
+            return VLC_EGENERIC;
+    }
+
+    struct yuv_rgb_params params;
+    const unsigned bits = SetPixelFormat( &params, fmt_out->i_chroma );
+    if( bits == 0 )
+        return VLC_EGENERIC;
+
+    filter_sys_t *p_sys = malloc( sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    /* Rows are converted by blocks of 16 pixels, the tail in C */
+    p_sys->lines = vlc_alloc( 3 * fmt_in->i_visible_width, sizeof(int16_t) );
+    if( unlikely(p_sys->lines == NULL) )
+    {
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
+    video_color_space_t space = fmt_in->space;
+    if( space == COLOR_SPACE_UNDEF )
+        space = fmt_in->i_visible_height > 576 ? COLOR_SPACE_BT709
+                                               : COLOR_SPACE_BT601;
+    const bool full_range = fmt_in->color_range == COLOR_RANGE_FULL;
+
+    SetParams( &params, space, full_range, bits );
+    p_sys->params = params;
+    p_sys->layout = layout;
+    p_sys->black = full_range ? 0 : 16 << 2;
+
+    const char *simd = "";
+    p_sys->convert = ConvertRow;
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        p_sys->convert = ConvertRowAVX2;
+        simd = " (AVX2)";
+    }
+#endif
+#ifdef YUV_RGB_HAVE_NEON
+    p_sys->convert = ConvertRowNEON;
+    simd = " (NEON)";
+#endif
+
+    msg_Dbg( p_filter, "%4.4s to %4.4s, %s range BT.%s%s",
+             (const char *)&fmt_in->i_chroma,
+             (const char *)&fmt_out->i_chroma,
+             full_range ? "full" : "limited",
+             space == COLOR_SPACE_BT601 ? "601" :
+             space == COLOR_SPACE_BT2020 ? "2020" : "709",
+             simd );
+
+    p_filter->p_sys = p_sys;
+    p_filter->ops = &I420_10_RGB_ops;
+    return VLC_SUCCESS;
+}
+
+static void Close( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    free( p_sys->lines );
+    free( p_sys );
+}
@@ -0,0 +1,308 @@
+/*****************************************************************************
+ * yuv_rgb.h : YUV to 32 bits RGB row conversion
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_VIDEO_CHROMA_YUV_RGB_H
+#define VLC_VIDEO_CHROMA_YUV_RGB_H
+
+#include <math.h>
+
+#include <vlc_es.h>
+
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define YUV_RGB_HAVE_NEON
+#endif
+
+/*****************************************************************************
+ * Row conversion
+ *****************************************************************************
+ * Each picture row is first unpacked to 10 bits signed samples, centered on
+ * the black level and on the neutral chroma, the chroma being upsampled
+ * horizontally. The unpacked row is then converted to packed RGB with 16 bits
+ * fixed point coefficients, in C, with AVX2 or with NEON, with the same
+ * results.
+ *****************************************************************************/
+#define COEF_BITS 12
+
+struct yuv_rgb_params
+{
+    /* Coefficients with COEF_BITS fractional bits */
+    int16_t y;
+    int16_t rv, gu, gv, bu;
+    unsigned shift;
+    int max; /* maximum component value */
+    unsigned r_pos, g_pos, b_pos; /* bit positions in the pixel */
+    uint32_t alpha; /* opaque alpha at its position */
+};
+
+typedef void (*yuv_rgb_row_fn)( uint32_t *restrict, const int16_t *,
+                                const int16_t *, const int16_t *, unsigned,
+                                const struct yuv_rgb_params * );
+
+static inline uint32_t Clip( int v, int max )
+{
+    return v < 0 ? 0 : v > max ? max : v;
+}
+
+static void ConvertRow( uint32_t *restrict dst, const int16_t *y,
+                        const int16_t *u, const int16_t *v, unsigned width,
+                        const struct yuv_rgb_params *p )
+{
+    const int round = 1 << (p->shift - 1);
+
+    for( unsigned i = 0; i < width; i++ )
+    {
+        int l = p->y * y[i] + round;
+        int r = (l + p->rv * v[i]) >> p->shift;
+        int g = (l + p->gu * u[i] + p->gv * v[i]) >> p->shift;
+        int b = (l + p->bu * u[i]) >> p->shift;
+
+        dst[i] = (Clip( r, p->max ) << p->r_pos)
+               | (Clip( g, p->max ) << p->g_pos)
+               | (Clip( b, p->max ) << p->b_pos) | p->alpha;
+    }
+}
+
+#ifdef CAN_COMPILE_AVX2
+__attribute__ ((__target__ ("avx2")))
+static void ConvertRowAVX2( uint32_t *restrict dst, const int16_t *y,
+                            const int16_t *u, const int16_t *v,
+                            unsigned width,
+                            const struct yuv_rgb_params *p )
+{
+    /* Pairs of 16 bits coefficients for _mm256_madd_epi16() */
+#define PAIR(a, b) _mm256_set1_epi32( (uint16_t)(a) | ((uint32_t)(b) << 16) )
+    const __m256i yv_r = PAIR( p->y, p->rv );
+    const __m256i yu_g = PAIR( p->y, p->gu );
+    const __m256i v0_g = PAIR( p->gv, 0 );
+    const __m256i yu_b = PAIR( p->y, p->bu );
+#undef PAIR
+    const __m256i round = _mm256_set1_epi32( 1 << (p->shift - 1) );
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i max = _mm256_set1_epi32( p->max );
+    const __m256i alpha = _mm256_set1_epi32( p->alpha );
+    const __m128i shift = _mm_cvtsi32_si128( p->shift );
+    const __m128i r_pos = _mm_cvtsi32_si128( p->r_pos );
+    const __m128i g_pos = _mm_cvtsi32_si128( p->g_pos );
+    const __m128i b_pos = _mm_cvtsi32_si128( p->b_pos );
+    unsigned i = 0;
+
+#define COMPONENT(sum) \
+    _mm256_min_epi32( _mm256_max_epi32( \
+        _mm256_sra_epi32( _mm256_add_epi32( sum, round ), shift ), zero ), max )
+
+    for( ; i + 16 <= width; i += 16 )
+    {
+        __m256i vy = _mm256_loadu_si256( (const __m256i *)&y[i] );
+        __m256i vu = _mm256_loadu_si256( (const __m256i *)&u[i] );
+        __m256i vv = _mm256_loadu_si256( (const __m256i *)&v[i] );
+        __m256i out[2];
+
+        /* The unpacks are per 128 bits lane: the low half gets the pixels
+         * 0-3 and 8-11, the high half the pixels 4-7 and 12-15 */
+        for( unsigned h = 0; h < 2; h++ )
+        {
+            __m256i yv, yu, v0;
+            if( h == 0 )
+            {
+                yv = _mm256_unpacklo_epi16( vy, vv );
+                yu = _mm256_unpacklo_epi16( vy, vu );
+                v0 = _mm256_unpacklo_epi16( vv, zero );
+            }
+            else
+            {
+                yv = _mm256_unpackhi_epi16( vy, vv );
+                yu = _mm256_unpackhi_epi16( vy, vu );
+                v0 = _mm256_unpackhi_epi16( vv, zero );
+            }
+
+            __m256i r = COMPONENT( _mm256_madd_epi16( yv, yv_r ) );
+            __m256i g = COMPONENT( _mm256_add_epi32(
+                                        _mm256_madd_epi16( yu, yu_g ),
+                                        _mm256_madd_epi16( v0, v0_g ) ) );
+            __m256i b = COMPONENT( _mm256_madd_epi16( yu, yu_b ) );
+
+            out[h] = _mm256_or_si256(
+                        _mm256_or_si256( _mm256_sll_epi32( r, r_pos ),
+                                         _mm256_sll_epi32( g, g_pos ) ),
+                        _mm256_or_si256( _mm256_sll_epi32( b, b_pos ),
+                                         alpha ) );
+        }
+
+        _mm256_storeu_si256( (__m256i *)&dst[i],
+                             _mm256_permute2x128_si256( out[0], out[1], 0x20 ) );
+        _mm256_storeu_si256( (__m256i *)&dst[i + 8],
+                             _mm256_permute2x128_si256( out[0], out[1], 0x31 ) );
+    }
+#undef COMPONENT
+
+    ConvertRow( dst + i, y + i, u + i, v + i, width - i, p );
+}
+#endif
+
+#ifdef YUV_RGB_HAVE_NEON
+static void ConvertRowNEON( uint32_t *restrict dst, const int16_t *y,
+                            const int16_t *u, const int16_t *v,
+                            unsigned width,
+                            const struct yuv_rgb_params *p )
+{
+    const int32x4_t round = vdupq_n_s32( 1 << (p->shift - 1) );
+    const int32x4_t shift = vdupq_n_s32( -(int)p->shift );
+    const int32x4_t zero = vdupq_n_s32( 0 );
+    const int32x4_t max = vdupq_n_s32( p->max );
+    const uint32x4_t alpha = vdupq_n_u32( p->alpha );
+    const int32x4_t r_pos = vdupq_n_s32( p->r_pos );
+    const int32x4_t g_pos = vdupq_n_s32( p->g_pos );
+    const int32x4_t b_pos = vdupq_n_s32( p->b_pos );
+    unsigned i = 0;
+
+#define COMPONENT(sum, pos) \
+    vshlq_u32( vreinterpretq_u32_s32( vminq_s32( vmaxq_s32( \
+        vshlq_s32( sum, shift ), zero ), max ) ), pos )
+
+    for( ; i + 8 <= width; i += 8 )
+    {
+        const int16x8_t vy = vld1q_s16( &y[i] );
+        const int16x8_t vu = vld1q_s16( &u[i] );
+        const int16x8_t vv = vld1q_s16( &v[i] );
+
+        /* Widening multiply-accumulates, 4 pixels per half */
+        for( unsigned h = 0; h < 2; h++ )
+        {
+            const int16x4_t y4 = h ? vget_high_s16( vy ) : vget_low_s16( vy );
+            const int16x4_t u4 = h ? vget_high_s16( vu ) : vget_low_s16( vu );
+            const int16x4_t v4 = h ? vget_high_s16( vv ) : vget_low_s16( vv );
+            const int32x4_t l = vmlal_n_s16( round, y4, p->y );
+
+            const int32x4_t r = vmlal_n_s16( l, v4, p->rv );
+            const int32x4_t g = vmlal_n_s16( vmlal_n_s16( l, u4, p->gu ),
+                                             v4, p->gv );
+            const int32x4_t b = vmlal_n_s16( l, u4, p->bu );
+
+            vst1q_u32( &dst[i + 4 * h],
+                       vorrq_u32( vorrq_u32( COMPONENT( r, r_pos ),
+                                             COMPONENT( g, g_pos ) ),
+                                  vorrq_u32( COMPONENT( b, b_pos ), alpha ) ) );
+        }
+    }
+#undef COMPONENT
+
+    ConvertRow( dst + i, y + i, u + i, v + i, width - i, p );
+}
+#endif
+
+/*****************************************************************************
+ * Coefficients
+ *****************************************************************************/
+static void SetParams( struct yuv_rgb_params *p,
+                       video_color_space_t space, bool full_range,
+                       unsigned out_bits )
+{
+    double kr, kb;
+
+    switch( space )
+    {
+        case COLOR_SPACE_BT601:
+            kr = 0.299;
+            kb = 0.114;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627;
+            kb = 0.0593;
+            break;
+        default:
+            kr = 0.2126;
+            kb = 0.0722;
+            break;
+    }
+
+    const double kg = 1. - kr - kb;
+    /* Gains from 10 bits samples, relative to the black level and to the
+     * neutral chroma, to 10 bits components */
+    const double ky = full_range ? 1. : 1023. / (219 << 2);
+    const double kc = full_range ? 1. : 1023. / (224 << 2);
+    const double one = 1 << COEF_BITS;
+
+    p->y  = lround( one * ky );
+    p->rv = lround( one * kc * 2. * (1. - kr) );
+    p->gu = -lround( one * kc * 2. * (1. - kb) * kb / kg );
+    p->gv = -lround( one * kc * 2. * (1. - kr) * kr / kg );
+    p->bu = lround( one * kc * 2. * (1. - kb) );
+
+    p->shift = COEF_BITS + 10 - out_bits;
+    p->max = (1 << out_bits) - 1;
+}
+
+/*****************************************************************************
+ * Output format
+ *****************************************************************************/
+/* Sets the positions of the components and of the alpha in the pixels,
+ * returns the number of bits per component, or 0 if not supported */
+static unsigned SetPixelFormat( struct yuv_rgb_params *p,
+                                vlc_fourcc_t i_chroma )
+{
+    /* Bit positions of the components in a host endian 32 bits value */
+    unsigned r_pos, g_pos, b_pos, a_pos, bits = 8;
+    switch( i_chroma )
+    {
+        case VLC_CODEC_RGBA:
+        case VLC_CODEC_RGBX:
+            r_pos = 0; g_pos = 8; b_pos = 16; a_pos = 24;
+            break;
+        case VLC_CODEC_BGRA:
+        case VLC_CODEC_BGRX:
+            b_pos = 0; g_pos = 8; r_pos = 16; a_pos = 24;
+            break;
+        case VLC_CODEC_ARGB:
+        case VLC_CODEC_XRGB:
+            a_pos = 0; r_pos = 8; g_pos = 16; b_pos = 24;
+            break;
+        case VLC_CODEC_ABGR:
+        case VLC_CODEC_XBGR:
+            a_pos = 0; b_pos = 8; g_pos = 16; r_pos = 24;
+            break;
+#ifndef WORDS_BIGENDIAN
+        case VLC_CODEC_RGBA10LE:
+            r_pos = 0; g_pos = 10; b_pos = 20; a_pos = 30;
+            bits = 10;
+            break;
+#endif
+        default:
+            return 0;
+    }
+#ifdef WORDS_BIGENDIAN
+    /* The 8 bits positions above are in memory order */
+    r_pos = 24 - r_pos;
+    g_pos = 24 - g_pos;
+    b_pos = 24 - b_pos;
+    a_pos = 24 - a_pos;
+#endif
+
+    p->r_pos = r_pos;
+    p->g_pos = g_pos;
+    p->b_pos = b_pos;
+    p->alpha = (uint32_t)(bits == 10 ? 0x3 : 0xff) << a_pos;
+    return bits;
+}
+
+#endif
@@ -0,0 +1,404 @@
+/*****************************************************************************
+ * yuv_rgb_scale.c : fused YUV 4:2:0 to scaled RGB conversion module for vlc
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Converts semi-planar and planar YUV 4:2:0 pictures to cropped and scaled
+ * 32 bits RGB in a single pass, instead of a chain of a chroma conversion, a
+ * scaler and a RGB conversion, each one writing a whole picture.
+ *
+ * The output is processed in tiles of TILE_WIDTH columns and of a band of
+ * rows: the source rows are scaled horizontally into small row buffers kept
+ * in cache, that are blended vertically, converted and stored. The source is
+ * read once and the destination written once.
+ *
+ * The scaling is bilinear, with chroma samples centered between the luma
+ * samples, so only downscaling down to half the source size is accepted.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+
+#include "yuv_rgb.h"
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+static int  Open ( filter_t * );
+
+vlc_module_begin ()
+    set_description( N_("Fused YUV 4:2:0 to scaled RGB conversion") )
+    /* Below swscale and its better scaling filters, above the chains of a
+     * chroma conversion and a scaler */
+    set_callback_video_converter( Open, 140 )
+vlc_module_end ()
+
+/*****************************************************************************
+ * Scaling
+ *****************************************************************************/
+#define TILE_WIDTH 256
+
+struct yuv_rgb_scale_tap
+{
+    unsigned i0, i1; /* source samples */
+    unsigned weight; /* weight of i1, with 8 bits */
+};
+
+/* Sets the bilinear taps of out_count samples over in_count source luma
+ * samples starting at in_offset, for a plane subsampled by 1 << shift */
+static void SetTaps( struct yuv_rgb_scale_tap *taps, unsigned out_count,
+                     unsigned in_offset, unsigned in_count, unsigned shift )
+{
+    const unsigned first = in_offset >> shift;
+    const unsigned last = (in_offset + in_count - 1) >> shift;
+
+    for( unsigned i = 0; i < out_count; i++ )
+    {
+        /* Center of the output sample, in 1/65536 of source luma sample */
+        int64_t pos = ((int64_t)(2 * i + 1) * in_count << 16) / (2 * out_count)
+                    + ((int64_t)in_offset << 16) - (1 << 15);
+        /* Subsampled plane, whose samples are centered between luma ones */
+        pos = (pos - (((1 << shift) - 1) << 15)) >> shift;
+
+        struct yuv_rgb_scale_tap *tap = &taps[i];
+        if( pos <= (int64_t)first << 16 )
+        {
+            tap->i0 = tap->i1 = first;
+            tap->weight = 0;
+        }
+        else if( pos >= (int64_t)last << 16 )
+        {
+            tap->i0 = tap->i1 = last;
+            tap->weight = 0;
+        }
+        else
+        {
+            tap->i0 = pos >> 16;
+            tap->i1 = tap->i0 + 1;
+            tap->weight = (pos >> 8) & 0xff;
+        }
+    }
+}
+
+/* Component of the source: rows of samples spaced by step bytes */
+struct yuv_rgb_scale_plane
+{
+    const uint8_t *pixels;
+    ptrdiff_t pitch;
+    unsigned step;
+};
+
+/* Horizontally scaled source rows, with 8 bits of fraction */
+struct yuv_rgb_scale_cache
+{
+    uint16_t rows[2][TILE_WIDTH];
+    int tags[2]; /* source row index, -1 if none */
+};
+
+/* Per slice buffers */
+struct yuv_rgb_scale_tile
+{
+    struct yuv_rgb_scale_cache cache[3]; /* Y, U and V */
+    int16_t y[TILE_WIDTH], u[TILE_WIDTH], v[TILE_WIDTH];
+};
+
+static void ScaleRow( uint16_t *restrict dst,
+                      const struct yuv_rgb_scale_plane *plane, unsigned row,
+                      const struct yuv_rgb_scale_tap *taps, unsigned count )
+{
+    const uint8_t *src = &plane->pixels[row * plane->pitch];
+    const unsigned step = plane->step;
+
+    for( unsigned i = 0; i < count; i++ )
+    {
+        const unsigned w = taps[i].weight;
+        dst[i] = src[taps[i].i0 * step] * (256 - w)
+               + src[taps[i].i1 * step] * w;
+    }
+}
+
+/* Returns the scaled row, keeping the other row of the pair in cache */
+static const uint16_t *GetRow( struct yuv_rgb_scale_cache *cache,
+                               const struct yuv_rgb_scale_plane *plane,
+                               int row, int keep,
+                               const struct yuv_rgb_scale_tap *taps,
+                               unsigned count )
+{
+    for( unsigned k = 0; k < 2; k++ )
+        if( cache->tags[k] == row )
+            return cache->rows[k];
+
+    const unsigned k = cache->tags[0] == keep;
+    ScaleRow( cache->rows[k], plane, row, taps, count );
+    cache->tags[k] = row;
+    return cache->rows[k];
+}
+
+/* Blends two scaled rows to 10 bits samples, relative to the offset */
+static void BlendRows( int16_t *restrict dst, const uint16_t *r0,
+                       const uint16_t *r1, unsigned weight, int offset,
+                       unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+        dst[i] = ((r0[i] * (256 - weight) + r1[i] * weight + (1 << 13)) >> 14)
+               - offset;
+}
+
+/*****************************************************************************
+ * Filter
+ *****************************************************************************/
+typedef struct
+{
+    struct yuv_rgb_params params;
+    yuv_rgb_row_fn convert;
+    bool semi_planar;
+    bool swap_uv;
+    int black; /* black level in 10 bits */
+
+    struct yuv_rgb_scale_tap *cols_y, *cols_c;
+    struct yuv_rgb_scale_tap *rows_y, *rows_c;
+    struct yuv_rgb_scale_tile *tiles; /* VLC_FILTER_SLICES_MAX tiles */
+} filter_sys_t;
+
+struct yuv_rgb_scale_frame
+{
+    filter_t *filter;
+    struct yuv_rgb_scale_plane planes[3]; /* Y, U and V */
+    picture_t *dst;
+};
+
+/* Converts the output rows [first, first + count) */
+static void ConvertRows( filter_t *p_filter,
+                         const struct yuv_rgb_scale_plane *planes,
+                         picture_t *p_dst, struct yuv_rgb_scale_tile *tile,
+                         unsigned first, unsigned count )
+{
+    const filter_sys_t *p_sys = p_filter->p_sys;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+    const unsigned width = fmt_out->i_visible_width;
+    const plane_t *out = &p_dst->p[0];
+
+    for( unsigned x = 0; x < width; x += TILE_WIDTH )
+    {
+        const unsigned tile_width = __MIN(width - x, TILE_WIDTH);
+
+        for( unsigned k = 0; k < 3; k++ )
+            tile->cache[k].tags[0] = tile->cache[k].tags[1] = -1;
+
+        for( unsigned row = first; row < first + count; row++ )
+        {
+            const struct yuv_rgb_scale_tap *ty = &p_sys->rows_y[row];
+            const struct yuv_rgb_scale_tap *tc = &p_sys->rows_c[row];
+            int16_t *dst[3] = { tile->y, tile->u, tile->v };
+
+            for( unsigned k = 0; k < 3; k++ )
+            {
+                const struct yuv_rgb_scale_tap *t = k == 0 ? ty : tc;
+                const struct yuv_rgb_scale_tap *cols =
+                    k == 0 ? &p_sys->cols_y[x] : &p_sys->cols_c[x];
+                struct yuv_rgb_scale_cache *cache = &tile->cache[k];
+
+                const uint16_t *r0 = GetRow( cache, &planes[k], t->i0, t->i1,
+                                             cols, tile_width );
+                const uint16_t *r1 = GetRow( cache, &planes[k], t->i1, t->i0,
+                                             cols, tile_width );
+                BlendRows( dst[k], r0, r1, t->weight,
+                           k == 0 ? p_sys->black : 512, tile_width );
+            }
+
+            uint32_t *pixels = (uint32_t *)
+                &out->p_pixels[(fmt_out->i_y_offset + row) * out->i_pitch]
+                + fmt_out->i_x_offset + x;
+            p_sys->convert( pixels, tile->y, tile->u, tile->v, tile_width,
+                            &p_sys->params );
+        }
+    }
+}
+
+static void ConvertSlice( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct yuv_rgb_scale_frame *frame = opaque;
+    filter_sys_t *p_sys = frame->filter->p_sys;
+
+    ConvertRows( frame->filter, frame->planes, frame->dst,
+                 &p_sys->tiles[slice->index], slice->first, slice->count );
+}
+
+static void SetPlanes( const filter_sys_t *p_sys, const picture_t *p_src,
+                       struct yuv_rgb_scale_plane *planes )
+{
+    planes[0].pixels = p_src->p[Y_PLANE].p_pixels;
+    planes[0].pitch = p_src->p[Y_PLANE].i_pitch;
+    planes[0].step = 1;
+
+    for( unsigned k = 1; k < 3; k++ )
+    {
+        const unsigned c = (k == 1) != p_sys->swap_uv ? 0 : 1;
+
+        if( p_sys->semi_planar )
+        {
+            planes[k].pixels = p_src->p[1].p_pixels + c;
+            planes[k].pitch = p_src->p[1].i_pitch;
+            planes[k].step = 2;
+        }
+        else
+        {
+            planes[k].pixels = p_src->p[1 + c].p_pixels;
+            planes[k].pitch = p_src->p[1 + c].i_pitch;
+            planes[k].step = 1;
+        }
+    }
+}
+
+static void YUV_RGB_Scale( filter_t *p_filter, picture_t *p_src,
+                           picture_t *p_dst )
+{
+    struct yuv_rgb_scale_frame frame = {
+        .filter = p_filter,
+        .dst = p_dst,
+    };
+
+    SetPlanes( p_filter->p_sys, p_src, frame.planes );
+    filter_ExecuteSlices( p_filter, p_filter->fmt_out.video.i_visible_height,
+                          1, 0, ConvertSlice, &frame );
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE( YUV_RGB_Scale, Close )
+
+static int Open( filter_t *p_filter )
+{
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+    bool semi_planar = false, swap_uv = false;
+    const bool full_range = fmt_in->color_range == COLOR_RANGE_FULL;
+
+    if( fmt_in->orientation != fmt_out->orientation )
+        return VLC_EGENERIC;
+
+    switch( fmt_in->i_chroma )
+    {
+        case VLC_CODEC_NV21:
+            swap_uv = true;
+            /* fall through */
+        case VLC_CODEC_NV12:
+            semi_planar = true;
+            break;
+        case VLC_CODEC_I420:
+            break;
+        case VLC_CODEC_YV12:
+            swap_uv = true;
+            break;
+        default:
+            return VLC_EGENERIC;
+    }
+
+    const unsigned in_width = fmt_in->i_visible_width;
+    const unsigned in_height = fmt_in->i_visible_height;
+    const unsigned out_width = fmt_out->i_visible_width;
+    const unsigned out_height = fmt_out->i_visible_height;
+
+    if( in_width == 0 || in_height == 0 || out_width == 0 || out_height == 0 )
+        return VLC_EGENERIC;
+    /* Plain planar conversions are left to i420_rgb and swscale */
+    if( !semi_planar && in_width == out_width && in_height == out_height )
+        return VLC_EGENERIC;
+    /* The bilinear filter would alias */
+    if( 2 * out_width < in_width || 2 * out_height < in_height )
+        return VLC_EGENERIC;
+
+    struct yuv_rgb_params params;
+    const unsigned bits = SetPixelFormat( &params, fmt_out->i_chroma );
+    if( bits == 0 )
+        return VLC_EGENERIC;
+
+    filter_sys_t *p_sys = malloc( sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    p_sys->cols_y = vlc_alloc( 2 * out_width + 2 * out_height,
+                               sizeof(*p_sys->cols_y) );
+    p_sys->tiles = vlc_alloc( VLC_FILTER_SLICES_MAX, sizeof(*p_sys->tiles) );
+    if( unlikely(p_sys->cols_y == NULL || p_sys->tiles == NULL) )
+    {
+        free( p_sys->tiles );
+        free( p_sys->cols_y );
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+    p_sys->cols_c = p_sys->cols_y + out_width;
+    p_sys->rows_y = p_sys->cols_c + out_width;
+    p_sys->rows_c = p_sys->rows_y + out_height;
+
+    SetTaps( p_sys->cols_y, out_width, fmt_in->i_x_offset, in_width, 0 );
+    SetTaps( p_sys->cols_c, out_width, fmt_in->i_x_offset, in_width, 1 );
+    SetTaps( p_sys->rows_y, out_height, fmt_in->i_y_offset, in_height, 0 );
+    SetTaps( p_sys->rows_c, out_height, fmt_in->i_y_offset, in_height, 1 );
+
+    video_color_space_t space = fmt_in->space;
+    if( space == COLOR_SPACE_UNDEF )
+        space = in_height > 576 ? COLOR_SPACE_BT709 : COLOR_SPACE_BT601;
+
+    SetParams( &params, space, full_range, bits );
+    p_sys->params = params;
+    p_sys->semi_planar = semi_planar;
+    p_sys->swap_uv = swap_uv;
+    p_sys->black = full_range ? 0 : 16 << 2;
+
+    const char *simd = "";
+    p_sys->convert = ConvertRow;
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        p_sys->convert = ConvertRowAVX2;
+        simd = " (AVX2)";
+    }
+#endif
+#ifdef YUV_RGB_HAVE_NEON
+    p_sys->convert = ConvertRowNEON;
+    simd = " (NEON)";
+#endif
+
+    msg_Dbg( p_filter, "%4.4s %ux%u to %4.4s %ux%u, %s range BT.%s%s",
+             (const char *)&fmt_in->i_chroma, in_width, in_height,
+             (const char *)&fmt_out->i_chroma, out_width, out_height,
+             full_range ? "full" : "limited",
+             space == COLOR_SPACE_BT601 ? "601" :
+             space == COLOR_SPACE_BT2020 ? "2020" : "709",
+             simd );
+
+    p_filter->p_sys = p_sys;
+    p_filter->ops = &YUV_RGB_Scale_ops;
+    return VLC_SUCCESS;
+}
+
+static void Close( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    free( p_sys->tiles );
+    free( p_sys->cols_y );
+    free( p_sys );
+}
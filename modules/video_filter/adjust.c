@@ -221,6 +221,84 @@ static void Destroy( filter_t *p_filter )
 /*****************************************************************************
  * Run the filter on a Planar YUV picture
  *****************************************************************************/
+struct adjust_planar
+{
+    picture_t *src;
+    picture_t *dst;
+    const int *luma;
+    int (*pf_process_sat_hue)( picture_t *, picture_t *, int, int, int,
+                               int, int );
+    int i_sin, i_cos, i_sat, i_x, i_y;
+};
+
+static plane_t PlaneBand( const plane_t *p_plane, unsigned i_first,
+                          unsigned i_count )
+{
+    plane_t band = *p_plane;
+
+    band.p_pixels += i_first * p_plane->i_pitch;
+    band.i_lines = band.i_visible_lines = i_count;
+    return band;
+}
+
+/* Processes the chroma lines matching the luma lines of the slice */
+static void PlanarSliceChroma( const struct adjust_planar *ctx,
+                               const struct vlc_filter_slice *slice )
+{
+    const unsigned i_lines = ctx->src->p[Y_PLANE].i_visible_lines;
+    const unsigned i_chroma_lines = ctx->src->p[U_PLANE].i_visible_lines;
+    const unsigned i_first = slice->first * i_chroma_lines / i_lines;
+    const unsigned i_end = (slice->first + slice->count) * i_chroma_lines
+                         / i_lines;
+
+    /* The saturation and hue functions only use the U and V planes */
+    picture_t src = { .i_planes = ctx->src->i_planes };
+    picture_t dst = { .i_planes = ctx->dst->i_planes };
+    for( int i = U_PLANE; i <= V_PLANE; i++ )
+    {
+        src.p[i] = PlaneBand( &ctx->src->p[i], i_first, i_end - i_first );
+        dst.p[i] = PlaneBand( &ctx->dst->p[i], i_first, i_end - i_first );
+    }
+
+    if( i_end > i_first )
+        ctx->pf_process_sat_hue( &src, &dst, ctx->i_sin, ctx->i_cos,
+                                 ctx->i_sat, ctx->i_x, ctx->i_y );
+}
+
+#define PLANAR_SLICE_LUMA( data_t )                                          \
+    do                                                                       \
+    {                                                                        \
+        const plane_t *p_in = &ctx->src->p[Y_PLANE];                         \
+        plane_t *p_out = &ctx->dst->p[Y_PLANE];                              \
+        const unsigned i_width = p_in->i_visible_pitch / sizeof(data_t);     \
+                                                                             \
+        for( unsigned y = slice->first; y < slice->first + slice->count; y++ ) \
+        {                                                                    \
+            const data_t *p_src =                                            \
+                (const data_t *)&p_in->p_pixels[y * p_in->i_pitch];          \
+            data_t *p_dst = (data_t *)&p_out->p_pixels[y * p_out->i_pitch];  \
+                                                                             \
+            for( unsigned x = 0; x < i_width; x++ )                          \
+                p_dst[x] = ctx->luma[p_src[x]];                              \
+        }                                                                    \
+    } while( 0 )
+
+static void PlanarSlice8( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct adjust_planar *ctx = opaque;
+
+    PLANAR_SLICE_LUMA( uint8_t );
+    PlanarSliceChroma( ctx, slice );
+}
+
+static void PlanarSlice16( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct adjust_planar *ctx = opaque;
+
+    PLANAR_SLICE_LUMA( uint16_t );
+    PlanarSliceChroma( ctx, slice );
+}
+
 static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
 {
     /* The full range will only be used for 10-bit */
@@ -275,86 +353,7 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
         pi_luma[ i ] = pi_gamma[VLC_CLIP( (int)(i_lum + i_cont * i / i_range), 0, (int) i_max )];
     }
 
-    /*
-     * Do the Y plane
-     */
-    if ( b_16bit )
-    {
-        uint16_t *p_in, *p_in_end, *p_line_end;
-        uint16_t *p_out;
-        p_in = (uint16_t *) p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-            * (p_pic->p[Y_PLANE].i_pitch >> 1) - 8;
-
-        p_out = (uint16_t *) p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + (p_pic->p[Y_PLANE].i_visible_pitch >> 1) - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += (p_pic->p[Y_PLANE].i_pitch >> 1)
-                - (p_pic->p[Y_PLANE].i_visible_pitch >> 1);
-            p_out += (p_outpic->p[Y_PLANE].i_pitch >> 1)
-                - (p_outpic->p[Y_PLANE].i_visible_pitch >> 1);
-        }
-    }
-    else
-    {
-        uint8_t *p_in, *p_in_end, *p_line_end;
-        uint8_t *p_out;
-        p_in = p_pic->p[Y_PLANE].p_pixels;
-        p_in_end = p_in + p_pic->p[Y_PLANE].i_visible_lines
-                 * p_pic->p[Y_PLANE].i_pitch - 8;
-
-        p_out = p_outpic->p[Y_PLANE].p_pixels;
-
-        for( ; p_in < p_in_end ; )
-        {
-            p_line_end = p_in + p_pic->p[Y_PLANE].i_visible_pitch - 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                /* Do 8 pixels at a time */
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-                *p_out++ = pi_luma[ *p_in++ ]; *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_line_end += 8;
-
-            for( ; p_in < p_line_end ; )
-            {
-                *p_out++ = pi_luma[ *p_in++ ];
-            }
-
-            p_in += p_pic->p[Y_PLANE].i_pitch
-                  - p_pic->p[Y_PLANE].i_visible_pitch;
-            p_out += p_outpic->p[Y_PLANE].i_pitch
-                   - p_outpic->p[Y_PLANE].i_visible_pitch;
-        }
-    }
-
-    /*
-     * Do the U and V planes
-     */
-
+    /* Hue and saturation of the U and V planes */
     int i_sin = sinf(f_hue) * f_max;
     int i_cos = cosf(f_hue) * f_max;
 
@@ -362,20 +361,19 @@ static void FilterPlanar( filter_t *p_filter, picture_t *p_pic, picture_t *p_out
     int i_x = ( cosf(f_hue) + sinf(f_hue) ) * f_range * i_mid;
     int i_y = ( cosf(f_hue) - sinf(f_hue) ) * f_range * i_mid;
 
-    if ( i_sat > i_range )
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue_clip( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
-    else
-    {
-        /* Currently no errors are implemented in the function, if any are added
-         * check them here */
-        p_sys->pf_process_sat_hue( p_pic, p_outpic, i_sin, i_cos, i_sat,
-                                        i_x, i_y );
-    }
+    struct adjust_planar ctx = {
+        .src = p_pic,
+        .dst = p_outpic,
+        .luma = pi_luma,
+        /* Currently no errors are implemented in the functions, if any are
+         * added check them here */
+        .pf_process_sat_hue = i_sat > i_range ? p_sys->pf_process_sat_hue_clip
+                                              : p_sys->pf_process_sat_hue,
+        .i_sin = i_sin, .i_cos = i_cos, .i_sat = i_sat, .i_x = i_x, .i_y = i_y,
+    };
+
+    filter_ExecuteSlices( p_filter, p_pic->p[Y_PLANE].i_visible_lines, 2, 0,
+                          b_16bit ? PlanarSlice16 : PlanarSlice8, &ctx );
 }
 
 /*****************************************************************************
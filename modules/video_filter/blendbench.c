@@ -59,14 +59,17 @@ static picture_t *Filter( filter_t *, picture_t * );
 #define BASE_IMAGE_LONGTEXT N_("The image which will be used to blend onto")
 
 #define BASE_CHROMA_TEXT N_("Chroma for the base image")
-#define BASE_CHROMA_LONGTEXT N_("Chroma which the base image will be loaded in")
+#define BASE_CHROMA_LONGTEXT N_("Chroma which the base image will be loaded " \
+                                "in. A comma separated list benchmarks each " \
+                                "chroma in turn.")
 
 #define BLEND_IMAGE_TEXT N_("Image which will be blended")
 #define BLEND_IMAGE_LONGTEXT N_("The image blended onto the base image")
 
 #define BLEND_CHROMA_TEXT N_("Chroma for the blend image")
 #define BLEND_CHROMA_LONGTEXT N_("Chroma which the blend image will be loaded" \
-                                 " in")
+                                 " in. A comma separated list benchmarks each" \
+                                 " chroma in turn.")
 
 #define CFG_PREFIX "blendbench-"
 
@@ -104,16 +107,18 @@ static const char *const ppsz_filter_options[] = {
 /*****************************************************************************
  * filter_sys_t: filter method descriptor
  *****************************************************************************/
+#define MAX_CHROMAS 16
+
 typedef struct
 {
     bool b_done;
     int i_loops, i_alpha;
 
-    picture_t *p_base_image;
-    picture_t *p_blend_image;
-
-    vlc_fourcc_t i_base_chroma;
-    vlc_fourcc_t i_blend_chroma;
+    /* One image per chroma, every pair of them is benchmarked */
+    unsigned i_base_images;
+    picture_t *pp_base_images[MAX_CHROMAS];
+    unsigned i_blend_images;
+    picture_t *pp_blend_images[MAX_CHROMAS];
 } filter_sys_t;
 
 static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
@@ -142,6 +147,42 @@ static int blendbench_LoadImage( vlc_object_t *p_this, picture_t **pp_pic,
     return VLC_SUCCESS;
 }
 
+static void blendbench_ReleaseImages( picture_t **pp_pics, unsigned i_count )
+{
+    for( unsigned i = 0; i < i_count; i++ )
+        picture_Release( pp_pics[i] );
+}
+
+/* Loads the image in each chroma of the comma separated list */
+static int blendbench_LoadImages( vlc_object_t *p_this, picture_t **pp_pics,
+                                  unsigned *pi_count, char *psz_chromas,
+                                  char *psz_file, const char *psz_name )
+{
+    char *psz_save = NULL;
+    char *psz_chroma = psz_chromas ? strtok_r( psz_chromas, ",", &psz_save )
+                                   : NULL;
+
+    *pi_count = 0;
+    do
+    {
+        vlc_fourcc_t i_chroma = !psz_chroma || strlen( psz_chroma ) != 4 ? 0 :
+            VLC_FOURCC( psz_chroma[0], psz_chroma[1], psz_chroma[2],
+                        psz_chroma[3] );
+
+        if( blendbench_LoadImage( p_this, &pp_pics[*pi_count], i_chroma,
+                                  psz_file, psz_name ) != VLC_SUCCESS )
+        {
+            blendbench_ReleaseImages( pp_pics, *pi_count );
+            return VLC_EGENERIC;
+        }
+        (*pi_count)++;
+    }
+    while( *pi_count < MAX_CHROMAS && psz_chroma != NULL
+        && (psz_chroma = strtok_r( NULL, ",", &psz_save )) != NULL );
+
+    return VLC_SUCCESS;
+}
+
 static const struct vlc_filter_operations filter_ops =
 {
     .filter_video = Filter, .close = Destroy,
@@ -177,11 +218,10 @@ static int Create( filter_t *p_filter )
                                                   CFG_PREFIX "alpha" );
 
     psz_temp = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-chroma" );
-    p_sys->i_base_chroma = !psz_temp || strlen( psz_temp ) != 4 ? 0 :
-        VLC_FOURCC( psz_temp[0], psz_temp[1], psz_temp[2], psz_temp[3] );
     psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "base-image" );
-    i_ret = blendbench_LoadImage( VLC_OBJECT(p_filter), &p_sys->p_base_image,
-                                  p_sys->i_base_chroma, psz_cmd, "Base" );
+    i_ret = blendbench_LoadImages( VLC_OBJECT(p_filter), p_sys->pp_base_images,
+                                   &p_sys->i_base_images, psz_temp, psz_cmd,
+                                   "Base" );
     free( psz_temp );
     free( psz_cmd );
     if( i_ret != VLC_SUCCESS )
@@ -192,18 +232,17 @@ static int Create( filter_t *p_filter )
 
     psz_temp = var_CreateGetStringCommand( p_filter,
                                            CFG_PREFIX "blend-chroma" );
-    p_sys->i_blend_chroma = !psz_temp || strlen( psz_temp ) != 4
-        ? 0 : VLC_FOURCC( psz_temp[0], psz_temp[1], psz_temp[2], psz_temp[3] );
     psz_cmd = var_CreateGetStringCommand( p_filter, CFG_PREFIX "blend-image" );
-    i_ret = blendbench_LoadImage( VLC_OBJECT(p_filter), &p_sys->p_blend_image, p_sys->i_blend_chroma,
-                                  psz_cmd, "Blend" );
+    i_ret = blendbench_LoadImages( VLC_OBJECT(p_filter), p_sys->pp_blend_images,
+                                   &p_sys->i_blend_images, psz_temp, psz_cmd,
+                                   "Blend" );
 
     free( psz_temp );
     free( psz_cmd );
 
     if( i_ret != VLC_SUCCESS )
     {
-        picture_Release( p_sys->p_base_image );
+        blendbench_ReleaseImages( p_sys->pp_base_images, p_sys->i_base_images );
         free( p_sys );
 
         return VLC_EGENERIC;
@@ -219,55 +258,78 @@ static void Destroy( filter_t *p_filter )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
 
-    picture_Release( p_sys->p_base_image );
-    picture_Release( p_sys->p_blend_image );
+    blendbench_ReleaseImages( p_sys->pp_base_images, p_sys->i_base_images );
+    blendbench_ReleaseImages( p_sys->pp_blend_images, p_sys->i_blend_images );
 }
 
 /*****************************************************************************
- * Render: displays previously rendered output
+ * Bench: blends one image onto the other and reports the speed
  *****************************************************************************/
-static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+static void Bench( filter_t *p_filter, picture_t *p_base, picture_t *p_blend )
 {
     filter_sys_t *p_sys = p_filter->p_sys;
-    filter_t *p_blend;
-
-    if( p_sys->b_done )
-        return p_pic;
-
-    p_blend = vlc_object_create( p_filter, sizeof(filter_t) );
-    if( !p_blend )
-    {
-        picture_Release( p_pic );
-        return NULL;
-    }
-    p_blend->fmt_out.video = p_sys->p_base_image->format;
-    p_blend->fmt_in.video = p_sys->p_blend_image->format;
-    p_blend->p_module = vlc_filter_LoadModule( p_blend, "video blending", NULL, false );
-    if( !p_blend->p_module )
+    filter_t *p_blend_filter;
+
+    p_blend_filter = vlc_object_create( p_filter, sizeof(filter_t) );
+    if( !p_blend_filter )
+        return;
+    p_blend_filter->fmt_out.video = p_base->format;
+    p_blend_filter->fmt_in.video = p_blend->format;
+    p_blend_filter->p_module = vlc_filter_LoadModule( p_blend_filter,
+                                                      "video blending",
+                                                      NULL, false );
+    if( !p_blend_filter->p_module )
     {
-        picture_Release( p_pic );
-        vlc_object_delete(p_blend);
-        return NULL;
+        msg_Warn( p_filter, "Unable to blend %4.4s onto %4.4s",
+                  (const char *)&p_blend->format.i_chroma,
+                  (const char *)&p_base->format.i_chroma );
+        vlc_object_delete( p_blend_filter );
+        return;
     }
-    assert( p_blend->ops != NULL );
+    assert( p_blend_filter->ops != NULL );
 
     vlc_tick_t time = vlc_tick_now();
     for( int i_iter = 0; i_iter < p_sys->i_loops; ++i_iter )
     {
-        filter_Blend( p_blend, p_sys->p_base_image,
-                      0, 0, p_sys->p_blend_image, p_sys->i_alpha );
+        filter_Blend( p_blend_filter, p_base, 0, 0, p_blend, p_sys->i_alpha );
     }
     time = vlc_tick_now() - time;
 
-    msg_Info( p_filter, "Blended %d images in %f sec", p_sys->i_loops,
-              secf_from_vlc_tick(time) );
-    msg_Info( p_filter, "Speed is: %f images/second, %f pixels/second",
-              (float) p_sys->i_loops / time * CLOCK_FREQ,
-              (float) p_sys->i_loops / time * CLOCK_FREQ *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_pitch *
-                  p_sys->p_blend_image->p[Y_PLANE].i_visible_lines );
+    /* The pixels actually blended, whatever the sample sizes */
+    const unsigned i_pixels =
+        __MIN(p_base->format.i_visible_width,
+              p_blend->format.i_visible_width) *
+        __MIN(p_base->format.i_visible_height,
+              p_blend->format.i_visible_height);
+    const double f_seconds = secf_from_vlc_tick( __MAX(time, 1) );
+
+    msg_Info( p_filter, "%4.4s -> %4.4s: blended %d images in %f sec",
+              (const char *)&p_blend->format.i_chroma,
+              (const char *)&p_base->format.i_chroma, p_sys->i_loops,
+              f_seconds );
+    msg_Info( p_filter, "%4.4s -> %4.4s: %f images/second, %.1f MPix/s",
+              (const char *)&p_blend->format.i_chroma,
+              (const char *)&p_base->format.i_chroma,
+              p_sys->i_loops / f_seconds,
+              p_sys->i_loops / f_seconds * i_pixels / 1000000. );
+
+    vlc_filter_Delete( p_blend_filter );
+}
+
+/*****************************************************************************
+ * Render: displays previously rendered output
+ *****************************************************************************/
+static picture_t *Filter( filter_t *p_filter, picture_t *p_pic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_sys->b_done )
+        return p_pic;
 
-    vlc_filter_Delete( p_blend );
+    for( unsigned i = 0; i < p_sys->i_base_images; i++ )
+        for( unsigned j = 0; j < p_sys->i_blend_images; j++ )
+            Bench( p_filter, p_sys->pp_base_images[i],
+                   p_sys->pp_blend_images[j] );
 
     p_sys->b_done = true;
     return p_pic;
@@ -0,0 +1,197 @@
+/*****************************************************************************
+ * algo_bwdif.c : Bob Weaver deinterlacing algorithm
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#   include "config.h"
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_picture.h>
+#include <vlc_filter.h>
+
+#include "deinterlace.h" /* filter_sys_t  */
+#include "common.h"      /* FFMIN3 et al. */
+
+#include "algo_bwdif.h"
+#include "bwdif.h"
+
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
+{
+    return RenderBwdif( p_filter, p_dst, p_src, 0, 0 );
+}
+
+struct bwdif_plane
+{
+    const plane_t *prevp;
+    const plane_t *curp;
+    const plane_t *nextp;
+    plane_t *dstp;
+    void (*filter)(void *dst, const void *prev, const void *cur,
+                   const void *next, int w, ptrdiff_t prefs, ptrdiff_t mrefs,
+                   ptrdiff_t prefs3, ptrdiff_t mrefs3, int parity, int max,
+                   enum bwdif_mode mode);
+    int i_field;
+    int parity;
+    int pixel_size;
+    int max;
+    bool intra; /* no temporal references */
+};
+
+static void BwdifSlice( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct bwdif_plane *plane = opaque;
+    const plane_t *prevp = plane->prevp;
+    const plane_t *curp  = plane->curp;
+    const plane_t *nextp = plane->nextp;
+    plane_t *dstp = plane->dstp;
+    const int h = dstp->i_visible_lines;
+    const ptrdiff_t refs = curp->i_pitch / plane->pixel_size;
+
+    for( int y = slice->first; y < (int)(slice->first + slice->count); y++ )
+    {
+        uint8_t *dst = &dstp->p_pixels[y * dstp->i_pitch];
+
+        if( (y % 2) == plane->i_field  ||  plane->parity == 2 )
+        {
+            memcpy( dst, &curp->p_pixels[y * curp->i_pitch],
+                    dstp->i_visible_pitch );
+            continue;
+        }
+
+        /* The filters need 4 lines above and below, less near the edges */
+        enum bwdif_mode mode;
+        if( plane->intra )
+            mode = BWDIF_INTRA;
+        else if( y < 2 || y + 3 > h )
+            mode = BWDIF_EDGE;
+        else if( y < 4 || y + 5 > h )
+            mode = BWDIF_EDGE_SPATIAL;
+        else
+            mode = BWDIF_LINE;
+
+        plane->filter( dst,
+                       &prevp->p_pixels[y * prevp->i_pitch],
+                       &curp->p_pixels[y * curp->i_pitch],
+                       &nextp->p_pixels[y * nextp->i_pitch],
+                       dstp->i_visible_pitch / plane->pixel_size,
+                       y + 1 < h ? refs : -refs,
+                       y > 0 ? -refs : refs,
+                       y + 3 < h ? 3 * refs : -refs,
+                       y > 2 ? -3 * refs : refs,
+                       plane->parity, plane->max, mode );
+    }
+}
+
+static void RenderPlanes( filter_t *p_filter, picture_t *p_dst,
+                          picture_t *p_prev, picture_t *p_cur,
+                          picture_t *p_next, int i_field, int parity )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const int pixel_size = p_sys->chroma->pixel_size;
+    void (*filter)(void *dst, const void *prev, const void *cur,
+                   const void *next, int w, ptrdiff_t prefs, ptrdiff_t mrefs,
+                   ptrdiff_t prefs3, ptrdiff_t mrefs3, int parity, int max,
+                   enum bwdif_mode mode);
+
+#if defined(CAN_COMPILE_AVX2)
+    if( vlc_CPU_AVX2() && p_sys->chroma->pixel_bits <= 12 )
+        filter = pixel_size == 2 ? bwdif_filter_line_avx2_16bit
+                                 : bwdif_filter_line_avx2;
+    else
+#endif
+        filter = pixel_size == 2 ? bwdif_filter_line_c_16bit
+                                 : bwdif_filter_line_c;
+
+    for( int n = 0; n < p_dst->i_planes; n++ )
+    {
+        struct bwdif_plane plane = {
+            .prevp = &p_prev->p[n],
+            .curp  = &p_cur->p[n],
+            .nextp = &p_next->p[n],
+            .dstp  = &p_dst->p[n],
+            .filter = filter,
+            .i_field = i_field,
+            .parity = parity,
+            .pixel_size = pixel_size,
+            .max = (1 << p_sys->chroma->pixel_bits) - 1,
+            .intra = p_prev == p_cur,
+        };
+
+        /* Too small to be interpolated */
+        if( plane.dstp->i_visible_lines < 4 )
+        {
+            plane_CopyPixels( plane.dstp, plane.curp );
+            continue;
+        }
+        assert( plane.prevp->i_pitch == plane.curp->i_pitch &&
+                plane.curp->i_pitch == plane.nextp->i_pitch );
+        /* Each line reads the four lines above and below */
+        filter_ExecuteSlices( p_filter, plane.dstp->i_visible_lines, 2, 4,
+                              BwdifSlice, &plane );
+    }
+}
+
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field )
+{
+    VLC_UNUSED(p_src);
+
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    assert( i_order >= 0 && i_order <= 2 ); /* 2 = soft field repeat */
+    assert( i_field == 0 || i_field == 1 );
+
+    /* As the pitches must match, use ONLY pictures coming from picture_New()! */
+    picture_t *p_prev = p_sys->context.pp_history[0];
+    picture_t *p_cur  = p_sys->context.pp_history[1];
+    picture_t *p_next = p_sys->context.pp_history[2];
+
+    /* Same parity as yadif, 2 being a repeated field that is not filtered,
+       see RenderYadif() */
+    int parity;
+    if( p_cur  &&  p_cur->i_nb_fields > 2 )
+        parity = (i_order + 1) % 3;
+    else
+        parity = (i_order + 1) % 2;
+
+    if( p_prev && p_cur && p_next )
+    {
+        RenderPlanes( p_filter, p_dst, p_prev, p_cur, p_next, i_field,
+                      parity );
+        p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
+        return VLC_SUCCESS;
+    }
+    else if( !p_prev && !p_cur && p_next )
+    {
+        /* The first frame only has its own field to interpolate from */
+        RenderPlanes( p_filter, p_dst, p_next, p_next, p_next, i_field,
+                      parity % 2 );
+        return VLC_SUCCESS;
+    }
+    else
+    {
+        p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame */
+        return VLC_EGENERIC;
+    }
+}
@@ -0,0 +1,64 @@
+/*****************************************************************************
+ * algo_bwdif.h : Bob Weaver deinterlacing algorithm
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DEINTERLACE_ALGO_BWDIF_H
+#define VLC_DEINTERLACE_ALGO_BWDIF_H 1
+
+/**
+ * \file
+ * Bob Weaver deinterlacing algorithm: yadif with a better interpolation of
+ * the missing lines. The line filters are implemented in bwdif.h.
+ */
+
+/* Forward declarations */
+struct filter_t;
+struct picture_t;
+
+/*****************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/**
+ * Bob Weaver deinterlacer (bwdif).
+ * One field is copied as-is (i_field), the other is interpolated.
+ *
+ * It works exactly as RenderYadif(), with the same frame history, frame
+ * offset and soft field repeat handling, and is used the same way. The
+ * first frame is interpolated from its own field only.
+ *
+ * @param p_filter The filter instance. Must be non-NULL.
+ * @param p_dst Output frame. Must be allocated by caller.
+ * @param p_src Input frame. Must exist.
+ * @param i_order Temporal field number: 0 = first, 1 = second, 2 = rep. first.
+ * @param i_field Keep which field? 0 = top field, 1 = bottom field.
+ * @return VLC error code (int).
+ * @retval VLC_SUCCESS The requested field was rendered into p_dst.
+ * @retval VLC_EGENERIC Frame dropped; only occurs at the second frame after start.
+ * @see RenderYadif()
+ */
+int RenderBwdif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
+                 int i_order, int i_field );
+
+/**
+ * Same as RenderBwdif() but with no temporal references
+ */
+int RenderBwdifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src );
+
+#endif
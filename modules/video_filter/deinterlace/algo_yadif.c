@@ -51,6 +51,63 @@ int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
 }
 
+struct yadif_plane
+{
+    const plane_t *prevp;
+    const plane_t *curp;
+    const plane_t *nextp;
+    plane_t *dstp;
+    void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
+                   int w, int prefs, int mrefs, int parity, int mode);
+    int i_field;
+    int parity;
+    int w; /* in pixels */
+};
+
+/* Renders the line y, from 1 to i_visible_lines - 2, into dst */
+static void YadifLine( const struct yadif_plane *plane, uint8_t *dst, int y )
+{
+    const plane_t *prevp = plane->prevp;
+    const plane_t *curp  = plane->curp;
+    const plane_t *nextp = plane->nextp;
+    const plane_t *dstp  = plane->dstp;
+
+    if( (y % 2) == plane->i_field  ||  plane->parity == 2 )
+    {
+        memcpy( dst, &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+    }
+    else
+    {
+        int mode;
+        /* Spatial checks only when enough data */
+        mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+        plane->filter( dst,
+                       &prevp->p_pixels[y * prevp->i_pitch],
+                       &curp->p_pixels[y * curp->i_pitch],
+                       &nextp->p_pixels[y * nextp->i_pitch],
+                       plane->w,
+                       y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                       y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                       plane->parity,
+                       mode );
+    }
+}
+
+static void YadifSlice( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct yadif_plane *plane = opaque;
+    plane_t *dstp = plane->dstp;
+    const int i_last = dstp->i_visible_lines - 1;
+
+    for( int y = slice->first; y < (int)(slice->first + slice->count); y++ )
+    {
+        /* We duplicate the first and last lines */
+        YadifLine( plane, &dstp->p_pixels[y * dstp->i_pitch],
+                   VLC_CLIP( y, 1, i_last - 1 ) );
+    }
+}
+
 int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
                  int i_order, int i_field )
 {
@@ -112,6 +169,11 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
         void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
                        int w, int prefs, int mrefs, int parity, int mode);
 
+#if defined(CAN_COMPILE_AVX2)
+        if( vlc_CPU_AVX2() )
+            filter = yadif_filter_line_avx2;
+        else
+#endif
 #if defined(HAVE_X86ASM)
         if( vlc_CPU_SSSE3() )
             filter = vlcpriv_yadif_filter_line_ssse3;
@@ -120,53 +182,47 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
             filter = vlcpriv_yadif_filter_line_sse2;
         else
 #endif
+#if defined(YADIF_HAVE_NEON)
+            filter = yadif_filter_line_neon;
+#else
             filter = yadif_filter_line_c;
+#endif
 
         if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
+        {
+#if defined(CAN_COMPILE_AVX2)
+            if( vlc_CPU_AVX2() && p_sys->chroma->pixel_bits <= 12 )
+                filter = yadif_filter_line_avx2_16bit;
+            else
+#endif
+#if defined(YADIF_HAVE_NEON)
+            if( p_sys->chroma->pixel_bits <= 12 )
+                filter = yadif_filter_line_neon_16bit;
+            else
+#endif
+                filter = yadif_filter_line_c_16bit;
+        }
 
         for( int n = 0; n < p_dst->i_planes; n++ )
         {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
+            struct yadif_plane plane = {
+                .prevp = &p_prev->p[n],
+                .curp  = &p_cur->p[n],
+                .nextp = &p_next->p[n],
+                .dstp  = &p_dst->p[n],
+                .filter = filter,
+                .i_field = i_field,
+                .parity = yadif_parity,
+                .w = p_dst->p[n].i_visible_pitch / p_sys->chroma->pixel_size,
+            };
+
+            if( plane.dstp->i_visible_lines < 3 )
+                continue;
+            assert( plane.prevp->i_pitch == plane.curp->i_pitch &&
+                    plane.curp->i_pitch == plane.nextp->i_pitch );
+            /* Each line reads the two lines above and below */
+            filter_ExecuteSlices( p_filter, plane.dstp->i_visible_lines, 2, 2,
+                                  YadifSlice, &plane );
         }
 
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
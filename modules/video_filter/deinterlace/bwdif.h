@@ -0,0 +1,319 @@
+/*****************************************************************************
+ * bwdif.h : Bob Weaver deinterlacing line filters
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DEINTERLACE_BWDIF_H
+#define VLC_DEINTERLACE_BWDIF_H 1
+
+/**
+ * \file
+ * Line filters of the Bob Weaver deinterlacer, as in the bwdif filter of
+ * FFmpeg. It is based on yadif, with the interpolation of w3fdif: the
+ * missing lines are interpolated with a 4 taps vertical filter of the
+ * current field, plus a 5 taps filter of the other fields when there is
+ * vertical detail, and the yadif temporal checks then limit the result.
+ *
+ * The line references are in pixels, as is the width. The references of the
+ * lines 3 rows away are mirrored at the edges of the picture.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "common.h" /* FFMIN3 et al. */
+
+/* Interpolation coefficients, scaled by 8192 */
+static const int bwdif_coef_lf[2] = { 4309, 213 };
+static const int bwdif_coef_hf[3] = { 5570, 3801, 1016 };
+static const int bwdif_coef_sp[2] = { 5077, 981 };
+
+enum bwdif_mode
+{
+    BWDIF_LINE,         /**< lines 4 to height - 5 */
+    BWDIF_EDGE_SPATIAL, /**< near the edges, with the yadif spatial check */
+    BWDIF_EDGE,         /**< the first and last two lines */
+    BWDIF_INTRA,        /**< no other field, spatial interpolation only */
+};
+
+static inline int bwdif_get(const void *p, ptrdiff_t i, int wide)
+{
+    return wide ? ((const uint16_t *)p)[i] : ((const uint8_t *)p)[i];
+}
+
+static inline void bwdif_filter_line_common(void *dst, const void *prev,
+                                            const void *cur, const void *next,
+                                            int w, ptrdiff_t prefs,
+                                            ptrdiff_t mrefs, ptrdiff_t prefs3,
+                                            ptrdiff_t mrefs3, int parity,
+                                            int max, enum bwdif_mode mode,
+                                            int wide)
+{
+    const void *prev2 = parity ? prev : cur ;
+    const void *next2 = parity ? cur  : next;
+
+#define CUR(i)   bwdif_get(cur, x + (i), wide)
+#define SPATIAL() ((bwdif_coef_sp[0] * (c + e) \
+                   - bwdif_coef_sp[1] * (CUR(mrefs3) + CUR(prefs3))) >> 13)
+#define FIELDS(i) (bwdif_get(prev2, x + (i), wide) + bwdif_get(next2, x + (i), wide))
+
+    for (int x = 0; x < w; x++) {
+        const int c = CUR(mrefs);
+        const int e = CUR(prefs);
+        int interpol;
+
+        if (mode == BWDIF_INTRA) {
+            interpol = SPATIAL();
+        } else {
+            const int d = FIELDS(0) >> 1;
+            const int temporal_diff0 = abs(bwdif_get(prev2, x, wide) - bwdif_get(next2, x, wide));
+            const int temporal_diff1 = (abs(bwdif_get(prev, x + mrefs, wide) - c)
+                                      + abs(bwdif_get(prev, x + prefs, wide) - e)) >> 1;
+            const int temporal_diff2 = (abs(bwdif_get(next, x + mrefs, wide) - c)
+                                      + abs(bwdif_get(next, x + prefs, wide) - e)) >> 1;
+            int diff = FFMAX3(temporal_diff0 >> 1, temporal_diff1, temporal_diff2);
+
+            if (diff != 0 && mode != BWDIF_EDGE) {
+                const int b = (FIELDS(2 * mrefs) >> 1) - c;
+                const int f = (FIELDS(2 * prefs) >> 1) - e;
+                const int dc = d - c;
+                const int de = d - e;
+                const int maximum = FFMAX3(de, dc, FFMIN(b, f));
+                const int minimum = FFMIN3(de, dc, FFMAX(b, f));
+
+                diff = FFMAX3(diff, minimum, -maximum);
+            }
+
+            if (diff == 0)
+                interpol = d;
+            else if (mode != BWDIF_LINE)
+                interpol = (c + e) >> 1;
+            else if (abs(c - e) > temporal_diff0)
+                interpol = (((bwdif_coef_hf[0] * FIELDS(0)
+                            - bwdif_coef_hf[1] * (FIELDS(2 * mrefs) + FIELDS(2 * prefs))
+                            + bwdif_coef_hf[2] * (FIELDS(4 * mrefs) + FIELDS(4 * prefs))) >> 2)
+                           + bwdif_coef_lf[0] * (c + e)
+                           - bwdif_coef_lf[1] * (CUR(mrefs3) + CUR(prefs3))) >> 13;
+            else
+                interpol = SPATIAL();
+
+            if (interpol > d + diff)
+                interpol = d + diff;
+            else if (interpol < d - diff)
+                interpol = d - diff;
+        }
+
+        interpol = VLC_CLIP(interpol, 0, max);
+        if (wide)
+            ((uint16_t *)dst)[x] = interpol;
+        else
+            ((uint8_t *)dst)[x] = interpol;
+    }
+#undef FIELDS
+#undef SPATIAL
+#undef CUR
+}
+
+static void bwdif_filter_line_c(void *dst, const void *prev, const void *cur,
+                                const void *next, int w, ptrdiff_t prefs,
+                                ptrdiff_t mrefs, ptrdiff_t prefs3,
+                                ptrdiff_t mrefs3, int parity, int max,
+                                enum bwdif_mode mode)
+{
+    bwdif_filter_line_common(dst, prev, cur, next, w, prefs, mrefs, prefs3,
+                             mrefs3, parity, max, mode, 0);
+}
+
+static void bwdif_filter_line_c_16bit(void *dst, const void *prev,
+                                      const void *cur, const void *next, int w,
+                                      ptrdiff_t prefs, ptrdiff_t mrefs,
+                                      ptrdiff_t prefs3, ptrdiff_t mrefs3,
+                                      int parity, int max,
+                                      enum bwdif_mode mode)
+{
+    bwdif_filter_line_common(dst, prev, cur, next, w, prefs, mrefs, prefs3,
+                             mrefs3, parity, max, mode, 1);
+}
+
+#ifdef CAN_COMPILE_AVX2
+#include <immintrin.h>
+
+/* The BWDIF_LINE filter on 16 pixels at a time, in 16 bits signed lanes and
+ * 32 bits for the interpolation: the samples must not exceed 12 bits. Bit
+ * exact with the C versions, which handle the edges. */
+#define BWDIF_AVX2 __attribute__ ((__target__ ("avx2")))
+
+BWDIF_AVX2
+static inline __m256i bwdif_load_avx2(const void *p, ptrdiff_t i, int wide)
+{
+    if (wide)
+        return _mm256_loadu_si256((const __m256i *)&((const uint16_t *)p)[i]);
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)&((const uint8_t *)p)[i]));
+}
+
+BWDIF_AVX2
+static inline __m256i bwdif_absdiff_avx2(__m256i a, __m256i b)
+{
+    return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+/* Coefficients of the pairs of 16 bits lanes for _mm256_madd_epi16() */
+BWDIF_AVX2
+static inline __m256i bwdif_coefs_avx2(int ca, int cb)
+{
+    return _mm256_set1_epi32((int)(((unsigned)cb << 16) | (ca & 0xffff)));
+}
+
+BWDIF_AVX2
+static inline void bwdif_filter_line_avx2_common(void *dst, const void *prev,
+                                                 const void *cur,
+                                                 const void *next, int w,
+                                                 ptrdiff_t prefs,
+                                                 ptrdiff_t mrefs,
+                                                 ptrdiff_t prefs3,
+                                                 ptrdiff_t mrefs3, int parity,
+                                                 int max,
+                                                 enum bwdif_mode mode,
+                                                 int wide)
+{
+    const void *prev2 = parity ? prev : cur ;
+    const void *next2 = parity ? cur  : next;
+    const int pixel_size = wide ? 2 : 1;
+    int x = 0;
+
+#define LOAD(p, i) bwdif_load_avx2(p, x + (i), wide)
+#define FIELDS(i) _mm256_add_epi16(LOAD(prev2, i), LOAD(next2, i))
+
+    for (; mode == BWDIF_LINE && x + 16 <= w; x += 16) {
+        const __m256i c = LOAD(cur, mrefs);
+        const __m256i e = LOAD(cur, prefs);
+        const __m256i p2 = LOAD(prev2, 0);
+        const __m256i n2 = LOAD(next2, 0);
+        const __m256i d = _mm256_srai_epi16(_mm256_add_epi16(p2, n2), 1);
+
+        const __m256i temporal_diff0 = bwdif_absdiff_avx2(p2, n2);
+        const __m256i temporal_diff1 = _mm256_srai_epi16(_mm256_add_epi16(
+            bwdif_absdiff_avx2(LOAD(prev, mrefs), c),
+            bwdif_absdiff_avx2(LOAD(prev, prefs), e)), 1);
+        const __m256i temporal_diff2 = _mm256_srai_epi16(_mm256_add_epi16(
+            bwdif_absdiff_avx2(LOAD(next, mrefs), c),
+            bwdif_absdiff_avx2(LOAD(next, prefs), e)), 1);
+        __m256i diff = _mm256_max_epi16(_mm256_max_epi16(
+            _mm256_srai_epi16(temporal_diff0, 1), temporal_diff1), temporal_diff2);
+
+        /* The spatial check, harmless where diff is 0 */
+        const __m256i fields2m = FIELDS(2 * mrefs), fields2p = FIELDS(2 * prefs);
+        const __m256i b = _mm256_sub_epi16(_mm256_srai_epi16(fields2m, 1), c);
+        const __m256i f = _mm256_sub_epi16(_mm256_srai_epi16(fields2p, 1), e);
+        const __m256i dc = _mm256_sub_epi16(d, c), de = _mm256_sub_epi16(d, e);
+        const __m256i maximum = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                                 _mm256_min_epi16(b, f));
+        const __m256i minimum = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                                 _mm256_max_epi16(b, f));
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i diff_spatial = _mm256_max_epi16(_mm256_max_epi16(diff, minimum),
+                                                      _mm256_sub_epi16(zero, maximum));
+        diff = _mm256_blendv_epi8(diff_spatial, zero, _mm256_cmpeq_epi16(diff, zero));
+
+        /* Both interpolations, from the current field and from all */
+        const __m256i ce = _mm256_add_epi16(c, e);
+        const __m256i cur3 = _mm256_add_epi16(LOAD(cur, mrefs3), LOAD(cur, prefs3));
+        const __m256i coefs_sp = bwdif_coefs_avx2(bwdif_coef_sp[0],
+                                                  -bwdif_coef_sp[1]);
+        const __m256i spatial = _mm256_packs_epi32(
+            _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(ce, cur3), coefs_sp), 13),
+            _mm256_srai_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(ce, cur3), coefs_sp), 13));
+
+        /* The packing restores the order of the unpacked lanes */
+        const __m256i fields0 = FIELDS(0);
+        const __m256i fields2 = _mm256_add_epi16(fields2m, fields2p);
+        const __m256i fields4 = _mm256_add_epi16(FIELDS(4 * mrefs), FIELDS(4 * prefs));
+        const __m256i coefs_hf = bwdif_coefs_avx2(bwdif_coef_hf[0],
+                                                  -bwdif_coef_hf[1]);
+        const __m256i coefs_hf4 = bwdif_coefs_avx2(bwdif_coef_hf[2], 0);
+        const __m256i coefs_lf = bwdif_coefs_avx2(bwdif_coef_lf[0],
+                                                  -bwdif_coef_lf[1]);
+        __m256i lo = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(fields0, fields2), coefs_hf),
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(fields4, zero), coefs_hf4));
+        __m256i hi = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(fields0, fields2), coefs_hf),
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(fields4, zero), coefs_hf4));
+        lo = _mm256_add_epi32(_mm256_srai_epi32(lo, 2),
+                 _mm256_madd_epi16(_mm256_unpacklo_epi16(ce, cur3), coefs_lf));
+        hi = _mm256_add_epi32(_mm256_srai_epi32(hi, 2),
+                 _mm256_madd_epi16(_mm256_unpackhi_epi16(ce, cur3), coefs_lf));
+        const __m256i temporal = _mm256_packs_epi32(_mm256_srai_epi32(lo, 13),
+                                                    _mm256_srai_epi32(hi, 13));
+
+        __m256i interpol = _mm256_blendv_epi8(spatial, temporal,
+            _mm256_cmpgt_epi16(bwdif_absdiff_avx2(c, e), temporal_diff0));
+
+        /* diff is never negative, and 0 gives d */
+        interpol = _mm256_min_epi16(interpol, _mm256_add_epi16(d, diff));
+        interpol = _mm256_max_epi16(interpol, _mm256_sub_epi16(d, diff));
+
+        if (wide) {
+            interpol = _mm256_min_epi16(_mm256_max_epi16(interpol, zero),
+                                        _mm256_set1_epi16(max));
+            _mm256_storeu_si256((__m256i *)&((uint16_t *)dst)[x], interpol);
+        } else {
+            _mm_storeu_si128((__m128i *)&((uint8_t *)dst)[x],
+                _mm256_castsi256_si128(_mm256_permute4x64_epi64(
+                    _mm256_packus_epi16(interpol, interpol), 0xD8)));
+        }
+    }
+#undef FIELDS
+#undef LOAD
+
+    if (x < w) {
+        const int offset = x * pixel_size;
+        bwdif_filter_line_common((uint8_t *)dst + offset,
+                                 (const uint8_t *)prev + offset,
+                                 (const uint8_t *)cur + offset,
+                                 (const uint8_t *)next + offset, w - x,
+                                 prefs, mrefs, prefs3, mrefs3, parity, max,
+                                 mode, wide);
+    }
+}
+
+BWDIF_AVX2
+static void bwdif_filter_line_avx2(void *dst, const void *prev,
+                                   const void *cur, const void *next, int w,
+                                   ptrdiff_t prefs, ptrdiff_t mrefs,
+                                   ptrdiff_t prefs3, ptrdiff_t mrefs3,
+                                   int parity, int max, enum bwdif_mode mode)
+{
+    bwdif_filter_line_avx2_common(dst, prev, cur, next, w, prefs, mrefs,
+                                  prefs3, mrefs3, parity, max, mode, 0);
+}
+
+BWDIF_AVX2
+static void bwdif_filter_line_avx2_16bit(void *dst, const void *prev,
+                                         const void *cur, const void *next,
+                                         int w, ptrdiff_t prefs,
+                                         ptrdiff_t mrefs, ptrdiff_t prefs3,
+                                         ptrdiff_t mrefs3, int parity,
+                                         int max, enum bwdif_mode mode)
+{
+    bwdif_filter_line_avx2_common(dst, prev, cur, next, w, prefs, mrefs,
+                                  prefs3, mrefs3, parity, max, mode, 1);
+}
+#endif
+
+#endif
@@ -357,6 +357,10 @@ static struct filter_mode_t filter_mode [] = {
                  { false, true, false, false }, false, true },
     { "yadif2x", .pf_render_ordered = RenderYadif,
                  { true, true, false, false }, false, true },
+    { "bwdif", .pf_render_single_pic = RenderBwdifSingle,
+                 { false, true, false, false }, false, true },
+    { "bwdif2x", .pf_render_ordered = RenderBwdif,
+                 { true, true, false, false }, false, true },
     { "x", .pf_render_single_pic = RenderX,
                  { false, false, false, false }, false, false },
     { "phosphor", .pf_render_ordered = RenderPhosphor,
@@ -97,3 +97,290 @@ static void yadif_filter_line_c_16bit(uint8_t *dst8, uint8_t *prev8, uint8_t *cu
 void vlcpriv_yadif_filter_line_ssse3(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode);
 void vlcpriv_yadif_filter_line_sse2(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode);
 #endif
+
+#ifdef CAN_COMPILE_AVX2
+#include <immintrin.h>
+
+/* The same filter on 16 pixels at a time, in 16 bits signed lanes: the
+ * samples must not exceed 12 bits. Bit exact with the C versions. */
+#define YADIF_AVX2 __attribute__ ((__target__ ("avx2")))
+
+YADIF_AVX2
+static inline __m256i yadif_load_avx2(const uint8_t *p, int i, int wide)
+{
+    if (wide)
+        return _mm256_loadu_si256((const __m256i *)&((const uint16_t *)p)[i]);
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)&p[i]));
+}
+
+YADIF_AVX2
+static inline __m256i yadif_avg_avx2(__m256i a, __m256i b)
+{
+    return _mm256_srai_epi16(_mm256_add_epi16(a, b), 1);
+}
+
+YADIF_AVX2
+static inline __m256i yadif_absdiff_avx2(__m256i a, __m256i b)
+{
+    return _mm256_abs_epi16(_mm256_sub_epi16(a, b));
+}
+
+/* Score of the edge direction j, as CHECK(j) */
+YADIF_AVX2
+static inline __m256i yadif_score_avx2(const uint8_t *cur, int x, int prefs,
+                                       int mrefs, int j, int wide)
+{
+    __m256i score;
+    score = yadif_absdiff_avx2(yadif_load_avx2(cur, x + mrefs - 1 + j, wide),
+                               yadif_load_avx2(cur, x + prefs - 1 - j, wide));
+    score = _mm256_add_epi16(score,
+            yadif_absdiff_avx2(yadif_load_avx2(cur, x + mrefs + j, wide),
+                               yadif_load_avx2(cur, x + prefs - j, wide)));
+    return _mm256_add_epi16(score,
+            yadif_absdiff_avx2(yadif_load_avx2(cur, x + mrefs + 1 + j, wide),
+                               yadif_load_avx2(cur, x + prefs + 1 - j, wide)));
+}
+
+/* Updates the spatial prediction if the direction j scores better */
+YADIF_AVX2
+static inline __m256i yadif_check_avx2(const uint8_t *cur, int x, int prefs,
+                                       int mrefs, int j, int wide,
+                                       __m256i *spatial_score,
+                                       __m256i *spatial_pred, __m256i mask)
+{
+    __m256i score = yadif_score_avx2(cur, x, prefs, mrefs, j, wide);
+    mask = _mm256_and_si256(mask, _mm256_cmpgt_epi16(*spatial_score, score));
+    *spatial_score = _mm256_blendv_epi8(*spatial_score, score, mask);
+    *spatial_pred = _mm256_blendv_epi8(*spatial_pred,
+        yadif_avg_avx2(yadif_load_avx2(cur, x + mrefs + j, wide),
+                       yadif_load_avx2(cur, x + prefs - j, wide)), mask);
+    return mask;
+}
+
+YADIF_AVX2
+static inline void yadif_filter_line_avx2_common(uint8_t *dst, uint8_t *prev,
+                                                 uint8_t *cur, uint8_t *next,
+                                                 int w, int prefs, int mrefs,
+                                                 int parity, int mode, int wide)
+{
+    uint8_t *prev2 = parity ? prev : cur ;
+    uint8_t *next2 = parity ? cur  : next;
+    const int pixel_size = wide ? 2 : 1;
+    const int p = prefs / pixel_size, m = mrefs / pixel_size;
+    const __m256i all = _mm256_set1_epi16(-1);
+    int x;
+
+    for (x = 0; x + 16 <= w; x += 16) {
+        __m256i c = yadif_load_avx2(cur, x + m, wide);
+        __m256i e = yadif_load_avx2(cur, x + p, wide);
+        __m256i p2 = yadif_load_avx2(prev2, x, wide);
+        __m256i n2 = yadif_load_avx2(next2, x, wide);
+        __m256i d = yadif_avg_avx2(p2, n2);
+
+        __m256i temporal_diff0 = yadif_absdiff_avx2(p2, n2);
+        __m256i temporal_diff1 = _mm256_srai_epi16(_mm256_add_epi16(
+            yadif_absdiff_avx2(yadif_load_avx2(prev, x + m, wide), c),
+            yadif_absdiff_avx2(yadif_load_avx2(prev, x + p, wide), e)), 1);
+        __m256i temporal_diff2 = _mm256_srai_epi16(_mm256_add_epi16(
+            yadif_absdiff_avx2(yadif_load_avx2(next, x + m, wide), c),
+            yadif_absdiff_avx2(yadif_load_avx2(next, x + p, wide), e)), 1);
+        __m256i diff = _mm256_max_epi16(_mm256_max_epi16(
+            _mm256_srai_epi16(temporal_diff0, 1), temporal_diff1), temporal_diff2);
+
+        __m256i spatial_pred = yadif_avg_avx2(c, e);
+        __m256i spatial_score = _mm256_add_epi16(
+            yadif_score_avx2(cur, x, p, m, 0, wide), all);
+        __m256i mask;
+
+        mask = yadif_check_avx2(cur, x, p, m, -1, wide,
+                                &spatial_score, &spatial_pred, all);
+        yadif_check_avx2(cur, x, p, m, -2, wide,
+                         &spatial_score, &spatial_pred, mask);
+        mask = yadif_check_avx2(cur, x, p, m, 1, wide,
+                                &spatial_score, &spatial_pred, all);
+        yadif_check_avx2(cur, x, p, m, 2, wide,
+                         &spatial_score, &spatial_pred, mask);
+
+        if (mode < 2) {
+            __m256i b = yadif_avg_avx2(yadif_load_avx2(prev2, x + 2 * m, wide),
+                                       yadif_load_avx2(next2, x + 2 * m, wide));
+            __m256i f = yadif_avg_avx2(yadif_load_avx2(prev2, x + 2 * p, wide),
+                                       yadif_load_avx2(next2, x + 2 * p, wide));
+            __m256i de = _mm256_sub_epi16(d, e), dc = _mm256_sub_epi16(d, c);
+            __m256i bc = _mm256_sub_epi16(b, c), fe = _mm256_sub_epi16(f, e);
+            __m256i max = _mm256_max_epi16(_mm256_max_epi16(de, dc),
+                                           _mm256_min_epi16(bc, fe));
+            __m256i min = _mm256_min_epi16(_mm256_min_epi16(de, dc),
+                                           _mm256_max_epi16(bc, fe));
+
+            diff = _mm256_max_epi16(_mm256_max_epi16(diff, min),
+                                    _mm256_sub_epi16(_mm256_setzero_si256(), max));
+        }
+
+        /* diff is never negative */
+        spatial_pred = _mm256_min_epi16(spatial_pred, _mm256_add_epi16(d, diff));
+        spatial_pred = _mm256_max_epi16(spatial_pred, _mm256_sub_epi16(d, diff));
+
+        if (wide)
+            _mm256_storeu_si256((__m256i *)&((uint16_t *)dst)[x], spatial_pred);
+        else
+            _mm_storeu_si128((__m128i *)&dst[x], _mm256_castsi256_si128(
+                _mm256_permute4x64_epi64(
+                    _mm256_packus_epi16(spatial_pred, spatial_pred), 0xD8)));
+    }
+
+    if (x < w) {
+        const int offset = x * pixel_size;
+        (wide ? yadif_filter_line_c_16bit : yadif_filter_line_c)(
+            dst + offset, prev + offset, cur + offset, next + offset,
+            w - x, prefs, mrefs, parity, mode);
+    }
+}
+
+YADIF_AVX2
+static void yadif_filter_line_avx2(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    yadif_filter_line_avx2_common(dst, prev, cur, next, w, prefs, mrefs,
+                                  parity, mode, 0);
+}
+
+YADIF_AVX2
+static void yadif_filter_line_avx2_16bit(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    yadif_filter_line_avx2_common(dst, prev, cur, next, w, prefs, mrefs,
+                                  parity, mode, 1);
+}
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define YADIF_HAVE_NEON
+
+/* The AVX2 filter on 8 pixels at a time, with the same 12 bits limit */
+static inline int16x8_t yadif_load_neon(const uint8_t *p, int i, int wide)
+{
+    if (wide)
+        return vreinterpretq_s16_u16(vld1q_u16(&((const uint16_t *)p)[i]));
+    return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(&p[i])));
+}
+
+static inline int16x8_t yadif_avg_neon(int16x8_t a, int16x8_t b)
+{
+    return vshrq_n_s16(vaddq_s16(a, b), 1);
+}
+
+/* Score of the edge direction j, as CHECK(j) */
+static inline int16x8_t yadif_score_neon(const uint8_t *cur, int x, int prefs,
+                                         int mrefs, int j, int wide)
+{
+    int16x8_t score;
+    score = vabdq_s16(yadif_load_neon(cur, x + mrefs - 1 + j, wide),
+                      yadif_load_neon(cur, x + prefs - 1 - j, wide));
+    score = vaddq_s16(score,
+            vabdq_s16(yadif_load_neon(cur, x + mrefs + j, wide),
+                      yadif_load_neon(cur, x + prefs - j, wide)));
+    return vaddq_s16(score,
+            vabdq_s16(yadif_load_neon(cur, x + mrefs + 1 + j, wide),
+                      yadif_load_neon(cur, x + prefs + 1 - j, wide)));
+}
+
+/* Updates the spatial prediction if the direction j scores better */
+static inline uint16x8_t yadif_check_neon(const uint8_t *cur, int x, int prefs,
+                                          int mrefs, int j, int wide,
+                                          int16x8_t *spatial_score,
+                                          int16x8_t *spatial_pred,
+                                          uint16x8_t mask)
+{
+    int16x8_t score = yadif_score_neon(cur, x, prefs, mrefs, j, wide);
+    mask = vandq_u16(mask, vcgtq_s16(*spatial_score, score));
+    *spatial_score = vbslq_s16(mask, score, *spatial_score);
+    *spatial_pred = vbslq_s16(mask,
+        yadif_avg_neon(yadif_load_neon(cur, x + mrefs + j, wide),
+                       yadif_load_neon(cur, x + prefs - j, wide)),
+        *spatial_pred);
+    return mask;
+}
+
+static inline void yadif_filter_line_neon_common(uint8_t *dst, uint8_t *prev,
+                                                 uint8_t *cur, uint8_t *next,
+                                                 int w, int prefs, int mrefs,
+                                                 int parity, int mode, int wide)
+{
+    uint8_t *prev2 = parity ? prev : cur ;
+    uint8_t *next2 = parity ? cur  : next;
+    const int pixel_size = wide ? 2 : 1;
+    const int p = prefs / pixel_size, m = mrefs / pixel_size;
+    const uint16x8_t all = vdupq_n_u16(0xFFFF);
+    int x;
+
+    for (x = 0; x + 8 <= w; x += 8) {
+        int16x8_t c = yadif_load_neon(cur, x + m, wide);
+        int16x8_t e = yadif_load_neon(cur, x + p, wide);
+        int16x8_t p2 = yadif_load_neon(prev2, x, wide);
+        int16x8_t n2 = yadif_load_neon(next2, x, wide);
+        int16x8_t d = yadif_avg_neon(p2, n2);
+
+        int16x8_t temporal_diff0 = vabdq_s16(p2, n2);
+        int16x8_t temporal_diff1 = vshrq_n_s16(vaddq_s16(
+            vabdq_s16(yadif_load_neon(prev, x + m, wide), c),
+            vabdq_s16(yadif_load_neon(prev, x + p, wide), e)), 1);
+        int16x8_t temporal_diff2 = vshrq_n_s16(vaddq_s16(
+            vabdq_s16(yadif_load_neon(next, x + m, wide), c),
+            vabdq_s16(yadif_load_neon(next, x + p, wide), e)), 1);
+        int16x8_t diff = vmaxq_s16(vmaxq_s16(
+            vshrq_n_s16(temporal_diff0, 1), temporal_diff1), temporal_diff2);
+
+        int16x8_t spatial_pred = yadif_avg_neon(c, e);
+        int16x8_t spatial_score = vsubq_s16(
+            yadif_score_neon(cur, x, p, m, 0, wide), vdupq_n_s16(1));
+        uint16x8_t mask;
+
+        mask = yadif_check_neon(cur, x, p, m, -1, wide,
+                                &spatial_score, &spatial_pred, all);
+        yadif_check_neon(cur, x, p, m, -2, wide,
+                         &spatial_score, &spatial_pred, mask);
+        mask = yadif_check_neon(cur, x, p, m, 1, wide,
+                                &spatial_score, &spatial_pred, all);
+        yadif_check_neon(cur, x, p, m, 2, wide,
+                         &spatial_score, &spatial_pred, mask);
+
+        if (mode < 2) {
+            int16x8_t b = yadif_avg_neon(yadif_load_neon(prev2, x + 2 * m, wide),
+                                         yadif_load_neon(next2, x + 2 * m, wide));
+            int16x8_t f = yadif_avg_neon(yadif_load_neon(prev2, x + 2 * p, wide),
+                                         yadif_load_neon(next2, x + 2 * p, wide));
+            int16x8_t de = vsubq_s16(d, e), dc = vsubq_s16(d, c);
+            int16x8_t bc = vsubq_s16(b, c), fe = vsubq_s16(f, e);
+            int16x8_t max = vmaxq_s16(vmaxq_s16(de, dc), vminq_s16(bc, fe));
+            int16x8_t min = vminq_s16(vminq_s16(de, dc), vmaxq_s16(bc, fe));
+
+            diff = vmaxq_s16(vmaxq_s16(diff, min), vnegq_s16(max));
+        }
+
+        /* diff is never negative */
+        spatial_pred = vminq_s16(spatial_pred, vaddq_s16(d, diff));
+        spatial_pred = vmaxq_s16(spatial_pred, vsubq_s16(d, diff));
+
+        if (wide)
+            vst1q_u16(&((uint16_t *)dst)[x],
+                      vreinterpretq_u16_s16(spatial_pred));
+        else
+            vst1_u8(&dst[x], vqmovun_s16(spatial_pred));
+    }
+
+    if (x < w) {
+        const int offset = x * pixel_size;
+        (wide ? yadif_filter_line_c_16bit : yadif_filter_line_c)(
+            dst + offset, prev + offset, cur + offset, next + offset,
+            w - x, prefs, mrefs, parity, mode);
+    }
+}
+
+static void yadif_filter_line_neon(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    yadif_filter_line_neon_common(dst, prev, cur, next, w, prefs, mrefs,
+                                  parity, mode, 0);
+}
+
+static void yadif_filter_line_neon_16bit(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next, int w, int prefs, int mrefs, int parity, int mode) {
+    yadif_filter_line_neon_common(dst, prev, cur, next, w, prefs, mrefs,
+                                  parity, mode, 1);
+}
+#endif
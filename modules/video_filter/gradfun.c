@@ -158,6 +158,26 @@ static void Close(filter_t *filter)
     free(sys);
 }
 
+struct gradfun_plane
+{
+    struct vf_priv_s *cfg;
+    const plane_t *src;
+    plane_t *dst;
+    int w, h, r;
+};
+
+static void FilterSlice(void *opaque, const struct vlc_filter_slice *slice)
+{
+    const struct gradfun_plane *plane = opaque;
+    struct vf_priv_s *cfg = plane->cfg;
+
+    filter_plane_rows(cfg, cfg->buf + slice->index * cfg->buf_size,
+                      plane->dst->p_pixels, plane->src->p_pixels,
+                      plane->w, plane->h, plane->dst->i_pitch,
+                      plane->src->i_pitch, plane->r,
+                      slice->first, slice->first + slice->count);
+}
+
 static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
 {
     filter_sys_t *sys = filter->p_sys;
@@ -172,9 +192,12 @@ static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
 
     cfg->thresh = (1 << 15) / strength;
     if (cfg->radius != radius) {
-        cfg->radius = radius;
-        cfg->buf    = aligned_alloc(16,
-                                   (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32) * sizeof(*cfg->buf));
+        cfg->radius   = radius;
+        /* One buffer per slice, 16 bytes aligned */
+        cfg->buf_size = (((fmt->i_width + 15) & ~15) * (cfg->radius + 1) / 2 + 32 + 7) & ~7;
+        aligned_free(cfg->buf);
+        cfg->buf      = aligned_alloc(16,
+                                      VLC_FILTER_SLICES_MAX * cfg->buf_size * sizeof(*cfg->buf));
     }
 
     for (int i = 0; i < dst->i_planes; i++) {
@@ -188,8 +211,11 @@ static void Filter(filter_t *filter, picture_t *src, picture_t *dst)
                  cfg->radius  * chroma->p[i].h.num / chroma->p[i].h.den) / 2;
         r = VLC_CLIP((r + 1) & ~1, RADIUS_MIN, RADIUS_MAX);
         if (__MIN(w, h) > 2 * r && cfg->buf) {
-            filter_plane(cfg, dstp->p_pixels, srcp->p_pixels,
-                         w, h, dstp->i_pitch, srcp->i_pitch, r);
+            struct gradfun_plane plane = {
+                .cfg = cfg, .src = srcp, .dst = dstp, .w = w, .h = h, .r = r,
+            };
+            /* Each band blurs again the 2*r rows above it */
+            filter_ExecuteSlices(filter, h, 2, 2 * r, FilterSlice, &plane);
         } else {
             plane_CopyPixels(dstp, srcp);
         }
@@ -32,6 +32,7 @@ struct vf_priv_s {
     int thresh;
     int radius;
     uint16_t *buf;
+    size_t buf_size;
     void (*filter_line)(uint8_t *dst, uint8_t *src, uint16_t *dc,
                         int width, int thresh, const uint16_t *dithers);
     void (*blur_line)(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
@@ -172,45 +173,58 @@ static void blur_line_sse2(uint16_t *dc, uint16_t *buf, uint16_t *buf1,
 }
 #endif // HAVE_6REGS && HAVE_SSE2
 
-static void filter_plane(struct vf_priv_s *ctx, uint8_t *dst, uint8_t *src,
-                         int width, int height, int dstride, int sstride, int r)
+/* Filters the rows [y0, y1) of a plane, using the tmp buffer of
+ * ((width+15)&~15)*(r+1)/2+32 values.
+ *
+ * The rows are filtered with a vertical box blur that is updated every two
+ * rows, which is computed again from the r pairs of rows above the first one,
+ * so that any band of rows gives the same output as the whole plane. */
+static void filter_plane_rows(struct vf_priv_s *ctx, uint16_t *tmp,
+                              uint8_t *dst, uint8_t *src,
+                              int width, int height, int dstride, int sstride,
+                              int r, int y0, int y1)
 {
     int bstride = ((width+15)&~15)/2;
-    int y;
     uint32_t dc_factor = (1<<21)/(r*r);
-    uint16_t *dc = ctx->buf+16;
-    uint16_t *buf = ctx->buf+bstride+32;
+    uint16_t *dc = tmp+16;
+    uint16_t *buf = tmp+bstride+32;
     int thresh = ctx->thresh;
+    /* The blur is updated at rows r, r+2, ... up to last, and the same blur
+     * is used by the first r rows and by the rows after last */
+    int last = r + 2*((height-2*r-1)/2);
+    int e0 = y0 < r+2 ? r : __MIN(r + ((y0-r)&~1), last);
+    int y = y0;
 
+    /* Rebuild the running sums of the pairs of rows (e0-r)/2 to (e0+r)/2-1,
+     * starting from zero: the first one reads the cleared dc */
     memset(dc, 0, (bstride+16)*sizeof(*buf));
-    for (y=0; y<r; y++)
-        ctx->blur_line(dc, buf+y*bstride, buf+(y-1)*bstride, src+2*y*sstride, sstride, width/2);
-    for (;;) {
-        if (y < height-r) {
-            int mod = ((y+r)/2)%r;
-            uint16_t *buf0 = buf+mod*bstride;
-            uint16_t *buf1 = buf+(mod?mod-1:r-1)*bstride;
-            int x, v;
-            ctx->blur_line(dc, buf0, buf1, src+(y+r)*sstride, sstride, width/2);
-            for (x=v=0; x<r; x++)
-                v += dc[x];
-            for (; x<width/2; x++) {
-                v += dc[x] - dc[x-r];
-                dc[x-r] = v * dc_factor >> 16;
-            }
-            for (; x<(width+r+1)/2; x++)
-                dc[x-r] = v * dc_factor >> 16;
-            for (x=-r/2; x<0; x++)
-                dc[x] = dc[0];
-        }
-        if (y == r) {
-            for (y=0; y<r; y++)
-                ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
+    for (int p = (e0-r)/2; p < (e0+r)/2; p++) {
+        int mod = p%r;
+        uint16_t *buf1 = p == (e0-r)/2 ? buf-bstride
+                                       : buf+(mod?mod-1:r-1)*bstride;
+        ctx->blur_line(dc, buf+mod*bstride, buf1, src+2*p*sstride, sstride,
+                       width/2);
+    }
+
+    for (int e = e0; y < y1; e += 2) {
+        int mod = ((e+r)/2)%r;
+        uint16_t *buf0 = buf+mod*bstride;
+        uint16_t *buf1 = buf+(mod?mod-1:r-1)*bstride;
+        int x, v;
+        ctx->blur_line(dc, buf0, buf1, src+(e+r)*sstride, sstride, width/2);
+        for (x=v=0; x<r; x++)
+            v += dc[x];
+        for (; x<width/2; x++) {
+            v += dc[x] - dc[x-r];
+            dc[x-r] = v * dc_factor >> 16;
         }
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
-        ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
-        if (++y >= height) break;
+        for (; x<(width+r+1)/2; x++)
+            dc[x-r] = v * dc_factor >> 16;
+        for (x=-r/2; x<0; x++)
+            dc[x] = dc[0];
+
+        int end = e == last ? height : e+2;
+        for (; y < __MIN(end, y1); y++)
+            ctx->filter_line(dst+y*dstride, src+y*sstride, dc-r/2, width, thresh, dither[y&7]);
     }
 }
-
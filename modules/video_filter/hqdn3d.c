@@ -33,11 +33,30 @@
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+#endif
+#ifdef CAN_COMPILE_SSE4_1
+# include <smmintrin.h>
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define HQDN3D_HAVE_NEON
+#endif
 
 #include "hqdn3d.h"
 
+enum hqdn3d_kernel
+{
+    HQDN3D_C,
+    HQDN3D_SSE4_1,
+    HQDN3D_AVX2,
+    HQDN3D_NEON,
+};
+
 /*****************************************************************************
  * Local protypes
  *****************************************************************************/
@@ -89,6 +108,8 @@ typedef struct
 {
     const vlc_chroma_description_t *chroma;
     int w[3], h[3];
+    int bits;
+    enum hqdn3d_kernel kernel;
 
     struct vf_priv_s cfg;
     bool   b_recalc_coefs;
@@ -99,6 +120,37 @@ typedef struct
 /*****************************************************************************
  * Open
  *****************************************************************************/
+/* Samples of more than 8 bits are read in the native byte order */
+static bool IsNativeHighDepth(vlc_fourcc_t fourcc)
+{
+    switch (fourcc) {
+#ifdef WORDS_BIGENDIAN
+        case VLC_CODEC_I420_9B:
+        case VLC_CODEC_I420_10B:
+        case VLC_CODEC_I420_12B:
+        case VLC_CODEC_I422_9B:
+        case VLC_CODEC_I422_10B:
+        case VLC_CODEC_I422_12B:
+        case VLC_CODEC_I444_9B:
+        case VLC_CODEC_I444_10B:
+        case VLC_CODEC_I444_12B:
+#else
+        case VLC_CODEC_I420_9L:
+        case VLC_CODEC_I420_10L:
+        case VLC_CODEC_I420_12L:
+        case VLC_CODEC_I422_9L:
+        case VLC_CODEC_I422_10L:
+        case VLC_CODEC_I422_12L:
+        case VLC_CODEC_I444_9L:
+        case VLC_CODEC_I444_10L:
+        case VLC_CODEC_I444_12L:
+#endif
+            return true;
+        default:
+            return false;
+    }
+}
+
 static int Open(filter_t *filter)
 {
     filter_sys_t *sys;
@@ -106,7 +158,7 @@ static int Open(filter_t *filter)
     const video_format_t *fmt_in  = &filter->fmt_in.video;
     const video_format_t *fmt_out = &filter->fmt_out.video;
     const vlc_fourcc_t fourcc_in  = fmt_in->i_chroma;
-    int wmax = 0;
+    int wmax = 0, hmax = 0;
 
     if ( !video_format_IsSameChroma( fmt_in, fmt_out ) ) {
         msg_Err(filter, "Input and output chromas don't match");
@@ -116,7 +168,8 @@ static int Open(filter_t *filter)
     const vlc_chroma_description_t *chroma =
             vlc_fourcc_GetChromaDescription(fourcc_in);
     assert( chroma != NULL );
-    if (chroma->plane_count != 3 || chroma->pixel_size != 1) {
+    if (chroma->plane_count != 3 ||
+        (chroma->pixel_size != 1 && !IsNativeHighDepth(fourcc_in))) {
         msg_Err(filter, "Unsupported chroma (%4.4s)", (char*)&fourcc_in);
         return VLC_EGENERIC;
     }
@@ -129,14 +182,28 @@ static int Open(filter_t *filter)
     cfg = &sys->cfg;
 
     sys->chroma = chroma;
+    sys->bits = chroma->pixel_size == 1 ? 8 : chroma->pixel_bits;
+    sys->kernel = HQDN3D_C;
+#ifdef CAN_COMPILE_SSE4_1
+    if (vlc_CPU_SSE4_1())
+        sys->kernel = HQDN3D_SSE4_1;
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        sys->kernel = HQDN3D_AVX2;
+#endif
+#ifdef HQDN3D_HAVE_NEON
+    sys->kernel = HQDN3D_NEON;
+#endif
 
     for (int i = 0; i < 3; ++i) {
         sys->w[i] = fmt_in->i_width  * chroma->p[i].w.num / chroma->p[i].w.den;
         if (sys->w[i] > wmax) wmax = sys->w[i];
         sys->h[i] = fmt_out->i_height * chroma->p[i].h.num / chroma->p[i].h.den;
+        if (sys->h[i] > hmax) hmax = sys->h[i];
     }
-    cfg->Line = malloc(wmax*sizeof(unsigned int));
-    if (!cfg->Line) {
+    cfg->LineH = vlc_alloc((size_t)wmax * hmax, sizeof(unsigned int));
+    if (!cfg->LineH) {
         free(sys);
         return VLC_ENOMEM;
     }
@@ -184,13 +251,505 @@ static void Close(filter_t *filter)
     for (int i = 0; i < 3; ++i) {
         free(cfg->Frame[i]);
     }
-    free(cfg->Line);
+    free(cfg->LineH);
     free(sys);
 }
 
 /*****************************************************************************
  * Filter
  *****************************************************************************/
+#ifdef CAN_COMPILE_AVX2
+/* The temporal and vertical recursions are independent for each column, so
+ * they are computed on 8 columns at once, gathering the coefficients. The
+ * horizontal recursion stays in C, the lines being split in slices. */
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i LowPassMulAVX2(__m256i Prev, __m256i Curr,
+                                     const int *Coef)
+{
+    __m256i d = _mm256_sub_epi32(Prev, Curr);
+    d = _mm256_srli_epi32(_mm256_add_epi32(d, _mm256_set1_epi32(0x10007FF)),
+                          12);
+    return _mm256_add_epi32(Curr, _mm256_i32gather_epi32(Coef, d, 4));
+}
+
+/* Packs the low 16 bits of each sample */
+__attribute__ ((__target__ ("avx2")))
+static inline __m128i Pack16AVX2(__m256i v)
+{
+    v = _mm256_and_si256(v, _mm256_set1_epi32(0xFFFF));
+    v = _mm256_permute4x64_epi64(_mm256_packus_epi32(v, v), 0x08);
+    return _mm256_castsi256_si128(v);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i LoadPixelsAVX2(const uint8_t *Line, long X, int Bits)
+{
+    if (Bits > 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)&Line[2 * X]);
+        return _mm256_sll_epi32(_mm256_cvtepu16_epi32(v),
+                                _mm_cvtsi32_si128(24 - Bits));
+    }
+    __m128i v = _mm_loadl_epi64((const __m128i *)&Line[X]);
+    return _mm256_slli_epi32(_mm256_cvtepu8_epi32(v), 16);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline void StorePixelsAVX2(uint8_t *Line, long X, __m256i Pixel,
+                                   int Bits)
+{
+    const int Shift = 24 - Bits;
+    __m256i v = _mm256_add_epi32(Pixel,
+        _mm256_set1_epi32(0x10000000 + (1 << (Shift - 1)) - 1));
+    v = _mm256_srl_epi32(v, _mm_cvtsi32_si128(Shift));
+    v = _mm256_and_si256(v, _mm256_set1_epi32((1 << Bits) - 1));
+
+    __m128i w = Pack16AVX2(v);
+    if (Bits > 8)
+        _mm_storeu_si128((__m128i *)&Line[2 * X], w);
+    else
+        _mm_storel_epi64((__m128i *)&Line[X], _mm_packus_epi16(w, w));
+}
+
+/* Updates the previous frame and returns the filtered pixels */
+__attribute__ ((__target__ ("avx2")))
+static inline __m256i TemporalAVX2(unsigned short *LinePrev, long X,
+                                   __m256i Pixel, const int *Temporal)
+{
+    __m128i prev = _mm_loadu_si128((const __m128i *)&LinePrev[X]);
+    __m256i dst = LowPassMulAVX2(
+        _mm256_slli_epi32(_mm256_cvtepu16_epi32(prev), 8), Pixel, Temporal);
+    __m256i ant = _mm256_srli_epi32(
+        _mm256_add_epi32(dst, _mm256_set1_epi32(0x1000007F)), 8);
+    _mm_storeu_si128((__m128i *)&LinePrev[X], Pack16AVX2(ant));
+    return dst;
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline void deNoiseTemporalAVX2(const void *Frame, void *FrameDest,
+                                       unsigned short *FrameAnt,
+                                       int W, int Y0, int Y1,
+                                       int sStride, int dStride,
+                                       int *Temporal, int Bits)
+{
+    for (long Y = Y0; Y < Y1; Y++) {
+        const uint8_t *Src = (const uint8_t *)Frame + Y * sStride;
+        uint8_t *Dst = (uint8_t *)FrameDest + Y * dStride;
+        unsigned short *LinePrev = &FrameAnt[Y * W];
+        long X = 0;
+
+        for (; X + 8 <= W; X += 8) {
+            __m256i dst = TemporalAVX2(LinePrev, X,
+                                       LoadPixelsAVX2(Src, X, Bits), Temporal);
+            StorePixelsAVX2(Dst, X, dst, Bits);
+        }
+        for (; X < W; X++) {
+            unsigned int PixelDst = LowPassMul(LinePrev[X] << 8,
+                                               GetPixel(Src, X, Bits), Temporal);
+            LinePrev[X] = (PixelDst + 0x1000007F) >> 8;
+            PutPixel(Dst, X, PixelDst, Bits);
+        }
+    }
+}
+
+__attribute__ ((__target__ ("avx2")))
+static inline void deNoiseVerticalAVX2(unsigned int *LineH, void *FrameDest,
+                                       unsigned short *FrameAnt,
+                                       int W, int H, int X0, int X1,
+                                       int dStride, int *Vertical,
+                                       int *Temporal, int Bits)
+{
+    for (long Y = 0; Y < H; Y++) {
+        unsigned int *LineAnt = &LineH[Y * W];
+        uint8_t *Dst = (uint8_t *)FrameDest + Y * dStride;
+        unsigned short *LinePrev = FrameAnt ? &FrameAnt[Y * W] : NULL;
+        long X = X0;
+
+        for (; X + 8 <= X1; X += 8) {
+            __m256i pixel = _mm256_loadu_si256((const __m256i *)&LineAnt[X]);
+
+            /* First line has no top neighbor */
+            if (Y > 0) {
+                __m256i up = _mm256_loadu_si256(
+                    (const __m256i *)&LineAnt[X - W]);
+                pixel = LowPassMulAVX2(up, pixel, Vertical);
+                _mm256_storeu_si256((__m256i *)&LineAnt[X], pixel);
+            }
+            if (LinePrev != NULL)
+                pixel = TemporalAVX2(LinePrev, X, pixel, Temporal);
+            StorePixelsAVX2(Dst, X, pixel, Bits);
+        }
+        for (; X < X1; X++) {
+            if (Y > 0)
+                LineAnt[X] = LowPassMul(LineAnt[X - W], LineAnt[X], Vertical);
+
+            unsigned int PixelDst = LineAnt[X];
+            if (LinePrev != NULL) {
+                PixelDst = LowPassMul(LinePrev[X] << 8, PixelDst, Temporal);
+                LinePrev[X] = (PixelDst + 0x1000007F) >> 8;
+            }
+            PutPixel(Dst, X, PixelDst, Bits);
+        }
+    }
+}
+#endif
+
+#ifdef CAN_COMPILE_SSE4_1
+/* Same as the AVX2 kernels on 4 columns, without gathers: the indexes are
+ * spilled and the coefficients looked up one lane at a time. Only the loads,
+ * the conversions and the arithmetic are shared, so the gain over the C code
+ * is small. */
+__attribute__ ((__target__ ("sse4.1")))
+static inline __m128i LowPassMulSSE4(__m128i Prev, __m128i Curr,
+                                     const int *Coef)
+{
+    __m128i d = _mm_sub_epi32(Prev, Curr);
+    d = _mm_srli_epi32(_mm_add_epi32(d, _mm_set1_epi32(0x10007FF)), 12);
+
+    uint32_t i[4];
+    _mm_storeu_si128((__m128i *)i, d);
+    return _mm_add_epi32(Curr, _mm_setr_epi32(Coef[i[0]], Coef[i[1]],
+                                              Coef[i[2]], Coef[i[3]]));
+}
+
+/* Packs the low 16 bits of each sample */
+__attribute__ ((__target__ ("sse4.1")))
+static inline __m128i Pack16SSE4(__m128i v)
+{
+    v = _mm_and_si128(v, _mm_set1_epi32(0xFFFF));
+    return _mm_packus_epi32(v, v);
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static inline __m128i LoadPixelsSSE4(const uint8_t *Line, long X, int Bits)
+{
+    if (Bits > 8) {
+        __m128i v = _mm_loadl_epi64((const __m128i *)&Line[2 * X]);
+        return _mm_sll_epi32(_mm_cvtepu16_epi32(v),
+                             _mm_cvtsi32_si128(24 - Bits));
+    }
+    uint32_t v;
+    memcpy(&v, &Line[X], sizeof (v));
+    return _mm_slli_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(v)), 16);
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static inline void StorePixelsSSE4(uint8_t *Line, long X, __m128i Pixel,
+                                   int Bits)
+{
+    const int Shift = 24 - Bits;
+    __m128i v = _mm_add_epi32(Pixel,
+        _mm_set1_epi32(0x10000000 + (1 << (Shift - 1)) - 1));
+    v = _mm_srl_epi32(v, _mm_cvtsi32_si128(Shift));
+    v = _mm_and_si128(v, _mm_set1_epi32((1 << Bits) - 1));
+
+    __m128i w = Pack16SSE4(v);
+    if (Bits > 8)
+        _mm_storel_epi64((__m128i *)&Line[2 * X], w);
+    else {
+        uint32_t b = _mm_cvtsi128_si32(_mm_packus_epi16(w, w));
+        memcpy(&Line[X], &b, sizeof (b));
+    }
+}
+
+/* Updates the previous frame and returns the filtered pixels */
+__attribute__ ((__target__ ("sse4.1")))
+static inline __m128i TemporalSSE4(unsigned short *LinePrev, long X,
+                                   __m128i Pixel, const int *Temporal)
+{
+    __m128i prev = _mm_loadl_epi64((const __m128i *)&LinePrev[X]);
+    __m128i dst = LowPassMulSSE4(
+        _mm_slli_epi32(_mm_cvtepu16_epi32(prev), 8), Pixel, Temporal);
+    __m128i ant = _mm_srli_epi32(
+        _mm_add_epi32(dst, _mm_set1_epi32(0x1000007F)), 8);
+    _mm_storel_epi64((__m128i *)&LinePrev[X], Pack16SSE4(ant));
+    return dst;
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static inline void deNoiseTemporalSSE4(const void *Frame, void *FrameDest,
+                                       unsigned short *FrameAnt,
+                                       int W, int Y0, int Y1,
+                                       int sStride, int dStride,
+                                       int *Temporal, int Bits)
+{
+    for (long Y = Y0; Y < Y1; Y++) {
+        const uint8_t *Src = (const uint8_t *)Frame + Y * sStride;
+        uint8_t *Dst = (uint8_t *)FrameDest + Y * dStride;
+        unsigned short *LinePrev = &FrameAnt[Y * W];
+        long X = 0;
+
+        for (; X + 4 <= W; X += 4) {
+            __m128i dst = TemporalSSE4(LinePrev, X,
+                                       LoadPixelsSSE4(Src, X, Bits), Temporal);
+            StorePixelsSSE4(Dst, X, dst, Bits);
+        }
+        for (; X < W; X++) {
+            unsigned int PixelDst = LowPassMul(LinePrev[X] << 8,
+                                               GetPixel(Src, X, Bits), Temporal);
+            LinePrev[X] = (PixelDst + 0x1000007F) >> 8;
+            PutPixel(Dst, X, PixelDst, Bits);
+        }
+    }
+}
+
+__attribute__ ((__target__ ("sse4.1")))
+static inline void deNoiseVerticalSSE4(unsigned int *LineH, void *FrameDest,
+                                       unsigned short *FrameAnt,
+                                       int W, int H, int X0, int X1,
+                                       int dStride, int *Vertical,
+                                       int *Temporal, int Bits)
+{
+    for (long Y = 0; Y < H; Y++) {
+        unsigned int *LineAnt = &LineH[Y * W];
+        uint8_t *Dst = (uint8_t *)FrameDest + Y * dStride;
+        unsigned short *LinePrev = FrameAnt ? &FrameAnt[Y * W] : NULL;
+        long X = X0;
+
+        for (; X + 4 <= X1; X += 4) {
+            __m128i pixel = _mm_loadu_si128((const __m128i *)&LineAnt[X]);
+
+            /* First line has no top neighbor */
+            if (Y > 0) {
+                __m128i up = _mm_loadu_si128((const __m128i *)&LineAnt[X - W]);
+                pixel = LowPassMulSSE4(up, pixel, Vertical);
+                _mm_storeu_si128((__m128i *)&LineAnt[X], pixel);
+            }
+            if (LinePrev != NULL)
+                pixel = TemporalSSE4(LinePrev, X, pixel, Temporal);
+            StorePixelsSSE4(Dst, X, pixel, Bits);
+        }
+        for (; X < X1; X++) {
+            if (Y > 0)
+                LineAnt[X] = LowPassMul(LineAnt[X - W], LineAnt[X], Vertical);
+
+            unsigned int PixelDst = LineAnt[X];
+            if (LinePrev != NULL) {
+                PixelDst = LowPassMul(LinePrev[X] << 8, PixelDst, Temporal);
+                LinePrev[X] = (PixelDst + 0x1000007F) >> 8;
+            }
+            PutPixel(Dst, X, PixelDst, Bits);
+        }
+    }
+}
+#endif
+
+#ifdef HQDN3D_HAVE_NEON
+/* NEON has no gather either: same lane by lane lookups as with SSE4.1 */
+static inline uint32x4_t LowPassMulNEON(uint32x4_t Prev, uint32x4_t Curr,
+                                        const int *Coef)
+{
+    uint32x4_t d = vsubq_u32(Prev, Curr);
+    d = vshrq_n_u32(vaddq_u32(d, vdupq_n_u32(0x10007FF)), 12);
+
+    int32x4_t c = vdupq_n_s32(Coef[vgetq_lane_u32(d, 0)]);
+    c = vsetq_lane_s32(Coef[vgetq_lane_u32(d, 1)], c, 1);
+    c = vsetq_lane_s32(Coef[vgetq_lane_u32(d, 2)], c, 2);
+    c = vsetq_lane_s32(Coef[vgetq_lane_u32(d, 3)], c, 3);
+    return vaddq_u32(Curr, vreinterpretq_u32_s32(c));
+}
+
+static inline uint32x4_t LoadPixelsNEON(const uint8_t *Line, long X, int Bits)
+{
+    if (Bits > 8) {
+        uint16x4_t v = vld1_u16((const uint16_t *)&Line[2 * X]);
+        return vshlq_u32(vmovl_u16(v), vdupq_n_s32(24 - Bits));
+    }
+    uint32_t v;
+    memcpy(&v, &Line[X], sizeof (v));
+    uint16x8_t w = vmovl_u8(vcreate_u8(v));
+    return vshlq_n_u32(vmovl_u16(vget_low_u16(w)), 16);
+}
+
+static inline void StorePixelsNEON(uint8_t *Line, long X, uint32x4_t Pixel,
+                                   int Bits)
+{
+    const int Shift = 24 - Bits;
+    uint32x4_t v = vaddq_u32(Pixel,
+        vdupq_n_u32(0x10000000 + (1 << (Shift - 1)) - 1));
+    v = vshlq_u32(v, vdupq_n_s32(-Shift));
+    v = vandq_u32(v, vdupq_n_u32((1 << Bits) - 1));
+
+    /* Narrowing keeps the low 16 bits of each sample */
+    uint16x4_t w = vmovn_u32(v);
+    if (Bits > 8)
+        vst1_u16((uint16_t *)&Line[2 * X], w);
+    else {
+        uint8x8_t b8 = vmovn_u16(vcombine_u16(w, w));
+        uint32_t b = vget_lane_u32(vreinterpret_u32_u8(b8), 0);
+        memcpy(&Line[X], &b, sizeof (b));
+    }
+}
+
+/* Updates the previous frame and returns the filtered pixels */
+static inline uint32x4_t TemporalNEON(unsigned short *LinePrev, long X,
+                                      uint32x4_t Pixel, const int *Temporal)
+{
+    uint32x4_t prev = vshlq_n_u32(vmovl_u16(vld1_u16(&LinePrev[X])), 8);
+    uint32x4_t dst = LowPassMulNEON(prev, Pixel, Temporal);
+    uint32x4_t ant = vshrq_n_u32(vaddq_u32(dst, vdupq_n_u32(0x1000007F)), 8);
+    vst1_u16(&LinePrev[X], vmovn_u32(ant));
+    return dst;
+}
+
+static inline void deNoiseTemporalNEON(const void *Frame, void *FrameDest,
+                                       unsigned short *FrameAnt,
+                                       int W, int Y0, int Y1,
+                                       int sStride, int dStride,
+                                       int *Temporal, int Bits)
+{
+    for (long Y = Y0; Y < Y1; Y++) {
+        const uint8_t *Src = (const uint8_t *)Frame + Y * sStride;
+        uint8_t *Dst = (uint8_t *)FrameDest + Y * dStride;
+        unsigned short *LinePrev = &FrameAnt[Y * W];
+        long X = 0;
+
+        for (; X + 4 <= W; X += 4) {
+            uint32x4_t dst = TemporalNEON(LinePrev, X,
+                                          LoadPixelsNEON(Src, X, Bits),
+                                          Temporal);
+            StorePixelsNEON(Dst, X, dst, Bits);
+        }
+        for (; X < W; X++) {
+            unsigned int PixelDst = LowPassMul(LinePrev[X] << 8,
+                                               GetPixel(Src, X, Bits), Temporal);
+            LinePrev[X] = (PixelDst + 0x1000007F) >> 8;
+            PutPixel(Dst, X, PixelDst, Bits);
+        }
+    }
+}
+
+static inline void deNoiseVerticalNEON(unsigned int *LineH, void *FrameDest,
+                                       unsigned short *FrameAnt,
+                                       int W, int H, int X0, int X1,
+                                       int dStride, int *Vertical,
+                                       int *Temporal, int Bits)
+{
+    for (long Y = 0; Y < H; Y++) {
+        unsigned int *LineAnt = &LineH[Y * W];
+        uint8_t *Dst = (uint8_t *)FrameDest + Y * dStride;
+        unsigned short *LinePrev = FrameAnt ? &FrameAnt[Y * W] : NULL;
+        long X = X0;
+
+        for (; X + 4 <= X1; X += 4) {
+            uint32x4_t pixel = vld1q_u32(&LineAnt[X]);
+
+            /* First line has no top neighbor */
+            if (Y > 0) {
+                pixel = LowPassMulNEON(vld1q_u32(&LineAnt[X - W]), pixel,
+                                       Vertical);
+                vst1q_u32(&LineAnt[X], pixel);
+            }
+            if (LinePrev != NULL)
+                pixel = TemporalNEON(LinePrev, X, pixel, Temporal);
+            StorePixelsNEON(Dst, X, pixel, Bits);
+        }
+        for (; X < X1; X++) {
+            if (Y > 0)
+                LineAnt[X] = LowPassMul(LineAnt[X - W], LineAnt[X], Vertical);
+
+            unsigned int PixelDst = LineAnt[X];
+            if (LinePrev != NULL) {
+                PixelDst = LowPassMul(LinePrev[X] << 8, PixelDst, Temporal);
+                LinePrev[X] = (PixelDst + 0x1000007F) >> 8;
+            }
+            PutPixel(Dst, X, PixelDst, Bits);
+        }
+    }
+}
+#endif
+
+struct hqdn3d_plane
+{
+    const plane_t *src;
+    plane_t *dst;
+    unsigned short *frame;
+    unsigned int *line;
+    int w, h;
+    int *spat, *temp;
+    int bits;
+    enum hqdn3d_kernel kernel;
+};
+
+/* The kernels are specialized for the 8 bits samples */
+#define HQDN3D_CALL(plane, fn, ...) \
+    ((plane)->bits > 8 ? fn(__VA_ARGS__, (plane)->bits) : fn(__VA_ARGS__, 8))
+
+static void TemporalSlice(void *opaque, const struct vlc_filter_slice *slice)
+{
+    const struct hqdn3d_plane *plane = opaque;
+    const int y1 = slice->first + slice->count;
+
+#define TEMPORAL(fn) \
+    HQDN3D_CALL(plane, fn, plane->src->p_pixels, plane->dst->p_pixels, \
+                plane->frame, plane->w, slice->first, y1, \
+                plane->src->i_pitch, plane->dst->i_pitch, plane->temp)
+
+    switch (plane->kernel) {
+#ifdef CAN_COMPILE_AVX2
+        case HQDN3D_AVX2:
+            TEMPORAL(deNoiseTemporalAVX2);
+            break;
+#endif
+#ifdef CAN_COMPILE_SSE4_1
+        case HQDN3D_SSE4_1:
+            TEMPORAL(deNoiseTemporalSSE4);
+            break;
+#endif
+#ifdef HQDN3D_HAVE_NEON
+        case HQDN3D_NEON:
+            TEMPORAL(deNoiseTemporalNEON);
+            break;
+#endif
+        default:
+            TEMPORAL(deNoiseTemporal);
+            break;
+    }
+#undef TEMPORAL
+}
+
+static void HorizontalSlice(void *opaque, const struct vlc_filter_slice *slice)
+{
+    const struct hqdn3d_plane *plane = opaque;
+
+    HQDN3D_CALL(plane, deNoiseHorizontal, plane->src->p_pixels, plane->line,
+                plane->w, slice->first, slice->first + slice->count,
+                plane->src->i_pitch, plane->spat);
+}
+
+/* The slices are bands of columns */
+static void VerticalSlice(void *opaque, const struct vlc_filter_slice *slice)
+{
+    const struct hqdn3d_plane *plane = opaque;
+    const int x1 = slice->first + slice->count;
+
+#define VERTICAL(fn) \
+    HQDN3D_CALL(plane, fn, plane->line, plane->dst->p_pixels, plane->frame, \
+                plane->w, plane->h, slice->first, x1, plane->dst->i_pitch, \
+                plane->spat, plane->temp)
+
+    switch (plane->kernel) {
+#ifdef CAN_COMPILE_AVX2
+        case HQDN3D_AVX2:
+            VERTICAL(deNoiseVerticalAVX2);
+            break;
+#endif
+#ifdef CAN_COMPILE_SSE4_1
+        case HQDN3D_SSE4_1:
+            VERTICAL(deNoiseVerticalSSE4);
+            break;
+#endif
+#ifdef HQDN3D_HAVE_NEON
+        case HQDN3D_NEON:
+            VERTICAL(deNoiseVerticalNEON);
+            break;
+#endif
+        default:
+            VERTICAL(deNoiseVertical);
+            break;
+    }
+#undef VERTICAL
+}
+
 static picture_t *Filter(filter_t *filter, picture_t *src)
 {
     picture_t *dst;
@@ -220,30 +779,41 @@ static picture_t *Filter(filter_t *filter, picture_t *src)
     }
     vlc_mutex_unlock( &sys->coefs_mutex );
 
-    deNoise(src->p[0].p_pixels, dst->p[0].p_pixels,
-            cfg->Line, &cfg->Frame[0], sys->w[0], sys->h[0],
-            src->p[0].i_pitch, dst->p[0].i_pitch,
-            cfg->Coefs[0],
-            cfg->Coefs[0],
-            cfg->Coefs[1]);
-    deNoise(src->p[1].p_pixels, dst->p[1].p_pixels,
-            cfg->Line, &cfg->Frame[1], sys->w[1], sys->h[1],
-            src->p[1].i_pitch, dst->p[1].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-    deNoise(src->p[2].p_pixels, dst->p[2].p_pixels,
-            cfg->Line, &cfg->Frame[2], sys->w[2], sys->h[2],
-            src->p[2].i_pitch, dst->p[2].i_pitch,
-            cfg->Coefs[2],
-            cfg->Coefs[2],
-            cfg->Coefs[3]);
-
-    if(unlikely(!cfg->Frame[0] || !cfg->Frame[1] || !cfg->Frame[2]))
-    {
-        picture_Release( src );
-        picture_Release( dst );
-        return NULL;
+    for (int i = 0; i < 3; ++i) {
+        if (!cfg->Frame[i]) {
+            cfg->Frame[i] = deNoiseInit(src->p[i].p_pixels, sys->w[i],
+                                        sys->h[i], src->p[i].i_pitch,
+                                        sys->bits);
+            if (unlikely(!cfg->Frame[i])) {
+                picture_Release( src );
+                picture_Release( dst );
+                return NULL;
+            }
+        }
+
+        struct hqdn3d_plane plane = {
+            .src = &src->p[i],
+            .dst = &dst->p[i],
+            .frame = cfg->Frame[i],
+            .line = cfg->LineH,
+            .w = sys->w[i],
+            .h = sys->h[i],
+            .spat = cfg->Coefs[i == 0 ? 0 : 2],
+            .temp = cfg->Coefs[i == 0 ? 1 : 3],
+            .bits = sys->bits,
+            .kernel = sys->kernel,
+        };
+
+        if (!plane.spat[0]) {
+            filter_ExecuteSlices(filter, plane.h, 1, 0, TemporalSlice, &plane);
+            continue;
+        }
+        if (!plane.temp[0])
+            plane.frame = NULL;
+
+        filter_ExecuteSlices(filter, plane.h, 1, 0, HorizontalSlice, &plane);
+        /* Each column is filtered independently */
+        filter_ExecuteSlices(filter, plane.w, 64, 0, VerticalSlice, &plane);
     }
 
     return CopyInfoAndRelease(dst, src);
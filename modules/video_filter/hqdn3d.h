@@ -32,7 +32,7 @@
 
 struct vf_priv_s {
         int Coefs[4][512*16];
-        unsigned int *Line;
+        unsigned int *LineH;
         unsigned short *Frame[3];
 };
 
@@ -46,134 +46,118 @@ static /*inline*/ unsigned int LowPassMul(unsigned int PrevMul, unsigned int Cur
     return CurrMul + Coef[d];
 }
 
-static void deNoiseTemporal(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
+/* Samples of more than 8 bits (up to 12) are stored on 16 bits, and scaled
+ * to the same range as the 8 bits samples, that is 8.16 fixed point. */
+static inline unsigned int GetPixel(const void *Line, long X, int Bits)
+{
+    if (Bits > 8)
+        return ((const uint16_t *)Line)[X] << (24 - Bits);
+    return ((const uint8_t *)Line)[X] << 16;
+}
+
+static inline void PutPixel(void *Line, long X, unsigned int Pixel, int Bits)
+{
+    const int Shift = 24 - Bits;
+    const unsigned int Value = (Pixel + 0x10000000 + (1 << (Shift - 1)) - 1) >> Shift;
+
+    if (Bits > 8)
+        ((uint16_t *)Line)[X] = Value & ((1 << Bits) - 1);
+    else
+        ((uint8_t *)Line)[X] = Value;
+}
+
+static inline void deNoiseTemporal(
+                    const void *Frame,           // mpi->planes[x]
+                    void *FrameDest,             // dmpi->planes[x]
                     unsigned short *FrameAnt,
-                    int W, int H, int sStride, int dStride,
-                    int *Temporal)
+                    int W, int Y0, int Y1, int sStride, int dStride,
+                    int *Temporal, int Bits)
 {
     unsigned int PixelDst;
 
-    for (long Y = 0; Y < H; Y++){
+    for (long Y = Y0; Y < Y1; Y++){
+        const uint8_t *Src = (const uint8_t *)Frame + Y*sStride;
+        uint8_t *Dst = (uint8_t *)FrameDest + Y*dStride;
+        unsigned short *LinePrev = &FrameAnt[Y*W];
+
         for (long X = 0; X < W; X++){
-            PixelDst = LowPassMul(FrameAnt[X]<<8, Frame[X]<<16, Temporal);
-            FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
+            PixelDst = LowPassMul(LinePrev[X]<<8, GetPixel(Src, X, Bits), Temporal);
+            LinePrev[X] = ((PixelDst+0x1000007F)>>8);
+            PutPixel(Dst, X, PixelDst, Bits);
         }
-        Frame += sStride;
-        FrameDest += dStride;
-        FrameAnt += W;
     }
 }
 
-static void deNoiseSpacial(
-                    unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,       // vf->priv->Line (width bytes)
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical)
+/* The spatial filter is a horizontal recursion along each line followed by
+ * a vertical recursion along each column: the former is run on bands of
+ * lines, the latter on bands of columns, with the result of the horizontal
+ * pass stored in LineH (W*H values). */
+static inline void deNoiseHorizontal(
+                    const void *Frame,           // mpi->planes[x]
+                    unsigned int *LineH,
+                    int W, int Y0, int Y1, int sStride,
+                    int *Horizontal, int Bits)
 {
-    long sLineOffs = 0, dLineOffs = 0;
     unsigned int PixelAnt;
-    unsigned int PixelDst;
 
-    /* First pixel has no left nor top neighbor. */
-    PixelDst = LineAnt[0] = PixelAnt = Frame[0]<<16;
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
+    for (long Y = Y0; Y < Y1; Y++){
+        const uint8_t *Src = (const uint8_t *)Frame + Y*sStride;
+        unsigned int *Dst = &LineH[Y*W];
 
-    /* First line has no top neighbor, only left. */
-    for (long X = 1; X < W; X++){
-        PixelDst = LineAnt[X] = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
-
-    for (long Y = 1; Y < H; Y++){
-        sLineOffs += sStride, dLineOffs += dStride;
         /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        PixelDst = LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            PixelDst = LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
-        }
+        Dst[0] = PixelAnt = GetPixel(Src, 0, Bits);
+        for (long X = 1; X < W; X++)
+            Dst[X] = PixelAnt = LowPassMul(PixelAnt, GetPixel(Src, X, Bits), Horizontal);
     }
 }
 
-static void deNoise(unsigned char *Frame,        // mpi->planes[x]
-                    unsigned char *FrameDest,    // dmpi->planes[x]
-                    unsigned int *LineAnt,      // vf->priv->Line (width bytes)
-                    unsigned short **FrameAntPtr,
-                    int W, int H, int sStride, int dStride,
-                    int *Horizontal, int *Vertical, int *Temporal)
+static inline void deNoiseVertical(
+                    unsigned int *LineH,
+                    void *FrameDest,             // dmpi->planes[x]
+                    unsigned short *FrameAnt,    // NULL if not temporal
+                    int W, int H, int X0, int X1, int dStride,
+                    int *Vertical, int *Temporal, int Bits)
 {
-    long sLineOffs = 0, dLineOffs = 0;
-    unsigned int PixelAnt;
     unsigned int PixelDst;
-    unsigned short* FrameAnt=(*FrameAntPtr);
-
-    if(!FrameAnt){
-        (*FrameAntPtr)=FrameAnt=malloc(W*H*sizeof(unsigned short));
-        if(!FrameAnt)
-            return;
-        for (long Y = 0; Y < H; Y++){
-            unsigned short* dst=&FrameAnt[Y*W];
-            unsigned char* src=Frame+Y*sStride;
-            for (long X = 0; X < W; X++) dst[X]=src[X]<<8;
-        }
-    }
 
-    if(!Horizontal[0] && !Vertical[0]){
-        deNoiseTemporal(Frame, FrameDest, FrameAnt,
-                        W, H, sStride, dStride, Temporal);
-        return;
-    }
-    if(!Temporal[0]){
-        deNoiseSpacial(Frame, FrameDest, LineAnt,
-                       W, H, sStride, dStride, Horizontal, Vertical);
-        return;
-    }
-
-    /* First pixel has no left nor top neighbor. Only previous frame */
-    LineAnt[0] = PixelAnt = Frame[0]<<16;
-    PixelDst = LowPassMul(FrameAnt[0]<<8, PixelAnt, Temporal);
-    FrameAnt[0] = ((PixelDst+0x1000007F)>>8);
-    FrameDest[0]= ((PixelDst+0x10007FFF)>>16);
-
-    /* First line has no top neighbor. Only left one for each pixel and
-     * last frame */
-    for (long X = 1; X < W; X++){
-        LineAnt[X] = PixelAnt = LowPassMul(PixelAnt, Frame[X]<<16, Horizontal);
-        PixelDst = LowPassMul(FrameAnt[X]<<8, PixelAnt, Temporal);
-        FrameAnt[X] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[X]= ((PixelDst+0x10007FFF)>>16);
-    }
+    for (long Y = 0; Y < H; Y++){
+        unsigned int *LineAnt = &LineH[Y*W];
+        uint8_t *Dst = (uint8_t *)FrameDest + Y*dStride;
+
+        /* First line has no top neighbor */
+        if (Y > 0)
+            for (long X = X0; X < X1; X++)
+                LineAnt[X] = LowPassMul(LineAnt[X-W], LineAnt[X], Vertical);
+
+        if (FrameAnt == NULL){
+            for (long X = X0; X < X1; X++)
+                PutPixel(Dst, X, LineAnt[X], Bits);
+            continue;
+        }
 
-    for (long Y = 1; Y < H; Y++){
-        unsigned short* LinePrev=&FrameAnt[Y*W];
-        sLineOffs += sStride, dLineOffs += dStride;
-        /* First pixel on each line doesn't have previous pixel */
-        PixelAnt = Frame[sLineOffs]<<16;
-        LineAnt[0] = LowPassMul(LineAnt[0], PixelAnt, Vertical);
-        PixelDst = LowPassMul(LinePrev[0]<<8, LineAnt[0], Temporal);
-        LinePrev[0] = ((PixelDst+0x1000007F)>>8);
-        FrameDest[dLineOffs]= ((PixelDst+0x10007FFF)>>16);
-
-        for (long X = 1; X < W; X++){
-            /* The rest are normal */
-            PixelAnt = LowPassMul(PixelAnt, Frame[sLineOffs+X]<<16, Horizontal);
-            LineAnt[X] = LowPassMul(LineAnt[X], PixelAnt, Vertical);
+        unsigned short *LinePrev = &FrameAnt[Y*W];
+        for (long X = X0; X < X1; X++){
             PixelDst = LowPassMul(LinePrev[X]<<8, LineAnt[X], Temporal);
             LinePrev[X] = ((PixelDst+0x1000007F)>>8);
-            FrameDest[dLineOffs+X]= ((PixelDst+0x10007FFF)>>16);
+            PutPixel(Dst, X, PixelDst, Bits);
         }
     }
 }
 
+static unsigned short *deNoiseInit(const void *Frame, // mpi->planes[x]
+                                   int W, int H, int sStride, int Bits)
+{
+    unsigned short *FrameAnt = malloc(W*H*sizeof(unsigned short));
+    if(!FrameAnt)
+        return NULL;
+
+    for (long Y = 0; Y < H; Y++){
+        unsigned short* dst=&FrameAnt[Y*W];
+        const uint8_t* src=(const uint8_t *)Frame+Y*sStride;
+        for (long X = 0; X < W; X++) dst[X]=GetPixel(src, X, Bits)>>8;
+    }
+    return FrameAnt;
+}
 
 //===========================================================================//
 
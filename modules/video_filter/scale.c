@@ -1,6 +1,6 @@
 /*****************************************************************************
- * scale.c: video scaling module for YUVP/A, I420 and RGBA pictures
- *  Uses the low quality "nearest neighbour" algorithm.
+ * scale.c: video scaling module for planar, semi-planar and RGBA pictures
+ *  Uses separable nearest neighbour, bilinear, bicubic or Lanczos kernels.
  *****************************************************************************
  * Copyright (C) 2003-2007 VLC authors and VideoLAN
  *
@@ -22,6 +22,18 @@
  * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
  *****************************************************************************/
 
+/*
+ * Each plane is scaled in two passes with the same kernel: the source rows
+ * are scaled horizontally into 32 bits intermediate rows, that are combined
+ * vertically into the output rows. The weights of both directions are
+ * computed once, in fixed point, when the filter is opened.
+ *
+ * The output is processed by tiles of TILE_SAMPLES samples and of a band of
+ * rows: the intermediate rows of a tile are kept in a small ring buffer, so
+ * that each source row is scaled once per tile and stays in cache until the
+ * output rows that need it are done. The bands run on the filter threads.
+ */
+
 /*****************************************************************************
  * Preamble
  *****************************************************************************/
@@ -29,160 +41,1237 @@
 # include "config.h"
 #endif
 
+#include <math.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_filter.h>
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
 #include "filter_picture.h"
 
 /****************************************************************************
  * Local prototypes
  ****************************************************************************/
 static int  OpenFilter ( filter_t * );
-VIDEO_FILTER_WRAPPER(Filter)
+
+#define KERNEL_TEXT N_("Scaling kernel")
+#define KERNEL_LONGTEXT N_("Interpolation used to scale the pictures. " \
+    "Palettized pictures always use the nearest neighbour.")
+
+static const char *const kernel_list[] = {
+    "nearest", "bilinear", "bicubic", "lanczos" };
+static const char *const kernel_list_text[] = {
+    N_("Nearest neighbour (bad quality)"), N_("Bilinear"),
+    N_("Bicubic (good quality)"), N_("Lanczos (best quality)") };
 
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
 vlc_module_begin ()
     set_description( N_("Video scaling filter") )
+    set_subcategory( SUBCAT_VIDEO_VFILTER )
     set_callback_video_converter( OpenFilter, 10 )
+    add_string( "scale-kernel", "bicubic", KERNEL_TEXT, KERNEL_LONGTEXT )
+        change_string_list( kernel_list, kernel_list_text )
 vlc_module_end ()
 
+/*****************************************************************************
+ * Kernels
+ *****************************************************************************/
+enum scale_kernel
+{
+    KERNEL_NEAREST,
+    KERNEL_BILINEAR,
+    KERNEL_BICUBIC,
+    KERNEL_LANCZOS,
+};
+
+/* Half width of the kernels, in source samples when upscaling */
+static const unsigned kernel_radius[] = { 0, 1, 2, 3 };
+
+static double Kernel( enum scale_kernel kernel, double x )
+{
+    x = fabs( x );
+
+    switch( kernel )
+    {
+        case KERNEL_BILINEAR:
+            return x < 1. ? 1. - x : 0.;
+        case KERNEL_BICUBIC: /* Catmull-Rom (a = -0.5) */
+            if( x < 1. )
+                return (1.5 * x - 2.5) * x * x + 1.;
+            if( x < 2. )
+                return ((-0.5 * x + 2.5) * x - 4.) * x + 2.;
+            return 0.;
+        case KERNEL_LANCZOS: /* 3 lobes */
+            if( x < 1e-8 )
+                return 1.;
+            if( x >= 3. )
+                return 0.;
+            return 3. * sin( M_PI * x ) * sin( M_PI * x / 3. )
+                 / (M_PI * M_PI * x * x);
+        default:
+            vlc_assert_unreachable();
+    }
+}
+
+/*****************************************************************************
+ * Weights
+ *****************************************************************************/
+#define COEF_BITS 14
+#define TILE_SAMPLES 256
+
+/* Weights of one direction: the output sample i is the sum of taps source
+ * samples from pos[i], weighted by coefs[i * taps + k], with COEF_BITS bits
+ * of fraction */
+struct scale_taps
+{
+    unsigned taps;
+    unsigned *pos;
+    int16_t *coefs;
+};
+
+/* Sets the weights of out_count samples over in_count source samples starting
+ * at in_offset. The source samples beyond the edges repeat the edge ones. */
+static int SetTaps( struct scale_taps *t, enum scale_kernel kernel,
+                    unsigned in_offset, unsigned in_count, unsigned out_count )
+{
+    const double scale = (double)in_count / out_count;
+    /* Downscaling stretches the kernel, to filter out the frequencies that
+     * the output cannot represent */
+    const double stretch = scale > 1. ? scale : 1.;
+    const double support = kernel_radius[kernel] * stretch;
+    unsigned taps = 1;
+
+    if( in_count != out_count && kernel != KERNEL_NEAREST )
+        for( unsigned i = 0; i < out_count; i++ )
+        {
+            const double center = (i + .5) * scale - .5;
+            const int first = floor( center - support ) + 1;
+            const int last = ceil( center + support ) - 1;
+            taps = __MAX(taps, (unsigned)(last - first + 1));
+        }
+    taps = __MIN(taps, in_count);
+
+    t->taps = taps;
+    t->pos = vlc_alloc( out_count, sizeof(*t->pos) );
+    t->coefs = vlc_alloc( out_count, taps * sizeof(*t->coefs) );
+    double *weights = vlc_alloc( taps, sizeof(*weights) );
+    if( unlikely(t->pos == NULL || t->coefs == NULL || weights == NULL) )
+    {
+        free( weights );
+        return VLC_ENOMEM;
+    }
+
+    for( unsigned i = 0; i < out_count; i++ )
+    {
+        const double center = (i + .5) * scale - .5;
+        int16_t *coefs = &t->coefs[i * taps];
+
+        if( taps == 1 )
+        {
+            long pos = in_count == out_count ? (long)i : lround( center );
+            t->pos[i] = in_offset + VLC_CLIP(pos, 0, (long)in_count - 1);
+            coefs[0] = 1 << COEF_BITS;
+            continue;
+        }
+
+        const int first = floor( center - support ) + 1;
+        const int last = ceil( center + support ) - 1;
+        const int pos = VLC_CLIP(first, 0, (int)(in_count - taps));
+        double sum = 0.;
+
+        for( unsigned k = 0; k < taps; k++ )
+            weights[k] = 0.;
+        for( int j = first; j <= last; j++ )
+        {
+            const double w = Kernel( kernel, (j - center) / stretch );
+            weights[VLC_CLIP(j, 0, (int)in_count - 1) - pos] += w;
+            sum += w;
+        }
+
+        /* Normalize, and give the rounding error to the largest weight */
+        int total = 0;
+        unsigned largest = 0;
+        for( unsigned k = 0; k < taps; k++ )
+        {
+            coefs[k] = lround( weights[k] / sum * (1 << COEF_BITS) );
+            total += coefs[k];
+            if( coefs[k] > coefs[largest] )
+                largest = k;
+        }
+        coefs[largest] += (1 << COEF_BITS) - total;
+        t->pos[i] = in_offset + pos;
+    }
+    free( weights );
+    return VLC_SUCCESS;
+}
+
+static void CleanTaps( struct scale_taps *t )
+{
+    free( t->coefs );
+    free( t->pos );
+}
+
+/*****************************************************************************
+ * Row kernels
+ *****************************************************************************/
+/* Layout of the samples */
+struct scale_format
+{
+    unsigned size;    /* bytes per sample */
+    unsigned bits;    /* significant bits */
+    unsigned shift;   /* unused low bits */
+    unsigned hshift;  /* descaling of the horizontal pass */
+    unsigned vshift;  /* descaling of the vertical pass */
+};
+
+static inline unsigned GetSample( const uint8_t *src, unsigned i,
+                                  unsigned shift, bool wide )
+{
+    return wide ? ((const uint16_t *)src)[i] >> shift : src[i];
+}
+
+/* Scales the pixels [first, first + count) of a source row */
+static inline void ScaleRowCommon( int32_t *restrict dst, const uint8_t *src,
+                                   const struct scale_taps *cols,
+                                   unsigned comps, unsigned first,
+                                   unsigned count,
+                                   const struct scale_format *fmt, bool wide )
+{
+    const unsigned taps = cols->taps;
+    const int32_t round = 1 << (fmt->hshift - 1);
+
+    for( unsigned i = first; i < first + count; i++ )
+    {
+        const int16_t *coefs = &cols->coefs[i * taps];
+        const unsigned pos = cols->pos[i] * comps;
+
+        for( unsigned c = 0; c < comps; c++ )
+        {
+            int32_t sum = round;
+            for( unsigned k = 0; k < taps; k++ )
+                sum += coefs[k] * (int32_t)GetSample( src, pos + k * comps + c,
+                                                      fmt->shift, wide );
+            *dst++ = sum >> fmt->hshift;
+        }
+    }
+}
+
+static void ScaleRow( int32_t *restrict dst, const uint8_t *src,
+                      const struct scale_taps *cols, unsigned comps,
+                      unsigned first, unsigned count,
+                      const struct scale_format *fmt )
+{
+    ScaleRowCommon( dst, src, cols, comps, first, count, fmt, false );
+}
+
+static void ScaleRow16( int32_t *restrict dst, const uint8_t *src,
+                        const struct scale_taps *cols, unsigned comps,
+                        unsigned first, unsigned count,
+                        const struct scale_format *fmt )
+{
+    ScaleRowCommon( dst, src, cols, comps, first, count, fmt, true );
+}
+
+/* Combines the samples [first, count) of the intermediate rows into an output
+ * row */
+static inline void ScaleColumnsCommon( uint8_t *dst,
+                                       const int32_t *const *rows,
+                                       const int16_t *coefs, unsigned taps,
+                                       unsigned first, unsigned count,
+                                       const struct scale_format *fmt,
+                                       bool wide )
+{
+    const int32_t round = 1 << (fmt->vshift - 1);
+    const int max = (1 << fmt->bits) - 1;
+
+    for( unsigned i = first; i < count; i++ )
+    {
+        int32_t sum = round;
+        for( unsigned k = 0; k < taps; k++ )
+            sum += coefs[k] * rows[k][i];
+
+        const int v = VLC_CLIP(sum >> fmt->vshift, 0, max);
+        if( wide )
+            ((uint16_t *)dst)[i] = v << fmt->shift;
+        else
+            dst[i] = v;
+    }
+}
+
+static void ScaleColumns( uint8_t *dst, const int32_t *const *rows,
+                          const int16_t *coefs, unsigned taps, unsigned first,
+                          unsigned count, const struct scale_format *fmt )
+{
+    ScaleColumnsCommon( dst, rows, coefs, taps, first, count, fmt, false );
+}
+
+static void ScaleColumns16( uint8_t *dst, const int32_t *const *rows,
+                            const int16_t *coefs, unsigned taps,
+                            unsigned first, unsigned count,
+                            const struct scale_format *fmt )
+{
+    ScaleColumnsCommon( dst, rows, coefs, taps, first, count, fmt, true );
+}
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+# include <arm_neon.h>
+# define SCALE_HAVE_NEON
+#endif
+
+#if defined(CAN_COMPILE_AVX2) || defined(SCALE_HAVE_NEON)
+# define SCALE_HAVE_SIMD
+
+/* Horizontal weights laid out for the vectorized passes */
+struct scale_simd
+{
+    /* Planes of single samples: taps padded to chunks of 8 for each pixel */
+    int16_t *coefs16;
+    unsigned chunks;
+    /* Interleaved samples, gathered by AVX2: the byte offset of the first
+     * tap of each sample, and for each group of 8 samples, taps times 8
+     * weights */
+    int32_t *offsets;
+    int32_t *coefs;
+
+    unsigned samples; /* leading samples whose loads stay in the row */
+};
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+# define SCALE_AVX2 __attribute__ ((__target__ ("avx2")))
+
+/* Loads 8 samples of two pixels as signed 16 bits */
+SCALE_AVX2
+static inline __m256i ScaleLoad2AVX2( const uint8_t *src, unsigned a,
+                                      unsigned b, __m128i shift, bool wide )
+{
+    if( !wide )
+        return _mm256_cvtepu8_epi16( _mm_unpacklo_epi64(
+                    _mm_loadl_epi64( (const __m128i *)&src[a] ),
+                    _mm_loadl_epi64( (const __m128i *)&src[b] ) ) );
+
+    const uint16_t *src16 = (const uint16_t *)src;
+    __m256i v = _mm256_inserti128_si256( _mm256_castsi128_si256(
+                    _mm_loadu_si128( (const __m128i *)&src16[a] ) ),
+                    _mm_loadu_si128( (const __m128i *)&src16[b] ), 1 );
+    v = _mm256_srl_epi16( v, shift );
+    return _mm256_xor_si256( v, _mm256_set1_epi16( INT16_MIN ) );
+}
+
+/* Scales the pixels [first, first + count) of a row of single samples, first
+ * being a multiple of 8: the taps of each pixel are loaded and weighted 8 by 8,
+ * and the partial sums of 8 pixels are added together */
+SCALE_AVX2
+static inline void ScaleRowPlanarAVX2Common( int32_t *restrict dst,
+                                             const uint8_t *src,
+                                             const struct scale_taps *cols,
+                                             const struct scale_simd *simd,
+                                             unsigned first, unsigned count,
+                                             const struct scale_format *fmt,
+                                             bool wide )
+{
+    const unsigned chunks = simd->chunks;
+    const unsigned end = __MIN(first + count, simd->samples);
+    const __m256i order = _mm256_setr_epi32( 0, 4, 1, 5, 2, 6, 3, 7 );
+    /* The 16 bits samples are offset to be signed, which the weights summing
+     * to one make up for */
+    const __m256i round = _mm256_set1_epi32( (1 << (fmt->hshift - 1))
+                                   + (wide ? 32768 << COEF_BITS : 0) );
+    const __m128i shift = _mm_cvtsi32_si128( fmt->shift );
+    const __m128i hshift = _mm_cvtsi32_si128( fmt->hshift );
+    unsigned i = first;
+
+    for( ; i + 8 <= end; i += 8 )
+    {
+        __m256i sums[4];
+
+        for( unsigned j = 0; j < 4; j++ )
+        {
+            const unsigned a = i + 2 * j;
+            const int16_t *coefs = &simd->coefs16[a * chunks * 8];
+            __m256i sum = _mm256_setzero_si256();
+
+            for( unsigned c = 0; c < chunks; c++ )
+            {
+                const __m256i v = ScaleLoad2AVX2( src, cols->pos[a] + 8 * c,
+                                                  cols->pos[a + 1] + 8 * c,
+                                                  shift, wide );
+                const __m256i w = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(
+                        _mm_loadu_si128( (const __m128i *)&coefs[8 * c] ) ),
+                    _mm_loadu_si128( (const __m128i *)&coefs[8 * (chunks + c)] ),
+                    1 );
+                sum = _mm256_add_epi32( sum, _mm256_madd_epi16( v, w ) );
+            }
+            sums[j] = sum;
+        }
+
+        /* Pixels 0, 2, 4, 6 in the low lane, 1, 3, 5, 7 in the high lane */
+        __m256i v = _mm256_hadd_epi32( _mm256_hadd_epi32( sums[0], sums[1] ),
+                                       _mm256_hadd_epi32( sums[2], sums[3] ) );
+        v = _mm256_add_epi32( _mm256_permutevar8x32_epi32( v, order ), round );
+        _mm256_storeu_si256( (__m256i *)&dst[i - first],
+                             _mm256_sra_epi32( v, hshift ) );
+    }
+
+    if( i < first + count )
+        ScaleRowCommon( &dst[i - first], src, cols, 1, i, first + count - i,
+                        fmt, wide );
+}
+
+SCALE_AVX2
+static void ScaleRowPlanarAVX2( int32_t *restrict dst, const uint8_t *src,
+                                const struct scale_taps *cols,
+                                const struct scale_simd *simd, unsigned first,
+                                unsigned count, const struct scale_format *fmt )
+{
+    ScaleRowPlanarAVX2Common( dst, src, cols, simd, first, count, fmt, false );
+}
+
+SCALE_AVX2
+static void ScaleRowPlanar16AVX2( int32_t *restrict dst, const uint8_t *src,
+                                  const struct scale_taps *cols,
+                                  const struct scale_simd *simd,
+                                  unsigned first, unsigned count,
+                                  const struct scale_format *fmt )
+{
+    ScaleRowPlanarAVX2Common( dst, src, cols, simd, first, count, fmt, true );
+}
+
+/* Scales the samples [first, first + count) of a row of interleaved samples,
+ * first being a multiple of 8, gathering the taps of 8 samples at once */
+SCALE_AVX2
+static void ScaleRowGatherAVX2( int32_t *restrict dst, const uint8_t *src,
+                                const struct scale_taps *cols,
+                                const struct scale_simd *simd, unsigned comps,
+                                unsigned first, unsigned count,
+                                const struct scale_format *fmt )
+{
+    const unsigned taps = cols->taps;
+    const ptrdiff_t stride = comps * fmt->size;
+    const unsigned end = __MIN(first + count, simd->samples);
+    const __m256i mask = _mm256_set1_epi32( fmt->size == 2 ? 0xffff : 0xff );
+    const __m256i round = _mm256_set1_epi32( 1 << (fmt->hshift - 1) );
+    const __m128i shift = _mm_cvtsi32_si128( fmt->shift );
+    const __m128i hshift = _mm_cvtsi32_si128( fmt->hshift );
+    unsigned s = first;
+
+    for( ; s + 8 <= end; s += 8 )
+    {
+        const __m256i offsets =
+            _mm256_loadu_si256( (const __m256i *)&simd->offsets[s] );
+        const int32_t *coefs = &simd->coefs[s * taps];
+        __m256i sum = round;
+
+        for( unsigned k = 0; k < taps; k++ )
+        {
+            __m256i v = _mm256_i32gather_epi32( (const int *)(src + k * stride),
+                                                offsets, 1 );
+            v = _mm256_srl_epi32( _mm256_and_si256( v, mask ), shift );
+            sum = _mm256_add_epi32( sum, _mm256_mullo_epi32( v,
+                    _mm256_loadu_si256( (const __m256i *)&coefs[k * 8] ) ) );
+        }
+        _mm256_storeu_si256( (__m256i *)&dst[s - first],
+                             _mm256_sra_epi32( sum, hshift ) );
+    }
+
+    /* The groups are made of whole pixels */
+    if( s < first + count )
+        (fmt->size == 2 ? ScaleRow16 : ScaleRow)( &dst[s - first], src, cols,
+            comps, s / comps, (first + count - s) / comps, fmt );
+}
+
+SCALE_AVX2
+static void ScaleColumnsAVX2( uint8_t *dst, const int32_t *const *rows,
+                              const int16_t *coefs, unsigned taps,
+                              unsigned count, const struct scale_format *fmt )
+{
+    const bool wide = fmt->size == 2;
+    const __m256i round = _mm256_set1_epi32( 1 << (fmt->vshift - 1) );
+    const __m256i max = _mm256_set1_epi32( (1 << fmt->bits) - 1 );
+    const __m128i vshift = _mm_cvtsi32_si128( fmt->vshift );
+    const __m128i shift = _mm_cvtsi32_si128( fmt->shift );
+    unsigned i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        __m256i sum = round;
+        for( unsigned k = 0; k < taps; k++ )
+            sum = _mm256_add_epi32( sum, _mm256_mullo_epi32(
+                    _mm256_loadu_si256( (const __m256i *)&rows[k][i] ),
+                    _mm256_set1_epi32( coefs[k] ) ) );
+        sum = _mm256_sra_epi32( sum, vshift );
+        sum = _mm256_min_epi32( _mm256_max_epi32( sum,
+                                _mm256_setzero_si256() ), max );
+
+        __m128i v = _mm_packus_epi32( _mm256_castsi256_si128( sum ),
+                                      _mm256_extracti128_si256( sum, 1 ) );
+        if( wide )
+            _mm_storeu_si128( (__m128i *)&dst[2 * i], _mm_sll_epi16( v, shift ) );
+        else
+            _mm_storel_epi64( (__m128i *)&dst[i], _mm_packus_epi16( v, v ) );
+    }
+
+    (wide ? ScaleColumns16 : ScaleColumns)( dst, rows, coefs, taps, i, count,
+                                            fmt );
+}
+#endif
+
+#ifdef SCALE_HAVE_NEON
+/* Loads 8 samples as signed 16 bits */
+static inline int16x8_t ScaleLoadNEON( const uint8_t *src, unsigned i,
+                                       int16x8_t shift, bool wide )
+{
+    if( !wide )
+        return vreinterpretq_s16_u16( vmovl_u8( vld1_u8( &src[i] ) ) );
+
+    const uint16x8_t v = vshlq_u16( vld1q_u16( &((const uint16_t *)src)[i] ),
+                                    shift );
+    return vreinterpretq_s16_u16( veorq_u16( v, vdupq_n_u16( 0x8000 ) ) );
+}
+
+/* Weights the taps of a pixel 8 by 8, into 2 partial sums */
+static inline int32x2_t ScaleTapsNEON( const uint8_t *src, unsigned pos,
+                                       const int16_t *coefs, unsigned chunks,
+                                       int16x8_t shift, bool wide )
+{
+    int32x4_t sum = vdupq_n_s32( 0 );
+
+    for( unsigned c = 0; c < chunks; c++ )
+    {
+        const int16x8_t v = ScaleLoadNEON( src, pos + 8 * c, shift, wide );
+        const int16x8_t w = vld1q_s16( &coefs[8 * c] );
+
+        sum = vmlal_s16( sum, vget_low_s16( v ), vget_low_s16( w ) );
+        sum = vmlal_s16( sum, vget_high_s16( v ), vget_high_s16( w ) );
+    }
+    return vadd_s32( vget_low_s32( sum ), vget_high_s32( sum ) );
+}
+
+/* Scales the pixels [first, first + count) of a row of single samples, with
+ * the same padded weights as AVX2, 4 pixels at a time */
+static inline void ScaleRowPlanarNEONCommon( int32_t *restrict dst,
+                                             const uint8_t *src,
+                                             const struct scale_taps *cols,
+                                             const struct scale_simd *simd,
+                                             unsigned first, unsigned count,
+                                             const struct scale_format *fmt,
+                                             bool wide )
+{
+    const unsigned chunks = simd->chunks;
+    const unsigned end = __MIN(first + count, simd->samples);
+    /* The 16 bits samples are offset to be signed, as with AVX2 */
+    const int32x4_t round = vdupq_n_s32( (1 << (fmt->hshift - 1))
+                                         + (wide ? 32768 << COEF_BITS : 0) );
+    const int16x8_t shift = vdupq_n_s16( -(int)fmt->shift );
+    const int32x4_t hshift = vdupq_n_s32( -(int)fmt->hshift );
+    unsigned i = first;
+
+    for( ; i + 4 <= end; i += 4 )
+    {
+        int32x2_t sums[4];
+
+        for( unsigned j = 0; j < 4; j++ )
+            sums[j] = ScaleTapsNEON( src, cols->pos[i + j],
+                                     &simd->coefs16[(i + j) * chunks * 8],
+                                     chunks, shift, wide );
+
+        int32x4_t v = vcombine_s32( vpadd_s32( sums[0], sums[1] ),
+                                    vpadd_s32( sums[2], sums[3] ) );
+        vst1q_s32( &dst[i - first], vshlq_s32( vaddq_s32( v, round ),
+                                               hshift ) );
+    }
+
+    if( i < first + count )
+        ScaleRowCommon( &dst[i - first], src, cols, 1, i, first + count - i,
+                        fmt, wide );
+}
+
+static void ScaleRowPlanarNEON( int32_t *restrict dst, const uint8_t *src,
+                                const struct scale_taps *cols,
+                                const struct scale_simd *simd, unsigned first,
+                                unsigned count, const struct scale_format *fmt )
+{
+    ScaleRowPlanarNEONCommon( dst, src, cols, simd, first, count, fmt, false );
+}
+
+static void ScaleRowPlanar16NEON( int32_t *restrict dst, const uint8_t *src,
+                                  const struct scale_taps *cols,
+                                  const struct scale_simd *simd,
+                                  unsigned first, unsigned count,
+                                  const struct scale_format *fmt )
+{
+    ScaleRowPlanarNEONCommon( dst, src, cols, simd, first, count, fmt, true );
+}
+
+/* Scales the pixels [first, first + count) of a row of 2 or 4 interleaved
+ * samples, all the samples of a pixel in one vector: there is no gather,
+ * but the pixels of RGBA or semi-planar chroma are at most 4 bytes */
+static inline void ScaleRowPackedNEONCommon( int32_t *restrict dst,
+                                             const uint8_t *src,
+                                             const struct scale_taps *cols,
+                                             unsigned comps, unsigned first,
+                                             unsigned count,
+                                             const struct scale_format *fmt,
+                                             bool wide )
+{
+    const unsigned taps = cols->taps;
+    const unsigned bytes = comps * (wide ? 2 : 1);
+    const int32x4_t round = vdupq_n_s32( 1 << (fmt->hshift - 1) );
+    const int32x4_t shift = vdupq_n_s32( -(int)fmt->shift );
+    const int32x4_t hshift = vdupq_n_s32( -(int)fmt->hshift );
+
+    for( unsigned i = first; i < first + count; i++ )
+    {
+        const int16_t *coefs = &cols->coefs[i * taps];
+        const uint8_t *p = &src[cols->pos[i] * bytes];
+        int32x4_t sum = round;
+
+        for( unsigned k = 0; k < taps; k++ )
+        {
+            uint32_t pixel = 0;
+            memcpy( &pixel, &p[k * bytes], bytes );
+
+            const uint32x2_t d = vdup_n_u32( pixel );
+            uint32x4_t v = wide
+                ? vshlq_u32( vmovl_u16( vreinterpret_u16_u32( d ) ), shift )
+                : vmovl_u16( vget_low_u16( vmovl_u8( vreinterpret_u8_u32( d ) ) ) );
+            sum = vmlaq_n_s32( sum, vreinterpretq_s32_u32( v ), coefs[k] );
+        }
+
+        sum = vshlq_s32( sum, hshift );
+        if( comps == 4 )
+            vst1q_s32( dst, sum );
+        else
+            vst1_s32( dst, vget_low_s32( sum ) );
+        dst += comps;
+    }
+}
+
+static void ScaleRowPackedNEON( int32_t *restrict dst, const uint8_t *src,
+                                const struct scale_taps *cols, unsigned comps,
+                                unsigned first, unsigned count,
+                                const struct scale_format *fmt )
+{
+    /* Constant layouts, for the loads of each tap to be a single move */
+    if( fmt->size == 2 )
+        ScaleRowPackedNEONCommon( dst, src, cols, 2, first, count, fmt, true );
+    else if( comps == 4 )
+        ScaleRowPackedNEONCommon( dst, src, cols, 4, first, count, fmt, false );
+    else
+        ScaleRowPackedNEONCommon( dst, src, cols, 2, first, count, fmt, false );
+}
+
+static void ScaleColumnsNEON( uint8_t *dst, const int32_t *const *rows,
+                              const int16_t *coefs, unsigned taps,
+                              unsigned count, const struct scale_format *fmt )
+{
+    const bool wide = fmt->size == 2;
+    const int32x4_t round = vdupq_n_s32( 1 << (fmt->vshift - 1) );
+    const int32x4_t vshift = vdupq_n_s32( -(int)fmt->vshift );
+    const uint16x8_t max = vdupq_n_u16( (1 << fmt->bits) - 1 );
+    const int16x8_t shift = vdupq_n_s16( fmt->shift );
+    unsigned i = 0;
+
+    for( ; i + 8 <= count; i += 8 )
+    {
+        int32x4_t lo = round, hi = round;
+
+        for( unsigned k = 0; k < taps; k++ )
+        {
+            lo = vmlaq_n_s32( lo, vld1q_s32( &rows[k][i] ), coefs[k] );
+            hi = vmlaq_n_s32( hi, vld1q_s32( &rows[k][i + 4] ), coefs[k] );
+        }
+
+        /* The narrowing saturates below 0 */
+        uint16x8_t v = vcombine_u16( vqmovun_s32( vshlq_s32( lo, vshift ) ),
+                                     vqmovun_s32( vshlq_s32( hi, vshift ) ) );
+        v = vminq_u16( v, max );
+        if( wide )
+            vst1q_u16( (uint16_t *)&dst[2 * i], vshlq_u16( v, shift ) );
+        else
+            vst1_u8( &dst[i], vmovn_u16( v ) );
+    }
+
+    (wide ? ScaleColumns16 : ScaleColumns)( dst, rows, coefs, taps, i, count,
+                                            fmt );
+}
+#endif
+
+/*****************************************************************************
+ * Filter
+ *****************************************************************************/
+struct scale_plane
+{
+    unsigned comps;                  /* interleaved samples per pixel */
+    unsigned in_x, in_y, in_width, in_height;     /* in pixels */
+    unsigned out_x, out_y, out_width, out_height;
+    struct scale_taps cols, rows;
+#ifdef SCALE_HAVE_SIMD
+    struct scale_simd simd;
+#endif
+};
+
+/* Per slice buffers */
+struct scale_ring
+{
+    int32_t *rows;       /* ring of TILE_SAMPLES intermediate rows */
+    int *tags;           /* source row index of each ring row, -1 if none */
+    const int32_t **taps; /* rows of the current output row */
+};
+
+/* Instruction set of the passes */
+enum scale_cpu
+{
+    SCALE_CPU_C,
+    SCALE_CPU_AVX2,
+    SCALE_CPU_NEON,
+};
+
+static const char *const cpu_names[] = { "C", "AVX2", "NEON" };
+
+typedef struct
+{
+    struct scale_format fmt;
+    unsigned planes;
+    struct scale_plane plane[4];
+    enum scale_cpu cpu;
+
+    unsigned ring_size; /* intermediate rows per slice */
+    struct scale_ring rings[VLC_FILTER_SLICES_MAX];
+    void *ring_buffer;
+} filter_sys_t;
+
+struct scale_frame
+{
+    const filter_sys_t *sys;
+    const struct scale_plane *plane;
+    const plane_t *src;
+    plane_t *dst;
+};
+
+static uint8_t *OutputRow( const struct scale_frame *frame, unsigned y )
+{
+    const struct scale_plane *plane = frame->plane;
+    const unsigned size = frame->sys->fmt.size;
+
+    return &frame->dst->p_pixels[(plane->out_y + y) * frame->dst->i_pitch
+                                 + plane->out_x * plane->comps * size];
+}
+
+/* Picks the source pixels, when both directions have a single tap */
+static void CopySlice( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct scale_frame *frame = opaque;
+    const struct scale_plane *plane = frame->plane;
+    const unsigned bytes = plane->comps * frame->sys->fmt.size;
+    const unsigned *pos = plane->cols.pos;
+    const unsigned width = plane->out_width;
+    const bool contiguous = pos[width - 1] - pos[0] == width - 1;
+
+    for( unsigned y = slice->first; y < slice->first + slice->count; y++ )
+    {
+        const uint8_t *src = &frame->src->p_pixels[plane->rows.pos[y]
+                                                   * frame->src->i_pitch];
+        uint8_t *dst = OutputRow( frame, y );
+
+        if( contiguous )
+            memcpy( dst, &src[pos[0] * bytes], width * bytes );
+        else
+            for( unsigned i = 0; i < width; i++ )
+                memcpy( &dst[i * bytes], &src[pos[i] * bytes], bytes );
+    }
+}
+
+/* Scales the output rows of the band, tile by tile */
+static void ScaleSlice( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct scale_frame *frame = opaque;
+    const filter_sys_t *sys = frame->sys;
+    const struct scale_format *fmt = &sys->fmt;
+    const struct scale_plane *plane = frame->plane;
+    const struct scale_ring *ring = &sys->rings[slice->index];
+    const unsigned comps = plane->comps;
+    const unsigned tile = TILE_SAMPLES / comps;
+    const unsigned vtaps = plane->rows.taps;
+
+    for( unsigned x = 0; x < plane->out_width; x += tile )
+    {
+        const unsigned count = __MIN(plane->out_width - x, tile);
+
+        for( unsigned k = 0; k < vtaps; k++ )
+            ring->tags[k] = -1;
+
+        for( unsigned y = slice->first; y < slice->first + slice->count; y++ )
+        {
+            const unsigned first = plane->rows.pos[y];
+
+            for( unsigned k = 0; k < vtaps; k++ )
+            {
+                const unsigned row = first + k;
+                const unsigned slot = row % vtaps;
+                int32_t *buf = &ring->rows[slot * TILE_SAMPLES];
+
+                if( ring->tags[slot] != (int)row )
+                {
+                    const uint8_t *src = &frame->src->p_pixels[row
+                                            * frame->src->i_pitch];
+                    switch( sys->cpu )
+                    {
+#ifdef CAN_COMPILE_AVX2
+                        case SCALE_CPU_AVX2:
+                            if( comps == 1 )
+                                (fmt->size == 2 ? ScaleRowPlanar16AVX2
+                                                : ScaleRowPlanarAVX2)( buf,
+                                    src, &plane->cols, &plane->simd, x, count,
+                                    fmt );
+                            else
+                                ScaleRowGatherAVX2( buf, src, &plane->cols,
+                                                    &plane->simd, comps,
+                                                    x * comps, count * comps,
+                                                    fmt );
+                            break;
+#endif
+#ifdef SCALE_HAVE_NEON
+                        case SCALE_CPU_NEON:
+                            if( comps == 1 )
+                                (fmt->size == 2 ? ScaleRowPlanar16NEON
+                                                : ScaleRowPlanarNEON)( buf,
+                                    src, &plane->cols, &plane->simd, x, count,
+                                    fmt );
+                            else
+                                ScaleRowPackedNEON( buf, src, &plane->cols,
+                                                    comps, x, count, fmt );
+                            break;
+#endif
+                        default:
+                            (fmt->size == 2 ? ScaleRow16 : ScaleRow)( buf,
+                                src, &plane->cols, comps, x, count, fmt );
+                    }
+                    ring->tags[slot] = row;
+                }
+                ring->taps[k] = buf;
+            }
+
+            uint8_t *dst = OutputRow( frame, y ) + x * comps * fmt->size;
+            const int16_t *coefs = &plane->rows.coefs[y * vtaps];
+            switch( sys->cpu )
+            {
+#ifdef CAN_COMPILE_AVX2
+                case SCALE_CPU_AVX2:
+                    ScaleColumnsAVX2( dst, ring->taps, coefs, vtaps,
+                                      count * comps, fmt );
+                    break;
+#endif
+#ifdef SCALE_HAVE_NEON
+                case SCALE_CPU_NEON:
+                    ScaleColumnsNEON( dst, ring->taps, coefs, vtaps,
+                                      count * comps, fmt );
+                    break;
+#endif
+                default:
+                    (fmt->size == 2 ? ScaleColumns16 : ScaleColumns)( dst,
+                        ring->taps, coefs, vtaps, 0, count * comps, fmt );
+            }
+        }
+    }
+}
+
+static void Resample( filter_t *p_filter, picture_t *p_pic,
+                      picture_t *p_pic_dst )
+{
+    const filter_sys_t *p_sys = p_filter->p_sys;
+
+    for( unsigned i = 0; i < p_sys->planes; i++ )
+    {
+        const struct scale_plane *plane = &p_sys->plane[i];
+        struct scale_frame frame = {
+            .sys = p_sys,
+            .plane = plane,
+            .src = &p_pic->p[i],
+            .dst = &p_pic_dst->p[i],
+        };
+        const bool copy = plane->cols.taps == 1 && plane->rows.taps == 1;
+
+        filter_ExecuteSlices( p_filter, plane->out_height, 1, 0,
+                              copy ? CopySlice : ScaleSlice, &frame );
+    }
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE( Resample, CloseFilter )
+
 /*****************************************************************************
  * OpenFilter: probe the filter and return score
  *****************************************************************************/
-static int OpenFilter( filter_t *p_filter )
+/* Formats with samples of more than 8 bits in the native byte order */
+static bool IsNativeHighDepth( vlc_fourcc_t fourcc )
+{
+    switch( fourcc )
+    {
+#ifdef WORDS_BIGENDIAN
+        case VLC_CODEC_I420_9B:
+        case VLC_CODEC_I420_10B:
+        case VLC_CODEC_I420_12B:
+        case VLC_CODEC_I420_16B:
+        case VLC_CODEC_I422_9B:
+        case VLC_CODEC_I422_10B:
+        case VLC_CODEC_I422_12B:
+        case VLC_CODEC_I422_16B:
+        case VLC_CODEC_I444_9B:
+        case VLC_CODEC_I444_10B:
+        case VLC_CODEC_I444_12B:
+        case VLC_CODEC_I444_16B:
+        case VLC_CODEC_YUVA_444_10B:
+        case VLC_CODEC_YUVA_444_12B:
+        case VLC_CODEC_GBR_PLANAR_9B:
+        case VLC_CODEC_GBR_PLANAR_10B:
+        case VLC_CODEC_GBR_PLANAR_12B:
+        case VLC_CODEC_GBR_PLANAR_14B:
+        case VLC_CODEC_GBR_PLANAR_16B:
+        case VLC_CODEC_GBRA_PLANAR_10B:
+        case VLC_CODEC_GBRA_PLANAR_12B:
+        case VLC_CODEC_GBRA_PLANAR_16B:
+        case VLC_CODEC_GREY_10B:
+        case VLC_CODEC_GREY_12B:
+        case VLC_CODEC_GREY_16B:
+#else
+        case VLC_CODEC_I420_9L:
+        case VLC_CODEC_I420_10L:
+        case VLC_CODEC_I420_12L:
+        case VLC_CODEC_I420_16L:
+        case VLC_CODEC_I422_9L:
+        case VLC_CODEC_I422_10L:
+        case VLC_CODEC_I422_12L:
+        case VLC_CODEC_I422_16L:
+        case VLC_CODEC_I444_9L:
+        case VLC_CODEC_I444_10L:
+        case VLC_CODEC_I444_12L:
+        case VLC_CODEC_I444_16L:
+        case VLC_CODEC_YUVA_444_10L:
+        case VLC_CODEC_YUVA_444_12L:
+        case VLC_CODEC_GBR_PLANAR_9L:
+        case VLC_CODEC_GBR_PLANAR_10L:
+        case VLC_CODEC_GBR_PLANAR_12L:
+        case VLC_CODEC_GBR_PLANAR_14L:
+        case VLC_CODEC_GBR_PLANAR_16L:
+        case VLC_CODEC_GBRA_PLANAR_10L:
+        case VLC_CODEC_GBRA_PLANAR_12L:
+        case VLC_CODEC_GBRA_PLANAR_16L:
+        case VLC_CODEC_GREY_10L:
+        case VLC_CODEC_GREY_12L:
+        case VLC_CODEC_GREY_16L:
+        case VLC_CODEC_P010:
+        case VLC_CODEC_P016:
+#endif
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Sets the layout of the samples, and the number of interleaved samples per
+ * pixel of the second plane, or returns false if the format is unsupported */
+static bool SetFormat( struct scale_format *fmt, unsigned *comps,
+                       vlc_fourcc_t fourcc,
+                       const vlc_chroma_description_t *desc )
 {
-    switch (p_filter->fmt_in.video.i_chroma)
+    *comps = 1;
+    fmt->size = 1;
+    fmt->bits = 8;
+    fmt->shift = 0;
+
+    switch( fourcc )
     {
+        case VLC_CODEC_NV12:
+        case VLC_CODEC_NV21:
+        case VLC_CODEC_NV16:
+        case VLC_CODEC_NV61:
+        case VLC_CODEC_NV24:
+        case VLC_CODEC_NV42:
+            *comps = 2;
+            break;
         case VLC_CODEC_YUVP:
-        case VLC_CODEC_YUVA:
+        case VLC_CODEC_GREY:
+        case VLC_CODEC_I410:
+        case VLC_CODEC_I411:
         case VLC_CODEC_I420:
         case VLC_CODEC_YV12:
+        case VLC_CODEC_I422:
+        case VLC_CODEC_I440:
+        case VLC_CODEC_I444:
+        case VLC_CODEC_YUVA:
+        case VLC_CODEC_YUV420A:
+        case VLC_CODEC_YUV422A:
+        case VLC_CODEC_GBR_PLANAR:
+        case VLC_CODEC_GBRA_PLANAR:
+            break;
         CASE_PACKED_RGB32
-            if (!video_format_IsSameChroma( &p_filter->fmt_in.video,
-                                            &p_filter->fmt_out.video ) )
-                return VLC_EINVAL;
+            /* All the samples of the pixel are scaled alike */
+            *comps = 4;
             break;
         default:
-            return VLC_EINVAL;
+            if( !IsNativeHighDepth( fourcc ) )
+                return false;
+            fmt->size = 2;
+            fmt->bits = desc->pixel_bits;
+            if( fourcc == VLC_CODEC_P010 )
+                fmt->shift = 6;
+            if( fourcc == VLC_CODEC_P010 || fourcc == VLC_CODEC_P016 )
+                *comps = 2;
+            break;
     }
 
-    if( p_filter->fmt_in.video.orientation != p_filter->fmt_out.video.orientation )
-        return VLC_EGENERIC;
+    /* The intermediate rows keep at least 14 bits of precision; with 16 bits
+     * samples, the sums of the vertical pass still fit in 32 bits for the
+     * overshoot of the bicubic and Lanczos kernels */
+    const unsigned precision = __MAX(fmt->bits, 14);
+    fmt->hshift = fmt->bits + COEF_BITS - precision;
+    fmt->vshift = COEF_BITS + precision - fmt->bits;
+    return true;
+}
 
-#warning Converter cannot (really) change output format.
-    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
+/* Scales a position in luma pixels to the plane, rounding up if needed */
+static unsigned PlanePos( unsigned pos, vlc_rational_t ratio, bool up )
+{
+    return ((uint64_t)pos * ratio.num + (up ? ratio.den - 1 : 0)) / ratio.den;
+}
 
-    p_filter->ops = &Filter_ops;
+static int SetupPlane( struct scale_plane *plane, enum scale_kernel kernel,
+                       const video_format_t *in, const video_format_t *out,
+                       vlc_rational_t ratio, vlc_rational_t vratio )
+{
+    plane->in_x = PlanePos( in->i_x_offset, ratio, false );
+    plane->in_y = PlanePos( in->i_y_offset, vratio, false );
+    plane->in_width = PlanePos( in->i_x_offset + in->i_visible_width,
+                                ratio, true ) - plane->in_x;
+    plane->in_height = PlanePos( in->i_y_offset + in->i_visible_height,
+                                 vratio, true ) - plane->in_y;
+    plane->out_x = PlanePos( out->i_x_offset, ratio, false );
+    plane->out_y = PlanePos( out->i_y_offset, vratio, false );
+    plane->out_width = PlanePos( out->i_x_offset + out->i_visible_width,
+                                 ratio, true ) - plane->out_x;
+    plane->out_height = PlanePos( out->i_y_offset + out->i_visible_height,
+                                  vratio, true ) - plane->out_y;
 
-    msg_Dbg( p_filter, "%ix%i -> %ix%i", p_filter->fmt_in.video.i_width,
-             p_filter->fmt_in.video.i_height, p_filter->fmt_out.video.i_width,
-             p_filter->fmt_out.video.i_height );
+    if( plane->in_width == 0 || plane->in_height == 0
+     || plane->out_width == 0 || plane->out_height == 0 )
+        return VLC_EGENERIC;
 
+    if( SetTaps( &plane->cols, kernel, plane->in_x, plane->in_width,
+                 plane->out_width )
+     || SetTaps( &plane->rows, kernel, plane->in_y, plane->in_height,
+                 plane->out_height ) )
+        return VLC_ENOMEM;
     return VLC_SUCCESS;
 }
 
-/****************************************************************************
- * Filter: the whole thing
- ****************************************************************************/
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_pic_dst )
+#ifdef SCALE_HAVE_SIMD
+/* Lays the horizontal weights out for the vectorized passes */
+static int SetupSIMD( struct scale_plane *plane,
+                      const struct scale_format *fmt )
 {
-#warning Converter cannot (really) change output format.
-    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
+    struct scale_simd *simd = &plane->simd;
+    const unsigned comps = plane->comps;
+    const unsigned taps = plane->cols.taps;
+    const unsigned *pos = plane->cols.pos;
+    const unsigned samples = plane->out_width * comps;
+    const unsigned row_end = (plane->in_x + plane->in_width) * comps;
+
+    simd->samples = 0;
 
-    switch (p_filter->fmt_in.video.i_chroma)
+    if( comps == 1 )
     {
-    default:
-        for( int i_plane = 0; i_plane < p_pic_dst->i_planes; i_plane++ )
-        {
-            const int i_src_pitch    = p_pic->p[i_plane].i_pitch;
-            const int i_dst_pitch    = p_pic_dst->p[i_plane].i_pitch;
-            const int i_src_height   = p_filter->fmt_in.video.i_height;
-            const int i_src_width    = p_filter->fmt_in.video.i_width;
-            const int i_dst_height   = p_filter->fmt_out.video.i_height;
-            const int i_dst_width    = p_filter->fmt_out.video.i_width;
-            const int i_dst_visible_lines =
-                                       p_pic_dst->p[i_plane].i_visible_lines;
-            const int i_dst_visible_pitch =
-                                       p_pic_dst->p[i_plane].i_visible_pitch;
-            const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
-#define SHIFT_SIZE 16
-            const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
-                                       / i_dst_height;
-            const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
-                                       / i_dst_width;
-            const int i_src_height_1 = i_src_height - 1;
-            const int i_src_width_1  = i_src_width - 1;
-
-            uint8_t *p_src = p_pic->p[i_plane].p_pixels;
-            uint8_t *p_dst = p_pic_dst->p[i_plane].p_pixels;
-            uint8_t *p_dstendline = p_dst + i_dst_visible_pitch;
-            const uint8_t *p_dstend = p_dst + i_dst_visible_lines*i_dst_pitch;
-
-            const int i_shift_height = i_dst_height / i_src_height;
-            const int i_shift_width = i_dst_width / i_src_width;
-
-            int l = 1<<(SHIFT_SIZE-i_shift_height);
-            for( ; p_dst < p_dstend;
-                 p_dst += i_dst_hidden_pitch,
-                 p_dstendline += i_dst_pitch, l += i_height_coef )
-            {
-                int k = 1<<(SHIFT_SIZE-i_shift_width);
-                uint8_t *p_srcl = p_src
-                       + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*i_src_pitch);
+        /* The taps are loaded 8 by 8 */
+        const unsigned chunks = (taps + 7) / 8;
 
-                for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
-                {
-                    *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
-                }
-            }
+        simd->chunks = chunks;
+        simd->coefs16 = calloc( samples, chunks * 8 * sizeof(*simd->coefs16) );
+        if( unlikely(simd->coefs16 == NULL) )
+            return VLC_ENOMEM;
+
+        for( unsigned i = 0; i < samples; i++ )
+        {
+            memcpy( &simd->coefs16[i * chunks * 8], &plane->cols.coefs[i * taps],
+                    taps * sizeof(*simd->coefs16) );
+            /* Whole groups of 8 pixels, whose last one reads the furthest */
+            if( (i & 7) == 7 && simd->samples == i - 7
+             && pos[i] + chunks * 8 <= row_end )
+                simd->samples = i + 1;
         }
-        break;
-    CASE_PACKED_RGB32
-    {
-        const int i_src_pitch = p_pic->p->i_pitch;
-        const int i_dst_pitch = p_pic_dst->p->i_pitch;
-        const int i_src_height   = p_filter->fmt_in.video.i_height;
-        const int i_src_width    = p_filter->fmt_in.video.i_width;
-        const int i_dst_height   = p_filter->fmt_out.video.i_height;
-        const int i_dst_width    = p_filter->fmt_out.video.i_width;
-        const int i_dst_visible_lines =
-                                   p_pic_dst->p->i_visible_lines;
-        const int i_dst_visible_pitch =
-                                   p_pic_dst->p->i_visible_pitch;
-        const int i_dst_hidden_pitch  = i_dst_pitch - i_dst_visible_pitch;
-        const int i_height_coef  = ( i_src_height << SHIFT_SIZE )
-                                   / i_dst_height;
-        const int i_width_coef   = ( i_src_width << SHIFT_SIZE )
-                                   / i_dst_width;
-        const int i_src_height_1 = i_src_height - 1;
-        const int i_src_width_1  = i_src_width - 1;
-
-        uint32_t *p_src = (uint32_t*)p_pic->p->p_pixels;
-        uint32_t *p_dst = (uint32_t*)p_pic_dst->p->p_pixels;
-        uint32_t *p_dstendline = p_dst + (i_dst_visible_pitch>>2);
-        const uint32_t *p_dstend = p_dst + i_dst_visible_lines*(i_dst_pitch>>2);
-
-        const int i_shift_height = i_dst_height / i_src_height;
-        const int i_shift_width = i_dst_width / i_src_width;
-
-        int l = 1<<(SHIFT_SIZE-i_shift_height);
-        for( ; p_dst < p_dstend;
-             p_dst += (i_dst_hidden_pitch>>2),
-             p_dstendline += (i_dst_pitch>>2),
-             l += i_height_coef )
+        return VLC_SUCCESS;
+    }
+
+#ifndef CAN_COMPILE_AVX2
+    /* NEON loads the interleaved samples pixel by pixel, without tables */
+    VLC_UNUSED(fmt);
+    return VLC_SUCCESS;
+#else
+    const unsigned groups = (samples + 7) / 8;
+
+    simd->offsets = vlc_alloc( groups * 8, sizeof(*simd->offsets) );
+    simd->coefs = vlc_alloc( groups * 8, taps * sizeof(*simd->coefs) );
+    if( unlikely(simd->offsets == NULL || simd->coefs == NULL) )
+        return VLC_ENOMEM;
+
+    for( unsigned s = 0; s < groups * 8; s++ )
+    {
+        const unsigned i = __MIN(s / comps, plane->out_width - 1);
+
+        simd->offsets[s] = (pos[i] * comps + s % comps) * fmt->size;
+        for( unsigned k = 0; k < taps; k++ )
+            simd->coefs[(s & ~7) * taps + k * 8 + (s & 7)] =
+                plane->cols.coefs[i * taps + k];
+
+        /* The gathers read 4 bytes from the last tap of each sample */
+        if( simd->samples == s && s + 8 <= samples && (s & 7) == 0 )
         {
-            int k = 1<<(SHIFT_SIZE-i_shift_width);
-            uint32_t *p_srcl = p_src
-                    + (__MIN( i_src_height_1, l >> SHIFT_SIZE )*(i_src_pitch>>2));
-            for( ; p_dst < p_dstendline; p_dst++, k += i_width_coef )
-            {
-                *p_dst = p_srcl[__MIN( i_src_width_1, k >> SHIFT_SIZE )];
-            }
+            const unsigned last = (s + 7) / comps;
+            if( ((pos[last] + taps) * comps - 1) * fmt->size + 4
+                    <= row_end * fmt->size )
+                simd->samples = s + 8;
         }
-        break;
     }
+    return VLC_SUCCESS;
+#endif
+}
+#endif
+
+static void CleanPlanes( filter_sys_t *p_sys )
+{
+    for( unsigned i = 0; i < p_sys->planes; i++ )
+    {
+        CleanTaps( &p_sys->plane[i].cols );
+        CleanTaps( &p_sys->plane[i].rows );
+#ifdef SCALE_HAVE_SIMD
+        free( p_sys->plane[i].simd.coefs16 );
+        free( p_sys->plane[i].simd.coefs );
+        free( p_sys->plane[i].simd.offsets );
+#endif
+    }
+}
+
+static int Setup( filter_t *p_filter, enum scale_kernel kernel )
+{
+    const video_format_t *fmt_in = &p_filter->fmt_in.video;
+    const video_format_t *fmt_out = &p_filter->fmt_out.video;
+    const vlc_chroma_description_t *desc =
+        vlc_fourcc_GetChromaDescription( fmt_in->i_chroma );
+    struct scale_format fmt;
+    unsigned comps;
+
+    if( desc == NULL || !SetFormat( &fmt, &comps, fmt_in->i_chroma, desc ) )
+        return VLC_EINVAL;
+    /* Blending palette indexes makes no sense */
+    if( fmt_in->i_chroma == VLC_CODEC_YUVP )
+        kernel = KERNEL_NEAREST;
+
+    filter_sys_t *p_sys = calloc( 1, sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+    p_sys->fmt = fmt;
+    p_sys->planes = desc->plane_count;
+
+    int ret = VLC_SUCCESS;
+    unsigned ring_size = 1;
+    for( unsigned i = 0; i < p_sys->planes && ret == VLC_SUCCESS; i++ )
+    {
+        struct scale_plane *plane = &p_sys->plane[i];
+        vlc_rational_t ratio = desc->p[i].w;
+
+        plane->comps = i == 0 && comps == 2 ? 1 : comps;
+        if( plane->comps == 2 )
+            ratio.num /= 2;
+        ret = SetupPlane( plane, kernel, fmt_in, fmt_out, ratio,
+                          desc->p[i].h );
+#ifdef SCALE_HAVE_SIMD
+        if( ret == VLC_SUCCESS )
+            ret = SetupSIMD( plane, &fmt );
+#endif
+        ring_size = __MAX(ring_size, plane->rows.taps);
     }
+
+    /* Rows pointers, rings of intermediate rows and tags of each slice, in
+     * their own cache lines */
+    const size_t ring_bytes = (ring_size * (sizeof(const int32_t *)
+                                            + TILE_SAMPLES * sizeof(int32_t)
+                                            + sizeof(int)) + 63) & ~(size_t)63;
+    if( ret == VLC_SUCCESS )
+    {
+        p_sys->ring_buffer = aligned_alloc( 64,
+                                            VLC_FILTER_SLICES_MAX * ring_bytes );
+        if( unlikely(p_sys->ring_buffer == NULL) )
+            ret = VLC_ENOMEM;
+    }
+    if( ret != VLC_SUCCESS )
+    {
+        CleanPlanes( p_sys );
+        free( p_sys );
+        return ret;
+    }
+
+    p_sys->ring_size = ring_size;
+    for( unsigned i = 0; i < VLC_FILTER_SLICES_MAX; i++ )
+    {
+        struct scale_ring *ring = &p_sys->rings[i];
+        uint8_t *base = (uint8_t *)p_sys->ring_buffer + i * ring_bytes;
+
+        ring->taps = (const int32_t **)base;
+        ring->rows = (int32_t *)&ring->taps[ring_size];
+        ring->tags = (int *)&ring->rows[ring_size * TILE_SAMPLES];
+    }
+
+    p_sys->cpu = SCALE_CPU_C;
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        p_sys->cpu = SCALE_CPU_AVX2;
+#endif
+#ifdef SCALE_HAVE_NEON
+    p_sys->cpu = SCALE_CPU_NEON;
+#endif
+
+    msg_Dbg( p_filter, "%4.4s %ux%u -> %ux%u, %s kernel, %ux%u taps, %s",
+             (const char *)&fmt_in->i_chroma, fmt_in->i_visible_width,
+             fmt_in->i_visible_height, fmt_out->i_visible_width,
+             fmt_out->i_visible_height, kernel_list[kernel],
+             p_sys->plane[0].cols.taps, p_sys->plane[0].rows.taps,
+             cpu_names[p_sys->cpu] );
+
+    p_filter->p_sys = p_sys;
+    p_filter->ops = &Resample_ops;
+    return VLC_SUCCESS;
+}
+
+static int OpenFilter( filter_t *p_filter )
+{
+    if( !video_format_IsSameChroma( &p_filter->fmt_in.video,
+                                    &p_filter->fmt_out.video ) )
+        return VLC_EINVAL;
+
+    if( p_filter->fmt_in.video.orientation != p_filter->fmt_out.video.orientation )
+        return VLC_EGENERIC;
+
+#warning Converter cannot (really) change output format.
+    video_format_ScaleCropAr( &p_filter->fmt_out.video, &p_filter->fmt_in.video );
+
+    enum scale_kernel kernel = KERNEL_BICUBIC;
+    char *name = var_InheritString( p_filter, "scale-kernel" );
+    for( size_t i = 0; name != NULL && i < ARRAY_SIZE(kernel_list); i++ )
+        if( !strcmp( name, kernel_list[i] ) )
+            kernel = i;
+    free( name );
+
+    return Setup( p_filter, kernel );
+}
+
+static void CloseFilter( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    CleanPlanes( p_sys );
+    aligned_free( p_sys->ring_buffer );
+    free( p_sys );
 }
@@ -154,24 +154,41 @@ static void Destroy( filter_t *p_filter )
 #define IS_YUV_420_10BITS(fmt) (fmt == VLC_CODEC_I420_10L ||    \
                                 fmt == VLC_CODEC_I420_10B)
 
-#define SHARPEN_FRAME(maxval, data_t)                                   \
+struct sharpen_plane
+{
+    const plane_t *src;
+    plane_t *dst;
+    int sigma;
+};
+
+#define SHARPEN_ROWS(maxval, data_t)                                    \
     do                                                                  \
     {                                                                   \
         assert((maxval) >= 0);                                          \
-        data_t *restrict p_src = (data_t *)p_pic->p[Y_PLANE].p_pixels;  \
-        data_t *restrict p_out = (data_t *)p_outpic->p[Y_PLANE].p_pixels; \
+        const struct sharpen_plane *ctx = opaque;                       \
+        const data_t *restrict p_src = (const data_t *)ctx->src->p_pixels; \
+        data_t *restrict p_out = (data_t *)ctx->dst->p_pixels;          \
         const unsigned data_sz = sizeof(data_t);                        \
-        const int i_src_line_len = p_pic->p[Y_PLANE].i_pitch / data_sz; \
-        const int i_out_line_len = p_outpic->p[Y_PLANE].i_pitch / data_sz; \
-        const int sigma = atomic_load(&p_sys->sigma);         \
-                                                                        \
-        memcpy(p_out, p_src, i_visible_pitch);                          \
+        const int i_src_line_len = ctx->src->i_pitch / data_sz;         \
+        const int i_out_line_len = ctx->dst->i_pitch / data_sz;         \
+        const unsigned i_visible_lines = ctx->src->i_visible_lines;     \
+        const unsigned i_visible_pitch = ctx->src->i_visible_pitch;     \
+        const unsigned i_width = i_visible_pitch / data_sz;             \
+        const int sigma = ctx->sigma;                                   \
                                                                         \
-        for( unsigned i = 1; i < i_visible_lines - 1; i++ )             \
+        for( unsigned i = slice->first; i < slice->first + slice->count; i++ ) \
         {                                                               \
+            /* The first and last lines are copied */                   \
+            if( i == 0 || i == i_visible_lines - 1 )                    \
+            {                                                           \
+                memcpy(&p_out[i * i_out_line_len],                      \
+                       &p_src[i * i_src_line_len], i_visible_pitch);    \
+                continue;                                               \
+            }                                                           \
+                                                                        \
             p_out[i * i_out_line_len] = p_src[i * i_src_line_len];      \
                                                                         \
-            for( unsigned j = data_sz; j < i_visible_pitch - 1; j++ )   \
+            for( unsigned j = 1; j < i_width - 1; j++ )                 \
             {                                                           \
                 const int line_idx_1 = (i - 1) * i_src_line_len;        \
                 const int line_idx_2 = i * i_src_line_len;              \
@@ -191,27 +208,37 @@ static void Destroy( filter_t *p_filter )
                 p_out[i * i_out_line_len + j] =                         \
                     VLC_CLIP( p_src[line_idx_2 + j] + pix, 0, maxval);  \
             }                                                           \
-            p_out[i * i_out_line_len + i_visible_pitch / data_sz - 1] = \
-                p_src[i * i_src_line_len + i_visible_pitch / data_sz - 1];  \
+            p_out[i * i_out_line_len + i_width - 1] =                   \
+                p_src[i * i_src_line_len + i_width - 1];                \
         }                                                               \
-        memcpy(&p_out[(i_visible_lines - 1) * i_out_line_len],          \
-               &p_src[(i_visible_lines - 1) * i_src_line_len],          \
-               i_visible_pitch);                                        \
     } while (0)
 
-static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+static const int v1 = -1;
+static const int v2 = 3; /* 2^3 = 8 */
+
+static void SharpenSlice8( void *opaque, const struct vlc_filter_slice *slice )
 {
-    const int v1 = -1;
-    const int v2 = 3; /* 2^3 = 8 */
-    const unsigned i_visible_lines = p_pic->p[Y_PLANE].i_visible_lines;
-    const unsigned i_visible_pitch = p_pic->p[Y_PLANE].i_visible_pitch;
+    SHARPEN_ROWS(255, uint8_t);
+}
 
-    filter_sys_t *p_sys = p_filter->p_sys;
+static void SharpenSlice16( void *opaque, const struct vlc_filter_slice *slice )
+{
+    SHARPEN_ROWS(1023, uint16_t);
+}
 
-    if (!IS_YUV_420_10BITS(p_pic->format.i_chroma))
-        SHARPEN_FRAME(255, uint8_t);
-    else
-        SHARPEN_FRAME(1023, uint16_t);
+static void Filter( filter_t *p_filter, picture_t *p_pic, picture_t *p_outpic )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    struct sharpen_plane plane = {
+        .src = &p_pic->p[Y_PLANE],
+        .dst = &p_outpic->p[Y_PLANE],
+        .sigma = atomic_load(&p_sys->sigma),
+    };
+
+    /* Each line reads the lines above and below */
+    filter_ExecuteSlices( p_filter, plane.src->i_visible_lines, 1, 1,
+                          IS_YUV_420_10BITS(p_pic->format.i_chroma)
+                              ? SharpenSlice16 : SharpenSlice8, &plane );
 
     plane_CopyPixels( &p_outpic->p[U_PLANE], &p_pic->p[U_PLANE] );
     plane_CopyPixels( &p_outpic->p[V_PLANE], &p_pic->p[V_PLANE] );
@@ -196,6 +196,34 @@
 # define GL_NUM_EXTENSIONS 0x821D
 #endif
 
+#ifndef GL_MAP_WRITE_BIT
+# define GL_MAP_WRITE_BIT 0x0002
+#endif
+
+#ifndef GL_MAP_PERSISTENT_BIT
+# define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+
+#ifndef GL_MAP_COHERENT_BIT
+# define GL_MAP_COHERENT_BIT 0x0080
+#endif
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+# define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+# define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+
+#ifndef GL_TIMEOUT_EXPIRED
+# define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+
+#ifndef GL_WAIT_FAILED
+# define GL_WAIT_FAILED 0x911D
+#endif
+
 #ifndef APIENTRY
 # define APIENTRY
 #endif
@@ -36,13 +36,23 @@
 #include "interop.h"
 
 #define PBO_DISPLAY_COUNT 2 /* Double buffering */
+#define PERSISTENT_DISPLAY_COUNT 3 /* Triple buffering */
 typedef struct
 {
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
+    PFNGLDELETESYNCPROC DeleteSync;
     GLuint      buffers[PICTURE_PLANE_MAX];
     size_t      bytes[PICTURE_PLANE_MAX];
+    GLsync      fence; /* last upload reading from the buffers */
 } picture_sys_t;
 
+enum upload_mode
+{
+    UPLOAD_SW,
+    UPLOAD_PBO,
+    UPLOAD_PERSISTENT,
+};
+
 struct priv
 {
     bool   has_gl_3;
@@ -51,8 +61,9 @@ struct priv
     void * texture_temp_buf;
     size_t texture_temp_buf_size;
     struct {
-        picture_t *display_pics[PBO_DISPLAY_COUNT];
+        picture_t *display_pics[PERSISTENT_DISPLAY_COUNT];
         size_t display_idx;
+        size_t display_count;
     } pbo;
 
 #define OPENGL_VTABLE_F(X) \
@@ -71,9 +82,18 @@ struct priv
         X(PFNGLDELETEBUFFERSPROC,   DeleteBuffers) \
         X(PFNGLGENBUFFERSPROC,      GenBuffers) \
         X(PFNGLPIXELSTOREIPROC,     PixelStorei)
+
+/* Only available with buffer storage and sync objects */
+#define OPENGL_PERSISTENT_VTABLE_F(X) \
+        X(PFNGLBUFFERSTORAGEPROC,   BufferStorage) \
+        X(PFNGLMAPBUFFERRANGEPROC,  MapBufferRange) \
+        X(PFNGLFENCESYNCPROC,       FenceSync) \
+        X(PFNGLCLIENTWAITSYNCPROC,  ClientWaitSync) \
+        X(PFNGLDELETESYNCPROC,      DeleteSync)
     struct {
 #define DECLARE_SYMBOL(type, name) type name;
         OPENGL_VTABLE_F(DECLARE_SYMBOL)
+        OPENGL_PERSISTENT_VTABLE_F(DECLARE_SYMBOL)
     } gl;
 };
 
@@ -82,6 +102,9 @@ pbo_picture_destroy(picture_t *pic)
 {
     picture_sys_t *picsys = pic->p_sys;
 
+    if (picsys->fence != NULL)
+        picsys->DeleteSync(picsys->fence);
+    /* Deleting the buffers also unmaps the persistent ones */
     picsys->DeleteBuffers(pic->i_planes, picsys->buffers);
 
     free(picsys);
@@ -108,6 +131,7 @@ pbo_picture_create(const struct vlc_gl_interop *interop)
 
     priv->gl.GenBuffers(pic->i_planes, picsys->buffers);
     picsys->DeleteBuffers = priv->gl.DeleteBuffers;
+    picsys->DeleteSync = priv->gl.DeleteSync;
 
     /* XXX: needed since picture_NewFromResource override pic planes */
     if (picture_Setup(pic, &interop->fmt_out))
@@ -159,17 +183,52 @@ pbo_data_alloc(const struct vlc_gl_interop *interop, picture_t *pic)
 }
 
 static int
-pbo_pics_alloc(const struct vlc_gl_interop *interop)
+persistent_data_alloc(const struct vlc_gl_interop *interop, picture_t *pic)
+{
+    const struct priv *priv = interop->priv;
+    picture_sys_t *picsys = pic->p_sys;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+                           | GL_MAP_COHERENT_BIT;
+
+    priv->gl.GetError();
+
+    for (int i = 0; i < pic->i_planes; ++i)
+    {
+        priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, picsys->buffers[i]);
+        priv->gl.BufferStorage(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i], NULL,
+                               flags);
+
+        /* The buffer stays mapped until it is deleted, so that uploads do
+         * not need to map it or to go through glBufferSubData(). */
+        void *pixels = priv->gl.MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                                               picsys->bytes[i], flags);
+        if (pixels == NULL || priv->gl.GetError() != GL_NO_ERROR)
+        {
+            msg_Err(interop->gl, "could not map persistent PBO buffers");
+            return VLC_EGENERIC;
+        }
+        pic->p[i].p_pixels = pixels;
+    }
+    return VLC_SUCCESS;
+}
+
+static int
+pbo_pics_alloc(const struct vlc_gl_interop *interop, bool persistent)
 {
     struct priv *priv = interop->priv;
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT; ++i)
+
+    priv->pbo.display_count = persistent ? PERSISTENT_DISPLAY_COUNT
+                                         : PBO_DISPLAY_COUNT;
+    for (size_t i = 0; i < priv->pbo.display_count; ++i)
     {
         picture_t *pic = priv->pbo.display_pics[i] =
             pbo_picture_create(interop);
         if (pic == NULL)
             goto error;
 
-        if (pbo_data_alloc(interop, pic) != VLC_SUCCESS)
+        int ret = persistent ? persistent_data_alloc(interop, pic)
+                             : pbo_data_alloc(interop, pic);
+        if (ret != VLC_SUCCESS)
             goto error;
     }
 
@@ -178,30 +237,28 @@ pbo_pics_alloc(const struct vlc_gl_interop *interop)
 
     return VLC_SUCCESS;
 error:
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
-        picture_Release(priv->pbo.display_pics[i]);
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    for (size_t i = 0; i < priv->pbo.display_count; ++i)
+    {
+        if (priv->pbo.display_pics[i] != NULL)
+            picture_Release(priv->pbo.display_pics[i]);
+        priv->pbo.display_pics[i] = NULL;
+    }
+    priv->pbo.display_count = 0;
     return VLC_EGENERIC;
 }
 
-static int
-tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
-              const int32_t tex_width[], const int32_t tex_height[],
-              picture_t *pic, const size_t *plane_offset)
+/* Upload the textures from the PBO of each plane, laid out as in pic */
+static void
+pbo_upload_textures(const struct vlc_gl_interop *interop, uint32_t textures[],
+                    const int32_t tex_width[], const int32_t tex_height[],
+                    const picture_t *pic, const picture_sys_t *p_sys)
 {
-    (void) plane_offset; assert(plane_offset == NULL);
     struct priv *priv = interop->priv;
 
-    picture_t *display_pic = priv->pbo.display_pics[priv->pbo.display_idx];
-    picture_sys_t *p_sys = display_pic->p_sys;
-    priv->pbo.display_idx = (priv->pbo.display_idx + 1) % PBO_DISPLAY_COUNT;
-
     for (int i = 0; i < pic->i_planes; i++)
     {
-        GLsizeiptr size = pic->p[i].i_lines * pic->p[i].i_pitch;
-        const GLvoid *data = pic->p[i].p_pixels;
-        priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER,
-                           p_sys->buffers[i]);
-        priv->gl.BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+        priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, p_sys->buffers[i]);
 
         priv->gl.ActiveTexture(GL_TEXTURE0 + i);
         priv->gl.BindTexture(interop->tex_target, textures[i]);
@@ -227,6 +284,83 @@ tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
                                interop->texs[1].format, interop->texs[1].type, NULL);
         priv->gl.PixelStorei(GL_UNPACK_ROW_LENGTH, 0);
     }
+}
+
+static int
+tc_pbo_update(const struct vlc_gl_interop *interop, uint32_t textures[],
+              const int32_t tex_width[], const int32_t tex_height[],
+              picture_t *pic, const size_t *plane_offset)
+{
+    (void) plane_offset; assert(plane_offset == NULL);
+    struct priv *priv = interop->priv;
+
+    picture_t *display_pic = priv->pbo.display_pics[priv->pbo.display_idx];
+    picture_sys_t *p_sys = display_pic->p_sys;
+    priv->pbo.display_idx = (priv->pbo.display_idx + 1) % PBO_DISPLAY_COUNT;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        GLsizeiptr size = pic->p[i].i_lines * pic->p[i].i_pitch;
+        const GLvoid *data = pic->p[i].p_pixels;
+        priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER,
+                           p_sys->buffers[i]);
+        priv->gl.BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+    }
+
+    pbo_upload_textures(interop, textures, tex_width, tex_height, pic, p_sys);
+    GL_ASSERT_NOERROR(&priv->gl);
+
+    /* turn off pbo */
+    priv->gl.BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    return VLC_SUCCESS;
+}
+
+static int
+tc_persistent_update(const struct vlc_gl_interop *interop, uint32_t textures[],
+                     const int32_t tex_width[], const int32_t tex_height[],
+                     picture_t *pic, const size_t *plane_offset)
+{
+    (void) plane_offset; assert(plane_offset == NULL);
+    struct priv *priv = interop->priv;
+
+    picture_t *display_pic = priv->pbo.display_pics[priv->pbo.display_idx];
+    picture_sys_t *p_sys = display_pic->p_sys;
+    priv->pbo.display_idx =
+        (priv->pbo.display_idx + 1) % PERSISTENT_DISPLAY_COUNT;
+
+    /* The buffers are only written again once the GPU is done reading the
+     * upload issued PERSISTENT_DISPLAY_COUNT frames ago, which is usually
+     * the case already. */
+    if (p_sys->fence != NULL)
+    {
+        GLenum status;
+        do
+            status = priv->gl.ClientWaitSync(p_sys->fence,
+                                             GL_SYNC_FLUSH_COMMANDS_BIT,
+                                             UINT64_C(1000000000));
+        while (status == GL_TIMEOUT_EXPIRED);
+
+        priv->gl.DeleteSync(p_sys->fence);
+        p_sys->fence = NULL;
+        if (status == GL_WAIT_FAILED)
+        {
+            msg_Err(interop->gl, "could not wait for the PBO upload");
+            return VLC_EGENERIC;
+        }
+    }
+
+    /* The decoder pictures are not allocated from the mapped buffers, so
+     * they are still copied into them: the decoder owner creates its pool
+     * before the display is opened, and filters or converters may sit in
+     * between, so there is no display pool to back with these buffers.
+     * The mapping is coherent: no flush is needed before the texture upload
+     * reads from the buffers. */
+    picture_CopyPixels(display_pic, pic);
+
+    pbo_upload_textures(interop, textures, tex_width, tex_height,
+                        display_pic, p_sys);
+    p_sys->fence = priv->gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     GL_ASSERT_NOERROR(&priv->gl);
 
     /* turn off pbo */
@@ -680,14 +814,40 @@ static void
 opengl_interop_generic_deinit(struct vlc_gl_interop *interop)
 {
     struct priv *priv = interop->priv;
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
+    for (size_t i = 0; i < priv->pbo.display_count; ++i)
         picture_Release(priv->pbo.display_pics[i]);
     free(priv->texture_temp_buf);
     free(priv);
 }
 
+static bool
+has_persistent_pbo(const struct vlc_gl_interop *interop,
+                   struct vlc_gl_extension_vt *extension_vt)
+{
+    const struct priv *priv = interop->priv;
+
+#define CHECK_SYMBOL(type, name) \
+    if (priv->gl.name == NULL) \
+        return false;
+    OPENGL_PERSISTENT_VTABLE_F(CHECK_SYMBOL);
+#undef CHECK_SYMBOL
+
+    if (interop->gl->api_type == VLC_OPENGL_ES2)
+        /* Sync objects are core since OpenGL ES 3.0 */
+        return priv->has_gl_3
+            && vlc_gl_HasExtension(extension_vt, "GL_EXT_buffer_storage");
+
+    const unsigned char *ogl_version = priv->gl.GetString(GL_VERSION);
+    const bool has_sync = strverscmp((const char *)ogl_version, "3.2") >= 0
+        || vlc_gl_HasExtension(extension_vt, "GL_ARB_sync");
+    return has_sync
+        && (strverscmp((const char *)ogl_version, "4.4") >= 0
+         || vlc_gl_HasExtension(extension_vt, "GL_ARB_buffer_storage"));
+}
+
 static int
-opengl_interop_generic_init(struct vlc_gl_interop *interop, bool allow_dr)
+opengl_interop_generic_init(struct vlc_gl_interop *interop,
+                            enum upload_mode mode)
 {
 
     struct priv *priv = calloc(1, sizeof(struct priv));
@@ -702,6 +862,14 @@ opengl_interop_generic_init(struct vlc_gl_interop *interop, bool allow_dr)
 
     OPENGL_VTABLE_F(LOAD_SYMBOL);
 
+#define LOAD_OPTIONAL_SYMBOL(type, name) \
+    priv->gl.name = vlc_gl_GetProcAddress(interop->gl, "gl" # name);
+
+    if (mode == UPLOAD_PERSISTENT)
+    {
+        OPENGL_PERSISTENT_VTABLE_F(LOAD_OPTIONAL_SYMBOL);
+    }
+
     struct vlc_gl_extension_vt extension_vt;
     vlc_gl_LoadExtensionFunctions(interop->gl, &extension_vt);
 
@@ -790,7 +958,7 @@ interop_init:
     };
     interop->ops = &ops;
 
-    if (allow_dr && priv->has_unpack_subimage)
+    if (mode != UPLOAD_SW && priv->has_unpack_subimage)
     {
         /* Ensure we do direct rendering / PBO with OpenGL 3.0 or higher. */
         const unsigned char *ogl_version = priv->gl.GetString(GL_VERSION);
@@ -800,9 +968,26 @@ interop_init:
             (vlc_gl_HasExtension(&extension_vt, "GL_ARB_pixel_buffer_object") ||
              vlc_gl_HasExtension(&extension_vt, "GL_EXT_pixel_buffer_object"));
 
+        if (mode == UPLOAD_PERSISTENT)
+        {
+            /* Without persistent mapping, let the plain PBO interop probe */
+            if (!has_pbo || !has_persistent_pbo(interop, &extension_vt)
+             || pbo_pics_alloc(interop, true) != VLC_SUCCESS)
+                goto error;
+
+            static const struct vlc_gl_interop_ops persistent_ops = {
+                .allocate_textures = tc_common_allocate_textures,
+                .update_textures = tc_persistent_update,
+                .close = opengl_interop_generic_deinit,
+            };
+            interop->ops = &persistent_ops;
+            msg_Dbg(interop->gl, "persistent PBO support enabled");
+            return VLC_SUCCESS;
+        }
+
         const bool supports_pbo = has_pbo && priv->gl.BufferData
             && priv->gl.BufferSubData;
-        if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
+        if (supports_pbo && pbo_pics_alloc(interop, false) == VLC_SUCCESS)
         {
             static const struct vlc_gl_interop_ops pbo_ops = {
                 .allocate_textures = tc_common_allocate_textures,
@@ -813,6 +998,8 @@ interop_init:
             msg_Dbg(interop->gl, "PBO support enabled");
         }
     }
+    else if (mode == UPLOAD_PERSISTENT)
+        goto error;
 
     return VLC_SUCCESS;
 
@@ -824,12 +1011,17 @@ error:
 
 static int OpenInteropSW(struct vlc_gl_interop *interop)
 {
-    return opengl_interop_generic_init(interop, false);
+    return opengl_interop_generic_init(interop, UPLOAD_SW);
 }
 
 static int OpenInteropDirectRendering(struct vlc_gl_interop *interop)
 {
-    return opengl_interop_generic_init(interop, true);
+    return opengl_interop_generic_init(interop, UPLOAD_PBO);
+}
+
+static int OpenInteropPersistent(struct vlc_gl_interop *interop)
+{
+    return opengl_interop_generic_init(interop, UPLOAD_PERSISTENT);
 }
 
 vlc_module_begin ()
@@ -843,4 +1035,9 @@ vlc_module_begin ()
     set_callback(OpenInteropDirectRendering)
     set_capability("opengl sw interop", 2)
     add_shortcut("pbo")
+
+    add_submodule()
+    set_callback(OpenInteropPersistent)
+    set_capability("opengl sw interop", 3)
+    add_shortcut("persistent")
 vlc_module_end ()
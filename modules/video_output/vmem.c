@@ -227,7 +227,7 @@ static void Prepare(vout_display_t *vd, picture_t *pic,
             locked->p[i].i_pitch  = sys->pitches[i];
         }
 
-        picture_CopyPixels(locked, pic);
+        picture_CopyPixelsThreaded(vd, locked, pic);
         picture_Release(locked);
     }
 
@@ -51,6 +51,8 @@
 #include "../clock/clock.h"
 #include "input_internal.h"
 #include "decoder.h"
+#include "decoder_drop.h"
+#include "decoder_cache.h"
 #include "resource.h"
 #include "libvlc.h"
 
@@ -122,6 +124,7 @@ struct vlc_input_decoder_t
     const char *psz_id;
 
     bool hw_dec;
+    bool fast_preroll;
 
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
@@ -139,6 +142,10 @@ struct vlc_input_decoder_t
     es_format_t pktz_fmt_in;
     bool b_packetizer;
 
+    /* Packetizer statistics, owned by the decoder thread */
+    uint64_t i_input_frames;
+    uint64_t i_packetizer_allocs;
+
     /* Current format in use by the output */
     es_format_t    fmt;
     vlc_video_context *vctx;
@@ -191,6 +198,10 @@ struct vlc_input_decoder_t
     /* -- Theses variables need locking on read *and* write -- */
     /* Preroll */
     vlc_tick_t i_preroll_end;
+    /* Latest date of the input frames flagged as preroll */
+    vlc_tick_t i_preroll_date;
+    /* Non-reference frames skipped during the current preroll */
+    unsigned preroll_skipped;
 
 #define PREROLL_NONE   VLC_TICK_MIN
 #define PREROLL_FORCED VLC_TICK_MAX
@@ -209,6 +220,31 @@ struct vlc_input_decoder_t
     bool b_first;
     bool b_has_data;
 
+    /* Frame dropping policy */
+    struct vlc_decoder_drop drop;
+    atomic_uint drop_level;
+    atomic_uint frames_dropped;
+
+    /* Decoded pictures cache */
+    struct
+    {
+        struct vlc_decoder_cache *cache;
+        char *key;
+        /* Entry being recorded, only accessed by the decoder thread */
+        struct vlc_decoder_cache_entry *rec;
+        size_t rec_frames;
+        /* Set around the decoder module calls while recording, pictures
+         * queued from other threads cannot be associated with input frames */
+        atomic_bool in_decode;
+        unsigned long thread_id;
+        atomic_bool rec_failed;
+        /* Entry being played instead of decoding */
+        struct vlc_decoder_cache_entry *entry;
+        size_t cursor;
+        bool format_set;
+        uint64_t served;
+    } cache;
+
     /* Flushing */
     bool flushing;
     bool b_draining;
@@ -421,6 +457,12 @@ static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
         return VLC_EGENERIC;
     }
 
+    if( p_owner->cache.rec != NULL )
+    {   /* The recording would not match the output of a single decoder */
+        vlc_decoder_cache_entry_Release( p_owner->cache.rec );
+        p_owner->cache.rec = NULL;
+    }
+
     /* Restart the decoder module */
     vlc_fifo_Unlock(p_owner->p_fifo);
     decoder_Clean( p_dec );
@@ -444,7 +486,15 @@ static int DecoderThread_Reload( vlc_input_decoder_t *p_owner,
         }
     }
 
+    unsigned target_width = p_dec->i_target_width;
+    unsigned target_height = p_dec->i_target_height;
+    unsigned threads = p_dec->i_threads;
+    enum vlc_decoder_threading threading = p_dec->threading;
     decoder_Init(p_dec, &p_owner->dec_fmt_in, &fmt_in);
+    p_dec->i_target_width = target_width;
+    p_dec->i_target_height = target_height;
+    p_dec->i_threads = threads;
+    p_dec->threading = threading;
     vlc_fifo_Unlock(p_owner->p_fifo);
     if (LoadDecoder(p_dec, false, &p_owner->dec_fmt_in))
     {
@@ -998,6 +1048,46 @@ static vlc_tick_t ModuleThread_GetDisplayDate( decoder_t *p_dec,
     return conv_ts;
 }
 
+static enum vlc_decoder_drop_level ModuleThread_GetDropLevel( decoder_t *p_dec )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    return atomic_load_explicit( &p_owner->drop_level, memory_order_relaxed );
+}
+
+static void ModuleThread_NotifyDropped( decoder_t *p_dec, unsigned count )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    atomic_fetch_add_explicit( &p_owner->frames_dropped, count,
+                               memory_order_relaxed );
+}
+
+/* Feeds the frame dropping policy with the lateness of a queued picture */
+static void ModuleThread_UpdateDropLevel( vlc_input_decoder_t *p_owner,
+                                          vlc_tick_t i_ts )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t display_date = ModuleThread_GetDisplayDate( p_dec, now, i_ts );
+
+    if( display_date == VLC_TICK_INVALID )
+        return;
+
+    vlc_fifo_Lock( p_owner->p_fifo );
+    bool changed = vlc_decoder_drop_Update( &p_owner->drop, now, display_date );
+    enum vlc_decoder_drop_level level = p_owner->drop.level;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+
+    if( changed )
+    {
+        atomic_store_explicit( &p_owner->drop_level, level,
+                               memory_order_relaxed );
+        msg_Dbg( p_dec, "frame dropping: %s",
+                 vlc_decoder_drop_LevelName( level ) );
+    }
+}
+
 static float ModuleThread_GetDisplayRate( decoder_t *p_dec )
 {
     vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
@@ -1059,10 +1149,27 @@ static int DecoderWaitUnblock( vlc_input_decoder_t *p_owner )
     return VLC_SUCCESS;
 }
 
-static inline void DecoderUpdatePreroll( vlc_tick_t *pi_preroll, const vlc_frame_t *p )
+static inline void DecoderUpdatePreroll( vlc_input_decoder_t *p_owner,
+                                        const vlc_frame_t *p )
 {
+    vlc_tick_t *pi_preroll = &p_owner->i_preroll_end;
+
+    if( *pi_preroll == PREROLL_NONE )
+    {
+        p_owner->i_preroll_date = VLC_TICK_INVALID;
+        p_owner->preroll_skipped = 0;
+    }
+
     if( p->i_flags & BLOCK_FLAG_PREROLL )
+    {
         *pi_preroll = PREROLL_FORCED;
+
+        vlc_tick_t date = p->i_pts != VLC_TICK_INVALID ? p->i_pts : p->i_dts;
+        if( date != VLC_TICK_INVALID
+         && ( p_owner->i_preroll_date == VLC_TICK_INVALID
+           || date > p_owner->i_preroll_date ) )
+            p_owner->i_preroll_date = date;
+    }
     /* Check if we can use the packet for end of preroll */
     else if( (p->i_flags & BLOCK_FLAG_DISCONTINUITY) &&
              (p->i_buffer == 0 || (p->i_flags & BLOCK_FLAG_CORRUPTED)) )
@@ -1319,7 +1426,8 @@ static void ModuleThread_QueueCc( decoder_t *p_videodec, vlc_frame_t *p_cc,
     vlc_fifo_Unlock(p_owner->p_fifo);
 }
 
-static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_picture )
+static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_picture,
+                                   vlc_tick_t *restrict queued_ts )
 {
     decoder_t *p_dec = &p_owner->dec;
 
@@ -1352,7 +1460,8 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
 
     if( unlikely(prerolled) )
     {
-        msg_Dbg( p_dec, "end of video preroll" );
+        msg_Dbg( p_dec, "end of video preroll (%u frames skipped)",
+                 p_owner->preroll_skipped );
 
         if( p_vout )
             vout_FlushAll( p_vout );
@@ -1389,11 +1498,30 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
         /* Ensure no earlier higher pts breaks still state */
         vout_Flush( p_vout, p_picture->date );
     }
+    else if( !p_picture->b_force )
+        *queued_ts = p_picture->date;
     vout_PutPicture( p_vout, p_picture );
 
     return VLC_SUCCESS;
 }
 
+static void ModuleThread_CachePicture( vlc_input_decoder_t *p_owner,
+                                       const picture_t *p_pic )
+{
+    /* Only the decoder thread, from the decoder module, can record */
+    if( atomic_load_explicit( &p_owner->cache.in_decode, memory_order_acquire )
+     && p_owner->cache.thread_id == vlc_thread_id() )
+    {
+        if( vlc_decoder_cache_entry_AddPicture( p_owner->cache.rec,
+                                                p_pic ) != VLC_SUCCESS )
+            atomic_store_explicit( &p_owner->cache.rec_failed, true,
+                                   memory_order_relaxed );
+    }
+    else
+        atomic_store_explicit( &p_owner->cache.rec_failed, true,
+                               memory_order_relaxed );
+}
+
 static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
 {
     assert( p_pic );
@@ -1406,9 +1534,13 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
                             "OUT", p_pic->date );
     }
 
+    if( p_owner->cache.cache != NULL )
+        ModuleThread_CachePicture( p_owner, p_pic );
+
     vlc_fifo_Lock( p_owner->p_fifo );
 
-    int success = ModuleThread_PlayVideo( p_owner, p_pic );
+    vlc_tick_t queued_ts = VLC_TICK_INVALID;
+    int success = ModuleThread_PlayVideo( p_owner, p_pic, &queued_ts );
 
     unsigned displayed = 0;
     unsigned vout_lost = 0;
@@ -1422,7 +1554,16 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
 
     vlc_fifo_Unlock(p_owner->p_fifo);
 
-    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late);
+    if( queued_ts != VLC_TICK_INVALID && p_dec->b_frame_drop_allowed )
+        ModuleThread_UpdateDropLevel( p_owner, queued_ts );
+
+    unsigned dropped = atomic_exchange_explicit( &p_owner->frames_dropped, 0,
+                                                 memory_order_relaxed );
+    enum vlc_decoder_drop_level drop_level =
+        atomic_load_explicit( &p_owner->drop_level, memory_order_relaxed );
+
+    decoder_Notify(p_owner, on_new_video_stats, 1, vout_lost, displayed, vout_late,
+                   dropped, drop_level);
 }
 
 static vlc_decoder_device * thumbnailer_get_device( decoder_t *p_dec )
@@ -1612,6 +1753,124 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
     vlc_fifo_Unlock(p_owner->p_fifo);
 }
 
+static void DecoderCacheInit( vlc_input_decoder_t *p_owner,
+                              const struct vlc_input_decoder_cfg *cfg )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    struct vlc_decoder_cache *cache =
+        input_resource_GetDecoderCache( p_owner->p_resource );
+    if( cache == NULL )
+        return;
+
+    if( asprintf( &p_owner->cache.key, "%s#%s", cfg->item_uri,
+                  cfg->str_id ) == -1 )
+    {
+        p_owner->cache.key = NULL;
+        return;
+    }
+    p_owner->cache.cache = cache;
+
+    p_owner->cache.entry = vlc_decoder_cache_Get( cache, p_owner->cache.key,
+                                                  cfg->fmt );
+    if( p_owner->cache.entry != NULL )
+        msg_Dbg( p_dec, "playing decoded pictures from the cache" );
+    else
+        p_owner->cache.rec = vlc_decoder_cache_entry_New( cache,
+                                                          p_owner->cache.key,
+                                                          cfg->fmt );
+}
+
+static void DecoderThread_CacheAbort( vlc_input_decoder_t *p_owner,
+                                      const char *reason )
+{
+    if( p_owner->cache.rec == NULL )
+        return;
+
+    msg_Dbg( &p_owner->dec, "not caching decoded pictures: %s", reason );
+    vlc_decoder_cache_entry_Release( p_owner->cache.rec );
+    p_owner->cache.rec = NULL;
+}
+
+static void DecoderThread_CacheComplete( vlc_input_decoder_t *p_owner )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    if( atomic_load_explicit( &p_owner->cache.rec_failed,
+                              memory_order_relaxed ) )
+    {
+        DecoderThread_CacheAbort( p_owner, "too large or not in system memory" );
+        return;
+    }
+
+    msg_Dbg( p_dec, "caching the decoded pictures of %zu frames",
+             p_owner->cache.rec_frames );
+    vlc_decoder_cache_Put( p_owner->cache.cache, p_owner->cache.rec,
+                           &p_dec->fmt_out.video );
+    p_owner->cache.rec = NULL;
+}
+
+static inline vlc_tick_t DecoderCacheFrameDate( const vlc_frame_t *frame )
+{
+    if( frame == NULL )
+        return VLC_TICK_INVALID; /* drain */
+    return frame->i_pts != VLC_TICK_INVALID ? frame->i_pts : frame->i_dts;
+}
+
+/* Plays the pictures the decoder output after this frame when it was
+ * recorded, returns false if the frame needs to be decoded */
+static bool DecoderThread_PlayCached( vlc_input_decoder_t *p_owner,
+                                      vlc_frame_t *frame )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    picture_t *const *pics;
+    ssize_t count =
+        vlc_decoder_cache_entry_Find( p_owner->cache.entry,
+                                      DecoderCacheFrameDate( frame ),
+                                      &p_owner->cache.cursor, &pics );
+
+    if( count > 0 && !p_owner->cache.format_set )
+    {
+        const video_format_t *fmt =
+            vlc_decoder_cache_entry_GetFormat( p_owner->cache.entry );
+
+        video_format_Clean( &p_dec->fmt_out.video );
+        if( video_format_Copy( &p_dec->fmt_out.video, fmt ) != VLC_SUCCESS )
+            count = -1;
+        else
+        {
+            p_dec->fmt_out.i_codec = fmt->i_chroma;
+            if( decoder_UpdateVideoFormat( p_dec ) != 0 )
+                count = -1;
+            else
+                p_owner->cache.format_set = true;
+        }
+    }
+
+    if( count < 0 )
+    {
+        /* Not recorded (different demuxing or seek outside of the
+         * recording): decode from now on */
+        msg_Warn( p_dec, "frame missing from the decoded pictures cache" );
+        vlc_decoder_cache_entry_Release( p_owner->cache.entry );
+        p_owner->cache.entry = NULL;
+        return false;
+    }
+
+    if( frame != NULL )
+        block_Release( frame );
+
+    for( ssize_t i = 0; i < count; i++ )
+    {
+        picture_t *pic = picture_Clone( pics[i] );
+        if( unlikely(pic == NULL) )
+            break;
+        picture_CopyProperties( pic, pics[i] );
+        decoder_QueueVideo( p_dec, pic );
+    }
+    p_owner->cache.served++;
+    return true;
+}
+
 static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_t *frame );
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t *frame )
 {
@@ -1626,8 +1885,43 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
                             frame->i_pts, frame->i_dts );
     }
 
+    if( p_owner->cache.entry != NULL
+     && DecoderThread_PlayCached( p_owner, frame ) )
+    {
+        vlc_fifo_Lock(p_owner->p_fifo);
+        return;
+    }
+
+    bool record = false;
+    if( p_owner->cache.rec != NULL )
+    {
+        if( vlc_decoder_cache_entry_AddFrame( p_owner->cache.rec,
+                            DecoderCacheFrameDate( frame ) ) == VLC_SUCCESS )
+        {
+            p_owner->cache.rec_frames++;
+            p_owner->cache.thread_id = vlc_thread_id();
+            atomic_store_explicit( &p_owner->cache.in_decode, true,
+                                   memory_order_release );
+            record = true;
+        }
+        else
+            DecoderThread_CacheAbort( p_owner, "out of memory" );
+    }
+
     int ret = p_dec->pf_decode( p_dec, frame );
 
+    if( record )
+    {
+        atomic_store_explicit( &p_owner->cache.in_decode, false,
+                               memory_order_relaxed );
+        if( ret != VLCDEC_SUCCESS )
+            DecoderThread_CacheAbort( p_owner, "decoder error or reload" );
+        else if( atomic_load_explicit( &p_owner->cache.rec_failed,
+                                       memory_order_relaxed ) )
+            DecoderThread_CacheAbort( p_owner,
+                                      "too large or not in system memory" );
+    }
+
     vlc_fifo_Lock(p_owner->p_fifo);
     switch( ret )
     {
@@ -1653,6 +1947,43 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, vlc_frame_t
     }
 }
 
+static vlc_frame_t *DecoderThread_Packetize( vlc_input_decoder_t *p_owner,
+                                             vlc_frame_t **ppframe )
+{
+    decoder_t *p_packetizer = p_owner->p_packetizer;
+
+    /* Count the frames (re)allocated by the packetizer: a packetizer that
+     * slices shared input frames does not allocate any */
+    uint64_t allocs = vlc_frame_GetAllocCount();
+    vlc_frame_t *frame = p_packetizer->pf_packetize( p_packetizer, ppframe );
+    p_owner->i_packetizer_allocs += vlc_frame_GetAllocCount() - allocs;
+    return frame;
+}
+
+/* Whether a packetized frame can be skipped while prerolling towards a seek
+ * target: it is neither referenced by other frames nor displayed */
+static bool DecoderThread_IsDisposable( vlc_input_decoder_t *p_owner,
+                                        const vlc_frame_t *frame )
+{
+    if( !p_owner->fast_preroll
+     || !(frame->i_flags & BLOCK_FLAG_NON_REFERENCE)
+     || frame->i_pts == VLC_TICK_INVALID )
+        return false;
+
+    vlc_tick_t end = p_owner->i_preroll_end;
+    if( end == PREROLL_NONE )
+        return false;
+    /* Until the target is reached, the input frames flagged as preroll are
+     * all before it, the latest one included */
+    if( end == PREROLL_FORCED )
+    {
+        end = p_owner->i_preroll_date;
+        return end != VLC_TICK_INVALID && frame->i_pts <= end;
+    }
+
+    return frame->i_pts < end;
+}
+
 /**
  * Decode a frame
  *
@@ -1686,7 +2017,7 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
         if( frame->i_buffer <= 0 )
             goto error;
 
-        DecoderUpdatePreroll( &p_owner->i_preroll_end, frame );
+        DecoderUpdatePreroll( p_owner, frame );
         if( unlikely( frame->i_flags & BLOCK_FLAG_CORE_PRIVATE_RELOADED ) )
         {
             /* This frame has already been packetized */
@@ -1707,8 +2038,11 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
         vlc_frame_t **ppframe = frame ? &frame : NULL;
         decoder_t *p_packetizer = p_owner->p_packetizer;
 
+        if( frame )
+            p_owner->i_input_frames++;
+
         while( (packetized_frame =
-                p_packetizer->pf_packetize( p_packetizer, ppframe ) ) )
+                DecoderThread_Packetize( p_owner, ppframe ) ) )
         {
             if( !es_format_IsSimilar( p_dec->fmt_in, &p_packetizer->fmt_out ) )
             {
@@ -1736,7 +2070,13 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, vlc_frame_
                 vlc_frame_t *p_next = packetized_frame->p_next;
                 packetized_frame->p_next = NULL;
 
-                DecoderThread_DecodeBlock( p_owner, packetized_frame );
+                if( DecoderThread_IsDisposable( p_owner, packetized_frame ) )
+                {
+                    p_owner->preroll_skipped++;
+                    block_Release( packetized_frame );
+                }
+                else
+                    DecoderThread_DecodeBlock( p_owner, packetized_frame );
 
                 if( p_owner->error )
                 {
@@ -1773,6 +2113,9 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
 
     if ( p_dec->pf_flush != NULL )
         p_dec->pf_flush( p_dec );
+
+    if( p_owner->cache.rec_frames > 0 )
+        DecoderThread_CacheAbort( p_owner, "discontinuity" );
 }
 
 /**
@@ -1816,6 +2159,7 @@ static void *DecoderThread( void *p_data )
              * harmless). */
             p_owner->flushing = false;
             p_owner->i_preroll_end = PREROLL_NONE;
+            vlc_decoder_drop_Reset( &p_owner->drop );
             continue;
         }
 
@@ -1872,6 +2216,9 @@ static void *DecoderThread( void *p_data )
         {
             p_owner->b_draining = false;
 
+            if( p_owner->cache.rec != NULL )
+                DecoderThread_CacheComplete( p_owner );
+
             if( p_owner->dec.fmt_in->i_cat == AUDIO_ES && p_owner->p_astream != NULL )
             {   /* Draining: the decoder is drained and all decoded buffers are
                  * queued to the output at this point. Now drain the output. */
@@ -1896,6 +2243,8 @@ static const struct decoder_owner_callbacks dec_video_cbs =
         .queue_cc = ModuleThread_QueueCc,
         .get_display_date = ModuleThread_GetDisplayDate,
         .get_display_rate = ModuleThread_GetDisplayRate,
+        .get_drop_level = ModuleThread_GetDropLevel,
+        .notify_dropped = ModuleThread_NotifyDropped,
     },
     .get_attachments = InputThread_GetInputAttachments,
 };
@@ -1952,6 +2301,9 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->psz_id = cfg->str_id;
     p_owner->p_clock = cfg->clock;
     p_owner->i_preroll_end = PREROLL_NONE;
+    p_owner->i_preroll_date = VLC_TICK_INVALID;
+    p_owner->preroll_skipped = 0;
+    p_owner->fast_preroll = var_InheritBool( p_parent, "fast-preroll" );
     p_owner->p_resource = cfg->resource;
     p_owner->hw_dec = cfg->hw_dec;
     p_owner->cbs = cfg->cbs;
@@ -1965,6 +2317,8 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->p_sout = cfg->sout;
     p_owner->p_sout_input = NULL;
     p_owner->p_packetizer = NULL;
+    p_owner->i_input_frames = 0;
+    p_owner->i_packetizer_allocs = 0;
 
     p_owner->b_fmt_description = false;
     p_owner->p_description = NULL;
@@ -1979,6 +2333,21 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->b_first = true;
     p_owner->b_has_data = false;
 
+    vlc_decoder_drop_Init( &p_owner->drop );
+    atomic_init( &p_owner->drop_level, VLC_DECODER_DROP_NONE );
+    atomic_init( &p_owner->frames_dropped, 0 );
+
+    p_owner->cache.cache = NULL;
+    p_owner->cache.key = NULL;
+    p_owner->cache.rec = NULL;
+    p_owner->cache.rec_frames = 0;
+    atomic_init( &p_owner->cache.in_decode, false );
+    atomic_init( &p_owner->cache.rec_failed, false );
+    p_owner->cache.entry = NULL;
+    p_owner->cache.cursor = 0;
+    p_owner->cache.format_set = false;
+    p_owner->cache.served = 0;
+
     p_owner->error = false;
 
     p_owner->flushing = false;
@@ -2046,6 +2415,10 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
 
     /* Find a suitable decoder/packetizer module */
     decoder_Init(p_dec, &p_owner->dec_fmt_in, fmt);
+    p_dec->i_target_width = cfg->target_width;
+    p_dec->i_target_height = cfg->target_height;
+    p_dec->i_threads = cfg->threads;
+    p_dec->threading = cfg->threading;
     if (LoadDecoder(p_dec, cfg->sout != NULL, &p_owner->dec_fmt_in))
         return p_owner;
 
@@ -2069,6 +2442,10 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
         }
     }
 
+    if( fmt->i_cat == VIDEO_ES && cfg->sout == NULL && cfg->item_uri != NULL
+     && cfg->input_type == INPUT_TYPE_PLAYBACK )
+        DecoderCacheInit( p_owner, cfg );
+
     /* */
     vlc_mutex_init(&p_owner->subdecs.lock);
     p_owner->cc.selected_codec = cfg->cc_decoder == 708 ?
@@ -2097,9 +2474,22 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner, enum es_format_category
     decoder_t *p_dec = &p_owner->dec;
     msg_Dbg( p_dec, "killing decoder fourcc `%4.4s'",
              (char*)&p_dec->fmt_in->i_codec );
+    if( p_owner->i_input_frames > 0 )
+        msg_Dbg( p_dec, "packetizer: %"PRIu64" input frames, %"PRIu64
+                 " frame allocations", p_owner->i_input_frames,
+                 p_owner->i_packetizer_allocs );
 
     decoder_Clean( p_dec );
 
+    if( p_owner->cache.rec != NULL )
+        vlc_decoder_cache_entry_Release( p_owner->cache.rec );
+    if( p_owner->cache.entry != NULL )
+        vlc_decoder_cache_entry_Release( p_owner->cache.entry );
+    if( p_owner->cache.served > 0 )
+        msg_Dbg( p_dec, "decoded pictures cache: %"PRIu64" frames served",
+                 p_owner->cache.served );
+    free( p_owner->cache.key );
+
     if ( p_owner->out_pool )
     {
         picture_pool_Release( p_owner->out_pool );
@@ -2631,6 +3021,7 @@ void vlc_input_decoder_ChangePause( vlc_input_decoder_t *p_owner,
     p_owner->paused = b_paused;
     p_owner->pause_date = i_date;
     p_owner->frames_countdown = 0;
+    vlc_decoder_drop_Reset( &p_owner->drop );
     vlc_fifo_Signal( p_owner->p_fifo );
     vlc_fifo_Unlock( p_owner->p_fifo );
 }
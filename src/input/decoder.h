@@ -42,6 +42,8 @@ struct vlc_input_decoder_callbacks {
 
     void (*on_new_video_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned displayed, unsigned late,
+                               unsigned dropped,
+                               enum vlc_decoder_drop_level drop_level,
                                void *userdata);
     void (*on_new_audio_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
@@ -62,6 +64,11 @@ struct vlc_input_decoder_cfg
     enum input_type input_type;
     bool hw_dec;
     unsigned cc_decoder;
+    unsigned target_width; /* cf. decoder_t.i_target_width */
+    unsigned target_height;
+    unsigned threads; /* cf. decoder_t.i_threads */
+    enum vlc_decoder_threading threading;
+    const char *item_uri; /* to identify the ES in the decoded pictures cache */
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_data;
 };
@@ -0,0 +1,266 @@
+/*****************************************************************************
+ * decoder_cache.c: decoded pictures cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+#include <vlc_threads.h>
+#include <vlc_list.h>
+#include <vlc_vector.h>
+
+#include "decoder_cache.h"
+
+struct vlc_decoder_cache_frame
+{
+    vlc_tick_t ts;
+    size_t first; /* index of the first picture */
+    size_t count;
+};
+
+struct vlc_decoder_cache_entry
+{
+    vlc_atomic_rc_t rc;
+    char *key;
+    es_format_t fmt;
+    video_format_t fmt_out;
+
+    struct VLC_VECTOR(struct vlc_decoder_cache_frame) frames;
+    struct VLC_VECTOR(picture_t *) pics;
+
+    size_t size;
+    size_t max_size;
+
+    struct vlc_list node;
+};
+
+struct vlc_decoder_cache
+{
+    vlc_mutex_t lock;
+    struct vlc_list entries; /* most recently used first */
+    size_t size;
+    size_t budget;
+};
+
+struct vlc_decoder_cache *vlc_decoder_cache_New(size_t budget)
+{
+    struct vlc_decoder_cache *cache = malloc(sizeof(*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    vlc_mutex_init(&cache->lock);
+    vlc_list_init(&cache->entries);
+    cache->size = 0;
+    cache->budget = budget;
+    return cache;
+}
+
+void vlc_decoder_cache_Delete(struct vlc_decoder_cache *cache)
+{
+    struct vlc_decoder_cache_entry *entry;
+
+    vlc_list_foreach(entry, &cache->entries, node)
+    {
+        vlc_list_remove(&entry->node);
+        vlc_decoder_cache_entry_Release(entry);
+    }
+    free(cache);
+}
+
+struct vlc_decoder_cache_entry *
+vlc_decoder_cache_Get(struct vlc_decoder_cache *cache, const char *key,
+                      const es_format_t *fmt)
+{
+    struct vlc_decoder_cache_entry *entry;
+
+    vlc_mutex_lock(&cache->lock);
+    vlc_list_foreach(entry, &cache->entries, node)
+    {
+        if (strcmp(entry->key, key) == 0 && es_format_IsSimilar(&entry->fmt, fmt))
+        {
+            vlc_list_remove(&entry->node);
+            vlc_list_prepend(&entry->node, &cache->entries);
+            vlc_atomic_rc_inc(&entry->rc);
+            vlc_mutex_unlock(&cache->lock);
+            return entry;
+        }
+    }
+    vlc_mutex_unlock(&cache->lock);
+    return NULL;
+}
+
+void vlc_decoder_cache_Put(struct vlc_decoder_cache *cache,
+                           struct vlc_decoder_cache_entry *entry,
+                           const video_format_t *fmt_out)
+{
+    if (entry->size > cache->budget || entry->pics.size == 0
+     || video_format_Copy(&entry->fmt_out, fmt_out) != VLC_SUCCESS)
+    {
+        vlc_decoder_cache_entry_Release(entry);
+        return;
+    }
+
+    vlc_mutex_lock(&cache->lock);
+
+    struct vlc_decoder_cache_entry *old;
+    vlc_list_reverse_foreach(old, &cache->entries, node)
+    {
+        /* Replace a previous recording of the same ES, and evict the least
+         * recently used entries until the new one fits */
+        if (strcmp(old->key, entry->key) == 0
+         || cache->size + entry->size > cache->budget)
+        {
+            vlc_list_remove(&old->node);
+            cache->size -= old->size;
+            vlc_decoder_cache_entry_Release(old);
+        }
+    }
+
+    vlc_list_prepend(&entry->node, &cache->entries);
+    cache->size += entry->size;
+    vlc_mutex_unlock(&cache->lock);
+}
+
+struct vlc_decoder_cache_entry *
+vlc_decoder_cache_entry_New(struct vlc_decoder_cache *cache, const char *key,
+                            const es_format_t *fmt)
+{
+    struct vlc_decoder_cache_entry *entry = malloc(sizeof(*entry));
+    if (unlikely(entry == NULL))
+        return NULL;
+
+    entry->key = strdup(key);
+    if (unlikely(entry->key == NULL))
+    {
+        free(entry);
+        return NULL;
+    }
+
+    if (es_format_Copy(&entry->fmt, fmt) != VLC_SUCCESS)
+    {
+        free(entry->key);
+        free(entry);
+        return NULL;
+    }
+
+    vlc_atomic_rc_init(&entry->rc);
+    video_format_Init(&entry->fmt_out, 0);
+    vlc_vector_init(&entry->frames);
+    vlc_vector_init(&entry->pics);
+    entry->size = 0;
+    entry->max_size = cache->budget;
+    return entry;
+}
+
+void vlc_decoder_cache_entry_Release(struct vlc_decoder_cache_entry *entry)
+{
+    if (!vlc_atomic_rc_dec(&entry->rc))
+        return;
+
+    for (size_t i = 0; i < entry->pics.size; i++)
+        picture_Release(entry->pics.data[i]);
+    vlc_vector_destroy(&entry->pics);
+    vlc_vector_destroy(&entry->frames);
+    video_format_Clean(&entry->fmt_out);
+    es_format_Clean(&entry->fmt);
+    free(entry->key);
+    free(entry);
+}
+
+int vlc_decoder_cache_entry_AddFrame(struct vlc_decoder_cache_entry *entry,
+                                     vlc_tick_t ts)
+{
+    struct vlc_decoder_cache_frame frame = {
+        .ts = ts,
+        .first = entry->pics.size,
+        .count = 0,
+    };
+
+    return vlc_vector_push(&entry->frames, frame) ? VLC_SUCCESS : VLC_ENOMEM;
+}
+
+int vlc_decoder_cache_entry_AddPicture(struct vlc_decoder_cache_entry *entry,
+                                       const picture_t *pic)
+{
+    /* Only pictures in system memory can outlive their decoder */
+    if (pic->context != NULL || entry->frames.size == 0)
+        return VLC_EGENERIC;
+    /* The entry is played with a single output format */
+    if (entry->pics.size > 0
+     && !video_format_IsSimilar(&entry->pics.data[0]->format, &pic->format))
+        return VLC_EGENERIC;
+
+    size_t size = 0;
+    for (int i = 0; i < pic->i_planes; i++)
+        size += (size_t)pic->p[i].i_pitch * pic->p[i].i_lines;
+    if (entry->size + size > entry->max_size)
+        return VLC_EGENERIC;
+
+    picture_t *copy = picture_NewFromFormat(&pic->format);
+    if (copy == NULL)
+        return VLC_ENOMEM;
+    picture_Copy(copy, pic);
+
+    if (!vlc_vector_push(&entry->pics, copy))
+    {
+        picture_Release(copy);
+        return VLC_ENOMEM;
+    }
+
+    struct vlc_decoder_cache_frame *frame =
+        &entry->frames.data[entry->frames.size - 1];
+    assert(frame->first + frame->count == entry->pics.size - 1);
+    frame->count++;
+    entry->size += size;
+    return VLC_SUCCESS;
+}
+
+const video_format_t *
+vlc_decoder_cache_entry_GetFormat(const struct vlc_decoder_cache_entry *entry)
+{
+    return &entry->fmt_out;
+}
+
+ssize_t vlc_decoder_cache_entry_Find(const struct vlc_decoder_cache_entry *entry,
+                                     vlc_tick_t ts, size_t *cursor,
+                                     picture_t *const **pics)
+{
+    const size_t count = entry->frames.size;
+
+    /* The frames are usually looked up in the recorded order */
+    for (size_t n = 0, i = *cursor; n < count; n++, i++)
+    {
+        if (i >= count)
+            i = 0;
+
+        const struct vlc_decoder_cache_frame *frame = &entry->frames.data[i];
+        if (frame->ts == ts)
+        {
+            *cursor = i + 1;
+            *pics = &entry->pics.data[frame->first];
+            return frame->count;
+        }
+    }
+    return -1;
+}
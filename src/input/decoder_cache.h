@@ -0,0 +1,110 @@
+/*****************************************************************************
+ * decoder_cache.h: decoded pictures cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_INPUT_DECODER_CACHE_H
+#define LIBVLC_INPUT_DECODER_CACHE_H 1
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_picture.h>
+
+/**
+ * Decoded pictures cache
+ *
+ * An entry holds all the pictures output by a video decoder for one ES of an
+ * input item, from its first input frame to the end of the stream, indexed by
+ * the timestamp of the input frame after which the decoder output them. When
+ * the same ES is played again, the pictures can be replayed from the entry
+ * without decoding anything, following the decoder output order.
+ *
+ * Only complete entries are stored: an entry being recorded is dropped on
+ * discontinuities (flush, reload) or if it does not fit in the budget. Stored
+ * entries are immutable and reference counted; the least recently used ones
+ * are evicted to make room for new ones.
+ */
+struct vlc_decoder_cache;
+struct vlc_decoder_cache_entry;
+
+struct vlc_decoder_cache *vlc_decoder_cache_New(size_t budget);
+void vlc_decoder_cache_Delete(struct vlc_decoder_cache *cache);
+
+/**
+ * Looks up a complete entry.
+ *
+ * \param key identifier of the ES, including its input item
+ * \param fmt the input format of the ES, that must match the recorded one
+ * \return a held entry, or NULL if there is none
+ */
+struct vlc_decoder_cache_entry *
+vlc_decoder_cache_Get(struct vlc_decoder_cache *cache, const char *key,
+                      const es_format_t *fmt);
+
+/**
+ * Stores a complete entry, taking ownership of it.
+ *
+ * \param fmt_out the video format of the recorded pictures
+ */
+void vlc_decoder_cache_Put(struct vlc_decoder_cache *cache,
+                           struct vlc_decoder_cache_entry *entry,
+                           const video_format_t *fmt_out);
+
+/**
+ * Creates an entry to record.
+ */
+struct vlc_decoder_cache_entry *
+vlc_decoder_cache_entry_New(struct vlc_decoder_cache *cache, const char *key,
+                            const es_format_t *fmt);
+
+void vlc_decoder_cache_entry_Release(struct vlc_decoder_cache_entry *entry);
+
+/**
+ * Records an input frame.
+ *
+ * \param ts the input frame timestamp (VLC_TICK_INVALID when draining)
+ */
+int vlc_decoder_cache_entry_AddFrame(struct vlc_decoder_cache_entry *entry,
+                                     vlc_tick_t ts);
+
+/**
+ * Records a copy of a picture output after the last recorded input frame.
+ *
+ * \return VLC_SUCCESS, VLC_ENOMEM, or VLC_EGENERIC if the picture cannot be
+ * copied or if the entry exceeds the budget; the recording should then be
+ * abandoned.
+ */
+int vlc_decoder_cache_entry_AddPicture(struct vlc_decoder_cache_entry *entry,
+                                       const picture_t *pic);
+
+const video_format_t *
+vlc_decoder_cache_entry_GetFormat(const struct vlc_decoder_cache_entry *entry);
+
+/**
+ * Finds the pictures output after an input frame.
+ *
+ * \param ts the input frame timestamp
+ * \param cursor position of the previous lookup, updated (0 initially)
+ * \param pics pointer to the pictures
+ * \return the number of pictures, or -1 if the input frame is unknown
+ */
+ssize_t vlc_decoder_cache_entry_Find(const struct vlc_decoder_cache_entry *entry,
+                                     vlc_tick_t ts, size_t *cursor,
+                                     picture_t *const **pics);
+
+#endif
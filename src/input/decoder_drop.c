@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * decoder_drop.c: video decoder frame dropping policy
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <limits.h>
+
+#include <vlc_common.h>
+
+#include "decoder_drop.h"
+
+void vlc_decoder_drop_Init(struct vlc_decoder_drop *drop)
+{
+    drop->level = VLC_DECODER_DROP_NONE;
+    drop->good_windows = 0;
+    drop->recover_windows = VLC_DECODER_DROP_RECOVER_MIN;
+    drop->windows_since_recovery = UINT_MAX;
+    drop->settling = false;
+    drop->escalations = 0;
+    drop->recoveries = 0;
+    vlc_decoder_drop_Reset(drop);
+}
+
+void vlc_decoder_drop_Reset(struct vlc_decoder_drop *drop)
+{
+    drop->window_start = VLC_TICK_INVALID;
+    drop->samples = 0;
+    drop->late = 0;
+    drop->min_margin = VLC_TICK_MAX;
+}
+
+static bool EndWindow(struct vlc_decoder_drop *drop)
+{
+    bool changed = false;
+
+    if (drop->windows_since_recovery < UINT_MAX)
+        drop->windows_since_recovery++;
+
+    if (drop->settling)
+        drop->settling = false;
+    else if (drop->late * 4 >= drop->samples)
+    {
+        /* At least a quarter of the pictures were late */
+        drop->good_windows = 0;
+        if (drop->level < VLC_DECODER_DROP_MAX)
+        {
+            /* The stage that was just released was still needed */
+            if (drop->windows_since_recovery <= 2)
+                drop->recover_windows = __MIN(drop->recover_windows * 2,
+                                              VLC_DECODER_DROP_RECOVER_MAX);
+            drop->level++;
+            drop->escalations++;
+            drop->settling = true;
+            changed = true;
+        }
+    }
+    else if (drop->late == 0 && drop->min_margin >= VLC_DECODER_DROP_HEADROOM)
+    {
+        drop->good_windows++;
+        if (drop->level > VLC_DECODER_DROP_NONE
+         && drop->good_windows >= drop->recover_windows)
+        {
+            drop->level--;
+            drop->recoveries++;
+            drop->good_windows = 0;
+            drop->windows_since_recovery = 0;
+            if (drop->level == VLC_DECODER_DROP_NONE)
+                drop->recover_windows = VLC_DECODER_DROP_RECOVER_MIN;
+            changed = true;
+        }
+    }
+    else
+        drop->good_windows = 0;
+
+    vlc_decoder_drop_Reset(drop);
+    return changed;
+}
+
+bool vlc_decoder_drop_Update(struct vlc_decoder_drop *drop, vlc_tick_t now,
+                             vlc_tick_t display_date)
+{
+    if (drop->window_start == VLC_TICK_INVALID)
+        drop->window_start = now;
+
+    vlc_tick_t margin = display_date - now;
+
+    drop->samples++;
+    if (margin < 0)
+        drop->late++;
+    if (margin < drop->min_margin)
+        drop->min_margin = margin;
+
+    if (drop->samples < VLC_DECODER_DROP_WINDOW_SAMPLES
+     && now - drop->window_start < VLC_DECODER_DROP_WINDOW)
+        return false;
+
+    return EndWindow(drop);
+}
+
+const char *vlc_decoder_drop_LevelName(enum vlc_decoder_drop_level level)
+{
+    switch (level)
+    {
+        case VLC_DECODER_DROP_NONE:
+            return "none";
+        case VLC_DECODER_DROP_NONREF:
+            return "non-reference frames";
+        case VLC_DECODER_DROP_BIDIR:
+            return "B-frames";
+        case VLC_DECODER_DROP_LOOPFILTER:
+            return "B-frames and loop filter";
+        case VLC_DECODER_DROP_NONKEY:
+            return "keyframes only";
+    }
+    vlc_assert_unreachable();
+}
@@ -0,0 +1,90 @@
+/*****************************************************************************
+ * decoder_drop.h: video decoder frame dropping policy
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef LIBVLC_INPUT_DECODER_DROP_H
+#define LIBVLC_INPUT_DECODER_DROP_H 1
+
+#include <vlc_common.h>
+#include <vlc_codec.h>
+
+/**
+ * Frame dropping policy
+ *
+ * The margin between the display date of each queued picture and the time it
+ * was queued is gathered over short windows. A window with too many late
+ * pictures escalates one stage, and the next window is ignored to let the new
+ * stage take effect. A stage is only released after several consecutive
+ * windows without late pictures and with some headroom. The number of windows
+ * needed to recover doubles each time a recovery is immediately followed by an
+ * escalation, to avoid oscillating between two stages.
+ */
+struct vlc_decoder_drop
+{
+    enum vlc_decoder_drop_level level;
+
+    /* Current window */
+    vlc_tick_t window_start;
+    unsigned samples;
+    unsigned late;
+    vlc_tick_t min_margin;
+
+    /* Hysteresis */
+    unsigned good_windows;
+    unsigned recover_windows;
+    unsigned windows_since_recovery;
+    bool settling;
+
+    /* Statistics */
+    unsigned escalations;
+    unsigned recoveries;
+};
+
+/** Pictures in a window, at most */
+#define VLC_DECODER_DROP_WINDOW_SAMPLES 16
+/** Duration of a window, at most */
+#define VLC_DECODER_DROP_WINDOW VLC_TICK_FROM_SEC(1)
+/** Minimum margin of all the pictures of a window to release a stage */
+#define VLC_DECODER_DROP_HEADROOM VLC_TICK_FROM_MS(20)
+/** Bounds of the number of good windows needed to release a stage */
+#define VLC_DECODER_DROP_RECOVER_MIN 2
+#define VLC_DECODER_DROP_RECOVER_MAX 32
+
+void vlc_decoder_drop_Init(struct vlc_decoder_drop *drop);
+
+/**
+ * Restarts the current window, keeping the current stage.
+ *
+ * To be called on discontinuities, i.e. flush or pause.
+ */
+void vlc_decoder_drop_Reset(struct vlc_decoder_drop *drop);
+
+/**
+ * Accounts for a queued picture.
+ *
+ * \param now the system date the picture is queued at
+ * \param display_date the system date the picture should be displayed at
+ * \return true if the stage changed
+ */
+bool vlc_decoder_drop_Update(struct vlc_decoder_drop *drop, vlc_tick_t now,
+                             vlc_tick_t display_date);
+
+const char *vlc_decoder_drop_LevelName(enum vlc_decoder_drop_level level);
+
+#endif
@@ -38,6 +38,10 @@ void decoder_Init( decoder_t *p_dec, es_format_t *restrict fmt_in, const es_form
 {
     p_dec->i_extra_picture_buffers = 0;
     p_dec->b_frame_drop_allowed = false;
+    p_dec->i_target_width = 0;
+    p_dec->i_target_height = 0;
+    p_dec->i_threads = 0;
+    p_dec->threading = VLC_DECODER_THREADING_AUTO;
 
     p_dec->pf_decode = NULL;
     p_dec->pf_get_cc = NULL;
@@ -70,6 +70,132 @@ static const char *demux_NameFromMimeType(const char *mime)
     return (type != NULL) ? type->name : "any";
 }
 
+typedef const struct
+{
+    uint8_t const offset;
+    uint8_t const length;
+    char const magic[12];
+    char const name[8];
+    uint8_t const extra_offset;
+    char const extra[4];
+
+} demux_signature;
+
+/* Container signatures, used to probe the matching demux first */
+static demux_signature signatures[] =
+{
+    { 4,  4, "ftyp",                 "mp4",     0, ""     },
+    { 4,  4, "moov",                 "mp4",     0, ""     },
+    { 4,  4, "moof",                 "mp4",     0, ""     },
+    { 4,  4, "styp",                 "mp4",     0, ""     },
+    { 0,  4, "\x1A\x45\xDF\xA3",     "mkv",     0, ""     },
+    { 0,  4, "RIFF",                 "avi",     8, "AVI " },
+    { 0,  4, "RIFF",                 "wav",     8, "WAVE" },
+    { 0,  4, "RF64",                 "wav",     8, "WAVE" },
+    { 0,  4, "OggS",                 "ogg",     0, ""     },
+    { 0,  4, "fLaC",                 "flacsys", 0, ""     },
+    { 0,  4, "\x00\x00\x01\xBA",     "ps",      0, ""     },
+    { 0,  4, "FORM",                 "aiff",    8, "AIFF" },
+    { 0,  4, "FORM",                 "aiff",    8, "AIFC" },
+    { 0,  4, ".snd",                 "au",      0, ""     },
+    { 0,  8, "\x30\x26\xB2\x75\x8E\x66\xCF\x11", "asf", 0, "" },
+    { 0,  4, "caff",                 "caf",     0, ""     },
+    { 0,  4, "MPCK",                 "mpc",     0, ""     },
+    { 0,  3, "MP+",                  "mpc",     0, ""     },
+    { 0,  4, "TTA1",                 "tta",     0, ""     },
+    { 0,  4, "MThd",                 "smf",     0, ""     },
+    { 0,  4, "NSVf",                 "nsv",     0, ""     },
+    { 0,  4, "NSVs",                 "nsv",     0, ""     },
+    { 0,  3, "ID3",                  "es",      0, ""     },
+    { 0, 12, "Creative Voi",         "voc",     0, ""     },
+};
+
+static bool demux_MatchSignature(demux_signature *sig,
+                                 const uint8_t *peek, size_t size)
+{
+    if (size < sig->offset + sig->length
+     || memcmp(&peek[sig->offset], sig->magic, sig->length))
+        return false;
+    if (sig->extra[0] != '\0'
+     && (size < sig->extra_offset + 4u
+      || memcmp(&peek[sig->extra_offset], sig->extra, 4)))
+        return false;
+    return true;
+}
+
+static const char *demux_NameFromSignature(const uint8_t *peek, size_t size)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(signatures); i++)
+        if (demux_MatchSignature(&signatures[i], peek, size))
+            return signatures[i].name;
+
+    /* MPEG-TS: two consecutive sync bytes */
+    if (size > 188 && peek[0] == 0x47 && peek[188] == 0x47)
+        return "ts";
+
+    return NULL;
+}
+
+/**
+ * Tells if the content cannot be opened by the demux \p name unless forced.
+ *
+ * Only the demuxes that always check their signature at the start of the
+ * stream are listed; the others may accept anything.
+ */
+static bool demux_MismatchSignature(const char *name,
+                                    const uint8_t *peek, size_t size)
+{
+    static const char strict[][8] =
+    {
+        "aiff", "asf", "au", "caf", "mkv", "nsv", "ogg", "tta", "voc", "wav",
+    };
+    bool listed = false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(strict) && !listed; i++)
+        listed = !strcmp(strict[i], name);
+    if (!listed)
+        return false;
+
+    for (size_t i = 0; i < ARRAY_SIZE(signatures); i++)
+        if (!strcmp(signatures[i].name, name)
+         && demux_MatchSignature(&signatures[i], peek, size))
+            return false;
+    return true;
+}
+
+static const char *demux_NameFromExtension(const char *ext)
+{
+    static demux_mapping types[] =
+    {   /* Must be sorted in ascending ASCII order */
+        { "3gp",   "mp4"     },
+        { "aac",   "es"      },
+        { "avi",   "avi"     },
+        { "flac",  "flacsys" },
+        { "m2ts",  "ts"      },
+        { "m4a",   "mp4"     },
+        { "m4v",   "mp4"     },
+        { "mka",   "mkv"     },
+        { "mkv",   "mkv"     },
+        { "mov",   "mp4"     },
+        { "mp3",   "es"      },
+        { "mp4",   "mp4"     },
+        { "mpg",   "ps"      },
+        { "mts",   "ts"      },
+        { "oga",   "ogg"     },
+        { "ogg",   "ogg"     },
+        { "ogv",   "ogg"     },
+        { "opus",  "ogg"     },
+        { "ts",    "ts"      },
+        { "vob",   "ps"      },
+        { "wav",   "wav"     },
+        { "webm",  "mkv"     },
+    };
+
+    demux_mapping *type = bsearch(ext, types, ARRAY_SIZE(types),
+                                  sizeof (*types), demux_mapping_cmp);
+    return (type != NULL) ? type->name : NULL;
+}
+
 demux_t *demux_New( vlc_object_t *p_obj, const char *module, const char *url,
                     stream_t *s, es_out_t *out )
 {
@@ -94,11 +220,9 @@ static void demux_DestroyDemux(demux_t *demux)
     vlc_stream_Delete(demux->s);
 }
 
-static int demux_Probe(void *func, bool forced, va_list ap)
+static int demux_Probe(demux_t *demux, int (*probe)(vlc_object_t *),
+                       bool forced)
 {
-    int (*probe)(vlc_object_t *) = func;
-    demux_t *demux = va_arg(ap, demux_t *);
-
     /* Restore input stream offset (in case previous probed demux failed to
      * to do so). */
     if (vlc_stream_Tell(demux->s) != 0 && vlc_stream_Seek(demux->s, 0))
@@ -115,6 +239,149 @@ static int demux_Probe(void *func, bool forced, va_list ap)
     return ret;
 }
 
+/**
+ * Moves the non-forced candidates whose signature does not match the content
+ * behind all the others, from index \p first. They are still probed last, in
+ * case the content is not what it looks like.
+ *
+ * \return the number of moved candidates
+ */
+static size_t demux_DeferModules(module_t **mods, size_t first, size_t total,
+                                 const uint8_t *peek, size_t size)
+{
+    module_t **deferred = vlc_alloc(total - first, sizeof (*deferred));
+    if (unlikely(deferred == NULL))
+        return 0;
+
+    size_t kept = first, count = 0;
+    for (size_t i = first; i < total; i++)
+    {
+        if (demux_MismatchSignature(module_get_object(mods[i]), peek, size))
+            deferred[count++] = mods[i];
+        else
+            mods[kept++] = mods[i];
+    }
+    memcpy(&mods[kept], deferred, count * sizeof (*mods));
+    free(deferred);
+    return count;
+}
+
+/**
+ * Moves the non-forced candidate named \p name in front of the other
+ * non-forced candidates of the same score, from index \p first.
+ *
+ * Candidates with a higher score are left in front, so that a specialised
+ * demux (such as es for DTS or A52 in WAV) still gets to probe first.
+ *
+ * \return true if the module was found
+ */
+static bool demux_PromoteModule(module_t **mods, size_t first, size_t total,
+                                const char *name)
+{
+    for (size_t i = first; i < total; i++)
+    {
+        if (strcmp(module_get_object(mods[i]), name) != 0)
+            continue;
+
+        module_t *cand = mods[i];
+        const int score = module_get_score(cand);
+        size_t pos = i;
+
+        while (pos > first && module_get_score(mods[pos - 1]) == score)
+            pos--;
+        memmove(&mods[pos + 1], &mods[pos], (i - pos) * sizeof (*mods));
+        mods[pos] = cand;
+        return true;
+    }
+    return false;
+}
+
+static module_t *demux_LoadModule(demux_t *demux, const char *name,
+                                  bool strict, const char *ext)
+{
+    module_t **mods;
+    size_t strict_total;
+    ssize_t total = vlc_module_match("demux", name, strict, &mods,
+                                     &strict_total);
+    if (unlikely(total < 0))
+        return NULL;
+
+    msg_Dbg(demux, "looking for demux module matching \"%s\": %zd candidates",
+            name, total);
+
+    /* Prefilter: the demuxes whose signature does not match the content
+     * are probed last. The demux matching the content signature, then the
+     * one matching the file extension are probed first among the candidates
+     * of the same score. */
+    if ((size_t)total > strict_total)
+    {
+        const uint8_t *peek;
+        ssize_t size = vlc_stream_Peek(demux->s, &peek, 189);
+        const char *sig_name = NULL;
+        const char *ext_name = ext != NULL
+                             ? demux_NameFromExtension(ext) : NULL;
+        bool found = false;
+
+        if (size > 0)
+        {
+            size_t deferred = demux_DeferModules(mods, strict_total, total,
+                                                 peek, size);
+            if (deferred > 0)
+                msg_Dbg(demux, "prefilter deferred %zu mismatching modules",
+                        deferred);
+            sig_name = demux_NameFromSignature(peek, size);
+        }
+
+        /* Promote the extension match first, so that the signature match
+         * ends up in front of it if both have the same score. */
+        if (ext_name != NULL && (sig_name == NULL || strcmp(sig_name, ext_name)))
+            found |= demux_PromoteModule(mods, strict_total, total, ext_name);
+        if (sig_name != NULL)
+            found |= demux_PromoteModule(mods, strict_total, total, sig_name);
+
+        if (found)
+            msg_Dbg(demux, "prefilter selected \"%s\" (signature) \"%s\" "
+                    "(extension)", sig_name ? sig_name : "",
+                    ext_name ? ext_name : "");
+    }
+
+    module_t *module = NULL;
+    const vlc_tick_t start = vlc_tick_now();
+    size_t probed = 0;
+
+    for (size_t i = 0; i < (size_t)total; i++)
+    {
+        module_t *cand = mods[i];
+        int (*probe)(vlc_object_t *) = vlc_module_map(vlc_object_logger(demux),
+                                                      cand);
+        if (probe == NULL)
+            continue;
+
+        int ret = demux_Probe(demux, probe, i < strict_total);
+        probed++;
+
+        if (ret == VLC_SUCCESS)
+        {
+            module = cand;
+            break;
+        }
+        if (ret == VLC_ETIMEOUT)
+            break;
+    }
+
+    if (module != NULL)
+        msg_Dbg(demux, "using demux module \"%s\" after %zu probes in "
+                "%"PRId64" us", module_get_object(module), probed,
+                US_FROM_VLC_TICK(vlc_tick_now() - start));
+    else
+        msg_Dbg(demux, "no demux modules matched with name %s after %zu "
+                "probes in %"PRId64" us", name, probed,
+                US_FROM_VLC_TICK(vlc_tick_now() - start));
+
+    free(mods);
+    return module;
+}
+
 demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
                             const char *module, const char *url,
                             stream_t *s, es_out_t *out, bool b_preparsing )
@@ -164,6 +431,7 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
     p_demux->ops        = NULL;
 
     char *modbuf = NULL;
+    const char *ext = NULL;
     bool strict = true;
 
     if (!strcasecmp(module, "any" ) || module[0] == '\0') {
@@ -179,13 +447,14 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
 
     if (strcasecmp(module, "any") == 0 && p_demux->psz_filepath != NULL)
     {
-        const char *ext = strrchr(p_demux->psz_filepath, '.');
+        ext = strrchr(p_demux->psz_filepath, '.');
 
         if (ext != NULL) {
-            if (b_preparsing && !vlc_ascii_strcasecmp(ext, ".mp3"))
+            ext++;
+            if (b_preparsing && !vlc_ascii_strcasecmp(ext, "mp3"))
                 module = "mpga";
             else
-            if (likely(asprintf(&modbuf, "ext-%s", ext + 1) >= 0))
+            if (likely(asprintf(&modbuf, "ext-%s", ext) >= 0))
                 module = modbuf;
             else
                 goto error;
@@ -193,8 +462,7 @@ demux_t *demux_NewAdvanced( vlc_object_t *p_obj, input_thread_t *p_input,
         strict = false;
     }
 
-    priv->module = vlc_module_load(vlc_object_logger(p_demux), "demux", module,
-                                   strict, demux_Probe, p_demux);
+    priv->module = demux_LoadModule(p_demux, module, strict, ext);
     free(modbuf);
 
     if (priv->module == NULL)
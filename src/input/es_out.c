@@ -44,6 +44,7 @@
 #include <vlc_decoder.h>
 #include <vlc_memstream.h>
 #include <vlc_tracer.h>
+#include <vlc_cpu.h>
 
 #include "input_internal.h"
 #include "./source.h"
@@ -147,6 +148,11 @@ struct es_out_id_t
     vlc_tick_t i_pts_level;
     vlc_tick_t delay;
 
+    /* Demuxer statistics: frame allocations of the sending thread since its
+     * previous send are attributed to the ES of the sent block */
+    uint64_t i_sent_blocks;
+    uint64_t i_frame_allocs;
+
     /* Fields for ES created by decoders */
     struct VLC_VECTOR(es_out_id_t *) sub_es_vec;
 
@@ -382,6 +388,8 @@ decoder_on_thumbnail_ready(vlc_input_decoder_t *decoder, picture_t *pic, void *u
     if (!p_sys->p_input)
         return;
 
+    atomic_store(&input_priv(p_sys->p_input)->thumbnail_ready, true);
+
     struct vlc_input_event event = {
         .type = INPUT_EVENT_THUMBNAIL_READY,
         .thumbnail = pic,
@@ -392,7 +400,8 @@ decoder_on_thumbnail_ready(vlc_input_decoder_t *decoder, picture_t *pic, void *u
 
 static void
 decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsigned lost,
-                           unsigned displayed, unsigned late, void *userdata)
+                           unsigned displayed, unsigned late, unsigned dropped,
+                           enum vlc_decoder_drop_level drop_level, void *userdata)
 {
     (void) decoder;
 
@@ -415,6 +424,10 @@ decoder_on_new_video_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
     atomic_fetch_add_explicit(&stats->late_pictures, late,
                               memory_order_relaxed);
+    atomic_fetch_add_explicit(&stats->dropped_video, dropped,
+                              memory_order_relaxed);
+    atomic_store_explicit(&stats->video_drop_level, drop_level,
+                          memory_order_relaxed);
 }
 
 static void
@@ -2193,6 +2206,8 @@ static es_out_id_t *EsOutAddLocked(es_out_sys_t *p_sys,
     es->mouse_event_cb = NULL;
     es->mouse_event_userdata = NULL;
     es->i_pts_level = VLC_TICK_INVALID;
+    es->i_sent_blocks = 0;
+    es->i_frame_allocs = 0;
     es->delay = VLC_TICK_MAX;
 
     vlc_list_append(&es->node, es->p_master ? &p_sys->es_slaves : &p_sys->es);
@@ -2240,6 +2255,46 @@ static void ClockUpdate(vlc_tick_t system_ts, vlc_tick_t ts, double rate,
                                ts, rate, frame_rate, frame_rate_base);
 }
 
+/* Share of the input thread budget for a new decoder: each audio decoder
+ * takes one thread, the video decoders share the remaining ones. The share is
+ * computed when the decoder is created, counting the video ES that will be
+ * decoded alongside it. */
+/* Returns the share of the thread budget of a new video decoder. The audio
+ * decoders each take one thread of the budget. The decoders already running
+ * keep the count they were created with: the budget is not rebalanced. */
+static unsigned EsOutGetDecoderThreads(es_out_sys_t *p_sys,
+                                       const es_out_id_t *p_es)
+{
+    if (p_es->fmt.i_cat != VIDEO_ES)
+        return 0;
+
+    /* Decoders running together: all of them in ES_OUT_MODE_ALL, otherwise
+     * the ones already decoding */
+    const bool all = p_sys->i_mode == ES_OUT_MODE_ALL;
+    int video = 1, audio = 0;
+    es_out_id_t *es;
+    foreach_es_then_es_slaves(es)
+    {
+        if (es == p_es || (!all && es->p_dec == NULL))
+            continue;
+        if (es->fmt.i_cat == VIDEO_ES)
+            video++;
+        else if (es->fmt.i_cat == AUDIO_ES)
+            audio++;
+    }
+
+    int budget = var_InheritInteger(p_sys->p_input, "dec-threads");
+    if (budget <= 0)
+    {
+        /* Let a single video decoder use its own defaults */
+        if (video == 1)
+            return 0;
+        budget = vlc_GetCPUCount();
+    }
+
+    return __MAX(1, (budget - audio) / video);
+}
+
 static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
 {
     input_thread_t *p_input = p_sys->p_input;
@@ -2294,6 +2349,11 @@ static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
     }
 
     input_thread_private_t *priv = input_priv(p_input);
+    enum vlc_decoder_threading threading =
+        var_InheritInteger(p_input, "dec-threading");
+    if (threading == VLC_DECODER_THREADING_AUTO && priv->b_low_delay)
+        threading = VLC_DECODER_THREADING_SLICE;
+    char *uri = input_item_GetURI(input_GetItem(p_input));
     const struct vlc_input_decoder_cfg cfg = {
         .fmt = &p_es->fmt,
         .str_id = p_es->id.str_id,
@@ -2303,6 +2363,11 @@ static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
         .input_type = p_sys->input_type,
         .hw_dec = priv->hw_dec,
         .cc_decoder = p_sys->cc_decoder,
+        .target_width = priv->thumbnail_target_width,
+        .target_height = priv->thumbnail_target_height,
+        .threads = EsOutGetDecoderThreads(p_sys, p_es),
+        .threading = threading,
+        .item_uri = uri,
         .cbs = &decoder_cbs,
         .cbs_data = p_es,
     };
@@ -2315,6 +2380,7 @@ static void EsOutCreateDecoder(es_out_sys_t *p_sys, es_out_id_t *p_es)
     {
         dec = vlc_input_decoder_New( VLC_OBJECT(p_input), &cfg );
     }
+    free(uri);
     if( dec != NULL )
     {
         vlc_input_decoder_ChangeRate( dec, p_sys->rate );
@@ -2849,6 +2915,10 @@ static void EsOutCreateSubESes(es_out_sys_t *sys,
     }
 }
 
+/* Frame allocation count of the current thread at its last EsOutSend() */
+static thread_local uint64_t es_out_frame_allocs;
+static thread_local bool es_out_frame_allocs_valid;
+
 /**
  * Send a block for the given es_out
  *
@@ -2886,8 +2956,18 @@ static int EsOutSend(es_out_t *out, es_out_id_t *es, block_t *p_block )
                                       memory_order_relaxed);
     }
 
+    uint64_t i_frame_allocs = block_GetAllocCount();
+
     vlc_mutex_lock( &p_sys->lock );
 
+    es->i_sent_blocks++;
+    /* The allocations made by the thread before its first send belong to no
+     * ES in particular */
+    if( es_out_frame_allocs_valid )
+        es->i_frame_allocs += i_frame_allocs - es_out_frame_allocs;
+    es_out_frame_allocs = i_frame_allocs;
+    es_out_frame_allocs_valid = true;
+
     /* Shift all slaves timestamps with the main source normal time. This will
      * allow to synchronize 2 demuxers with different time bases. Remove the
      * normal time from the current source and add the main source normal time.
@@ -3043,6 +3123,11 @@ static void EsOutDelLocked(es_out_sys_t *p_sys, es_out_id_t *es)
 
     EsTerminate(es);
 
+    if( es->i_sent_blocks > 0 )
+        msg_Dbg( p_sys->p_input, "ES %s: %"PRIu64" blocks sent, %"PRIu64
+                 " frame allocations", es->id.str_id, es->i_sent_blocks,
+                 es->i_frame_allocs );
+
     if( es->p_pgrm == p_sys->p_pgrm )
         EsOutSendEsEvent(p_sys, es, VLC_INPUT_ES_DELETED, false, VLC_VOUT_ORDER_PRIMARY);
 
@@ -268,6 +268,16 @@ input_thread_t * input_Create( vlc_object_t *p_parent, input_item_t *p_item,
     priv->cbs_data = cfg->cbs_data;
     priv->type = cfg->type;
     priv->preparse_subitems = cfg->preparsing.subitems;
+    priv->thumbnail_wait_seek = cfg->type == INPUT_TYPE_THUMBNAILING &&
+                                cfg->thumbnailing.wait_seek;
+    atomic_init( &priv->thumbnail_ready, false );
+    if( cfg->type == INPUT_TYPE_THUMBNAILING )
+    {
+        priv->thumbnail_target_width = cfg->thumbnailing.target_width;
+        priv->thumbnail_target_height = cfg->thumbnailing.target_height;
+    }
+    else
+        priv->thumbnail_target_width = priv->thumbnail_target_height = 0;
     priv->i_start = 0;
     priv->i_stop  = 0;
     priv->i_title_offset = input_priv(p_input)->i_seekpoint_offset = 0;
@@ -649,6 +659,10 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
         if( b_paused )
             b_paused = !es_out_GetBuffering( input_priv(p_input)->p_es_out )
                     || input_priv(p_input)->master->b_eof;
+        /* Don't demux past a thumbnail when the next position is to come */
+        if( input_priv(p_input)->thumbnail_wait_seek
+         && atomic_load( &input_priv(p_input)->thumbnail_ready ) )
+            b_paused = true;
 
         if( !b_paused )
         {
@@ -686,6 +700,20 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
                 b_paused = true;
                 b_paused_at_eof = true;
             }
+            else if( input_priv(p_input)->thumbnail_wait_seek )
+            {
+                /* Notify the thumbnailer once, then wait for a seek */
+                if( !b_paused_at_eof
+                 && !atomic_load( &input_priv(p_input)->thumbnail_ready ) )
+                {
+                    msg_Dbg( p_input, "no thumbnail before EOF, waiting for a seek" );
+                    input_SendEvent( p_input, &(struct vlc_input_event) {
+                        .type = INPUT_EVENT_THUMBNAIL_READY,
+                        .thumbnail = NULL,
+                    });
+                    b_paused_at_eof = true;
+                }
+            }
             else
             {
                 if( MainLoopTryRepeat( p_input ) )
@@ -735,7 +763,10 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
             if( Control( p_input, i_type, param ) )
             {
                 if( ControlIsSeekRequest( i_type ) )
+                {
                     i_last_seek_mdate = vlc_tick_now();
+                    atomic_store( &input_priv(p_input)->thumbnail_ready, false );
+                }
                 i_intf_update = 0;
             }
 
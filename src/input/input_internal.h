@@ -312,7 +312,8 @@ struct vlc_input_event
         bool vbi_transparent;
         /* INPUT_EVENT_SUBS_FPS */
         float subs_fps;
-        /* INPUT_EVENT_THUMBNAIL_READY */
+        /* INPUT_EVENT_THUMBNAIL_READY, NULL if the end of the stream was
+         * reached without a thumbnail (cf. thumbnailing.wait_seek) */
         picture_t *thumbnail;
         /* INPUT_EVENT_ATTACHMENTS */
         struct vlc_input_event_attachments attachments;
@@ -344,6 +345,16 @@ struct vlc_input_thread_cfg
     struct {
         bool subitems;
     } preparsing;
+    struct {
+        /* Stop demuxing once a thumbnail is ready, or at the end of the
+         * stream, until the next seek request, instead of stopping the
+         * input. This allows to reuse the input for several thumbnails. */
+        bool wait_seek;
+        /* Smallest thumbnail size needed, 0 if unspecified (cf.
+         * decoder_t.i_target_width) */
+        unsigned target_width;
+        unsigned target_height;
+    } thumbnailing;
     bool interact;
 };
 /**
@@ -454,6 +465,10 @@ typedef struct input_thread_private_t
     enum input_type type;
     bool hw_dec;
     bool preparse_subitems;
+    bool thumbnail_wait_seek;
+    unsigned thumbnail_target_width;
+    unsigned thumbnail_target_height;
+    atomic_bool thumbnail_ready; /* since the last seek request */
 
     /* Current state */
     int         i_state;
@@ -718,6 +733,8 @@ struct input_stats {
     atomic_uintmax_t demux_discontinuity;
     atomic_uintmax_t decoded_audio;
     atomic_uintmax_t decoded_video;
+    atomic_uintmax_t dropped_video;
+    atomic_uint video_drop_level;
     atomic_uintmax_t played_abuffers;
     atomic_uintmax_t lost_abuffers;
     atomic_uintmax_t displayed_pictures;
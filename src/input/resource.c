@@ -43,6 +43,7 @@
 #include "input_interface.h"
 #include "event.h"
 #include "resource.h"
+#include "decoder_cache.h"
 
 struct vout_resource
 {
@@ -84,6 +85,10 @@ struct input_resource_t
 
     bool            b_aout_busy;
     audio_output_t *p_aout;
+
+    /* Decoded pictures cache, created on first use */
+    struct vlc_decoder_cache *p_decoder_cache;
+    bool            b_decoder_cache_probed;
 };
 
 #define resource_GetFirstVoutRsc(resource) \
@@ -334,6 +339,8 @@ void input_resource_Release( input_resource_t *p_resource )
     DestroyVout( p_resource );
     if( p_resource->p_aout != NULL )
         aout_Release( p_resource->p_aout );
+    if( p_resource->p_decoder_cache != NULL )
+        vlc_decoder_cache_Delete( p_resource->p_decoder_cache );
 
     vout_Release( p_resource->p_vout_dummy );
     free( p_resource );
@@ -645,3 +652,25 @@ void input_resource_TerminateSout( input_resource_t *p_resource )
     DestroySout(p_resource);
     vlc_mutex_unlock( &p_resource->lock );
 }
+
+struct vlc_decoder_cache *input_resource_GetDecoderCache( input_resource_t *p_resource )
+{
+    vlc_mutex_lock( &p_resource->lock );
+    if( !p_resource->b_decoder_cache_probed )
+    {
+        p_resource->b_decoder_cache_probed = true;
+
+        int64_t i_size = var_InheritInteger( p_resource->p_parent,
+                                             "decoder-cache-size" );
+        if( i_size > 0 )
+        {
+            p_resource->p_decoder_cache =
+                vlc_decoder_cache_New( (size_t)i_size * 1024 * 1024 );
+            if( p_resource->p_decoder_cache != NULL )
+                msg_Dbg( p_resource->p_parent,
+                         "decoded pictures cache of %"PRId64" MiB", i_size );
+        }
+    }
+    vlc_mutex_unlock( &p_resource->lock );
+    return p_resource->p_decoder_cache;
+}
@@ -96,4 +96,14 @@ input_resource_t *input_resource_Hold( input_resource_t * );
 
 void input_resource_ResetAout( input_resource_t * );
 
+struct vlc_decoder_cache;
+
+/**
+ * This function returns the decoded pictures cache shared by the inputs
+ * using this resource, or NULL if it is disabled.
+ *
+ * The cache lives as long as the resource.
+ */
+struct vlc_decoder_cache *input_resource_GetDecoderCache( input_resource_t * );
+
 #endif
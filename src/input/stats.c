@@ -63,6 +63,8 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->demux_discontinuity, 0);
     atomic_init(&stats->decoded_audio, 0);
     atomic_init(&stats->decoded_video, 0);
+    atomic_init(&stats->dropped_video, 0);
+    atomic_init(&stats->video_drop_level, 0);
     atomic_init(&stats->played_abuffers, 0);
     atomic_init(&stats->lost_abuffers, 0);
     atomic_init(&stats->displayed_pictures, 0);
@@ -105,6 +107,10 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
     /* Vouts */
     st->i_decoded_video = atomic_load_explicit(&stats->decoded_video,
                                                memory_order_relaxed);
+    st->i_dropped_video = atomic_load_explicit(&stats->dropped_video,
+                                               memory_order_relaxed);
+    st->i_video_drop_level = atomic_load_explicit(&stats->video_drop_level,
+                                                  memory_order_relaxed);
     st->i_displayed_pictures = atomic_load_explicit(&stats->displayed_pictures,
                                                     memory_order_relaxed);
     st->i_late_pictures = atomic_load_explicit(&stats->late_pictures,
@@ -45,6 +45,7 @@
 #include <vlc_aout.h>
 #include <vlc_vout.h>
 #include <vlc_player.h>
+#include <vlc_codec.h>
 
 #include "clock/clock.h"
 
@@ -374,13 +375,13 @@ static const char * const  ppsz_deinterlace_text[] = {
     "Deinterlace method to use for video processing.")
 static const char * const ppsz_deinterlace_mode[] = {
     "auto", "discard", "blend", "mean", "bob",
-    "linear", "x", "yadif", "yadif2x", "phosphor",
-    "ivtc"
+    "linear", "x", "yadif", "yadif2x", "bwdif", "bwdif2x",
+    "phosphor", "ivtc"
 };
 static const char * const ppsz_deinterlace_mode_text[] = {
     N_("Auto"), N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"),
-    N_("Linear"), "X", "Yadif", "Yadif (2x)", N_("Phosphor"),
-    N_("Film NTSC (IVTC)")
+    N_("Linear"), "X", "Yadif", "Yadif (2x)", "Bwdif", "Bwdif (2x)",
+    N_("Phosphor"), N_("Film NTSC (IVTC)")
 };
 
 #define DEINTERLACE_FILTER_TEXT N_("Deinterlace filter")
@@ -415,6 +416,11 @@ static const char *const screensaver_texts[] = {
     "picture quality, for instance deinterlacing, or distort " \
     "the video.")
 
+#define FILTER_THREADS_TEXT N_("Video filter threads")
+#define FILTER_THREADS_LONGTEXT N_( \
+    "Number of threads shared by the video filters that process pictures " \
+    "in slices (0 = number of CPUs, 1 = no threads).")
+
 #define SNAP_PATH_TEXT N_("Video snapshot directory (or filename)")
 #define SNAP_PATH_LONGTEXT N_( \
     "Directory where the video snapshots will be stored.")
@@ -680,6 +686,35 @@ static const char *const ppsz_prefres[] = {
     "Try to minimize delay along decoding chain. "\
     "Might break with non compliant streams.")
 
+#define INPUT_DECTHREADS_TEXT N_("Decoder threads")
+#define INPUT_DECTHREADS_LONGTEXT N_( \
+    "Maximum number of threads shared by the decoders of an input, each " \
+    "audio decoder counting for one. With 0, a single video decoder uses " \
+    "its own default, and video decoders running together share the CPUs. " \
+    "The share is computed when a video decoder starts: the decoders " \
+    "already running keep theirs.")
+
+#define INPUT_DECTHREADING_TEXT N_("Decoder threading")
+#define INPUT_DECTHREADING_LONGTEXT N_( \
+    "Preferred threading of the video decoders. Frame threading has the " \
+    "best throughput but adds one frame of latency per thread, slice " \
+    "threading does not add latency. Low delay mode implies slice " \
+    "threading.")
+#define INPUT_DECODER_CACHE_TEXT N_("Decoded pictures cache size (MiB)")
+#define INPUT_DECODER_CACHE_LONGTEXT N_( \
+    "Keep the decoded pictures of short videos in memory, up to this size, " \
+    "so that playing them again does not decode them anymore. This is " \
+    "useful for looping playlists of short clips. 0 disables the cache.")
+
+static const int pi_dec_threading[] = {
+    VLC_DECODER_THREADING_AUTO,
+    VLC_DECODER_THREADING_FRAME,
+    VLC_DECODER_THREADING_SLICE,
+};
+static const char *const ppsz_dec_threading[] = {
+    N_("Automatic"), N_("Frame"), N_("Slice"),
+};
+
 #define INPUT_REPEAT_TEXT N_("Input repetitions")
 #define INPUT_REPEAT_LONGTEXT N_( \
     "Number of time the same input will be repeated")
@@ -700,6 +735,12 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_FAST_SEEK_LONGTEXT N_( \
     "Favor speed over precision while seeking" )
 
+#define INPUT_FAST_PREROLL_TEXT N_("Skip non-reference frames when seeking")
+#define INPUT_FAST_PREROLL_LONGTEXT N_( \
+    "When seeking precisely, skip the frames between the previous keyframe " \
+    "and the target that no other frame depends on, instead of decoding " \
+    "them. This requires the stream to be parsed by a packetizer.")
+
 #define INPUT_RATE_TEXT N_("Playback speed")
 #define INPUT_RATE_LONGTEXT N_( \
     "This defines the playback speed (nominal speed is 1.0)." )
@@ -1749,6 +1790,9 @@ vlc_module_begin ()
     set_subcategory( SUBCAT_VIDEO_VFILTER )
     add_module_list("video-filter", "video filter", NULL,
                     VIDEO_FILTER_TEXT, VIDEO_FILTER_LONGTEXT)
+    add_integer( "filter-threads", 0, FILTER_THREADS_TEXT,
+                 FILTER_THREADS_LONGTEXT )
+        change_integer_range( 0, 64 )
 
 #if 0
     add_string( "pixel-ratio", "1", PIXEL_RATIO_TEXT, PIXEL_RATIO_TEXT )
@@ -1851,6 +1895,17 @@ vlc_module_begin ()
     add_bool( "low-delay", false, INPUT_LOWDELAY_TEXT,
               INPUT_LOWDELAY_LONGTEXT )
         change_safe ()
+    add_integer( "dec-threads", 0, INPUT_DECTHREADS_TEXT,
+                 INPUT_DECTHREADS_LONGTEXT )
+        change_integer_range( 0, 256 )
+        change_safe ()
+    add_integer( "dec-threading", VLC_DECODER_THREADING_AUTO,
+                 INPUT_DECTHREADING_TEXT, INPUT_DECTHREADING_LONGTEXT )
+        change_integer_list( pi_dec_threading, ppsz_dec_threading )
+        change_safe ()
+    add_integer( "decoder-cache-size", 0, INPUT_DECODER_CACHE_TEXT,
+                 INPUT_DECODER_CACHE_LONGTEXT )
+        change_integer_range( 0, 65536 )
 
     set_section( N_( "Playback control" ) , NULL)
     add_integer( "input-repeat", 0,
@@ -1869,6 +1924,9 @@ vlc_module_begin ()
     add_bool( "input-fast-seek", false,
               INPUT_FAST_SEEK_TEXT, INPUT_FAST_SEEK_LONGTEXT )
         change_safe ()
+    add_bool( "fast-preroll", true,
+              INPUT_FAST_PREROLL_TEXT, INPUT_FAST_PREROLL_LONGTEXT )
+        change_safe ()
     add_float( "rate", 1.,
                INPUT_RATE_TEXT, INPUT_RATE_LONGTEXT )
 
@@ -63,6 +63,7 @@
 #include <vlc_modules.h>
 #include <vlc_media_library.h>
 #include <vlc_tracer.h>
+#include <vlc_executor.h>
 #include "player/player.h"
 
 #include "libvlc.h"
@@ -96,6 +97,8 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->filter_executor = NULL;
+    priv->filter_executor_init = false;
 
     vlc_ExitInit( &priv->exit );
 
@@ -372,6 +375,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
     if( priv->media_source_provider )
         vlc_media_source_provider_Delete( priv->media_source_provider );
 
+    if( priv->filter_executor != NULL )
+        vlc_executor_Delete( priv->filter_executor );
+
     libvlc_InternalDialogClean( p_libvlc );
     libvlc_InternalKeystoreClean( p_libvlc );
     libvlc_InternalActionsClean( p_libvlc );
@@ -187,6 +187,8 @@ typedef struct libvlc_priv_t
     vlc_actions_t *actions; ///< Hotkeys handler
     struct vlc_medialibrary_t *p_media_library; ///< Media library instance
     struct vlc_tracer *tracer; ///< Tracer callbacks
+    struct vlc_executor *filter_executor; ///< Video filters slices threads
+    bool filter_executor_init;
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -197,6 +199,17 @@ static inline libvlc_priv_t *libvlc_priv (libvlc_int_t *libvlc)
     return container_of(libvlc, libvlc_priv_t, public_data);
 }
 
+struct vlc_filter_slice;
+
+/**
+ * Runs a callback on horizontal bands, on the threads shared by the video
+ * filters of the instance (see filter_ExecuteSlices()).
+ */
+void vlc_ExecuteSlices(vlc_object_t *obj, unsigned rows, unsigned align,
+                       unsigned overlap,
+                       void (*cb)(void *, const struct vlc_filter_slice *),
+                       void *opaque);
+
 int intf_InsertItem(libvlc_int_t *, const char *mrl, unsigned optc,
                     const char * const *optv, unsigned flags);
 void intf_DestroyAll( libvlc_int_t * );
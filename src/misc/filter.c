@@ -31,6 +31,8 @@
 #include <libvlc.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
+#include <vlc_executor.h>
+#include <vlc_cpu.h>
 #include "../misc/variables.h"
 
 /* */
@@ -213,3 +215,143 @@ void video_splitter_Delete( video_splitter_t *p_splitter )
     video_format_Clean( &p_splitter->fmt );
     vlc_object_delete(p_splitter);
 }
+
+/* */
+
+/* Minimum number of rows of a slice, to amortize the threads overhead */
+#define FILTER_SLICE_MIN_ROWS 16
+
+struct filter_slices
+{
+    vlc_filter_slice_cb cb;
+    void *opaque;
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    unsigned pending;
+};
+
+struct filter_slice_task
+{
+    struct vlc_runnable runnable;
+    struct filter_slices *slices;
+    struct vlc_filter_slice slice;
+};
+
+static void RunSlice(void *userdata)
+{
+    struct filter_slice_task *task = userdata;
+    struct filter_slices *slices = task->slices;
+
+    slices->cb(slices->opaque, &task->slice);
+
+    vlc_mutex_lock(&slices->lock);
+    if (--slices->pending == 0)
+        vlc_cond_signal(&slices->wait);
+    vlc_mutex_unlock(&slices->lock);
+}
+
+static vlc_executor_t *GetSlicesExecutor(vlc_object_t *obj)
+{
+    libvlc_int_t *libvlc = vlc_object_instance(obj);
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+    vlc_executor_t *executor;
+
+    vlc_mutex_lock(&priv->lock);
+    if (!priv->filter_executor_init)
+    {
+        unsigned threads = var_InheritInteger(libvlc, "filter-threads");
+        if (threads == 0)
+            threads = vlc_GetCPUCount();
+        /* The calling thread runs slices too */
+        if (threads > 1)
+            priv->filter_executor = vlc_executor_New(threads - 1);
+        priv->filter_executor_init = true;
+    }
+    executor = priv->filter_executor;
+    vlc_mutex_unlock(&priv->lock);
+    return executor;
+}
+
+void vlc_ExecuteSlices(vlc_object_t *obj, unsigned rows, unsigned align,
+                       unsigned overlap, vlc_filter_slice_cb cb, void *opaque)
+{
+    assert(align > 0);
+
+    if (rows == 0)
+        return;
+
+    /* The partition only depends on the picture, so that the output does not
+     * depend on the number of threads. */
+    const unsigned units = (rows + align - 1) / align;
+    unsigned count = rows / FILTER_SLICE_MIN_ROWS;
+    if (count > VLC_FILTER_SLICES_MAX)
+        count = VLC_FILTER_SLICES_MAX;
+    if (count > units)
+        count = units;
+    if (count == 0)
+        count = 1;
+
+    struct filter_slice_task tasks[VLC_FILTER_SLICES_MAX];
+    struct filter_slices slices = {
+        .cb = cb,
+        .opaque = opaque,
+        .pending = count - 1,
+    };
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct vlc_filter_slice *slice = &tasks[i].slice;
+        unsigned end = (i + 1) * units / count * align;
+
+        slice->index = i;
+        slice->first = i * units / count * align;
+        slice->count = __MIN(end, rows) - slice->first;
+        slice->start = slice->first > overlap ? slice->first - overlap : 0;
+        slice->end = __MIN(slice->first + slice->count + overlap, rows);
+    }
+
+    vlc_executor_t *executor = count > 1 ? GetSlicesExecutor(obj) : NULL;
+    if (executor == NULL)
+    {
+        for (unsigned i = 0; i < count; i++)
+            cb(opaque, &tasks[i].slice);
+        return;
+    }
+
+    vlc_mutex_init(&slices.lock);
+    vlc_cond_init(&slices.wait);
+
+    for (unsigned i = 1; i < count; i++)
+    {
+        tasks[i].runnable.run = RunSlice;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].slices = &slices;
+        vlc_executor_Submit(executor, &tasks[i].runnable);
+    }
+
+    cb(opaque, &tasks[0].slice);
+
+    /* Run the slices that no threads took yet (the threads are shared with
+     * the other filters), starting from the last submitted ones */
+    for (unsigned i = count - 1; i > 0; i--)
+        if (vlc_executor_Cancel(executor, &tasks[i].runnable))
+        {
+            cb(opaque, &tasks[i].slice);
+            vlc_mutex_lock(&slices.lock);
+            slices.pending--;
+            vlc_mutex_unlock(&slices.lock);
+        }
+
+    vlc_mutex_lock(&slices.lock);
+    while (slices.pending > 0)
+        vlc_cond_wait(&slices.wait, &slices.lock);
+    vlc_mutex_unlock(&slices.lock);
+}
+
+void filter_ExecuteSlices(filter_t *filter, unsigned rows, unsigned align,
+                          unsigned overlap, vlc_filter_slice_cb cb,
+                          void *opaque)
+{
+    vlc_ExecuteSlices(VLC_OBJECT(filter), rows, align, overlap, cb, opaque);
+}
@@ -104,6 +104,14 @@ vlc_frame_t *vlc_frame_Init(vlc_frame_t *restrict f, const struct vlc_frame_call
     return f;
 }
 
+/* Frame buffers allocated by the current thread */
+static thread_local uint64_t vlc_frame_allocs;
+
+uint64_t vlc_frame_GetAllocCount(void)
+{
+    return vlc_frame_allocs;
+}
+
 /** Initial memory alignment of data frame.
  * @note This must be a multiple of sizeof(void*) and a power of two.
  * libavcodec AVX optimizations require at least 32-bytes. */
@@ -136,6 +144,8 @@ vlc_frame_t *vlc_frame_Alloc (size_t size)
     if (unlikely(buf == NULL))
         return NULL;
 
+    vlc_frame_allocs++;
+
     vlc_frame_t *f = vlc_frame_heap_Alloc(buf, capacity);
     if (likely(f != NULL)) {
 #ifndef HAVE_ALIGNED_ALLOC
@@ -280,6 +290,108 @@ vlc_frame_t *vlc_frame_heap_Alloc (void *addr, size_t length)
     return frame;
 }
 
+/* Shared frames: the original frame is owned by a reference counted
+ * holder, and every slice holds a reference to it. */
+struct vlc_frame_holder
+{
+    vlc_atomic_rc_t rc;
+    vlc_frame_t *owner;
+};
+
+struct vlc_frame_slice
+{
+    vlc_frame_t frame;
+    struct vlc_frame_holder *holder;
+};
+
+static void vlc_frame_slice_Release(vlc_frame_t *frame)
+{
+    struct vlc_frame_slice *slice =
+        container_of(frame, struct vlc_frame_slice, frame);
+    struct vlc_frame_holder *holder = slice->holder;
+
+    if (vlc_atomic_rc_dec(&holder->rc))
+    {
+        vlc_frame_Release(holder->owner);
+        free(holder);
+    }
+    free(slice);
+}
+
+static const struct vlc_frame_callbacks vlc_frame_slice_cbs =
+{
+    vlc_frame_slice_Release,
+};
+
+static vlc_frame_t *vlc_frame_slice_New(struct vlc_frame_holder *holder,
+                                        uint8_t *buf, size_t length)
+{
+    struct vlc_frame_slice *slice = malloc(sizeof (*slice));
+    if (unlikely(slice == NULL))
+        return NULL;
+
+    slice->holder = holder;
+    return vlc_frame_Init(&slice->frame, &vlc_frame_slice_cbs, buf, length);
+}
+
+vlc_frame_t *vlc_frame_Share(vlc_frame_t *frame)
+{
+    if (frame->cbs == &vlc_frame_slice_cbs)
+        return frame;
+
+    struct vlc_frame_holder *holder = malloc(sizeof (*holder));
+    if (unlikely(holder == NULL))
+    {
+        vlc_frame_Release(frame);
+        return NULL;
+    }
+
+    vlc_frame_t *shared = vlc_frame_slice_New(holder, frame->p_buffer,
+                                              frame->i_buffer);
+    if (unlikely(shared == NULL))
+    {
+        free(holder);
+        vlc_frame_Release(frame);
+        return NULL;
+    }
+
+    vlc_atomic_rc_init(&holder->rc);
+    holder->owner = frame;
+
+    vlc_frame_CopyProperties(shared, frame);
+    shared->p_next = frame->p_next;
+    frame->p_next = NULL;
+    return shared;
+}
+
+vlc_frame_t *vlc_frame_Slice(vlc_frame_t *frame, size_t offset, size_t length)
+{
+    assert(offset <= frame->i_buffer);
+    assert(length <= frame->i_buffer - offset);
+
+    if (frame->cbs != &vlc_frame_slice_cbs)
+    {
+        /* Not shareable: copy */
+        vlc_frame_t *copy = vlc_frame_Alloc(length);
+        if (likely(copy != NULL))
+            memcpy(copy->p_buffer, frame->p_buffer + offset, length);
+        return copy;
+    }
+
+    struct vlc_frame_holder *holder =
+        container_of(frame, struct vlc_frame_slice, frame)->holder;
+    vlc_frame_t *slice = vlc_frame_slice_New(holder, frame->p_buffer + offset,
+                                             length);
+    if (likely(slice != NULL))
+        vlc_atomic_rc_inc(&holder->rc);
+    return slice;
+}
+
+bool vlc_frame_IsShared(const vlc_frame_t *frame)
+{
+    return frame->cbs == &vlc_frame_slice_cbs;
+}
+
 #ifdef HAVE_MMAP
 # include <sys/mman.h>
 
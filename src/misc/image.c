@@ -189,6 +189,10 @@ static picture_t *ImageRead( image_handler_t *p_image, block_t *p_block,
         }
     }
 
+    /* Let the decoder skip the work for the resolution scaled away below */
+    p_image->p_dec->i_target_width = p_fmt_out->i_width;
+    p_image->p_dec->i_target_height = p_fmt_out->i_height;
+
     p_block->i_pts = p_block->i_dts = vlc_tick_now();
     int ret = p_image->p_dec->pf_decode( p_image->p_dec, p_block );
     if( ret == VLCDEC_SUCCESS )
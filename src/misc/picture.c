@@ -38,8 +38,11 @@
 #include "picture.h"
 #include <vlc_image.h>
 #include <vlc_block.h>
+#include <vlc_filter.h>
+#include <vlc_cpu.h>
 
 #include "ancillary.h"
+#include "../libvlc.h"
 
 static void PictureDestroyContext( picture_t *p_picture )
 {
@@ -364,12 +367,78 @@ void picture_Destroy(picture_t *picture)
 /*****************************************************************************
  *
  *****************************************************************************/
-void plane_CopyPixels( plane_t *p_dst, const plane_t *p_src )
+
+/* Copies from this size are written around the caches: the destination would
+ * not fit in them anyway, and would evict the working set of the decoder
+ * (the reference pictures) for nothing. */
+#define PICTURE_STREAM_MIN_SIZE (4 << 20)
+/* Copies from this size (8K pictures) are split over the filter threads */
+#define PICTURE_THREADED_MIN_SIZE (32 << 20)
+
+#ifdef CAN_COMPILE_SSE2
+VLC_SSE
+static void SSE_StreamCopy( uint8_t *p_dst, const uint8_t *p_src,
+                            size_t i_size )
+{
+    /* The non-temporal stores need an aligned destination */
+    const size_t i_head = __MIN( -(uintptr_t)p_dst & 15, i_size );
+    memcpy( p_dst, p_src, i_head );
+    p_dst += i_head;
+    p_src += i_head;
+    i_size -= i_head;
+
+    for( ; i_size >= 64; i_size -= 64, p_dst += 64, p_src += 64 )
+        asm volatile (
+            "movdqu   0(%[src]), %%xmm1\n"
+            "movdqu  16(%[src]), %%xmm2\n"
+            "movdqu  32(%[src]), %%xmm3\n"
+            "movdqu  48(%[src]), %%xmm4\n"
+            "movntdq %%xmm1,  0(%[dst])\n"
+            "movntdq %%xmm2, 16(%[dst])\n"
+            "movntdq %%xmm3, 32(%[dst])\n"
+            "movntdq %%xmm4, 48(%[dst])\n"
+            : : [dst]"r"(p_dst), [src]"r"(p_src)
+            : "memory", "xmm1", "xmm2", "xmm3", "xmm4" );
+
+    memcpy( p_dst, p_src, i_size );
+}
+#endif
+
+static void StreamCopy( uint8_t *p_dst, const uint8_t *p_src, size_t i_size )
+{
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+    {
+        SSE_StreamCopy( p_dst, p_src, i_size );
+        return;
+    }
+#endif
+    memcpy( p_dst, p_src, i_size );
+}
+
+/* Makes the non-temporal stores visible before the copy is reported done */
+static void StreamFence( void )
+{
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+        asm volatile ("sfence" ::: "memory");
+#endif
+}
+
+static size_t PlaneCopySize( const plane_t *p_dst, const plane_t *p_src )
+{
+    return (size_t)__MIN( p_dst->i_visible_pitch, p_src->i_visible_pitch )
+         * __MIN( p_dst->i_visible_lines, p_src->i_visible_lines );
+}
+
+/* Copies i_count visible lines from i_first */
+static void CopyLines( plane_t *p_dst, const plane_t *p_src,
+                       unsigned i_first, unsigned i_count, bool b_stream )
 {
     const unsigned i_width  = __MIN( p_dst->i_visible_pitch,
                                      p_src->i_visible_pitch );
-    const unsigned i_height = __MIN( p_dst->i_visible_lines,
-                                     p_src->i_visible_lines );
+    uint8_t *p_out = &p_dst->p_pixels[(size_t)i_first * p_dst->i_pitch];
+    const uint8_t *p_in = &p_src->p_pixels[(size_t)i_first * p_src->i_pitch];
 
     /* The 2x visible pitch check does two things:
        1) Makes field plane_t's work correctly (see the deinterlacer module)
@@ -379,27 +448,42 @@ void plane_CopyPixels( plane_t *p_dst, const plane_t *p_src )
         p_src->i_pitch < 2*p_src->i_visible_pitch )
     {
         /* There are margins, but with the same width : perfect ! */
-        memcpy( p_dst->p_pixels, p_src->p_pixels,
-                    p_src->i_pitch * i_height );
+        const size_t i_size = (size_t)p_src->i_pitch * i_count;
+        if( b_stream )
+            StreamCopy( p_out, p_in, i_size );
+        else
+            memcpy( p_out, p_in, i_size );
     }
     else
     {
         /* We need to proceed line by line */
-        uint8_t *p_in = p_src->p_pixels;
-        uint8_t *p_out = p_dst->p_pixels;
-
         assert( p_in );
         assert( p_out );
 
-        for( int i_line = i_height; i_line--; )
+        for( unsigned i_line = i_count; i_line--; )
         {
-            memcpy( p_out, p_in, i_width );
+            if( b_stream )
+                StreamCopy( p_out, p_in, i_width );
+            else
+                memcpy( p_out, p_in, i_width );
             p_in += p_src->i_pitch;
             p_out += p_dst->i_pitch;
         }
     }
 }
 
+void plane_CopyPixels( plane_t *p_dst, const plane_t *p_src )
+{
+    const unsigned i_height = __MIN( p_dst->i_visible_lines,
+                                     p_src->i_visible_lines );
+    const bool b_stream =
+        PlaneCopySize( p_dst, p_src ) >= PICTURE_STREAM_MIN_SIZE;
+
+    CopyLines( p_dst, p_src, 0, i_height, b_stream );
+    if( b_stream )
+        StreamFence();
+}
+
 void picture_CopyProperties( picture_t *p_dst, const picture_t *p_src )
 {
     p_dst->date = p_src->date;
@@ -415,17 +499,96 @@ void picture_CopyProperties( picture_t *p_dst, const picture_t *p_src )
     vlc_ancillary_array_Dup(&dst_priv->ancillaries, &src_priv->ancillaries);
 }
 
-void picture_CopyPixels( picture_t *p_dst, const picture_t *p_src )
+static size_t PictureCopySize( const picture_t *p_dst,
+                               const picture_t *p_src )
 {
+    size_t i_size = 0;
     for( int i = 0; i < p_src->i_planes ; i++ )
-        plane_CopyPixels( p_dst->p+i, p_src->p+i );
+        i_size += PlaneCopySize( p_dst->p+i, p_src->p+i );
+    return i_size;
+}
 
+static void PictureCopyContext( picture_t *p_dst, const picture_t *p_src )
+{
     assert( p_dst->context == NULL );
 
     if( p_src->context != NULL )
         p_dst->context = p_src->context->copy( p_src->context );
 }
 
+void picture_CopyPixels( picture_t *p_dst, const picture_t *p_src )
+{
+    /* The decision is taken for the whole picture, so that the chroma planes
+     * of a large picture do not evict the caches either */
+    const bool b_stream =
+        PictureCopySize( p_dst, p_src ) >= PICTURE_STREAM_MIN_SIZE;
+
+    for( int i = 0; i < p_src->i_planes ; i++ )
+    {
+        plane_t *p_out = p_dst->p+i;
+        const plane_t *p_in = p_src->p+i;
+
+        CopyLines( p_out, p_in, 0,
+                   __MIN( p_out->i_visible_lines, p_in->i_visible_lines ),
+                   b_stream );
+    }
+    if( b_stream )
+        StreamFence();
+
+    PictureCopyContext( p_dst, p_src );
+}
+
+struct picture_copy_slices
+{
+    picture_t *p_dst;
+    const picture_t *p_src;
+    unsigned i_rows;
+};
+
+static void CopySlice( void *opaque, const struct vlc_filter_slice *slice )
+{
+    const struct picture_copy_slices *sys = opaque;
+    const unsigned i_end = slice->first + slice->count;
+
+    /* The bands of the first plane are scaled to the height of the others
+     * (the subsampled chroma planes) */
+    for( int i = 0; i < sys->p_src->i_planes ; i++ )
+    {
+        plane_t *p_out = sys->p_dst->p+i;
+        const plane_t *p_in = sys->p_src->p+i;
+        const uint64_t i_lines = __MIN( p_out->i_visible_lines,
+                                        p_in->i_visible_lines );
+        const unsigned i_first = slice->first * i_lines / sys->i_rows;
+        const unsigned i_last = i_end * i_lines / sys->i_rows;
+
+        CopyLines( p_out, p_in, i_first, i_last - i_first, true );
+    }
+    StreamFence();
+}
+
+void (picture_CopyPixelsThreaded)( vlc_object_t *obj, picture_t *p_dst,
+                                   const picture_t *p_src )
+{
+    const unsigned i_rows = p_src->i_planes > 0 ?
+        __MIN( p_dst->p[0].i_visible_lines, p_src->p[0].i_visible_lines ) : 0;
+
+    if( i_rows == 0 ||
+        PictureCopySize( p_dst, p_src ) < PICTURE_THREADED_MIN_SIZE )
+    {
+        picture_CopyPixels( p_dst, p_src );
+        return;
+    }
+
+    struct picture_copy_slices sys = {
+        .p_dst = p_dst,
+        .p_src = p_src,
+        .i_rows = i_rows,
+    };
+    vlc_ExecuteSlices( obj, i_rows, 1, 0, CopySlice, &sys );
+
+    PictureCopyContext( p_dst, p_src );
+}
+
 void picture_Copy( picture_t *p_dst, const picture_t *p_src )
 {
     picture_CopyPixels( p_dst, p_src );
@@ -31,6 +31,8 @@
 #include <vlc_interrupt.h>
 #include <vlc_modules.h>
 #include <vlc_fs.h>
+#include <vlc_image.h>
+#include <vlc_memstream.h>
 
 #include "input/input_interface.h"
 #include "input/input_internal.h"
@@ -41,6 +43,7 @@ union vlc_preparser_cbs
     const input_item_parser_cbs_t *parser;
     const struct vlc_thumbnailer_cbs *thumbnailer;
     const struct vlc_thumbnailer_to_files_cbs *thumbnailer_to_files;
+    const struct vlc_trickplay_cbs *trickplay;
 };
 
 struct vlc_preparser_t
@@ -67,6 +70,14 @@ struct task_thumbnail_output
     unsigned int creat_mode;
 };
 
+struct task_trickplay
+{
+    struct vlc_trickplay_arg arg;
+    char *prefix;
+    vlc_fourcc_t fourcc;
+    const char *ext;
+};
+
 struct task
 {
     vlc_preparser_t *preparser;
@@ -81,6 +92,7 @@ struct task
     picture_t *pic;
     struct task_thumbnail_output *outputs;
     size_t output_count;
+    struct task_trickplay *trickplay;
 
     vlc_sem_t preparse_ended;
     int preparse_status;
@@ -108,6 +120,7 @@ TaskNew(vlc_preparser_t *preparser, void (*run)(void *), input_item_t *item,
     task->pic = NULL;
     task->outputs = NULL;
     task->output_count = 0;
+    task->trickplay = NULL;
 
     if (thumb_arg == NULL)
         task->thumb_arg = (struct vlc_thumbnailer_arg) {
@@ -125,7 +138,8 @@ TaskNew(vlc_preparser_t *preparser, void (*run)(void *), input_item_t *item,
 
     task->runnable.run = run;
     task->runnable.userdata = task;
-    if (options & VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES)
+    if (options & (VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES |
+                   VLC_PREPARSER_TYPE_TRICKPLAY))
         task->i11e_ctx = vlc_interrupt_create();
     else
         task->i11e_ctx = NULL;
@@ -140,6 +154,11 @@ TaskDelete(struct task *task)
     for (size_t i = 0; i < task->output_count; ++i)
         free(task->outputs[i].file_path);
     free(task->outputs);
+    if (task->trickplay != NULL)
+    {
+        free(task->trickplay->prefix);
+        free(task->trickplay);
+    }
     if (task->i11e_ctx != NULL)
         vlc_interrupt_destroy(task->i11e_ctx);
     free(task);
@@ -350,7 +369,7 @@ on_thumbnailer_input_event( input_thread_t *input,
 }
 
 static int
-WriteToFile(const block_t *block, const char *path, unsigned mode)
+WriteToFile(const void *buf, size_t size, const char *path, unsigned mode)
 {
     int bflags =
 #ifdef O_BINARY
@@ -363,8 +382,7 @@ WriteToFile(const block_t *block, const char *path, unsigned mode)
     if (fd == -1)
         return -errno;
 
-    uint8_t *data = block->p_buffer;
-    size_t size = block->i_buffer;
+    const uint8_t *data = buf;
 
     while (size > 0)
     {
@@ -420,7 +438,8 @@ ThumbnailerToFilesRun(void *userdata)
             continue;
         }
 
-        ret = WriteToFile(block, output->file_path, output->creat_mode);
+        ret = WriteToFile(block->p_buffer, block->i_buffer, output->file_path,
+                          output->creat_mode);
         block_Release(block);
         if (ret == -EINTR)
         {
@@ -446,6 +465,27 @@ error:
     free(result_array);
 }
 
+/* Smallest decoded size covering all the outputs, whatever the orientation
+ * of the picture, 0 if an output keeps the original size */
+static unsigned
+ThumbnailerGetTargetSize(const struct task *task)
+{
+    unsigned size = 0;
+
+    for (size_t i = 0; i < task->output_count; ++i)
+    {
+        const struct task_thumbnail_output *output = &task->outputs[i];
+
+        if (output->fourcc == VLC_CODEC_UNKNOWN)
+            continue;
+        if (output->width < 0 || output->height < 0
+         || (output->width == 0 && output->height == 0))
+            return 0;
+        size = __MAX(size, (unsigned) __MAX(output->width, output->height));
+    }
+    return size;
+}
+
 static void
 ThumbnailerRun(void *userdata)
 {
@@ -458,12 +498,15 @@ ThumbnailerRun(void *userdata)
         .on_event = on_thumbnailer_input_event,
     };
 
+    unsigned target_size = ThumbnailerGetTargetSize(task);
     const struct vlc_input_thread_cfg cfg = {
         .type = INPUT_TYPE_THUMBNAILING,
         .hw_dec = task->thumb_arg.hw_dec ? INPUT_CFG_HW_DEC_ENABLED
                                          : INPUT_CFG_HW_DEC_DISABLED,
         .cbs = &cbs,
         .cbs_data = task,
+        .thumbnailing.target_width = target_size,
+        .thumbnailing.target_height = target_size,
     };
 
     vlc_tick_t deadline = preparser->timeout != VLC_TICK_INVALID ?
@@ -558,6 +601,450 @@ error:
         TaskDelete(task);
 }
 
+struct trickplay
+{
+    struct task *task;
+    image_handler_t *image;
+    video_format_t tile_fmt;
+    picture_t *sprite;
+    unsigned tile_count; /**< tiles in the current sprite */
+    struct vlc_memstream vtt;
+    struct vlc_trickplay_report report;
+
+    /* Stream date of the media start and length, set by the input */
+    _Atomic vlc_tick_t normal_time;
+    _Atomic vlc_tick_t length;
+    /* The cue of the last tile, ended by the next one */
+    struct
+    {
+        vlc_tick_t start;
+        size_t sprite;
+        unsigned tile;
+    } cue;
+};
+
+static void
+on_trickplay_input_event(input_thread_t *input,
+                         const struct vlc_input_event *event, void *userdata)
+{
+    struct trickplay *tp = userdata;
+
+    if (event->type == INPUT_EVENT_TIMES)
+    {
+        if (event->times.normal_time != VLC_TICK_INVALID)
+            atomic_store_explicit(&tp->normal_time, event->times.normal_time,
+                                  memory_order_relaxed);
+        atomic_store_explicit(&tp->length,
+                              input_GetItemDuration(input, event->times.length),
+                              memory_order_relaxed);
+        return;
+    }
+
+    if (event->type != INPUT_EVENT_THUMBNAIL_READY &&
+        (event->type != INPUT_EVENT_STATE || event->state.value != ERROR_S))
+        return;
+
+    struct task *task = tp->task;
+
+    /* A NULL thumbnail signals the end of the stream, the input is waiting
+     * for the next seek */
+    if (event->type == INPUT_EVENT_THUMBNAIL_READY && event->thumbnail != NULL)
+        task->pic = picture_Hold(event->thumbnail);
+    vlc_sem_post(&task->preparse_ended);
+}
+
+static void
+TrickplayClearSprite(picture_t *sprite)
+{
+    /* Black, for the unused tiles of the last sprite */
+    for (int i = 0; i < sprite->i_planes; ++i)
+        memset(sprite->p[i].p_pixels, i == 0 ? 0x10 : 0x80,
+               sprite->p[i].i_pitch * sprite->p[i].i_lines);
+}
+
+static int
+TrickplaySetup(struct trickplay *tp, const video_format_t *src)
+{
+    const struct vlc_trickplay_arg *arg = &tp->task->trickplay->arg;
+    unsigned width = arg->tile_width;
+    unsigned height = arg->tile_height;
+
+    if (height == 0)
+    {
+        unsigned sar_num = src->i_sar_num ? src->i_sar_num : 1;
+        unsigned sar_den = src->i_sar_den ? src->i_sar_den : 1;
+
+        if (src->i_visible_width == 0)
+            return VLC_EGENERIC;
+        height = (uint64_t) width * src->i_visible_height * sar_den
+               / ((uint64_t) src->i_visible_width * sar_num);
+    }
+    /* 4:2:0 tiles, aligned on chroma samples in the sprite */
+    width = __MAX((width + 1) & ~1u, 2);
+    height = __MAX((height + 1) & ~1u, 2);
+
+    video_format_Init(&tp->tile_fmt, VLC_CODEC_I420);
+    tp->tile_fmt.i_width = tp->tile_fmt.i_visible_width = width;
+    tp->tile_fmt.i_height = tp->tile_fmt.i_visible_height = height;
+    tp->tile_fmt.i_sar_num = tp->tile_fmt.i_sar_den = 1;
+
+    video_format_t sprite_fmt;
+    video_format_Init(&sprite_fmt, VLC_CODEC_I420);
+    sprite_fmt.i_width = sprite_fmt.i_visible_width = width * arg->columns;
+    sprite_fmt.i_height = sprite_fmt.i_visible_height = height * arg->rows;
+    sprite_fmt.i_sar_num = sprite_fmt.i_sar_den = 1;
+
+    tp->sprite = picture_NewFromFormat(&sprite_fmt);
+    video_format_Clean(&sprite_fmt);
+    if (tp->sprite == NULL)
+        return VLC_ENOMEM;
+    TrickplayClearSprite(tp->sprite);
+
+    tp->image = image_HandlerCreate(tp->task->preparser->owner);
+    if (tp->image == NULL)
+        return VLC_ENOMEM;
+    return VLC_SUCCESS;
+}
+
+static char *
+TrickplaySpritePath(const struct task_trickplay *trickplay, size_t index)
+{
+    char *path;
+    if (asprintf(&path, "%s-%zu.%s", trickplay->prefix, index,
+                 trickplay->ext) == -1)
+        return NULL;
+    return path;
+}
+
+static int
+TrickplayWriteSprite(struct trickplay *tp)
+{
+    struct task *task = tp->task;
+    const struct task_trickplay *trickplay = task->trickplay;
+
+    char *path = TrickplaySpritePath(trickplay, tp->report.sprite_count);
+    if (path == NULL)
+        return VLC_ENOMEM;
+
+    block_t *block;
+    int ret = picture_Export(task->preparser->owner, &block, NULL, tp->sprite,
+                             trickplay->fourcc, -1, -1, false);
+    if (ret == VLC_SUCCESS)
+    {
+        ret = WriteToFile(block->p_buffer, block->i_buffer, path,
+                          trickplay->arg.creat_mode);
+        block_Release(block);
+    }
+    free(path);
+
+    if (ret != VLC_SUCCESS)
+        return ret;
+
+    tp->report.sprite_count++;
+    tp->tile_count = 0;
+    TrickplayClearSprite(tp->sprite);
+    return VLC_SUCCESS;
+}
+
+static void
+TrickplayPrintTime(struct vlc_memstream *ms, vlc_tick_t tick)
+{
+    /* Rounded, the dates of the pictures being off by a tick at times */
+    int64_t ms_time = MS_FROM_VLC_TICK(tick + VLC_TICK_FROM_US(500));
+    vlc_memstream_printf(ms, "%02"PRId64":%02u:%02u.%03u",
+                         ms_time / 3600000, (unsigned)(ms_time / 60000 % 60),
+                         (unsigned)(ms_time / 1000 % 60),
+                         (unsigned)(ms_time % 1000));
+}
+
+static int
+TrickplayEndCue(struct trickplay *tp, vlc_tick_t end)
+{
+    const struct task_trickplay *trickplay = tp->task->trickplay;
+
+    /* The sprite is referenced relatively to the index */
+    char *path = TrickplaySpritePath(trickplay, tp->cue.sprite);
+    if (path == NULL)
+        return VLC_ENOMEM;
+    const char *name = strrchr(path, DIR_SEP_CHAR);
+    name = name != NULL ? name + 1 : path;
+
+    unsigned col = tp->cue.tile % trickplay->arg.columns;
+    unsigned row = tp->cue.tile / trickplay->arg.columns;
+
+    TrickplayPrintTime(&tp->vtt, tp->cue.start);
+    vlc_memstream_puts(&tp->vtt, " --> ");
+    TrickplayPrintTime(&tp->vtt, end);
+    vlc_memstream_printf(&tp->vtt, "\n%s#xywh=%u,%u,%u,%u\n\n", name,
+                         col * tp->tile_fmt.i_visible_width,
+                         row * tp->tile_fmt.i_visible_height,
+                         tp->tile_fmt.i_visible_width,
+                         tp->tile_fmt.i_visible_height);
+    free(path);
+    return VLC_SUCCESS;
+}
+
+static int
+TrickplayAddTile(struct trickplay *tp, picture_t *pic, vlc_tick_t start)
+{
+    const struct task_trickplay *trickplay = tp->task->trickplay;
+
+    if (tp->sprite == NULL)
+    {
+        int ret = TrickplaySetup(tp, &pic->format);
+        if (ret != VLC_SUCCESS)
+            return ret;
+    }
+
+    video_format_t fmt_out = tp->tile_fmt;
+    picture_t *tile = image_Convert(tp->image, pic, &pic->format, &fmt_out);
+    if (tile == NULL)
+        return VLC_EGENERIC;
+
+    unsigned col = tp->tile_count % trickplay->arg.columns;
+    unsigned row = tp->tile_count / trickplay->arg.columns;
+
+    for (int i = 0; i < tile->i_planes && i < tp->sprite->i_planes; ++i)
+    {
+        const plane_t *src = &tile->p[i];
+        const plane_t *dst = &tp->sprite->p[i];
+        uint8_t *p = dst->p_pixels + row * src->i_visible_lines * dst->i_pitch
+                   + col * src->i_visible_pitch;
+
+        for (int y = 0; y < src->i_visible_lines; ++y)
+            memcpy(&p[y * dst->i_pitch], &src->p_pixels[y * src->i_pitch],
+                   src->i_visible_pitch);
+    }
+    picture_Release(tile);
+
+    if (tp->report.thumbnail_count > 0)
+    {
+        int ret = TrickplayEndCue(tp, start);
+        if (ret != VLC_SUCCESS)
+            return ret;
+    }
+    tp->cue.start = start;
+    tp->cue.sprite = tp->report.sprite_count;
+    tp->cue.tile = tp->tile_count;
+
+    tp->report.thumbnail_count++;
+    if (++tp->tile_count == trickplay->arg.columns * trickplay->arg.rows)
+        return TrickplayWriteSprite(tp);
+    return VLC_SUCCESS;
+}
+
+static int
+TrickplayWriteIndex(struct trickplay *tp)
+{
+    const struct task_trickplay *trickplay = tp->task->trickplay;
+
+    if (vlc_memstream_close(&tp->vtt))
+        return VLC_ENOMEM;
+
+    char *path;
+    int ret;
+    if (asprintf(&path, "%s.vtt", trickplay->prefix) == -1)
+        ret = VLC_ENOMEM;
+    else
+    {
+        ret = WriteToFile(tp->vtt.ptr, tp->vtt.length, path,
+                          trickplay->arg.creat_mode);
+        free(path);
+    }
+    free(tp->vtt.ptr);
+    return ret;
+}
+
+static void
+TrickplayRun(void *userdata)
+{
+    vlc_thread_set_name("vlc-run-trick");
+
+    struct task *task = userdata;
+    vlc_preparser_t *preparser = task->preparser;
+    const struct vlc_trickplay_arg *arg = &task->trickplay->arg;
+
+    static const struct vlc_input_thread_callbacks cbs = {
+        .on_event = on_trickplay_input_event,
+    };
+
+    struct trickplay tp = {
+        .task = task,
+        .normal_time = VLC_TICK_0,
+        .length = VLC_TICK_INVALID,
+    };
+
+    const struct vlc_input_thread_cfg cfg = {
+        .type = INPUT_TYPE_THUMBNAILING,
+        .hw_dec = arg->hw_dec ? INPUT_CFG_HW_DEC_ENABLED
+                              : INPUT_CFG_HW_DEC_DISABLED,
+        .cbs = &cbs,
+        .cbs_data = &tp,
+        .thumbnailing = {
+            .wait_seek = true,
+            .target_width = arg->tile_width,
+            .target_height = arg->tile_height,
+        },
+    };
+    vlc_tick_t start = vlc_tick_now();
+
+    vlc_interrupt_set(task->i11e_ctx);
+    task->preparse_status = VLC_EGENERIC;
+
+    if (vlc_memstream_open(&tp.vtt))
+        goto end;
+    vlc_memstream_puts(&tp.vtt, "WEBVTT\n\n");
+
+    input_thread_t *input = input_Create(preparser->owner, task->item, &cfg);
+    if (input == NULL)
+    {
+        if (vlc_memstream_close(&tp.vtt) == 0)
+            free(tp.vtt.ptr);
+        goto end;
+    }
+
+    /* Every position is reached by a fast seek, landing on a keyframe: let
+     * the decoder discard all the other frames instead of decoding them */
+    var_Create(input, "avcodec-skip-frame", VLC_VAR_INTEGER);
+    var_SetInteger(input, "avcodec-skip-frame", 3 /* non-key */);
+
+    if (input_Start(input) != VLC_SUCCESS)
+    {
+        input_Close(input);
+        if (vlc_memstream_close(&tp.vtt) == 0)
+            free(tp.vtt.ptr);
+        goto end;
+    }
+
+    vlc_tick_t interval = arg->interval;
+    vlc_tick_t duration = VLC_TICK_INVALID;
+    vlc_tick_t last = 0; /* media date of the last tile */
+    size_t duplicates = 0;
+    int status = VLC_SUCCESS;
+
+    for (vlc_tick_t time = 0;; time += interval)
+    {
+        if (time > 0)
+        {
+            /* Skip the positions before the last keyframe: the fast seek
+             * would land on it again */
+            if (tp.report.thumbnail_count > 0 && time <= last)
+                time = last + interval - (last % interval);
+            if (time >= duration)
+                break;
+            input_SetTime(input, time, true);
+        }
+
+        if (preparser->timeout == VLC_TICK_INVALID)
+            vlc_sem_wait(&task->preparse_ended);
+        else if (vlc_sem_timedwait(&task->preparse_ended,
+                                   vlc_tick_now() + preparser->timeout))
+        {
+            status = VLC_ETIMEOUT;
+            break;
+        }
+
+        if (atomic_load(&task->interrupted))
+        {
+            status = -EINTR;
+            break;
+        }
+
+        picture_t *pic = task->pic;
+        task->pic = NULL;
+        if (pic == NULL)
+        {
+            /* No keyframe left, or failure before the first thumbnail */
+            if (time == 0)
+                status = VLC_EGENERIC;
+            break;
+        }
+
+        if (time == 0)
+        {
+            duration = input_item_GetDuration(task->item);
+            if (duration <= 0)
+                duration = atomic_load_explicit(&tp.length,
+                                                memory_order_relaxed);
+            /* Unknown length: only the first thumbnail can be placed */
+            if (duration <= 0)
+                duration = interval;
+        }
+
+        /* Label the cue with the date of the keyframe the seek landed on,
+         * the first one covering the start of the media */
+        vlc_tick_t date = time;
+        if (pic->date != VLC_TICK_INVALID)
+            date = pic->date - atomic_load_explicit(&tp.normal_time,
+                                                    memory_order_relaxed);
+        if (time == 0 || date < 0)
+            date = 0;
+        else if (date >= duration)
+            date = time;
+
+        if (tp.report.thumbnail_count > 0 && date <= last)
+        {
+            /* Keyframes sparser than the interval: the seek landed on the
+             * same keyframe as the previous one, merge them */
+            duplicates++;
+            picture_Release(pic);
+            continue;
+        }
+        last = date;
+
+        status = TrickplayAddTile(&tp, pic, date);
+        picture_Release(pic);
+        if (status != VLC_SUCCESS)
+            break;
+    }
+
+    if (duplicates > 0)
+        msg_Dbg(preparser->owner, "trickplay: %zu positions on the same "
+                "keyframe as the previous one", duplicates);
+
+    input_Stop(input);
+    input_Close(input);
+    if (task->pic != NULL)
+    {
+        picture_Release(task->pic);
+        task->pic = NULL;
+    }
+
+    if (status == VLC_SUCCESS && tp.report.thumbnail_count > 0)
+        status = TrickplayEndCue(&tp, duration);
+    if (status == VLC_SUCCESS && tp.tile_count > 0)
+        status = TrickplayWriteSprite(&tp);
+    if (status == VLC_SUCCESS)
+        status = TrickplayWriteIndex(&tp);
+    else
+    {
+        if (vlc_memstream_close(&tp.vtt) == 0)
+            free(tp.vtt.ptr);
+    }
+    task->preparse_status = status;
+
+end:
+    if (tp.image != NULL)
+        image_HandlerDelete(tp.image);
+    if (tp.sprite != NULL)
+        picture_Release(tp.sprite);
+
+    if (atomic_load(&task->interrupted))
+        task->preparse_status = -EINTR;
+
+    tp.report.elapsed = vlc_tick_now() - start;
+    if (tp.report.thumbnail_count > 0)
+        msg_Dbg(preparser->owner, "trickplay: %zu thumbnails in %zu sprites, "
+                "%.2f thumbnails/s", tp.report.thumbnail_count,
+                tp.report.sprite_count, tp.report.thumbnail_count
+                * (double) CLOCK_FREQ / __MAX(tp.report.elapsed, 1));
+
+    PreparserRemoveTask(preparser, task);
+    task->cbs.trickplay->on_ended(task->item, task->preparse_status,
+                                  &tp.report, task->userdata);
+    TaskDelete(task);
+}
+
 static void
 Interrupt(struct task *task)
 {
@@ -578,7 +1065,9 @@ vlc_preparser_t* vlc_preparser_New( vlc_object_t *parent,
     int request_type = cfg->types;
     assert(request_type & (VLC_PREPARSER_TYPE_FETCHMETA_ALL|
                            VLC_PREPARSER_TYPE_PARSE|
-                           VLC_PREPARSER_TYPE_THUMBNAIL));
+                           VLC_PREPARSER_TYPE_THUMBNAIL|
+                           VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES|
+                           VLC_PREPARSER_TYPE_TRICKPLAY));
 
     unsigned parser_threads = cfg->max_parser_threads == 0 ? 1 :
                               cfg->max_parser_threads;
@@ -611,7 +1100,8 @@ vlc_preparser_t* vlc_preparser_New( vlc_object_t *parent,
         preparser->fetcher = NULL;
 
     if (request_type & (VLC_PREPARSER_TYPE_THUMBNAIL |
-                        VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES))
+                        VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES |
+                        VLC_PREPARSER_TYPE_TRICKPLAY))
     {
         preparser->thumbnailer = vlc_executor_New(thumbnailer_threads);
         if (!preparser->thumbnailer)
@@ -855,6 +1345,61 @@ vlc_preparser_GenerateThumbnailToFiles( vlc_preparser_t *preparser, input_item_t
     return id;
 }
 
+vlc_preparser_req_id
+vlc_preparser_GenerateTrickplay( vlc_preparser_t *preparser, input_item_t *item,
+                                 const struct vlc_trickplay_arg *arg,
+                                 const struct vlc_trickplay_cbs *cbs,
+                                 void *cbs_userdata )
+{
+    assert(preparser->thumbnailer != NULL);
+    assert(cbs != NULL && cbs->on_ended != NULL);
+    assert(arg != NULL && arg->prefix != NULL);
+    assert(arg->tile_width > 0 && arg->columns > 0 && arg->rows > 0);
+    assert(arg->interval >= 0);
+
+    union vlc_preparser_cbs task_cbs = {
+        .trickplay = cbs,
+    };
+
+    struct task *task =
+        TaskNew(preparser, TrickplayRun, item, VLC_PREPARSER_TYPE_TRICKPLAY,
+                NULL, task_cbs, cbs_userdata);
+    if (task == NULL)
+        return VLC_PREPARSER_REQ_ID_INVALID;
+
+    struct task_trickplay *trickplay = malloc(sizeof(*trickplay));
+    if (unlikely(trickplay == NULL))
+    {
+        TaskDelete(task);
+        return VLC_PREPARSER_REQ_ID_INVALID;
+    }
+    task->trickplay = trickplay;
+    trickplay->arg = *arg;
+    if (trickplay->arg.interval == 0)
+        trickplay->arg.interval = VLC_TICK_FROM_SEC(10);
+    trickplay->prefix = strdup(arg->prefix);
+    trickplay->arg.prefix = trickplay->prefix;
+    if (unlikely(trickplay->prefix == NULL))
+    {
+        TaskDelete(task);
+        return VLC_PREPARSER_REQ_ID_INVALID;
+    }
+
+    if (CheckThumbnailerFormat(arg->format, NULL, &trickplay->ext,
+                               &trickplay->fourcc) != 0)
+    {
+        TaskDelete(task);
+        msg_Err(preparser->owner, "trickplay: no valid \"image encoder\" found");
+        return VLC_PREPARSER_REQ_ID_INVALID;
+    }
+
+    vlc_preparser_req_id id = PreparserAddTask(preparser, task);
+
+    vlc_executor_Submit(preparser->thumbnailer, &task->runnable);
+
+    return id;
+}
+
 size_t vlc_preparser_Cancel( vlc_preparser_t *preparser, vlc_preparser_req_id id )
 {
     vlc_mutex_lock(&preparser->lock);
@@ -875,7 +1420,8 @@ size_t vlc_preparser_Cancel( vlc_preparser_t *preparser, vlc_preparser_req_id id
                                                &task->runnable);
             }
             else if (task->options & (VLC_PREPARSER_TYPE_THUMBNAIL |
-                                      VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES))
+                                      VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES |
+                                      VLC_PREPARSER_TYPE_TRICKPLAY))
             {
                 assert(preparser->thumbnailer != NULL);
                 canceled = vlc_executor_Cancel(preparser->thumbnailer,
@@ -910,6 +1456,13 @@ size_t vlc_preparser_Cancel( vlc_preparser_t *preparser, vlc_preparser_req_id id
                                                     task->preparse_status, NULL,
                                                     task->userdata);
                 }
+                else if (task->options & VLC_PREPARSER_TYPE_TRICKPLAY)
+                {
+                    const struct vlc_trickplay_report report = { 0 };
+                    task->cbs.trickplay->on_ended(task->item,
+                                                  task->preparse_status,
+                                                  &report, task->userdata);
+                }
                 else
                 {
                     assert(task->options & VLC_PREPARSER_TYPE_THUMBNAIL_TO_FILES);
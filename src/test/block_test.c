@@ -86,11 +86,64 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_Slice(void)
+{
+    block_t *block = block_Alloc(sizeof (text));
+    assert(block != NULL);
+    memcpy(block->p_buffer, text, sizeof (text));
+    block->i_pts = VLC_TICK_0;
+
+    /* Non-shareable parent: the slice is a copy */
+    uint64_t allocs = block_GetAllocCount();
+    block_t *slice = block_Slice(block, 5, 7);
+    assert(slice != NULL);
+    assert(block_GetAllocCount() == allocs + 1);
+    assert(!block_IsShared(slice));
+    assert(slice->p_buffer != block->p_buffer + 5);
+    assert(!memcmp(slice->p_buffer, text + 5, 7));
+    block_Release(slice);
+
+    block = block_Share(block);
+    assert(block != NULL);
+    assert(block_IsShared(block));
+    assert(block->i_pts == VLC_TICK_0);
+    assert(block->i_buffer == sizeof (text));
+    assert(block_Share(block) == block);
+
+    /* Shareable parent: no copy, slices outlive the parent */
+    allocs = block_GetAllocCount();
+    block_t *first = block_Slice(block, 0, 4);
+    block_t *second = block_Slice(block, 5, 2);
+    assert(first != NULL && second != NULL);
+    assert(block_GetAllocCount() == allocs);
+    assert(first->p_buffer == block->p_buffer);
+    assert(second->p_buffer == block->p_buffer + 5);
+    assert(first->i_pts == VLC_TICK_INVALID);
+    block_Release(block);
+
+    /* Slice of a slice */
+    block_t *third = block_Slice(second, 1, 1);
+    assert(third != NULL);
+    assert(block_IsShared(third));
+    block_Release(second);
+    assert(third->i_buffer == 1 && third->p_buffer[0] == 's');
+    block_Release(third);
+
+    assert(!memcmp(first->p_buffer, "This", 4));
+    /* Growing a slice must not touch the parent memory */
+    first = block_Realloc(first, 0, 8);
+    assert(first != NULL);
+    assert(!block_IsShared(first));
+    assert(!memcmp(first->p_buffer, "This", 4));
+    block_Release(first);
+}
+
 int main (void)
 {
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_Slice();
     return 0;
 }
 
@@ -50,6 +50,8 @@ static const char deinterlace_modes[][9]= {
     "x",
     "yadif",
     "yadif2x",
+    "bwdif",
+    "bwdif2x",
     "phosphor",
     "ivtc",
 };
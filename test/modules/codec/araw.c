@@ -0,0 +1,106 @@
+/*****************************************************************************
+ * araw.c: raw PCM decoder vectorized unpacking test
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#define MODULE_NAME araw
+#include "../module_test.h"
+#include "../modules/codec/araw.c"
+
+#define TEST_SAMPLES 1027
+
+static uint8_t test_in[TEST_SAMPLES * 8];
+static uint8_t test_ref[TEST_SAMPLES * 8 + 32];
+static uint8_t test_out[TEST_SAMPLES * 8 + 32];
+
+static void fill_input( unsigned seed )
+{
+    test_fill_random( test_in, sizeof(test_in), seed );
+
+    /* some infinities and NaNs, in both byte orders */
+    for( size_t i = 0; i + 8 <= sizeof(test_in); i += 8 * 13 )
+    {
+        memset( &test_in[i], 0xFF, 2 );
+        memset( &test_in[i + 6], 0x7F, 2 );
+    }
+    for( size_t i = 4; i + 4 <= sizeof(test_in); i += 4 * 7 )
+    {
+        test_in[i] = 0x7F;
+        test_in[i + 1] = 0x80;
+        test_in[i + 2] = 0x80;
+        test_in[i + 3] = 0x7F;
+    }
+}
+
+/* Checks that a vectorized kernel followed by the scalar tail matches the
+ * scalar decoder, bit per bit, and does not write past the output */
+static int check_unpack( const char *name, pcm_unpack_fn fn )
+{
+    for( size_t i = 0; i < ARRAY_SIZE(pcm_unpacks); i++ )
+    {
+        const struct pcm_unpack *u = &pcm_unpacks[i];
+        size_t out_size = 16 / u->samples;
+
+        for( unsigned samples = 0; samples <= TEST_SAMPLES;
+             samples += (samples < 70) ? 1 : 97 )
+        {
+            decoder_sys_t sys = {
+                .decode = u->decode,
+                .unpack = u,
+                .unpack_simd = fn,
+            };
+
+            memset( test_ref, TEST_JUNK, sizeof(test_ref) );
+            memset( test_out, TEST_JUNK, sizeof(test_out) );
+
+            u->decode( test_ref, test_in, samples );
+            Unpack( &sys, test_out, test_in, samples );
+
+            if( memcmp( test_ref, test_out, samples * out_size + 32 ) )
+            {
+                fprintf( stderr, "%s: mismatch for kernel %zu with %u samples\n",
+                         name, i, samples );
+                return 1;
+            }
+        }
+    }
+    printf( "%s: ok\n", name );
+    return 0;
+}
+
+int main( void )
+{
+    int ret = 0;
+
+    for( unsigned seed = 0; seed < 4 && ret == 0; seed++ )
+    {
+        fill_input( seed );
+#ifdef PCM_UNPACK_X86
+        if( vlc_CPU_SSSE3() )
+            ret |= check_unpack( "ssse3", pcm_UnpackSSSE3 );
+# ifdef CAN_COMPILE_AVX2
+        if( vlc_CPU_AVX2() )
+            ret |= check_unpack( "avx2", pcm_UnpackAVX2 );
+# endif
+#endif
+#ifdef PCM_UNPACK_NEON
+        ret |= check_unpack( "neon", pcm_UnpackNEON );
+#endif
+    }
+    return ret;
+}
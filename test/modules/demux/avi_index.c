@@ -0,0 +1,432 @@
+/*****************************************************************************
+ * avi_index.c: test the AVI demux index cache and background reading
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+#define FRAMES 50
+#define FRAME_SIZE 16
+/* Must match AVI_INDEX_CACHE_MAX_FILES */
+#define CACHE_MAX_FILES 64
+
+static char tmpdir[] = "/tmp/vlc-test-avi-index-XXXXXX";
+static char avi_path[64];
+static char cache_dir[128];
+
+/*****************************************************************************
+ * Minimal AVI file, one MJPG track, with or without idx1
+ *****************************************************************************/
+static void PutDW(FILE *f, uint32_t v)
+{
+    uint8_t buf[4];
+    SetDWLE(buf, v);
+    assert(fwrite(buf, sizeof (buf), 1, f) == 1);
+}
+
+static void PutW(FILE *f, uint16_t v)
+{
+    uint8_t buf[2];
+    SetWLE(buf, v);
+    assert(fwrite(buf, sizeof (buf), 1, f) == 1);
+}
+
+static void PutFourCC(FILE *f, const char *fcc)
+{
+    assert(fwrite(fcc, 4, 1, f) == 1);
+}
+
+static void WriteAVI(const char *path, bool idx1)
+{
+    FILE *f = fopen(path, "wb");
+    assert(f != NULL);
+
+    const uint32_t strl_size = 4 + (8 + 56) + (8 + 40);
+    const uint32_t hdrl_size = 4 + (8 + 56) + (8 + strl_size);
+    const uint32_t movi_size = 4 + FRAMES * (8 + FRAME_SIZE);
+    const uint32_t idx1_size = idx1 ? FRAMES * 16 : 0;
+
+    PutFourCC(f, "RIFF");
+    PutDW(f, 4 + (8 + hdrl_size) + (8 + movi_size) + (idx1 ? 8 + idx1_size : 0));
+    PutFourCC(f, "AVI ");
+
+    PutFourCC(f, "LIST");
+    PutDW(f, hdrl_size);
+    PutFourCC(f, "hdrl");
+
+    PutFourCC(f, "avih");
+    PutDW(f, 56);
+    PutDW(f, 40000);            /* microseconds per frame */
+    PutDW(f, 25 * FRAME_SIZE);  /* max bytes per second */
+    PutDW(f, 0);                /* padding granularity */
+    PutDW(f, idx1 ? 0x10 : 0);  /* flags: AVIF_HASINDEX */
+    PutDW(f, FRAMES);
+    PutDW(f, 0);                /* initial frames */
+    PutDW(f, 1);                /* streams */
+    PutDW(f, FRAME_SIZE);
+    PutDW(f, 16);
+    PutDW(f, 16);
+    for (int i = 0; i < 4; i++)
+        PutDW(f, 0);
+
+    PutFourCC(f, "LIST");
+    PutDW(f, strl_size);
+    PutFourCC(f, "strl");
+
+    PutFourCC(f, "strh");
+    PutDW(f, 56);
+    PutFourCC(f, "vids");
+    PutFourCC(f, "MJPG");
+    PutDW(f, 0);                /* flags */
+    PutW(f, 0);                 /* priority */
+    PutW(f, 0);                 /* language */
+    PutDW(f, 0);                /* initial frames */
+    PutDW(f, 1);                /* scale */
+    PutDW(f, 25);               /* rate */
+    PutDW(f, 0);                /* start */
+    PutDW(f, FRAMES);           /* length */
+    PutDW(f, FRAME_SIZE);
+    PutDW(f, UINT32_MAX);       /* quality */
+    PutDW(f, 0);                /* sample size */
+    PutW(f, 0); PutW(f, 0); PutW(f, 16); PutW(f, 16);
+
+    PutFourCC(f, "strf");
+    PutDW(f, 40);
+    PutDW(f, 40);
+    PutDW(f, 16);
+    PutDW(f, 16);
+    PutW(f, 1);
+    PutW(f, 24);
+    PutFourCC(f, "MJPG");
+    PutDW(f, 16 * 16 * 3);
+    for (int i = 0; i < 4; i++)
+        PutDW(f, 0);
+
+    PutFourCC(f, "LIST");
+    PutDW(f, movi_size);
+    PutFourCC(f, "movi");
+    for (int i = 0; i < FRAMES; i++)
+    {
+        uint8_t data[FRAME_SIZE];
+        memset(data, i, sizeof (data));
+        PutFourCC(f, "00dc");
+        PutDW(f, FRAME_SIZE);
+        assert(fwrite(data, sizeof (data), 1, f) == 1);
+    }
+
+    if (idx1)
+    {
+        PutFourCC(f, "idx1");
+        PutDW(f, idx1_size);
+        for (int i = 0; i < FRAMES; i++)
+        {
+            PutFourCC(f, "00dc");
+            PutDW(f, 0x10);     /* AVIIF_KEYFRAME */
+            PutDW(f, 4 + i * (8 + FRAME_SIZE)); /* from the movi fourcc */
+            PutDW(f, FRAME_SIZE);
+        }
+    }
+
+    assert(fclose(f) == 0);
+}
+
+/*****************************************************************************
+ * Demux
+ *****************************************************************************/
+static es_out_id_t *trash_es_out_Add(es_out_t *out, input_source_t *in,
+                                     const es_format_t *fmt)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    return (es_out_id_t *)(uintptr_t)(fmt->i_id + 1);
+}
+
+static int trash_es_out_Send(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void trash_es_out_Del(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int trash_es_out_Control(es_out_t *out, input_source_t *in, int query,
+                                va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    if (query == ES_OUT_GET_ES_STATE)
+    {
+        (void) va_arg(args, es_out_id_t *);
+        *va_arg(args, bool *) = true;
+        return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
+static void trash_es_out_Delete(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks trash_es_out_cbs =
+{
+    .add = trash_es_out_Add,
+    .send = trash_es_out_Send,
+    .del = trash_es_out_Del,
+    .control = trash_es_out_Control,
+    .destroy = trash_es_out_Delete,
+};
+
+static void OpenAVI(vlc_object_t *obj)
+{
+    es_out_t out = { .cbs = &trash_es_out_cbs };
+
+    char *url = vlc_path2uri(avi_path, NULL);
+    assert(url != NULL);
+
+    stream_t *s = vlc_stream_NewURL(obj, url);
+    assert(s != NULL);
+    demux_t *demux = demux_New(obj, "avi", url, s, &out);
+    assert(demux != NULL);
+
+    bool can_seek;
+    assert(vlc_stream_Control(s, STREAM_CAN_FASTSEEK, &can_seek) == VLC_SUCCESS
+        && can_seek);
+
+    demux_Delete(demux);
+    free(url);
+}
+
+/* The index is read in background, and waited for by the first seek */
+static void SeekAVI(vlc_object_t *obj)
+{
+    es_out_t out = { .cbs = &trash_es_out_cbs };
+
+    char *url = vlc_path2uri(avi_path, NULL);
+    assert(url != NULL);
+
+    stream_t *s = vlc_stream_NewURL(obj, url);
+    assert(s != NULL);
+    demux_t *demux = demux_New(obj, "avi", url, s, &out);
+    assert(demux != NULL);
+
+    assert(demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+    assert(demux_Control(demux, DEMUX_SET_TIME, VLC_TICK_FROM_SEC(1),
+                         true) == VLC_SUCCESS);
+
+    vlc_tick_t length;
+    assert(demux_Control(demux, DEMUX_GET_LENGTH, &length) == VLC_SUCCESS);
+    assert(length == VLC_TICK_FROM_MS(FRAMES * 40));
+
+    vlc_tick_t time;
+    assert(demux_Control(demux, DEMUX_GET_TIME, &time) == VLC_SUCCESS);
+    assert(time == VLC_TICK_FROM_SEC(1));
+
+    demux_Delete(demux);
+    free(url);
+}
+
+/*****************************************************************************
+ * Cache directory
+ *****************************************************************************/
+static unsigned CountCacheFiles(char *found, size_t found_size)
+{
+    DIR *dir = opendir(cache_dir);
+    if (dir == NULL)
+        return 0;
+
+    unsigned count = 0;
+    const struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        size_t len = strlen(ent->d_name);
+        if (len < 4 || strcmp(&ent->d_name[len - 4], ".idx"))
+            continue;
+        /* The dummy files are named with digits only */
+        if (found != NULL && len == 4 + 32)
+            snprintf(found, found_size, "%s/%s", cache_dir, ent->d_name);
+        count++;
+    }
+    closedir(dir);
+    return count;
+}
+
+static void SetMTime(const char *path, time_t mtime)
+{
+    struct utimbuf times = { .actime = mtime, .modtime = mtime };
+    assert(utime(path, &times) == 0);
+}
+
+static time_t GetMTime(const char *path)
+{
+    struct stat st;
+    assert(stat(path, &st) == 0);
+    return st.st_mtime;
+}
+
+static off_t GetSize(const char *path)
+{
+    struct stat st;
+    assert(stat(path, &st) == 0);
+    return st.st_size;
+}
+
+static int64_t GetCachedMTime(const char *path)
+{
+    uint8_t header[24];
+    FILE *f = fopen(path, "rb");
+    assert(f != NULL);
+    assert(fread(header, sizeof (header), 1, f) == 1);
+    fclose(f);
+    assert(!memcmp(header, "VLCAVIX2", 8));
+    return GetQWLE(&header[16]);
+}
+
+static void RemoveDir(const char *path)
+{
+    DIR *dir = opendir(path);
+    if (dir == NULL)
+        return;
+
+    const struct dirent *ent;
+    while ((ent = readdir(dir)) != NULL)
+    {
+        if (!strcmp(ent->d_name, ".") || !strcmp(ent->d_name, ".."))
+            continue;
+
+        char *sub;
+        assert(asprintf(&sub, "%s/%s", path, ent->d_name) != -1);
+        struct stat st;
+        if (lstat(sub, &st) == 0 && S_ISDIR(st.st_mode))
+            RemoveDir(sub);
+        else
+            unlink(sub);
+        free(sub);
+    }
+    closedir(dir);
+    rmdir(path);
+}
+
+int main(void)
+{
+    test_init();
+
+    assert(mkdtemp(tmpdir) != NULL);
+    snprintf(avi_path, sizeof (avi_path), "%s/test.avi", tmpdir);
+    snprintf(cache_dir, sizeof (cache_dir), "%s/cache/vlc/avi-index", tmpdir);
+
+    char cache_home[64];
+    snprintf(cache_home, sizeof (cache_home), "%s/cache", tmpdir);
+    setenv("XDG_CACHE_HOME", cache_home, 1);
+
+    WriteAVI(avi_path, false);
+    SetMTime(avi_path, 1000000);
+
+    /* Always create the index, from the cache if valid */
+    const char *const args[] = { "--avi-index=1", "--avi-index-cache" };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* Save */
+    char cache_path[192] = "";
+    OpenAVI(obj);
+    assert(CountCacheFiles(cache_path, sizeof (cache_path)) == 1);
+    assert(GetCachedMTime(cache_path) == 1000000);
+    const off_t cache_size = GetSize(cache_path);
+
+    /* Load: the cache is used as is */
+    SetMTime(cache_path, 100);
+    OpenAVI(obj);
+    assert(GetMTime(cache_path) == 100);
+
+    /* Invalidate: same size, but rewritten */
+    SetMTime(avi_path, 2000000);
+    OpenAVI(obj);
+    assert(GetMTime(cache_path) != 100);
+    assert(GetCachedMTime(cache_path) == 2000000);
+    assert(GetSize(cache_path) == cache_size);
+
+    /* Invalidate: corrupted cache */
+    FILE *f = fopen(cache_path, "r+b");
+    assert(f != NULL);
+    assert(fseek(f, 40, SEEK_SET) == 0);
+    for (int i = 0; i < 64; i++)
+        fputc(0xff, f);
+    fclose(f);
+    SetMTime(cache_path, 100);
+    OpenAVI(obj);
+    assert(GetMTime(cache_path) != 100);
+    assert(GetSize(cache_path) == cache_size);
+
+    /* Eviction: the oldest files are removed beyond the limit */
+    for (int i = 0; i < CACHE_MAX_FILES + 6; i++)
+    {
+        char dummy[192];
+        snprintf(dummy, sizeof (dummy), "%s/%03d.idx", cache_dir, i);
+        f = fopen(dummy, "wb");
+        assert(f != NULL);
+        fputc(0, f);
+        fclose(f);
+        SetMTime(dummy, 1000 + i);
+    }
+    SetMTime(avi_path, 3000000);
+    OpenAVI(obj);
+    assert(CountCacheFiles(NULL, 0) == CACHE_MAX_FILES);
+    assert(GetCachedMTime(cache_path) == 3000000);
+    for (int i = 0; i < CACHE_MAX_FILES + 6; i++)
+    {
+        char dummy[192];
+        snprintf(dummy, sizeof (dummy), "%s/%03d.idx", cache_dir, i);
+        /* The 7 oldest dummies leave room for the real index */
+        assert((access(dummy, F_OK) == 0) == (i >= 7));
+    }
+
+    libvlc_release(vlc);
+
+    /* Complete idx1, read while playing: nothing to ask nor to cache */
+    unlink(cache_path);
+    WriteAVI(avi_path, true);
+    const char *const args_read[] = { "--avi-index=0", "--avi-index-cache" };
+    vlc = libvlc_new(ARRAY_SIZE(args_read), args_read);
+    assert(vlc != NULL);
+    obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    SeekAVI(obj);
+    assert(access(cache_path, F_OK) != 0);
+
+    libvlc_release(vlc);
+    RemoveDir(tmpdir);
+    return 0;
+}
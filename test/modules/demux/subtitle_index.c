@@ -0,0 +1,295 @@
+/*****************************************************************************
+ * subtitle_index.c: test the subtitle demux indexed mode
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../../../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+#include <sys/stat.h>
+
+/* Enough cues for the files to be above the 1 MiB indexing threshold */
+#define CUES 14000
+
+static char tmpdir[] = "/tmp/vlc-test-sub-index-XXXXXX";
+
+/*****************************************************************************
+ * Subtitle files
+ *****************************************************************************/
+static void WriteSRT(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    assert(f != NULL);
+
+    for (unsigned i = 0; i < CUES; i++)
+    {
+        unsigned start = i * 1500, stop = start + 1000;
+        fprintf(f, "%u\r\n%02u:%02u:%02u,%03u --> %02u:%02u:%02u,%03u\r\n",
+                i + 1,
+                start / 3600000, start / 60000 % 60, start / 1000 % 60,
+                start % 1000,
+                stop / 3600000, stop / 60000 % 60, stop / 1000 % 60,
+                stop % 1000);
+        fprintf(f, "Cue %u, <i>first line</i>\r\n", i);
+        if (i % 3 == 0)
+            fprintf(f, "second line of cue %u, a bit longer\r\n", i);
+        fprintf(f, "\r\n");
+    }
+    assert(fclose(f) == 0);
+}
+
+static void WriteMicroDVD(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    assert(f != NULL);
+
+    for (unsigned i = 0; i < CUES; i++)
+        fprintf(f, "{%u}{%u}Cue %u, {y:i}first line|second line, padded "
+                "to make the file large enough to be indexed\n",
+                i * 40, i * 40 + 25, i);
+    assert(fclose(f) == 0);
+}
+
+static void WriteWebVTT(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    assert(f != NULL);
+
+    fprintf(f, "WEBVTT\n\n");
+    for (unsigned i = 0; i < CUES; i++)
+        fprintf(f, "%02u:%02u.%03u --> %02u:%02u.%03u\nCue %u, padded to make "
+                "a large enough file\n\n",
+                i / 60, i % 60, 0, i / 60, i % 60, 500, i);
+    assert(fclose(f) == 0);
+}
+
+/*****************************************************************************
+ * Demux
+ *****************************************************************************/
+struct cue
+{
+    vlc_tick_t pts;
+    vlc_tick_t length;
+    char *text;
+};
+
+struct cues
+{
+    struct cue *p;
+    size_t count;
+};
+
+struct cues_out
+{
+    es_out_t out;
+    struct cues *cues;
+};
+
+static es_out_id_t *cues_es_out_Add(es_out_t *out, input_source_t *in,
+                                    const es_format_t *fmt)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in);
+    return (es_out_id_t *)(uintptr_t)(fmt->i_id + 1);
+}
+
+static int cues_es_out_Send(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct cues *cues = container_of(out, struct cues_out, out)->cues;
+    VLC_UNUSED(id);
+
+    struct cue *p = realloc(cues->p, (cues->count + 1) * sizeof (*p));
+    assert(p != NULL);
+    cues->p = p;
+    p[cues->count].pts = block->i_pts;
+    p[cues->count].length = block->i_length;
+    p[cues->count].text = strndup((const char *)block->p_buffer,
+                                  block->i_buffer);
+    assert(p[cues->count].text != NULL);
+    cues->count++;
+
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void cues_es_out_Del(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int cues_es_out_Control(es_out_t *out, input_source_t *in, int query,
+                               va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(query); VLC_UNUSED(args);
+    return VLC_EGENERIC;
+}
+
+static void cues_es_out_Delete(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks cues_es_out_cbs =
+{
+    .add = cues_es_out_Add,
+    .send = cues_es_out_Send,
+    .del = cues_es_out_Del,
+    .control = cues_es_out_Control,
+    .destroy = cues_es_out_Delete,
+};
+
+static void CleanCues(struct cues *cues)
+{
+    for (size_t i = 0; i < cues->count; i++)
+        free(cues->p[i].text);
+    free(cues->p);
+    cues->p = NULL;
+    cues->count = 0;
+}
+
+static libvlc_instance_t *NewInstance(int threshold)
+{
+    char arg[32];
+    snprintf(arg, sizeof (arg), "--sub-index-threshold=%d", threshold);
+    const char *const args[] = { arg };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    /* Created by the input otherwise */
+    var_Create(vlc->p_libvlc_int, "sub-original-fps", VLC_VAR_FLOAT);
+    return vlc;
+}
+
+static demux_t *OpenSub(vlc_object_t *obj, const char *path, es_out_t *out)
+{
+    char *url = vlc_path2uri(path, NULL);
+    assert(url != NULL);
+
+    stream_t *s = vlc_stream_NewURL(obj, url);
+    assert(s != NULL);
+    demux_t *demux = demux_New(obj, "subtitle", url, s, out);
+    if (demux == NULL)
+        vlc_stream_Delete(s);
+    free(url);
+    return demux;
+}
+
+static void DemuxAll(demux_t *demux)
+{
+    assert(demux_Control(demux, DEMUX_SET_NEXT_DEMUX_TIME,
+                         VLC_TICK_0 + VLC_TICK_FROM_SEC(24 * 3600))
+           == VLC_SUCCESS);
+    while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+}
+
+/* Reads all the cues, then the ones after a seek to the middle */
+static void ReadCues(const char *path, int threshold, struct cues *all,
+                     struct cues *seek)
+{
+    libvlc_instance_t *vlc = NewInstance(threshold);
+    struct cues_out out = { { .cbs = &cues_es_out_cbs }, all };
+
+    demux_t *demux = OpenSub(VLC_OBJECT(vlc->p_libvlc_int), path, &out.out);
+    assert(demux != NULL);
+    DemuxAll(demux);
+    assert(all->count == CUES);
+
+    vlc_tick_t length;
+    assert(demux_Control(demux, DEMUX_GET_LENGTH, &length) == VLC_SUCCESS);
+    assert(demux_Control(demux, DEMUX_SET_TIME, length / 2, true)
+           == VLC_SUCCESS);
+    out.cues = seek;
+    DemuxAll(demux);
+    assert(seek->count > 0 && seek->count < CUES);
+
+    demux_Delete(demux);
+    libvlc_release(vlc);
+}
+
+static void CompareCues(const struct cues *a, const struct cues *b)
+{
+    assert(a->count == b->count);
+    for (size_t i = 0; i < a->count; i++)
+    {
+        assert(a->p[i].pts == b->p[i].pts);
+        assert(a->p[i].length == b->p[i].length);
+        assert(!strcmp(a->p[i].text, b->p[i].text));
+    }
+}
+
+/* The cues must be the same whether the file is loaded in memory
+ * (threshold 0) or indexed (any file above 1 MiB) */
+static void TestFormat(const char *path)
+{
+    struct cues loaded = { 0 }, loaded_seek = { 0 };
+    struct cues indexed = { 0 }, indexed_seek = { 0 };
+
+    struct stat st;
+    assert(stat(path, &st) == 0 && st.st_size >= 1024 * 1024);
+
+    ReadCues(path, 0, &loaded, &loaded_seek);
+    ReadCues(path, 1, &indexed, &indexed_seek);
+
+    CompareCues(&loaded, &indexed);
+    CompareCues(&loaded_seek, &indexed_seek);
+    assert(!strcmp(loaded_seek.p[0].text,
+                   loaded.p[CUES - loaded_seek.count].text));
+
+    CleanCues(&loaded);
+    CleanCues(&loaded_seek);
+    CleanCues(&indexed);
+    CleanCues(&indexed_seek);
+}
+
+int main(void)
+{
+    test_init();
+
+    assert(mkdtemp(tmpdir) != NULL);
+
+    char path[64];
+    snprintf(path, sizeof (path), "%s/test.srt", tmpdir);
+    WriteSRT(path);
+    TestFormat(path);
+    unlink(path);
+
+    snprintf(path, sizeof (path), "%s/test.sub", tmpdir);
+    WriteMicroDVD(path);
+    TestFormat(path);
+    unlink(path);
+
+    /* WebVTT is left to the webvtt demux, whatever the threshold */
+    snprintf(path, sizeof (path), "%s/test.vtt", tmpdir);
+    WriteWebVTT(path);
+    libvlc_instance_t *vlc = NewInstance(1);
+    struct cues_out out = { { .cbs = &cues_es_out_cbs }, NULL };
+    assert(OpenSub(VLC_OBJECT(vlc->p_libvlc_int), path, &out.out) == NULL);
+    libvlc_release(vlc);
+    unlink(path);
+
+    rmdir(tmpdir);
+    return 0;
+}
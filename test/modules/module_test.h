@@ -0,0 +1,81 @@
+/*****************************************************************************
+ * module_test.h: fixture for the tests built with a module source
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * The tests of the internal kernels of a module include its source, to reach
+ * its static functions, right after this header:
+ *
+ *     #define MODULE_NAME araw
+ *     #include "../module_test.h"
+ *     #include "../modules/codec/araw.c"
+ *
+ * The module is then built in, as if statically linked.
+ */
+
+#ifndef VLC_TEST_MODULE_TEST_H
+#define VLC_TEST_MODULE_TEST_H
+
+#ifndef MODULE_NAME
+# error "MODULE_NAME must be defined before including module_test.h"
+#endif
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#undef VLC_DYNAMIC_PLUGIN
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+
+const char vlc_module_name[] = MODULE_STRING;
+
+/* Fills the outputs before running a kernel, to catch the overwrites */
+#define TEST_JUNK 0xA5
+
+static inline void test_fill_random( void *buf, size_t size, unsigned seed )
+{
+    uint8_t *p = buf;
+
+    srand( seed );
+    for( size_t i = 0; i < size; i++ )
+        p[i] = rand();
+}
+
+/* Reproducible noise, as a function of the position in the plane k */
+static inline uint32_t test_noise( unsigned k, unsigned x, unsigned y )
+{
+    return (x * 7919 + y * 104729 + k * 31) * 2654435761u;
+}
+
+/* Compares the first bytes of the rows of two planes */
+static inline bool test_same_rows( const uint8_t *a, ptrdiff_t a_pitch,
+                                   const uint8_t *b, ptrdiff_t b_pitch,
+                                   size_t bytes, unsigned rows )
+{
+    for( unsigned y = 0; y < rows; y++ )
+        if( memcmp( &a[y * a_pitch], &b[y * b_pitch], bytes ) )
+            return false;
+    return true;
+}
+
+#endif
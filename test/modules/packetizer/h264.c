@@ -111,6 +111,7 @@ int main(void)
     params.i_rate_num = 0;
     params.i_rate_den = 0;
     params.i_frame_count = 2*25;
+    params.i_nonref_count = 2*12;
     params.b_extra = true;
 
     params.i_read_size = 500;
@@ -124,6 +125,7 @@ int main(void)
         test_samples_raw_h264, test_samples_raw_h264_len, 0);
 
     params.i_frame_count = 1*25;
+    params.i_nonref_count = 1*12;
     params.i_read_size = 500;
     RUN("skip 1st Iframe", test_packetize,
         test_samples_raw_h264 + 10, test_samples_raw_h264_len - 10, 0);
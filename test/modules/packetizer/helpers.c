@@ -30,6 +30,7 @@
 #include <vlc_block_helper.h>
 
 #include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
 
 struct results_s
 {
@@ -77,16 +78,91 @@ static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
         return i_ret;
 
     /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
     {
-        printf("checking asm:\n");
+        printf("checking sse2:\n");
         i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+                           startcode_FindAnnexB_SSE2 );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+    {
+        printf("checking avx2:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_AVX2 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+    if( vlc_CPU_AVX512() )
+    {
+        printf("checking avx-512:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_AVX512 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+#endif
+#ifdef STARTCODE_HAVE_NEON
+    printf("checking neon:\n");
+    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                       startcode_FindAnnexB_NEON );
+    if( i_ret != 0 )
+        return i_ret;
+#endif
+
+    printf("checking dispatched code:\n");
+    return check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                      startcode_FindAnnexB );
+}
 
+/* Reference byte per byte emulation prevention stripping */
+static uint8_t *ep3b_to_rbsp_ref( uint8_t *p, uint8_t *end, unsigned *pi_prev,
+                                  size_t i_count )
+{
+    for( size_t i=0; i<i_count; i++ )
+    {
+        if( ++p >= end )
+            return p;
+
+        *pi_prev = (*pi_prev << 1) | (!*p);
+
+        if( *p == 0x03 && ( p + 1 ) != end )
+        {
+            if( (*pi_prev & 0x06) == 0x06 )
+            {
+                ++p;
+                *pi_prev = !*p;
+            }
+        }
+    }
+    return p;
+}
+
+static int run_ep3b_set( uint8_t *p_set, size_t i_set )
+{
+    static const size_t counts[] = { 1, 3, 16, 17, 40, 100, 333, 4096 };
+
+    for( size_t i = 0; i < ARRAY_SIZE(counts); i++ )
+    {
+        uint8_t *p_ref = p_set, *p = p_set;
+        unsigned i_prev_ref = 0, i_prev = 0;
+
+        while( p_ref < p_set + i_set )
+        {
+            p_ref = ep3b_to_rbsp_ref( p_ref, p_set + i_set, &i_prev_ref, counts[i] );
+            p = hxxx_ep3b_to_rbsp( p, p_set + i_set, &i_prev, counts[i] );
+            if( p != p_ref || (i_prev & 0x03) != (i_prev_ref & 0x03) )
+            {
+                printf("- ep3b mismatch at %td/%td forwarding %zu\n",
+                       p - p_set, p_ref - p_set, counts[i]);
+                return 1;
+            }
+        }
+    }
     return 0;
 }
 
@@ -134,5 +210,22 @@ int main( void )
             return i_ret;
     }
 
+    p_data = malloc( 8192 );
+    if( p_data )
+    {
+        /* sparse zeros runs and escape sequences, some at vector boundaries */
+        srand( 0 );
+        for( size_t i = 0; i < 8192; i++ )
+            p_data[i] = (rand() % 8) ? 0x42 : 0x00;
+        for( size_t i = 0; i + 3 < 8192; i += 29 + (rand() % 64) )
+            memcpy( &p_data[i], "\x00\x00\x03", 3 );
+        memcpy( &p_data[8192 - 3], "\x00\x00\x03", 3 );
+        printf("* Running emulation prevention tests:\n");
+        i_ret = run_ep3b_set( p_data, 8192 );
+        free( p_data );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+
     return 0;
 }
@@ -129,6 +129,7 @@ int main(void)
     params.i_rate_num = 0;
     params.i_rate_den = 0;
     params.i_frame_count = 2*25;
+    params.i_nonref_count = 29;
     params.b_extra = true;
 
     params.i_read_size = 500;
@@ -142,6 +143,7 @@ int main(void)
         test_samples_raw_h265, test_samples_raw_h265_len, 0);
 
     params.i_frame_count = 1*25 + 4 /* RASL from previous GOP */;
+    params.i_nonref_count = 17;
     params.i_read_size = 500;
     RUN("skip 1st Iframe", test_packetize,
         test_samples_raw_h265 + 10, test_samples_raw_h265_len - 10, 0);
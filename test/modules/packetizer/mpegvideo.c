@@ -158,6 +158,7 @@ int main(void)
     params.i_rate_num = 0;
     params.i_rate_den = 0;
     params.i_frame_count = 2*25;
+    params.i_nonref_count = 0;
     params.b_extra = false;
 
     params.i_read_size = 500;
@@ -39,6 +39,7 @@ struct params_s
     unsigned i_rate_den;
     unsigned i_read_size;
     unsigned i_frame_count;
+    unsigned i_nonref_count;
     bool b_extra;
 };
 
@@ -109,6 +110,7 @@ static int test_packetize(const char *run,
     block_t **outappend = &outchain;
     block_t *p_block;
     unsigned i_count = 0;
+    unsigned i_nonref = 0;
     do
     {
         p_block = vlc_stream_Block(s, params->i_read_size);
@@ -125,6 +127,8 @@ static int test_packetize(const char *run,
                                 " flags %x sz %zu""\n",
                         i_count, out->i_dts,
                         out->i_flags, out->i_buffer );
+                if(out->i_flags & BLOCK_FLAG_NON_REFERENCE)
+                    ++i_nonref;
                 block_ChainLastAppend(&outappend, out);
                 ++i_count;
             }
@@ -132,6 +136,7 @@ static int test_packetize(const char *run,
     } while(p_block);
 
     EXPECT(i_count == params->i_frame_count);
+    EXPECT(i_nonref == params->i_nonref_count);
 
     if(params->i_rate_num && params->i_rate_den)
     {
@@ -0,0 +1,262 @@
+/*****************************************************************************
+ * startcode_bench.c: Annex B start code and emulation prevention benchmark
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the start code and emulation prevention lookups of each kernel
+ * supported by the CPU, in MB/s.
+ *
+ * Usage: startcode_bench [file.h264|file.hevc]
+ *
+ * Without file, a high bitrate intra only like Annex B stream is synthesized:
+ * large slices of entropy coded looking data, few start codes and sparse
+ * emulation prevention bytes.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
+
+#define BENCH_SIZE   (64 << 20)
+#define BENCH_SLICE  (768 << 10)
+#define BENCH_RUNS   5
+
+typedef const uint8_t *(*find_annexb_t)(const uint8_t *, const uint8_t *);
+typedef const uint8_t *(*find_3b_t)(const uint8_t *, const uint8_t *, uint8_t);
+
+static uint32_t lcg = 0x12345678;
+
+static uint8_t bench_rand(void)
+{
+    lcg = lcg * 1664525 + 1013904223;
+    return lcg >> 24;
+}
+
+/* Writes a NAL with escaped payload, returns the written size */
+static size_t write_nal(uint8_t *p, size_t size, uint8_t header, size_t payload)
+{
+    size_t i = 0;
+    unsigned zeros = 0;
+
+    if (size < 5)
+        return 0;
+    memcpy(p, "\x00\x00\x00\x01", 4);
+    p[4] = header;
+    i = 5;
+
+    while (payload-- > 0 && i + 2 < size)
+    {
+        /* zeros are more frequent than in uniform data */
+        uint8_t b = bench_rand();
+        if (b < 8)
+            b = 0;
+        else if (b < 12)
+            b = 0x03;
+
+        if (zeros >= 2 && b <= 0x03)
+        {
+            p[i++] = 0x03;
+            zeros = 0;
+        }
+        p[i++] = b;
+        zeros = b ? 0 : zeros + 1;
+    }
+    /* rbsp trailing bits */
+    p[i++] = 0x80;
+    return i;
+}
+
+static uint8_t *generate(size_t *restrict sizep)
+{
+    uint8_t *buf = malloc(BENCH_SIZE);
+    if (buf == NULL)
+        return NULL;
+
+    size_t size = 0;
+    while (BENCH_SIZE - size > BENCH_SLICE + 256)
+    {
+        /* SPS, PPS, IDR slice */
+        size += write_nal(&buf[size], BENCH_SIZE - size, 0x67, 24);
+        size += write_nal(&buf[size], BENCH_SIZE - size, 0x68, 4);
+        size += write_nal(&buf[size], BENCH_SIZE - size, 0x65,
+                          BENCH_SLICE - 1024 + (bench_rand() << 4));
+    }
+    *sizep = size;
+    return buf;
+}
+
+static uint8_t *load(const char *path, size_t *restrict sizep)
+{
+    FILE *stream = fopen(path, "rb");
+    if (stream == NULL)
+    {
+        perror(path);
+        return NULL;
+    }
+
+    uint8_t *buf = NULL;
+    size_t size = 0;
+
+    for (;;)
+    {
+        uint8_t *grown = realloc(buf, size + (1 << 20));
+        if (grown == NULL)
+            break;
+        buf = grown;
+
+        size_t len = fread(buf + size, 1, 1 << 20, stream);
+        size += len;
+        if (len < (1 << 20))
+            break;
+    }
+    fclose(stream);
+    *sizep = size;
+    return buf;
+}
+
+static void bench_annexb(const char *name, find_annexb_t find,
+                         const uint8_t *buf, size_t size)
+{
+    vlc_tick_t best = VLC_TICK_MAX;
+    size_t count = 0;
+
+    for (unsigned run = 0; run < BENCH_RUNS; run++)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        const uint8_t *p = buf, *end = buf + size;
+
+        count = 0;
+        while ((p = find(p, end)) != NULL)
+        {
+            count++;
+            p += 3;
+        }
+
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    printf("startcode %-8s %8zu matches %10.1f MB/s\n", name, count,
+           size / (double) best * CLOCK_FREQ / 1000000.);
+}
+
+static void bench_3b(const char *name, find_3b_t find,
+                     const uint8_t *buf, size_t size)
+{
+    vlc_tick_t best = VLC_TICK_MAX;
+    size_t count = 0;
+
+    for (unsigned run = 0; run < BENCH_RUNS; run++)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        const uint8_t *p = buf, *end = buf + size;
+
+        count = 0;
+        while ((p = find(p, end, 0x03)) != NULL)
+        {
+            count++;
+            p += 3;
+        }
+
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    printf("ep3b      %-8s %8zu matches %10.1f MB/s\n", name, count,
+           size / (double) best * CLOCK_FREQ / 1000000.);
+}
+
+/* Strips emulation prevention over whole NAL payloads, as slice data skips */
+static void bench_rbsp(uint8_t *buf, size_t size, size_t chunk)
+{
+    vlc_tick_t best = VLC_TICK_MAX;
+
+    for (unsigned run = 0; run < BENCH_RUNS; run++)
+    {
+        vlc_tick_t start = vlc_tick_now();
+        uint8_t *p = buf, *end = buf + size;
+        unsigned prev = 0;
+
+        while (p < end)
+            p = hxxx_ep3b_to_rbsp(p, end, &prev, chunk);
+
+        vlc_tick_t elapsed = vlc_tick_now() - start;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    printf("rbsp      by %-5zu %19s %10.1f MB/s\n", chunk, "",
+           size / (double) best * CLOCK_FREQ / 1000000.);
+}
+
+int main(int argc, char *argv[])
+{
+    size_t size;
+    uint8_t *buf = (argc > 1) ? load(argv[1], &size) : generate(&size);
+
+    if (buf == NULL)
+        return 1;
+
+    printf("%zu bytes\n", size);
+
+    bench_annexb("bits", startcode_FindAnnexB_Bits, buf, size);
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        bench_annexb("sse2", startcode_FindAnnexB_SSE2, buf, size);
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        bench_annexb("avx2", startcode_FindAnnexB_AVX2, buf, size);
+    if (vlc_CPU_AVX512())
+        bench_annexb("avx-512", startcode_FindAnnexB_AVX512, buf, size);
+#endif
+#ifdef STARTCODE_HAVE_NEON
+    bench_annexb("neon", startcode_FindAnnexB_NEON, buf, size);
+#endif
+
+    bench_3b("c", startcode_Find3B_C, buf, size);
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        bench_3b("avx2", startcode_Find3B_AVX2, buf, size);
+    if (vlc_CPU_AVX512())
+        bench_3b("avx-512", startcode_Find3B_AVX512, buf, size);
+#endif
+#ifdef STARTCODE_HAVE_NEON
+    bench_3b("neon", startcode_Find3B_NEON, buf, size);
+#endif
+
+    bench_rbsp(buf, size, 1);
+    bench_rbsp(buf, size, 64);
+    bench_rbsp(buf, size, 4096);
+
+    free(buf);
+    return 0;
+}
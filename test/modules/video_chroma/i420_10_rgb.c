@@ -0,0 +1,168 @@
+/*****************************************************************************
+ * i420_10_rgb.c: high bit depth YUV to RGB conversion test
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#define MODULE_NAME i420_10_rgb
+#include "../module_test.h"
+#include "../modules/video_chroma/i420_10_rgb.c"
+
+#define TEST_WIDTH 1031
+
+static int16_t test_y[TEST_WIDTH], test_u[TEST_WIDTH], test_v[TEST_WIDTH];
+static uint32_t test_ref[TEST_WIDTH + 8];
+static uint32_t test_out[TEST_WIDTH + 8];
+
+/* Converts one pixel with the C kernel */
+static uint32_t convert_pixel( const struct yuv_rgb_params *p,
+                               int16_t y, int16_t u, int16_t v )
+{
+    uint32_t px;
+    ConvertRow( &px, &y, &u, &v, 1, p );
+    return px;
+}
+
+/* RGBA10LE output, without the alpha */
+static void set_params( struct yuv_rgb_params *p,
+                        video_color_space_t space, bool full_range,
+                        unsigned bits )
+{
+    SetParams( p, space, full_range, bits );
+    p->r_pos = 0;
+    p->g_pos = bits;
+    p->b_pos = 2 * bits;
+    p->alpha = 0;
+}
+
+static void test_reference( void )
+{
+    struct yuv_rgb_params p;
+    const uint32_t mask = 0x3ff;
+
+    /* Limited range black and white */
+    set_params( &p, COLOR_SPACE_BT709, false, 10 );
+    assert( convert_pixel( &p, 0, 0, 0 ) == 0 );
+    assert( convert_pixel( &p, 940 - 64, 0, 0 ) == 0x3fffffff );
+    /* Below black and above white are clipped */
+    assert( convert_pixel( &p, -64, 0, 0 ) == 0 );
+    assert( convert_pixel( &p, 1023 - 64, 511, 511 ) >> 20 == mask );
+
+    /* BT.709 limited range red (R'G'B' 1, 0, 0): Y 250, Cb 409, Cr 960 */
+    uint32_t red = convert_pixel( &p, 250 - 64, 409 - 512, 960 - 512 );
+    assert( (red & mask) >= 1021 );
+    assert( ((red >> 10) & mask) <= 2 );
+    assert( ((red >> 20) & mask) <= 2 );
+
+    /* BT.2020 limited range blue: Y 116, Cb 960, Cr 476 */
+    set_params( &p, COLOR_SPACE_BT2020, false, 10 );
+    uint32_t blue = convert_pixel( &p, 116 - 64, 960 - 512, 476 - 512 );
+    assert( (blue & mask) <= 2 );
+    assert( ((blue >> 10) & mask) <= 2 );
+    assert( ((blue >> 20) & mask) >= 1021 );
+
+    /* Full range 8 bits output */
+    set_params( &p, COLOR_SPACE_BT601, true, 8 );
+    assert( convert_pixel( &p, 1020, 0, 0 ) == 0xffffff );
+    assert( convert_pixel( &p, 512, 0, 0 ) == 0x808080 );
+}
+
+#if defined(CAN_COMPILE_AVX2) || defined(YUV_RGB_HAVE_NEON)
+static void fill_input( unsigned seed )
+{
+    test_fill_random( test_y, sizeof(test_y), seed );
+    test_fill_random( test_u, sizeof(test_u), seed + 1 );
+    test_fill_random( test_v, sizeof(test_v), seed + 2 );
+    for( size_t i = 0; i < TEST_WIDTH; i++ )
+    {
+        /* Including out of range samples */
+        test_y[i] = (test_y[i] & 1023) - 64;
+        test_u[i] = (test_u[i] & 1023) - 512;
+        test_v[i] = (test_v[i] & 1023) - 512;
+    }
+}
+
+/* Checks that the vectorized kernel matches the C one, bit per bit, and does
+ * not write past the output */
+static int check_convert( const char *name, yuv_rgb_row_fn fn )
+{
+    static const video_color_space_t spaces[] = {
+        COLOR_SPACE_BT601, COLOR_SPACE_BT709, COLOR_SPACE_BT2020,
+    };
+
+    for( size_t s = 0; s < ARRAY_SIZE(spaces); s++ )
+    for( unsigned full = 0; full < 2; full++ )
+    for( unsigned bits = 8; bits <= 10; bits += 2 )
+    {
+        struct yuv_rgb_params p;
+        SetParams( &p, spaces[s], full, bits );
+        p.r_pos = 16;
+        p.g_pos = 8;
+        p.b_pos = 0;
+        p.alpha = UINT32_C(0xff) << 24;
+        if( bits == 10 )
+        {
+            p.r_pos = 20;
+            p.g_pos = 10;
+            p.alpha = UINT32_C(0x3) << 30;
+        }
+
+        for( unsigned width = 0; width <= TEST_WIDTH;
+             width += (width < 40) ? 1 : 97 )
+        {
+            memset( test_ref, TEST_JUNK, sizeof(test_ref) );
+            memset( test_out, TEST_JUNK, sizeof(test_out) );
+
+            ConvertRow( test_ref, test_y, test_u, test_v, width, &p );
+            fn( test_out, test_y, test_u, test_v, width, &p );
+
+            if( memcmp( test_ref, test_out, sizeof(test_ref) ) )
+            {
+                fprintf( stderr, "%s: mismatch for space %d, %s range, "
+                         "%u bits, width %u\n", name, spaces[s],
+                         full ? "full" : "limited", bits, width );
+                return 1;
+            }
+        }
+    }
+    printf( "%s: ok\n", name );
+    return 0;
+}
+#endif
+
+int main( void )
+{
+    int ret = 0;
+
+    test_reference();
+
+#if defined(CAN_COMPILE_AVX2) || defined(YUV_RGB_HAVE_NEON)
+    for( unsigned seed = 0; seed < 4 && ret == 0; seed++ )
+    {
+        fill_input( seed );
+# ifdef CAN_COMPILE_AVX2
+        if( vlc_CPU_AVX2() )
+            ret |= check_convert( "avx2", ConvertRowAVX2 );
+# endif
+# ifdef YUV_RGB_HAVE_NEON
+        if( ret == 0 )
+            ret |= check_convert( "neon", ConvertRowNEON );
+# endif
+    }
+#endif
+    return ret;
+}
@@ -0,0 +1,298 @@
+/*****************************************************************************
+ * yuv_rgb_scale.c: fused YUV to scaled RGB conversion test
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#define MODULE_NAME yuv_rgb_scale
+#include "../module_test.h"
+#include "../modules/video_chroma/yuv_rgb_scale.c"
+
+struct test_converter
+{
+    filter_t *filter;
+    struct yuv_rgb_scale_tile tile;
+};
+
+/* Opens the converter, without crop on the output, on a parentless object
+ * for the module logs */
+static int open_converter( struct test_converter *conv,
+                           const video_format_t *in,
+                           unsigned width, unsigned height )
+{
+    filter_t *filter = (vlc_object_create)( NULL, sizeof(*filter) );
+    assert( filter != NULL );
+
+    es_format_Init( &filter->fmt_in, VIDEO_ES, in->i_chroma );
+    video_format_Copy( &filter->fmt_in.video, in );
+    es_format_Init( &filter->fmt_out, VIDEO_ES, VLC_CODEC_BGRA );
+    video_format_Init( &filter->fmt_out.video, VLC_CODEC_BGRA );
+    video_format_Setup( &filter->fmt_out.video, VLC_CODEC_BGRA,
+                        width, height, width, height, 1, 1 );
+
+    int ret = Open( filter );
+    if( ret != VLC_SUCCESS )
+    {
+        es_format_Clean( &filter->fmt_out );
+        es_format_Clean( &filter->fmt_in );
+        vlc_object_delete( filter );
+    }
+    else
+        conv->filter = filter;
+    return ret;
+}
+
+static void close_converter( struct test_converter *conv )
+{
+    Close( conv->filter );
+    es_format_Clean( &conv->filter->fmt_out );
+    es_format_Clean( &conv->filter->fmt_in );
+    vlc_object_delete( conv->filter );
+}
+
+/* Converts the rows by bands of the given height */
+static picture_t *convert( struct test_converter *conv, const picture_t *src,
+                           unsigned band )
+{
+    filter_t *filter = conv->filter;
+    picture_t *dst = picture_NewFromFormat( &filter->fmt_out.video );
+    assert( dst != NULL );
+
+    struct yuv_rgb_scale_plane planes[3];
+    SetPlanes( filter->p_sys, src, planes );
+
+    const unsigned height = filter->fmt_out.video.i_visible_height;
+    for( unsigned row = 0; row < height; row += band )
+        ConvertRows( filter, planes, dst, &conv->tile, row,
+                     __MIN(band, height - row) );
+    return dst;
+}
+
+static bool same_pixels( const picture_t *a, const picture_t *b,
+                         unsigned width, unsigned height )
+{
+    return test_same_rows( a->p[0].p_pixels, a->p[0].i_pitch,
+                           b->p[0].p_pixels, b->p[0].i_pitch,
+                           4 * width, height );
+}
+
+/* Sets the Y, U and V samples of the 4:2:0 picture, whatever its layout */
+static void set_samples( picture_t *pic, unsigned x0, unsigned y0,
+                         unsigned width, unsigned height,
+                         uint8_t (*sample)( unsigned k, unsigned x, unsigned y ) )
+{
+    const vlc_fourcc_t chroma = pic->format.i_chroma;
+    const bool swap = chroma == VLC_CODEC_NV21 || chroma == VLC_CODEC_YV12;
+    const bool semi_planar = chroma == VLC_CODEC_NV12
+                          || chroma == VLC_CODEC_NV21;
+
+    for( unsigned y = 0; y < height; y++ )
+        for( unsigned x = 0; x < width; x++ )
+            pic->p[0].p_pixels[(y0 + y) * pic->p[0].i_pitch + x0 + x] =
+                sample( 0, x, y );
+
+    for( unsigned k = 1; k < 3; k++ )
+    {
+        const unsigned c = (k == 1) != swap ? 0 : 1;
+        const plane_t *p = &pic->p[semi_planar ? 1 : 1 + c];
+
+        for( unsigned y = 0; y < height / 2; y++ )
+            for( unsigned x = 0; x < width / 2; x++ )
+            {
+                uint8_t *px = &p->p_pixels[(y0 / 2 + y) * p->i_pitch];
+                if( semi_planar )
+                    px[2 * (x0 / 2 + x) + c] = sample( k, x, y );
+                else
+                    px[x0 / 2 + x] = sample( k, x, y );
+            }
+    }
+}
+
+static picture_t *new_source( vlc_fourcc_t chroma, unsigned width,
+                              unsigned height, video_format_t *fmt )
+{
+    video_format_Init( fmt, chroma );
+    video_format_Setup( fmt, chroma, width, height, width, height, 1, 1 );
+
+    picture_t *pic = picture_NewFromFormat( fmt );
+    assert( pic != NULL );
+    return pic;
+}
+
+static uint8_t flat_sample( unsigned k, unsigned x, unsigned y )
+{
+    static const uint8_t yuv[3] = { 81, 90, 240 };
+    return yuv[k];
+}
+
+static uint8_t noise_sample( unsigned k, unsigned x, unsigned y )
+{
+    return test_noise( k, x, y ) >> 24;
+}
+
+static uint8_t junk_sample( unsigned k, unsigned x, unsigned y )
+{
+    return TEST_JUNK;
+}
+
+static void test_taps( void )
+{
+    struct yuv_rgb_scale_tap taps[16];
+
+    /* Unscaled luma samples are copied */
+    SetTaps( taps, 8, 0, 8, 0 );
+    for( unsigned i = 0; i < 8; i++ )
+        assert( taps[i].i0 == i && taps[i].weight == 0 );
+
+    /* Unscaled chroma samples are centered between two luma samples */
+    SetTaps( taps, 8, 0, 8, 1 );
+    assert( taps[0].i0 == 0 && taps[0].weight == 0 );
+    assert( taps[1].i0 == 0 && taps[1].i1 == 1 && taps[1].weight == 64 );
+    assert( taps[2].i0 == 0 && taps[2].i1 == 1 && taps[2].weight == 192 );
+    assert( taps[7].i0 == 3 && taps[7].i1 == 3 && taps[7].weight == 0 );
+
+    /* Upscaled twice, within the crop */
+    SetTaps( taps, 16, 4, 8, 0 );
+    assert( taps[0].i0 == 4 && taps[0].weight == 0 );
+    assert( taps[1].i0 == 4 && taps[1].i1 == 5 && taps[1].weight == 64 );
+    assert( taps[2].i0 == 4 && taps[2].i1 == 5 && taps[2].weight == 192 );
+    assert( taps[15].i0 == 11 && taps[15].i1 == 11 );
+}
+
+/* A flat picture stays flat, whatever the scale */
+static void test_flat( void )
+{
+    static const unsigned sizes[][2] = {
+        { 64, 48 }, { 33, 25 }, { 100, 90 }, { 1000, 24 }, { 333, 500 },
+    };
+    video_format_t fmt;
+    picture_t *src = new_source( VLC_CODEC_NV12, 64, 48, &fmt );
+    set_samples( src, 0, 0, 64, 48, flat_sample );
+
+    for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+    {
+        struct test_converter conv;
+        assert( open_converter( &conv, &fmt, sizes[i][0], sizes[i][1] )
+                == VLC_SUCCESS );
+
+        const filter_sys_t *p_sys = conv.filter->p_sys;
+        const int16_t y = (81 << 2) - p_sys->black;
+        const int16_t u = (90 << 2) - 512, v = (240 << 2) - 512;
+        uint32_t ref;
+        ConvertRow( &ref, &y, &u, &v, 1, &p_sys->params );
+
+        picture_t *dst = convert( &conv, src, sizes[i][1] );
+        for( unsigned row = 0; row < sizes[i][1]; row++ )
+        {
+            const uint32_t *px = (const uint32_t *)
+                &dst->p[0].p_pixels[row * dst->p[0].i_pitch];
+            for( unsigned x = 0; x < sizes[i][0]; x++ )
+                assert( px[x] == ref );
+        }
+        picture_Release( dst );
+        close_converter( &conv );
+    }
+    picture_Release( src );
+    video_format_Clean( &fmt );
+}
+
+/* The layouts, the crop and the bands give the same pixels */
+static void test_layouts( void )
+{
+    static const vlc_fourcc_t chromas[] = {
+        VLC_CODEC_NV12, VLC_CODEC_NV21, VLC_CODEC_I420, VLC_CODEC_YV12,
+    };
+    static const unsigned bands[] = { 1, 2, 7, 64, 1000 };
+    const unsigned width = 400, height = 300;
+    const unsigned out_width = 701, out_height = 433;
+    picture_t *ref = NULL;
+
+    for( size_t i = 0; i < ARRAY_SIZE(chromas); i++ )
+    {
+        video_format_t fmt;
+        picture_t *src = new_source( chromas[i], width, height, &fmt );
+        set_samples( src, 0, 0, width, height, noise_sample );
+
+        struct test_converter conv;
+        assert( open_converter( &conv, &fmt, out_width, out_height )
+                == VLC_SUCCESS );
+        for( size_t b = 0; b < ARRAY_SIZE(bands); b++ )
+        {
+            picture_t *dst = convert( &conv, src, bands[b] );
+            if( ref == NULL )
+                ref = dst;
+            else
+            {
+                assert( same_pixels( ref, dst, out_width, out_height ) );
+                picture_Release( dst );
+            }
+        }
+        close_converter( &conv );
+        picture_Release( src );
+        video_format_Clean( &fmt );
+    }
+
+    /* The same content within a larger picture */
+    video_format_t fmt;
+    picture_t *src = new_source( VLC_CODEC_NV12, width + 64, height + 32,
+                                 &fmt );
+    set_samples( src, 0, 0, width + 64, height + 32, junk_sample );
+    set_samples( src, 24, 12, width, height, noise_sample );
+    fmt.i_x_offset = 24;
+    fmt.i_y_offset = 12;
+    fmt.i_visible_width = width;
+    fmt.i_visible_height = height;
+
+    struct test_converter conv;
+    assert( open_converter( &conv, &fmt, out_width, out_height )
+            == VLC_SUCCESS );
+    picture_t *dst = convert( &conv, src, 16 );
+    assert( same_pixels( ref, dst, out_width, out_height ) );
+    picture_Release( dst );
+    close_converter( &conv );
+    picture_Release( src );
+    video_format_Clean( &fmt );
+
+    picture_Release( ref );
+}
+
+static void test_open( void )
+{
+    video_format_t fmt;
+    struct test_converter conv;
+    picture_t *src = new_source( VLC_CODEC_I420, 64, 48, &fmt );
+    picture_Release( src );
+
+    /* Unscaled planar conversions are left to the other converters */
+    assert( open_converter( &conv, &fmt, 64, 48 ) == VLC_EGENERIC );
+    /* Too small downscaling */
+    assert( open_converter( &conv, &fmt, 31, 48 ) == VLC_EGENERIC );
+    assert( open_converter( &conv, &fmt, 64, 23 ) == VLC_EGENERIC );
+
+    assert( open_converter( &conv, &fmt, 32, 24 ) == VLC_SUCCESS );
+    close_converter( &conv );
+    video_format_Clean( &fmt );
+}
+
+int main( void )
+{
+    test_taps();
+    test_open();
+    test_flat();
+    test_layouts();
+    return 0;
+}
@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * deinterlace.c: yadif and bwdif line filters test
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+
+#include "../modules/video_filter/deinterlace/common.h"
+#include "../modules/video_filter/deinterlace/yadif.h"
+#include "../modules/video_filter/deinterlace/bwdif.h"
+
+#define TEST_WIDTH  97
+#define TEST_HEIGHT 16
+#define TEST_STRIDE (2 * TEST_WIDTH + 64)
+
+/* Previous, current and next frames */
+static uint8_t frames[3][TEST_HEIGHT * TEST_STRIDE];
+
+static void fill_frames( unsigned seed, int bits, bool still )
+{
+    srand( seed );
+    for( unsigned f = 0; f < 3; f++ )
+        for( unsigned y = 0; y < TEST_HEIGHT; y++ )
+            for( unsigned x = 0; x < TEST_STRIDE / 2; x++ )
+            {
+                /* Moving edges, with some noise */
+                unsigned v = ((x + (still ? 0 : 5 * f) + y / 2) / 6) % 2 ? 200 : 30;
+                v += rand() % 24;
+                uint8_t *row = &frames[still ? 0 : f][y * TEST_STRIDE];
+                if( bits > 8 )
+                    ((uint16_t *)row)[x] = (v << (bits - 8))
+                                         | (rand() & ((1 << (bits - 8)) - 1));
+                else
+                    row[x] = v;
+            }
+    if( still )
+    {
+        memcpy( frames[1], frames[0], sizeof(frames[0]) );
+        memcpy( frames[2], frames[0], sizeof(frames[0]) );
+    }
+}
+
+static const uint8_t *line( unsigned f, unsigned y )
+{
+    return &frames[f][y * TEST_STRIDE];
+}
+
+#if defined(CAN_COMPILE_AVX2) || defined(YADIF_HAVE_NEON)
+typedef void (*yadif_line)(uint8_t *, uint8_t *, uint8_t *, uint8_t *, int,
+                           int, int, int, int);
+
+/* The vectorized yadif matches the C one bit per bit */
+static int check_yadif( const char *name, yadif_line line8,
+                        yadif_line line16, int bits )
+{
+    yadif_line ref = bits > 8 ? yadif_filter_line_c_16bit
+                              : yadif_filter_line_c;
+    yadif_line simd = bits > 8 ? line16 : line8;
+
+    fill_frames( bits, bits, false );
+    for( int width = 1; width <= TEST_WIDTH - 4; width++ )
+        for( int parity = 0; parity < 2; parity++ )
+            for( int mode = 0; mode <= 2; mode += 2 )
+            {
+                const int y = 4 + width % 8;
+                uint8_t a[TEST_STRIDE] = { 0 }, b[TEST_STRIDE] = { 0 };
+
+                /* The filters read 3 pixels on each side */
+                const int offset = 4 * (bits > 8 ? 2 : 1);
+                uint8_t *prev = (uint8_t *)line( 0, y ) + offset;
+                uint8_t *cur  = (uint8_t *)line( 1, y ) + offset;
+                uint8_t *next = (uint8_t *)line( 2, y ) + offset;
+
+                ref( a, prev, cur, next, width, TEST_STRIDE, -TEST_STRIDE,
+                     parity, mode );
+                simd( b, prev, cur, next, width, TEST_STRIDE, -TEST_STRIDE,
+                      parity, mode );
+                if( memcmp( a, b, sizeof(a) ) )
+                {
+                    fprintf( stderr, "yadif %s: mismatch for %d bits, "
+                             "width %d, parity %d, mode %d\n", name, bits,
+                             width, parity, mode );
+                    return 1;
+                }
+            }
+    printf( "yadif %s %d bits: ok\n", name, bits );
+    return 0;
+}
+#endif
+
+static void bwdif_frame( int bits, int width, bool intra, int parity,
+                         uint8_t *dst, bool avx2 )
+{
+    const int pixel_size = bits > 8 ? 2 : 1;
+    const ptrdiff_t refs = TEST_STRIDE / pixel_size;
+    const int h = TEST_HEIGHT;
+
+    for( int y = 0; y < h; y++ )
+    {
+        uint8_t *out = &dst[y * TEST_STRIDE];
+        if( (y % 2) == parity )
+        {
+            memcpy( out, line( 1, y ), width * pixel_size );
+            continue;
+        }
+
+        enum bwdif_mode mode;
+        if( intra )
+            mode = BWDIF_INTRA;
+        else if( y < 2 || y + 3 > h )
+            mode = BWDIF_EDGE;
+        else if( y < 4 || y + 5 > h )
+            mode = BWDIF_EDGE_SPATIAL;
+        else
+            mode = BWDIF_LINE;
+
+        void (*filter)(void *, const void *, const void *, const void *, int,
+                       ptrdiff_t, ptrdiff_t, ptrdiff_t, ptrdiff_t, int, int,
+                       enum bwdif_mode) =
+            bits > 8 ? bwdif_filter_line_c_16bit : bwdif_filter_line_c;
+#ifdef CAN_COMPILE_AVX2
+        if( avx2 )
+            filter = bits > 8 ? bwdif_filter_line_avx2_16bit
+                              : bwdif_filter_line_avx2;
+#else
+        assert( !avx2 );
+#endif
+        filter( out, line( 0, y ), line( 1, y ), line( 2, y ), width,
+            y + 1 < h ? refs : -refs, y > 0 ? -refs : refs,
+            y + 3 < h ? 3 * refs : -refs, y > 2 ? -3 * refs : refs,
+            parity, (1 << bits) - 1, mode );
+    }
+}
+
+/* Without motion, the missing lines are those of the other fields */
+static void test_bwdif_still( int bits )
+{
+    const size_t size = TEST_WIDTH * (bits > 8 ? 2 : 1);
+    static uint8_t dst[TEST_HEIGHT * TEST_STRIDE];
+
+    fill_frames( bits, bits, true );
+    for( int parity = 0; parity < 2; parity++ )
+    {
+        bwdif_frame( bits, TEST_WIDTH, false, parity, dst, false );
+        for( unsigned y = 0; y < TEST_HEIGHT; y++ )
+            assert( !memcmp( &dst[y * TEST_STRIDE], line( 1, y ), size ) );
+    }
+}
+
+/* The interpolation keeps flat areas flat, with or without the other fields */
+static void test_bwdif_flat( int bits )
+{
+    const int max = (1 << bits) - 1;
+    static uint8_t dst[TEST_HEIGHT * TEST_STRIDE];
+
+    for( unsigned f = 0; f < 3; f++ )
+        for( unsigned y = 0; y < TEST_HEIGHT; y++ )
+            for( unsigned x = 0; x < TEST_STRIDE / 2; x++ )
+                if( bits > 8 )
+                    ((uint16_t *)&frames[f][y * TEST_STRIDE])[x] = max / 3;
+                else
+                    frames[f][y * TEST_STRIDE + x] = max / 3;
+
+    for( int intra = 0; intra < 2; intra++ )
+    {
+        bwdif_frame( bits, TEST_WIDTH, intra, 1, dst, false );
+        for( unsigned y = 0; y < TEST_HEIGHT; y++ )
+            for( unsigned x = 0; x < TEST_WIDTH; x++ )
+                assert( bwdif_get( &dst[y * TEST_STRIDE], x, bits > 8 )
+                        == max / 3 );
+    }
+}
+
+#ifdef CAN_COMPILE_AVX2
+/* The vectorized bwdif matches the C one bit per bit */
+static int check_bwdif_avx2( int bits )
+{
+    static uint8_t a[TEST_HEIGHT * TEST_STRIDE], b[TEST_HEIGHT * TEST_STRIDE];
+
+    fill_frames( bits, bits, false );
+    for( int width = 1; width <= TEST_WIDTH; width++ )
+        for( int parity = 0; parity < 2; parity++ )
+        {
+            memset( a, 0, sizeof(a) );
+            memset( b, 0, sizeof(b) );
+            bwdif_frame( bits, width, false, parity, a, false );
+            bwdif_frame( bits, width, false, parity, b, true );
+            if( memcmp( a, b, sizeof(a) ) )
+            {
+                fprintf( stderr, "bwdif avx2: mismatch for %d bits, "
+                         "width %d, parity %d\n", bits, width, parity );
+                return 1;
+            }
+        }
+    printf( "bwdif avx2 %d bits: ok\n", bits );
+    return 0;
+}
+#endif
+
+int main( void )
+{
+    int ret = 0;
+
+    for( int bits = 8; bits <= 10; bits += 2 )
+    {
+        test_bwdif_still( bits );
+        test_bwdif_flat( bits );
+    }
+
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        for( int bits = 8; bits <= 12 && ret == 0; bits += 2 )
+        {
+            ret |= check_yadif( "avx2", yadif_filter_line_avx2,
+                                yadif_filter_line_avx2_16bit, bits );
+            ret |= check_bwdif_avx2( bits );
+        }
+#endif
+#ifdef YADIF_HAVE_NEON
+    for( int bits = 8; bits <= 12 && ret == 0; bits += 2 )
+        ret |= check_yadif( "neon", yadif_filter_line_neon,
+                            yadif_filter_line_neon_16bit, bits );
+#endif
+    return ret;
+}
@@ -0,0 +1,197 @@
+/*****************************************************************************
+ * filter_bench.c: CPU video filters benchmark
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the frame rate of the slice threaded video filters, on a single
+ * thread and with the shared filter threads.
+ *
+ * Usage: filter_bench [width height [frames [filter ...]]]
+ *
+ * The default is 60 frames of 3840x2160 I420 through hqdn3d, adjust,
+ * sharpen, gradfun and the yadif and bwdif deinterlacers.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_tick.h>
+
+static const char *const default_filters[] = {
+    "hqdn3d",
+    "adjust{contrast=1.2,saturation=1.5,hue=20}",
+    "sharpen{sigma=0.5}",
+    "gradfun",
+    "deinterlace{mode=yadif}",
+    "deinterlace{mode=bwdif}",
+};
+
+static unsigned bench_rand(void)
+{
+    static uint32_t lcg = 0x12345678;
+
+    lcg = lcg * 1664525 + 1013904223;
+    return lcg >> 24;
+}
+
+/* Smooth gradients with some noise, so that every filter has work to do */
+static picture_t *NewSource(const video_format_t *fmt, unsigned seed)
+{
+    picture_t *pic = picture_NewFromFormat(fmt);
+    if (pic == NULL)
+        return NULL;
+
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+                p->p_pixels[y * p->i_pitch + x] =
+                    (x + y + seed) / 8 + (bench_rand() & 7);
+    }
+    return pic;
+}
+
+static double Bench(libvlc_int_t *libvlc, const char *filter,
+                    const video_format_t *fmt, unsigned frames)
+{
+    es_format_t es;
+    double fps = -1.;
+
+    es_format_Init(&es, VIDEO_ES, fmt->i_chroma);
+    video_format_Copy(&es.video, fmt);
+
+    filter_chain_t *chain = filter_chain_NewVideo(libvlc, false, NULL);
+    if (chain == NULL)
+        goto out;
+    filter_chain_Reset(chain, &es, NULL, &es);
+    if (filter_chain_AppendFromString(chain, filter) != 1)
+        goto out;
+
+    picture_t *src[2] = { NewSource(fmt, 0), NewSource(fmt, 16) };
+    if (src[0] == NULL || src[1] == NULL)
+        goto out_pics;
+
+    vlc_tick_t start = 0;
+    /* The first frames are not measured: the deinterlacer fills its history
+     * and the threads are created */
+    for (unsigned i = 0; i < frames + 3; i++)
+    {
+        if (i == 3)
+            start = vlc_tick_now();
+
+        picture_t *pic = picture_Hold(src[i & 1]);
+        pic->date = VLC_TICK_0 + i * VLC_TICK_FROM_MS(40);
+        pic = filter_chain_VideoFilter(chain, pic);
+        if (pic != NULL)
+            picture_Release(pic);
+    }
+    fps = frames / secf_from_vlc_tick(vlc_tick_now() - start);
+
+out_pics:
+    for (size_t i = 0; i < ARRAY_SIZE(src); i++)
+        if (src[i] != NULL)
+            picture_Release(src[i]);
+out:
+    if (chain != NULL)
+        filter_chain_Delete(chain);
+    es_format_Clean(&es);
+    return fps;
+}
+
+static libvlc_instance_t *NewInstance(const char *threads)
+{
+    const char *const args[] = {
+        "--ignore-config", "--quiet", threads,
+    };
+
+    return libvlc_new(ARRAY_SIZE(args), args);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned width = 3840, height = 2160, frames = 60;
+    const char *const *filters = default_filters;
+    size_t count = ARRAY_SIZE(default_filters);
+
+    if (argc > 2)
+    {
+        width = strtoul(argv[1], NULL, 0);
+        height = strtoul(argv[2], NULL, 0);
+    }
+    if (argc > 3)
+        frames = strtoul(argv[3], NULL, 0);
+    if (argc > 4)
+    {
+        filters = (const char *const *)&argv[4];
+        count = argc - 4;
+    }
+    if (width == 0 || height == 0 || frames == 0)
+    {
+        fprintf(stderr, "usage: %s [width height [frames [filter ...]]]\n",
+                argv[0]);
+        return 1;
+    }
+
+    test_setup();
+
+    libvlc_instance_t *single = NewInstance("--filter-threads=1");
+    libvlc_instance_t *threaded = NewInstance("--filter-threads=0");
+    if (single == NULL || threaded == NULL)
+        return 1;
+
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, width, height, width, height,
+                       1, 1);
+
+    printf("%ux%u I420, %u frames, %u CPUs\n", width, height, frames,
+           vlc_GetCPUCount());
+    printf("%-44s %10s %10s %8s\n", "filter", "1 thread", "threads",
+           "speedup");
+
+    for (size_t i = 0; i < count; i++)
+    {
+        double fps1 = Bench(single->p_libvlc_int, filters[i], &fmt, frames);
+        double fpsn = Bench(threaded->p_libvlc_int, filters[i], &fmt, frames);
+
+        if (fps1 < 0. || fpsn < 0.)
+        {
+            printf("%-44s %10s\n", filters[i], "n/a");
+            continue;
+        }
+        printf("%-44s %6.1f fps %6.1f fps %7.2fx\n", filters[i], fps1, fpsn,
+               fpsn / fps1);
+    }
+
+    video_format_Clean(&fmt);
+    libvlc_release(threaded);
+    libvlc_release(single);
+    return 0;
+}
@@ -0,0 +1,202 @@
+/*****************************************************************************
+ * hqdn3d.c: high quality 3D denoiser test
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#define MODULE_NAME hqdn3d
+#include "../module_test.h"
+#include "../modules/video_filter/hqdn3d.c"
+
+#define TEST_WIDTH  77
+#define TEST_HEIGHT 23
+#define TEST_FRAMES 4
+#define TEST_STRIDE (2 * TEST_WIDTH + 32)
+
+struct test_state
+{
+    unsigned int line[TEST_WIDTH * TEST_HEIGHT];
+    unsigned short *frame;
+    uint8_t dst[TEST_HEIGHT * TEST_STRIDE];
+};
+
+static int coefs[4][512 * 16];
+static uint8_t test_src[TEST_FRAMES][TEST_HEIGHT * TEST_STRIDE];
+
+static void fill_source( unsigned seed, int bits )
+{
+    for( unsigned f = 0; f < TEST_FRAMES; f++ )
+        for( unsigned y = 0; y < TEST_HEIGHT; y++ )
+            for( unsigned x = 0; x < TEST_WIDTH; x++ )
+            {
+                /* Noise around a gradient, and a few edges */
+                const uint32_t noise = test_noise( seed * TEST_FRAMES + f,
+                                                   x, y );
+                unsigned v = x * 3 + y + (noise >> 24) % 24
+                           + ((x / 16) & 1) * 96;
+                v %= 256;
+                uint8_t *row = &test_src[f][y * TEST_STRIDE];
+                if( bits > 8 )
+                    ((uint16_t *)row)[x] = (v << (bits - 8))
+                                         | (noise & ((1 << (bits - 8)) - 1));
+                else
+                    row[x] = v;
+            }
+}
+
+/* Runs the filter on the frames of the given width, the columns and lines
+ * split in bands of the given size, as in the slices */
+static void run( struct test_state *st, int width, int band, bool spatial,
+                 bool temporal, enum hqdn3d_kernel kernel, int bits,
+                 unsigned frame )
+{
+    struct hqdn3d_plane plane = {
+        .src = &(plane_t) {
+            .p_pixels = test_src[frame], .i_pitch = TEST_STRIDE,
+        },
+        .dst = &(plane_t) {
+            .p_pixels = st->dst, .i_pitch = TEST_STRIDE,
+        },
+        .frame = temporal ? st->frame : NULL,
+        .line = st->line,
+        .w = width,
+        .h = TEST_HEIGHT,
+        .spat = coefs[0],
+        .temp = coefs[1],
+        .bits = bits,
+        .kernel = kernel,
+    };
+
+    if( !spatial )
+    {
+        for( int y = 0; y < TEST_HEIGHT; y += band )
+            TemporalSlice( &plane, &(struct vlc_filter_slice) {
+                .first = y, .count = __MIN(band, TEST_HEIGHT - y) } );
+        return;
+    }
+
+    for( int y = 0; y < TEST_HEIGHT; y += band )
+        HorizontalSlice( &plane, &(struct vlc_filter_slice) {
+            .first = y, .count = __MIN(band, TEST_HEIGHT - y) } );
+    for( int x = 0; x < width; x += band )
+        VerticalSlice( &plane, &(struct vlc_filter_slice) {
+            .first = x, .count = __MIN(band, width - x) } );
+}
+
+static void init_state( struct test_state *st, int width, int bits )
+{
+    memset( st->dst, 0, sizeof(st->dst) );
+    st->frame = deNoiseInit( test_src[0], width, TEST_HEIGHT, TEST_STRIDE,
+                             bits );
+    assert( st->frame != NULL );
+}
+
+/* Zero strengths leave the pictures unchanged, whatever the depth */
+static void test_identity( void )
+{
+    static const int depths[] = { 8, 10, 12 };
+
+    PrecalcCoefs( coefs[0], 0. );
+    PrecalcCoefs( coefs[1], 0. );
+
+    for( size_t d = 0; d < ARRAY_SIZE(depths); d++ )
+    {
+        struct test_state st;
+
+        fill_source( d, depths[d] );
+        init_state( &st, TEST_WIDTH, depths[d] );
+        run( &st, TEST_WIDTH, TEST_HEIGHT, true, true, HQDN3D_C, depths[d],
+             1 );
+
+        const size_t size = depths[d] > 8 ? 2 : 1;
+        assert( test_same_rows( st.dst, TEST_STRIDE,
+                                test_src[1], TEST_STRIDE,
+                                size * TEST_WIDTH, TEST_HEIGHT ) );
+        free( st.frame );
+    }
+}
+
+/* The vectorized kernels match the C ones bit per bit */
+static int check_kernel( enum hqdn3d_kernel kernel, const char *name,
+                         int bits )
+{
+    PrecalcCoefs( coefs[0], 4. );
+    PrecalcCoefs( coefs[1], 6. );
+
+    for( unsigned mode = 0; mode < 3; mode++ )
+    for( int width = 1; width <= TEST_WIDTH; width += (width < 20) ? 1 : 19 )
+    {
+        const bool spatial = mode != 0, temporal = mode != 1;
+        const int band = 1 + width % 7;
+        struct test_state ref, out;
+
+        init_state( &ref, width, bits );
+        init_state( &out, width, bits );
+
+        for( unsigned f = 0; f < TEST_FRAMES; f++ )
+        {
+            run( &ref, width, TEST_HEIGHT, spatial, temporal, HQDN3D_C,
+                 bits, f );
+            run( &out, width, band, spatial, temporal, kernel, bits, f );
+
+            if( memcmp( ref.dst, out.dst, sizeof(ref.dst) )
+             || memcmp( ref.frame, out.frame,
+                        width * TEST_HEIGHT * sizeof(*ref.frame) ) )
+            {
+                fprintf( stderr, "%s: mismatch for %d bits, width %d, "
+                         "mode %u, frame %u\n", name, bits, width, mode, f );
+                return 1;
+            }
+        }
+        free( ref.frame );
+        free( out.frame );
+    }
+    printf( "%s %d bits: ok\n", name, bits );
+    return 0;
+}
+
+static int check_kernels( enum hqdn3d_kernel kernel, const char *name )
+{
+    int ret = 0;
+
+    for( int bits = 8; bits <= 12 && ret == 0; bits += 2 )
+    {
+        fill_source( bits, bits );
+        ret |= check_kernel( kernel, name, bits );
+    }
+    return ret;
+}
+
+int main( void )
+{
+    int ret = 0;
+
+    test_identity();
+
+#ifdef CAN_COMPILE_SSE4_1
+    if( vlc_CPU_SSE4_1() )
+        ret |= check_kernels( HQDN3D_SSE4_1, "sse4.1" );
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        ret |= check_kernels( HQDN3D_AVX2, "avx2" );
+#endif
+#ifdef HQDN3D_HAVE_NEON
+    ret |= check_kernels( HQDN3D_NEON, "neon" );
+#endif
+    return ret;
+}
@@ -0,0 +1,376 @@
+/*****************************************************************************
+ * scale.c: video scaling filter test
+ *****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#define MODULE_NAME scale
+#include "../module_test.h"
+#include "../modules/video_filter/scale.c"
+
+static const vlc_fourcc_t chromas[] = {
+    VLC_CODEC_I420, VLC_CODEC_NV12, VLC_CODEC_I422, VLC_CODEC_RGBA,
+#ifndef WORDS_BIGENDIAN
+    VLC_CODEC_I420_10L, VLC_CODEC_P010, VLC_CODEC_I444_16L,
+#endif
+};
+
+/* Opens the scaler from a picture of the given size, cropped by crop pixels
+ * on each side, on a parentless object for the module logs */
+static int open_scaler( filter_t **pp_filter, vlc_fourcc_t chroma,
+                        unsigned width, unsigned height, unsigned crop,
+                        unsigned out_width, unsigned out_height,
+                        enum scale_kernel kernel )
+{
+    filter_t *filter = (vlc_object_create)( NULL, sizeof(*filter) );
+    assert( filter != NULL );
+
+    es_format_Init( &filter->fmt_in, VIDEO_ES, chroma );
+    video_format_Setup( &filter->fmt_in.video, chroma, width, height,
+                        width - 2 * crop, height - 2 * crop, 1, 1 );
+    filter->fmt_in.video.i_x_offset = crop;
+    filter->fmt_in.video.i_y_offset = crop;
+    es_format_Init( &filter->fmt_out, VIDEO_ES, chroma );
+    video_format_Setup( &filter->fmt_out.video, chroma, out_width, out_height,
+                        out_width, out_height, 1, 1 );
+
+    int ret = Setup( filter, kernel );
+    if( ret != VLC_SUCCESS )
+    {
+        es_format_Clean( &filter->fmt_out );
+        es_format_Clean( &filter->fmt_in );
+        vlc_object_delete( filter );
+    }
+    else
+        *pp_filter = filter;
+    return ret;
+}
+
+static void close_scaler( filter_t *filter )
+{
+    CloseFilter( filter );
+    es_format_Clean( &filter->fmt_out );
+    es_format_Clean( &filter->fmt_in );
+    vlc_object_delete( filter );
+}
+
+/* Scales the picture by bands of the given height */
+static picture_t *scale( filter_t *filter, picture_t *src, unsigned band,
+                         enum scale_cpu cpu )
+{
+    filter_sys_t *p_sys = filter->p_sys;
+    picture_t *dst = picture_NewFromFormat( &filter->fmt_out.video );
+    assert( dst != NULL );
+
+    p_sys->cpu = cpu;
+    for( unsigned i = 0; i < p_sys->planes; i++ )
+    {
+        const struct scale_plane *plane = &p_sys->plane[i];
+        struct scale_frame frame = {
+            .sys = p_sys, .plane = plane, .src = &src->p[i], .dst = &dst->p[i],
+        };
+        const bool copy = plane->cols.taps == 1 && plane->rows.taps == 1;
+
+        for( unsigned y = 0, index = 0; y < plane->out_height; y += band )
+        {
+            struct vlc_filter_slice slice = {
+                .index = index++ % VLC_FILTER_SLICES_MAX,
+                .first = y, .count = __MIN(band, plane->out_height - y),
+            };
+            (copy ? CopySlice : ScaleSlice)( &frame, &slice );
+        }
+    }
+    return dst;
+}
+
+static unsigned sample_bytes( const picture_t *pic )
+{
+    const vlc_chroma_description_t *desc =
+        vlc_fourcc_GetChromaDescription( pic->format.i_chroma );
+    return desc->pixel_size;
+}
+
+/* Compares the visible samples of the planes */
+static bool same_pixels( const filter_t *filter, const picture_t *a,
+                         const picture_t *b )
+{
+    const filter_sys_t *p_sys = filter->p_sys;
+    const unsigned size = sample_bytes( a ) == 4 ? 1 : sample_bytes( a );
+
+    for( unsigned i = 0; i < p_sys->planes; i++ )
+    {
+        const struct scale_plane *plane = &p_sys->plane[i];
+        if( !test_same_rows( a->p[i].p_pixels, a->p[i].i_pitch,
+                             b->p[i].p_pixels, b->p[i].i_pitch,
+                             plane->out_width * plane->comps * size,
+                             plane->out_height ) )
+            return false;
+    }
+    return true;
+}
+
+/* Fills the picture with a function of the position in the plane */
+static void fill( picture_t *pic, unsigned max, unsigned shift,
+                  unsigned (*sample)( unsigned i, unsigned x, unsigned y ) )
+{
+    const bool wide = sample_bytes( pic ) == 2;
+
+    for( int i = 0; i < pic->i_planes; i++ )
+    {
+        plane_t *p = &pic->p[i];
+        for( int y = 0; y < p->i_lines; y++ )
+            for( int x = 0; x < p->i_pitch / (wide ? 2 : 1); x++ )
+            {
+                const unsigned v = (sample( i, x, y ) & max) << shift;
+                if( wide )
+                    ((uint16_t *)&p->p_pixels[y * p->i_pitch])[x] = v;
+                else
+                    p->p_pixels[y * p->i_pitch + x] = v;
+            }
+    }
+}
+
+static unsigned flat_sample( unsigned i, unsigned x, unsigned y )
+{
+    return 0x5a5a5a5a >> i;
+}
+
+static unsigned noise_sample( unsigned i, unsigned x, unsigned y )
+{
+    return test_noise( i, x, y ) >> 8;
+}
+
+static void format_range( vlc_fourcc_t chroma, unsigned *max,
+                          unsigned *shift )
+{
+    struct scale_format fmt;
+    unsigned comps;
+
+    assert( SetFormat( &fmt, &comps, chroma,
+                       vlc_fourcc_GetChromaDescription( chroma ) ) );
+    *max = (1 << fmt.bits) - 1;
+    *shift = fmt.shift;
+}
+
+/* The weights sum to one and stay within the source */
+static void test_taps( void )
+{
+    static const unsigned sizes[][3] = {
+        { 0, 64, 64 }, { 0, 64, 128 }, { 3, 64, 37 }, { 5, 7, 300 },
+        { 0, 1920, 160 }, { 0, 2, 5 }, { 1, 1, 9 },
+    };
+
+    for( unsigned kernel = KERNEL_NEAREST; kernel <= KERNEL_LANCZOS; kernel++ )
+        for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+        {
+            const unsigned offset = sizes[i][0], in = sizes[i][1];
+            const unsigned out = sizes[i][2];
+            struct scale_taps t;
+
+            assert( SetTaps( &t, kernel, offset, in, out ) == VLC_SUCCESS );
+            assert( t.taps >= 1 && t.taps <= in );
+            if( in == out || kernel == KERNEL_NEAREST )
+                assert( t.taps == 1 );
+
+            for( unsigned j = 0; j < out; j++ )
+            {
+                int sum = 0;
+                for( unsigned k = 0; k < t.taps; k++ )
+                    sum += t.coefs[j * t.taps + k];
+                assert( sum == 1 << COEF_BITS );
+                assert( t.pos[j] >= offset );
+                assert( t.pos[j] + t.taps <= offset + in );
+                if( j > 0 )
+                    assert( t.pos[j] >= t.pos[j - 1] );
+                if( in == out )
+                    assert( t.pos[j] == offset + j );
+            }
+            CleanTaps( &t );
+        }
+}
+
+/* Unscaled pictures are copied, from the crop */
+static void test_copy( void )
+{
+    for( size_t c = 0; c < ARRAY_SIZE(chromas); c++ )
+        for( unsigned kernel = KERNEL_NEAREST; kernel <= KERNEL_LANCZOS;
+             kernel++ )
+        {
+            filter_t *filter;
+            unsigned max, shift;
+
+            format_range( chromas[c], &max, &shift );
+            assert( open_scaler( &filter, chromas[c], 100, 60, 2, 96, 56,
+                                 kernel ) == VLC_SUCCESS );
+
+            picture_t *src = picture_NewFromFormat( &filter->fmt_in.video );
+            assert( src != NULL );
+            fill( src, max, shift, noise_sample );
+            picture_t *dst = scale( filter, src, 7, SCALE_CPU_C );
+
+            const filter_sys_t *p_sys = filter->p_sys;
+            const unsigned size = sample_bytes( src ) == 4 ? 1
+                                : sample_bytes( src );
+            for( unsigned i = 0; i < p_sys->planes; i++ )
+            {
+                const struct scale_plane *plane = &p_sys->plane[i];
+                const plane_t *in = &src->p[i], *out = &dst->p[i];
+                const size_t bytes = plane->comps * size;
+
+                assert( test_same_rows( out->p_pixels, out->i_pitch,
+                                        &in->p_pixels[plane->in_y * in->i_pitch
+                                                      + plane->in_x * bytes],
+                                        in->i_pitch, plane->out_width * bytes,
+                                        plane->out_height ) );
+            }
+            picture_Release( dst );
+            picture_Release( src );
+            close_scaler( filter );
+        }
+}
+
+/* A flat picture stays flat, whatever the scale and the kernel */
+static void test_flat( void )
+{
+    static const unsigned sizes[][2] = {
+        { 160, 90 }, { 33, 25 }, { 600, 24 }, { 111, 300 }, { 2, 2 },
+    };
+
+    for( size_t c = 0; c < ARRAY_SIZE(chromas); c++ )
+        for( unsigned kernel = KERNEL_NEAREST; kernel <= KERNEL_LANCZOS;
+             kernel++ )
+            for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+            {
+                filter_t *filter;
+                unsigned max, shift;
+
+                format_range( chromas[c], &max, &shift );
+                assert( open_scaler( &filter, chromas[c], 128, 96, 0,
+                                     sizes[i][0], sizes[i][1], kernel )
+                        == VLC_SUCCESS );
+
+                picture_t *src = picture_NewFromFormat( &filter->fmt_in.video );
+                picture_t *ref = picture_NewFromFormat( &filter->fmt_out.video );
+                assert( src != NULL && ref != NULL );
+                fill( src, max, shift, flat_sample );
+                fill( ref, max, shift, flat_sample );
+
+                picture_t *dst = scale( filter, src, 16, SCALE_CPU_C );
+                assert( same_pixels( filter, ref, dst ) );
+
+                picture_Release( dst );
+                picture_Release( ref );
+                picture_Release( src );
+                close_scaler( filter );
+            }
+}
+
+/* The bands and the vectorized kernels give the same pixels */
+static int check_bands( enum scale_cpu cpu )
+{
+    static const unsigned sizes[][2] = {
+        { 211, 77 }, { 40, 30 }, { 300, 250 }, { 17, 301 },
+    };
+    static const unsigned bands[] = { 1, 5, 64 };
+
+    for( size_t c = 0; c < ARRAY_SIZE(chromas); c++ )
+        for( unsigned kernel = KERNEL_BILINEAR; kernel <= KERNEL_LANCZOS;
+             kernel++ )
+            for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+            {
+                filter_t *filter;
+                unsigned max, shift;
+
+                format_range( chromas[c], &max, &shift );
+                assert( open_scaler( &filter, chromas[c], 176, 144, 4,
+                                     sizes[i][0], sizes[i][1], kernel )
+                        == VLC_SUCCESS );
+
+                picture_t *src = picture_NewFromFormat( &filter->fmt_in.video );
+                assert( src != NULL );
+                fill( src, max, shift, noise_sample );
+
+                picture_t *ref = scale( filter, src, 1000, SCALE_CPU_C );
+                for( size_t b = 0; b < ARRAY_SIZE(bands); b++ )
+                {
+                    picture_t *dst = scale( filter, src, bands[b], cpu );
+                    bool same = same_pixels( filter, ref, dst );
+                    picture_Release( dst );
+                    if( !same )
+                    {
+                        fprintf( stderr, "%s: mismatch for %4.4s, %s, "
+                                 "%ux%u, band %u\n", cpu_names[cpu],
+                                 (const char *)&chromas[c],
+                                 kernel_list[kernel], sizes[i][0],
+                                 sizes[i][1], bands[b] );
+                        return 1;
+                    }
+                }
+                picture_Release( ref );
+                picture_Release( src );
+                close_scaler( filter );
+            }
+    printf( "%s bands: ok\n", cpu_names[cpu] );
+    return 0;
+}
+
+static void test_open( void )
+{
+    filter_t *filter;
+
+    /* Palette indexes are not blended */
+    assert( open_scaler( &filter, VLC_CODEC_YUVP, 64, 48, 0, 128, 96,
+                         KERNEL_LANCZOS ) == VLC_SUCCESS );
+    const filter_sys_t *p_sys = filter->p_sys;
+    assert( p_sys->plane[0].cols.taps == 1 && p_sys->plane[0].rows.taps == 1 );
+    close_scaler( filter );
+
+    /* Packed YUV is not supported */
+    assert( open_scaler( &filter, VLC_CODEC_YUYV, 64, 48, 0, 128, 96,
+                         KERNEL_BICUBIC ) == VLC_EINVAL );
+
+    /* The chroma planes have their own weights */
+    assert( open_scaler( &filter, VLC_CODEC_NV12, 64, 48, 0, 32, 24,
+                         KERNEL_BICUBIC ) == VLC_SUCCESS );
+    p_sys = filter->p_sys;
+    assert( p_sys->planes == 2 );
+    assert( p_sys->plane[1].comps == 2 );
+    assert( p_sys->plane[1].in_width == 32 && p_sys->plane[1].out_width == 16 );
+    assert( p_sys->plane[1].in_height == 24 && p_sys->plane[1].out_height == 12 );
+    close_scaler( filter );
+}
+
+int main( void )
+{
+    int ret = 0;
+
+    test_open();
+    test_taps();
+    test_copy();
+    test_flat();
+    ret |= check_bands( SCALE_CPU_C );
+
+#ifdef CAN_COMPILE_AVX2
+    if( ret == 0 && vlc_CPU_AVX2() )
+        ret |= check_bands( SCALE_CPU_AVX2 );
+#endif
+#ifdef SCALE_HAVE_NEON
+    if( ret == 0 )
+        ret |= check_bands( SCALE_CPU_NEON );
+#endif
+    return ret;
+}
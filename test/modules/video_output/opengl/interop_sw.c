@@ -0,0 +1,235 @@
+/*****************************************************************************
+ * interop_sw.c: test for the OpenGL software interop uploads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#ifndef VLC_TEST_OPENGL_API
+# error "Define VLC_TEST_OPENGL_API to the VLC_OPENGL API to use"
+#endif
+
+/* Define a builtin module for mocked parts */
+#define MODULE_NAME test_opengl
+#undef VLC_DYNAMIC_PLUGIN
+
+#include "../../../libvlc/test.h"
+#include "../../../../lib/libvlc_internal.h"
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_codec.h>
+#include <vlc_opengl.h>
+#include <vlc_modules.h>
+
+#include "../../../../modules/video_output/opengl/gl_api.h"
+#include "../../../../modules/video_output/opengl/gl_util.h"
+#include "../../../../modules/video_output/opengl/interop.h"
+
+static_assert(
+    VLC_TEST_OPENGL_API == VLC_OPENGL ||
+    VLC_TEST_OPENGL_API == VLC_OPENGL_ES2,
+    "VLC_TEST_OPENGL_API must be assigned to VLC_OPENGL or VLC_OPENGL_ES2");
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#define WIDTH 64
+#define HEIGHT 48
+/* More frames than uploading buffers, so that each one is reused */
+#define FRAMES 8
+
+static uint8_t PixelValue(unsigned frame, int plane, int line)
+{
+    return (frame * 37 + plane * 64 + line) & 0xff;
+}
+
+static bool HasPersistentMapping(vlc_gl_t *gl)
+{
+    struct vlc_gl_extension_vt extension_vt;
+    vlc_gl_LoadExtensionFunctions(gl, &extension_vt);
+
+    if (gl->api_type == VLC_OPENGL_ES2)
+        return vlc_gl_GetVersionMajor(&extension_vt) >= 3
+            && vlc_gl_HasExtension(&extension_vt, "GL_EXT_buffer_storage");
+    return vlc_gl_HasExtension(&extension_vt, "GL_ARB_buffer_storage")
+        && vlc_gl_HasExtension(&extension_vt, "GL_ARB_sync");
+}
+
+static void test_interop_upload(vlc_object_t *root)
+{
+    struct vlc_decoder_device *device =
+        vlc_decoder_device_Create(root, NULL);
+    vlc_gl_t *gl = vlc_gl_CreateOffscreen(
+            root, device, WIDTH, HEIGHT, VLC_TEST_OPENGL_API, NULL, NULL);
+    assert(gl != NULL);
+    if (device != NULL)
+        vlc_decoder_device_Release(device);
+
+    int ret = vlc_gl_MakeCurrent(gl);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_gl_api api;
+    ret = vlc_gl_api_Init(&api, gl);
+    assert(ret == VLC_SUCCESS);
+
+    video_format_t fmt;
+    video_format_Init(&fmt, VLC_CODEC_I420);
+    video_format_Setup(&fmt, VLC_CODEC_I420, WIDTH, HEIGHT, WIDTH, HEIGHT,
+                       1, 1);
+
+    struct vlc_gl_interop *interop = vlc_gl_interop_New(gl, NULL, &fmt);
+    assert(interop != NULL);
+    GL_ASSERT_NOERROR(&api.vt);
+
+    /* The persistent submodule has the highest priority */
+    const bool persistent = HasPersistentMapping(gl);
+    fprintf(stderr, "Using the sw interop with priority %d%s\n",
+            module_get_score(interop->module),
+            persistent ? " (persistent mapping available)" : "");
+    if (persistent)
+        assert(module_get_score(interop->module) == 3);
+
+    /* The readback needs color-renderable textures */
+    if (interop->texs[0].internal != GL_R8)
+    {
+        vlc_gl_interop_Delete(interop);
+        vlc_gl_ReleaseCurrent(gl);
+        vlc_gl_Delete(gl);
+        return;
+    }
+
+    GLsizei tex_width[PICTURE_PLANE_MAX];
+    GLsizei tex_height[PICTURE_PLANE_MAX];
+    GLuint textures[PICTURE_PLANE_MAX];
+    for (unsigned i = 0; i < interop->tex_count; ++i)
+    {
+        tex_width[i] = WIDTH * interop->texs[i].w.num / interop->texs[i].w.den;
+        tex_height[i] = HEIGHT * interop->texs[i].h.num / interop->texs[i].h.den;
+    }
+    ret = vlc_gl_interop_GenerateTextures(interop, tex_width, tex_height,
+                                          textures);
+    assert(ret == VLC_SUCCESS);
+    GL_ASSERT_NOERROR(&api.vt);
+
+    GLuint out_fb;
+    api.vt.GenFramebuffers(1, &out_fb);
+    api.vt.BindFramebuffer(GL_FRAMEBUFFER, out_fb);
+
+    picture_t *picture = picture_NewFromFormat(&interop->fmt_in);
+    assert(picture != NULL);
+
+    uint8_t *pixels = malloc(WIDTH * HEIGHT * 4);
+    assert(pixels != NULL);
+
+    for (unsigned frame = 0; frame < FRAMES; ++frame)
+    {
+        for (int i = 0; i < picture->i_planes; ++i)
+        {
+            const plane_t *p = &picture->p[i];
+            for (int y = 0; y < p->i_lines; ++y)
+                memset(&p->p_pixels[y * p->i_pitch],
+                       PixelValue(frame, i, y), p->i_pitch);
+        }
+
+        ret = interop->ops->update_textures(interop, textures, tex_width,
+                                            tex_height, picture, NULL);
+        assert(ret == VLC_SUCCESS);
+        GL_ASSERT_NOERROR(&api.vt);
+
+        /* Each texture must hold the last uploaded frame */
+        for (unsigned i = 0; i < interop->tex_count; ++i)
+        {
+            api.vt.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0,
+                                        interop->tex_target, textures[i], 0);
+            assert(api.vt.CheckFramebufferStatus(GL_FRAMEBUFFER)
+                    == GL_FRAMEBUFFER_COMPLETE);
+            api.vt.ReadPixels(0, 0, tex_width[i], tex_height[i], GL_RGBA,
+                              GL_UNSIGNED_BYTE, pixels);
+            GL_ASSERT_NOERROR(&api.vt);
+
+            for (GLsizei y = 0; y < tex_height[i]; ++y)
+                for (GLsizei x = 0; x < tex_width[i]; ++x)
+                    assert(pixels[(y * tex_width[i] + x) * 4]
+                            == PixelValue(frame, i, y));
+        }
+    }
+
+    free(pixels);
+    picture_Release(picture);
+
+    api.vt.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    api.vt.DeleteFramebuffers(1, &out_fb);
+    vlc_gl_interop_DeleteTextures(interop, textures);
+    vlc_gl_interop_Delete(interop);
+    GL_ASSERT_NOERROR(&api.vt);
+
+    vlc_gl_ReleaseCurrent(gl);
+    vlc_gl_Delete(gl);
+}
+
+int main( int argc, char **argv )
+{
+    (void)argc; (void)argv;
+    test_init();
+
+    const char * const vlc_argv[] = {
+        "-vvv", "--aout=dummy", "--text-renderer=dummy",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(vlc_argv), vlc_argv);
+    vlc_object_t *root = &vlc->p_libvlc_int->obj;
+
+    const char *cap =
+        (VLC_TEST_OPENGL_API == VLC_OPENGL)     ? "opengl offscreen" :
+        (VLC_TEST_OPENGL_API == VLC_OPENGL_ES2) ? "opengl es2 offscreen" :
+        NULL;
+    assert(cap != NULL);
+
+    module_t **providers;
+    size_t strict_matches;
+    ssize_t provider_available = vlc_module_match(
+            cap, NULL, false, &providers, &strict_matches);
+    (void)strict_matches;
+    free(providers);
+
+    if (provider_available <= 0)
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+
+    struct vlc_decoder_device *device =
+        vlc_decoder_device_Create(root, NULL);
+    vlc_gl_t *gl = vlc_gl_CreateOffscreen(
+            root, device, 3, 3, VLC_TEST_OPENGL_API, NULL, NULL);
+    if (device != NULL)
+        vlc_decoder_device_Release(device);
+
+    if (gl == NULL)
+    {
+        libvlc_release(vlc);
+        return 77;
+    }
+    vlc_gl_Delete(gl);
+
+    test_interop_upload(root);
+
+    libvlc_release(vlc);
+    return 0;
+}
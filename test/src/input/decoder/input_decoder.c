@@ -134,13 +134,18 @@ static void CloseCcDecoder(vlc_object_t *obj)
 
 static vlc_frame_t *PacketizerPacketize(decoder_t *dec, vlc_frame_t **in)
 {
-    (void)dec;
     if (in == NULL)
         return NULL;
 
     vlc_frame_t *ret = *in;
     if (ret != NULL)
+    {
         *in = NULL;
+
+        struct input_decoder_scenario *scenario = &input_decoder_scenarios[current_scenario];
+        if (scenario->packetizer_packetize != NULL)
+            scenario->packetizer_packetize(dec, ret);
+    }
     return ret;
 }
 
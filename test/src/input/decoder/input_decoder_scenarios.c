@@ -45,8 +45,11 @@ static struct scenario_data
     bool skip_decoder;
     bool has_reload;
     bool stream_out_sent;
+    bool preroll_seeking;
+    bool preroll_flushed;
     size_t decoder_image_sent;
     size_t cc_track_idx;
+    size_t preroll_decoded;
 } scenario_data;
 
 static void decoder_fixed_size(decoder_t *dec, vlc_fourcc_t chroma,
@@ -607,6 +610,74 @@ static void cc_text_renderer_render_608_02(filter_t *filter,
     vlc_sem_post(&scenario_data.wait_stop);
 }
 
+/* 25 fps, with a keyframe every 2 seconds and every other frame not
+ * referenced. Seeking to PREROLL_TARGET restarts from the keyframe at 2s,
+ * the frames up to 2.40s being flagged as preroll by the es_out. */
+#define PREROLL_FRAME VLC_TICK_FROM_MS(40)
+#define PREROLL_KEYFRAME (VLC_TICK_0 + VLC_TICK_FROM_SEC(2))
+#define PREROLL_TARGET VLC_TICK_FROM_MS(2460)
+
+static void packetizer_packetize_non_reference(decoder_t *dec,
+                                               vlc_frame_t *out)
+{
+    (void)dec;
+    if ((out->i_pts - VLC_TICK_0) / PREROLL_FRAME % 2 != 0)
+        out->i_flags |= VLC_FRAME_FLAG_NON_REFERENCE;
+}
+
+static int decoder_decode_check_preroll(decoder_t *dec, picture_t *pic)
+{
+    vlc_tick_t date = pic->date;
+    picture_Release(pic);
+
+    if (!scenario_data.preroll_flushed)
+    {
+        if (scenario_data.decoder_image_sent++ == 0)
+            vlc_sem_post(&scenario_data.wait_ready_to_flush);
+        return VLC_SUCCESS;
+    }
+
+    /* The non-reference frames before the target are skipped, not the
+     * frame displayed at the target, even if not referenced */
+    static const vlc_tick_t expected[] = {
+        PREROLL_KEYFRAME,
+        PREROLL_KEYFRAME + 2 * PREROLL_FRAME,
+        PREROLL_KEYFRAME + 4 * PREROLL_FRAME,
+        PREROLL_KEYFRAME + 6 * PREROLL_FRAME,
+        PREROLL_KEYFRAME + 8 * PREROLL_FRAME,
+        PREROLL_KEYFRAME + 10 * PREROLL_FRAME,
+        PREROLL_KEYFRAME + 11 * PREROLL_FRAME,
+    };
+
+    size_t i = scenario_data.preroll_decoded;
+    if (i >= ARRAY_SIZE(expected))
+        return VLC_SUCCESS;
+
+    msg_Info(dec, "Decoded frame %zu at %"PRId64, i, date);
+    assert(date == expected[i]);
+    if (++scenario_data.preroll_decoded == ARRAY_SIZE(expected))
+        vlc_sem_post(&scenario_data.wait_stop);
+    return VLC_SUCCESS;
+}
+
+static void decoder_flush_preroll(decoder_t *dec)
+{
+    (void)dec;
+    if (scenario_data.preroll_seeking)
+        scenario_data.preroll_flushed = true;
+}
+
+static void interface_setup_seek_precise(intf_thread_t *intf)
+{
+    vlc_player_t *player = (vlc_player_t *)intf->p_sys;
+    vlc_sem_wait(&scenario_data.wait_ready_to_flush);
+
+    scenario_data.preroll_seeking = true;
+    vlc_player_Lock(player);
+    vlc_player_SetTime(player, PREROLL_TARGET);
+    vlc_player_Unlock(player);
+}
+
 static const vlc_fourcc_t subpicture_chromas[] = {
     VLC_CODEC_RGBA, 0
 };
@@ -759,6 +830,16 @@ struct input_decoder_scenario input_decoder_scenarios[] =
     .display_prepare = display_prepare_noop,
     .text_renderer_render = cc_text_renderer_render_608_02,
 },
+{
+    .name = "non-reference frames before a precise seek target are skipped",
+    .source = source_800_600 ";video_packetized=false"
+              ";video_keyframe_interval=2000000",
+    .packetizer_packetize = packetizer_packetize_non_reference,
+    .decoder_setup = decoder_i420_800_600,
+    .decoder_decode = decoder_decode_check_preroll,
+    .decoder_flush = decoder_flush_preroll,
+    .interface_setup = interface_setup_seek_precise,
+},
 };
 
 size_t input_decoder_scenarios_count = ARRAY_SIZE(input_decoder_scenarios);
@@ -769,8 +850,11 @@ void input_decoder_scenario_init(void)
     scenario_data.skip_decoder = false;
     scenario_data.has_reload = false;
     scenario_data.stream_out_sent = false;
+    scenario_data.preroll_seeking = false;
+    scenario_data.preroll_flushed = false;
     scenario_data.decoder_image_sent = 0;
     scenario_data.cc_track_idx = 1;
+    scenario_data.preroll_decoded = 0;
     vlc_sem_init(&scenario_data.wait_stop, 0);
     vlc_sem_init(&scenario_data.wait_ready_to_flush, 0);
 }
@@ -0,0 +1,207 @@
+/*****************************************************************************
+ * decoder_cache.c: test for the decoded pictures cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_es.h>
+#include <vlc_picture.h>
+#include "../../../src/input/decoder_cache.h"
+
+#define WIDTH 64
+#define HEIGHT 32
+
+static es_format_t fmt_in;
+static video_format_t fmt_out;
+static size_t pic_size; /* including the padding */
+
+static picture_t *NewPicture(vlc_tick_t date)
+{
+    picture_t *pic = picture_NewFromFormat(&fmt_out);
+    assert(pic != NULL);
+    for (int i = 0; i < pic->i_planes; i++)
+        memset(pic->p[i].p_pixels, date & 0xff,
+               pic->p[i].i_pitch * pic->p[i].i_lines);
+    pic->date = date;
+    return pic;
+}
+
+static void AddPicture(struct vlc_decoder_cache_entry *entry, vlc_tick_t date)
+{
+    picture_t *pic = NewPicture(date);
+    assert(vlc_decoder_cache_entry_AddPicture(entry, pic) == VLC_SUCCESS);
+    picture_Release(pic);
+}
+
+/* Records a stream of frames decoded with one frame of delay, in decoding
+ * order: I0 P3 B1 B2 */
+static struct vlc_decoder_cache_entry *
+Record(struct vlc_decoder_cache *cache, const char *key)
+{
+    struct vlc_decoder_cache_entry *entry =
+        vlc_decoder_cache_entry_New(cache, key, &fmt_in);
+    assert(entry != NULL);
+
+    static const vlc_tick_t order[] = { 0, 3, 1, 2 };
+    for (size_t i = 0; i < ARRAY_SIZE(order); i++)
+    {
+        assert(vlc_decoder_cache_entry_AddFrame(entry, VLC_TICK_0 + order[i])
+               == VLC_SUCCESS);
+        if (i > 0)
+            AddPicture(entry, VLC_TICK_0 + i - 1);
+    }
+
+    /* Drain */
+    assert(vlc_decoder_cache_entry_AddFrame(entry, VLC_TICK_INVALID)
+           == VLC_SUCCESS);
+    AddPicture(entry, VLC_TICK_0 + 3);
+    return entry;
+}
+
+static void test_replay(void)
+{
+    struct vlc_decoder_cache *cache = vlc_decoder_cache_New(16 * pic_size);
+    assert(cache != NULL);
+
+    assert(vlc_decoder_cache_Get(cache, "item#1", &fmt_in) == NULL);
+    vlc_decoder_cache_Put(cache, Record(cache, "item#1"), &fmt_out);
+
+    struct vlc_decoder_cache_entry *entry =
+        vlc_decoder_cache_Get(cache, "item#1", &fmt_in);
+    assert(entry != NULL);
+    assert(video_format_IsSimilar(vlc_decoder_cache_entry_GetFormat(entry),
+                                  &fmt_out));
+
+    /* Played in decoding order, the pictures come out in display order */
+    static const vlc_tick_t order[] = { 0, 3, 1, 2 };
+    size_t cursor = 0;
+    vlc_tick_t next = VLC_TICK_0;
+    picture_t *const *pics;
+
+    for (size_t i = 0; i < ARRAY_SIZE(order); i++)
+    {
+        ssize_t count = vlc_decoder_cache_entry_Find(entry,
+                                                     VLC_TICK_0 + order[i],
+                                                     &cursor, &pics);
+        assert(count == (i > 0));
+        for (ssize_t j = 0; j < count; j++)
+        {
+            assert(pics[j]->date == next);
+            assert(pics[j]->p[0].p_pixels[0] == (next & 0xff));
+            next++;
+        }
+    }
+    assert(vlc_decoder_cache_entry_Find(entry, VLC_TICK_INVALID, &cursor,
+                                        &pics) == 1);
+    assert(pics[0]->date == VLC_TICK_0 + 3);
+
+    /* Seek back */
+    assert(vlc_decoder_cache_entry_Find(entry, VLC_TICK_0 + 3, &cursor,
+                                        &pics) == 1);
+    assert(pics[0]->date == VLC_TICK_0);
+
+    /* Unknown frame */
+    assert(vlc_decoder_cache_entry_Find(entry, VLC_TICK_0 + 42, &cursor,
+                                        &pics) == -1);
+
+    /* A different format is a different stream */
+    es_format_t other;
+    es_format_Copy(&other, &fmt_in);
+    other.i_codec = VLC_CODEC_HEVC;
+    assert(vlc_decoder_cache_Get(cache, "item#1", &other) == NULL);
+    es_format_Clean(&other);
+
+    vlc_decoder_cache_entry_Release(entry);
+    vlc_decoder_cache_Delete(cache);
+}
+
+static void test_budget(void)
+{
+    /* Room for two recordings */
+    struct vlc_decoder_cache *cache = vlc_decoder_cache_New(8 * pic_size);
+    assert(cache != NULL);
+
+    vlc_decoder_cache_Put(cache, Record(cache, "item#1"), &fmt_out);
+    vlc_decoder_cache_Put(cache, Record(cache, "item#2"), &fmt_out);
+
+    /* Hold item#1 while it gets evicted: it is the least recently used one
+     * once item#2 has been looked up */
+    struct vlc_decoder_cache_entry *entry1 =
+        vlc_decoder_cache_Get(cache, "item#1", &fmt_in);
+    assert(entry1 != NULL);
+    struct vlc_decoder_cache_entry *entry2 =
+        vlc_decoder_cache_Get(cache, "item#2", &fmt_in);
+    assert(entry2 != NULL);
+    vlc_decoder_cache_entry_Release(entry2);
+
+    vlc_decoder_cache_Put(cache, Record(cache, "item#3"), &fmt_out);
+    assert(vlc_decoder_cache_Get(cache, "item#1", &fmt_in) == NULL);
+
+    size_t cursor = 0;
+    picture_t *const *pics;
+    assert(vlc_decoder_cache_entry_Find(entry1, VLC_TICK_0 + 3, &cursor,
+                                        &pics) == 1);
+    vlc_decoder_cache_entry_Release(entry1);
+
+    entry2 = vlc_decoder_cache_Get(cache, "item#2", &fmt_in);
+    assert(entry2 != NULL);
+    vlc_decoder_cache_entry_Release(entry2);
+
+    /* A recording larger than the budget is refused */
+    struct vlc_decoder_cache_entry *entry =
+        vlc_decoder_cache_entry_New(cache, "item#4", &fmt_in);
+    assert(entry != NULL);
+    assert(vlc_decoder_cache_entry_AddFrame(entry, VLC_TICK_0) == VLC_SUCCESS);
+    for (unsigned i = 0; i < 8; i++)
+        AddPicture(entry, VLC_TICK_0 + i);
+    picture_t *pic = NewPicture(VLC_TICK_0 + 8);
+    assert(vlc_decoder_cache_entry_AddPicture(entry, pic) == VLC_EGENERIC);
+    picture_Release(pic);
+    vlc_decoder_cache_entry_Release(entry);
+
+    vlc_decoder_cache_Delete(cache);
+}
+
+int main(void)
+{
+    video_format_Init(&fmt_out, VLC_CODEC_I420);
+    video_format_Setup(&fmt_out, VLC_CODEC_I420, WIDTH, HEIGHT,
+                       WIDTH, HEIGHT, 1, 1);
+    es_format_Init(&fmt_in, VIDEO_ES, VLC_CODEC_H264);
+    fmt_in.video.i_width = WIDTH;
+    fmt_in.video.i_height = HEIGHT;
+
+    picture_t *pic = picture_NewFromFormat(&fmt_out);
+    assert(pic != NULL);
+    for (int i = 0; i < pic->i_planes; i++)
+        pic_size += (size_t)pic->p[i].i_pitch * pic->p[i].i_lines;
+    picture_Release(pic);
+
+    test_replay();
+    test_budget();
+
+    es_format_Clean(&fmt_in);
+    return 0;
+}
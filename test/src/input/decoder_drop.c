@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * decoder_drop.c: test for the decoder frame dropping policy
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc_common.h>
+#include "../../../src/input/decoder_drop.h"
+
+#define FRAME_DURATION VLC_TICK_FROM_MS(16)
+
+static vlc_tick_t now = VLC_TICK_0;
+
+/* Queues a full window of pictures with the given margin, returns the number
+ * of stage changes */
+static unsigned queue_window(struct vlc_decoder_drop *drop, vlc_tick_t margin)
+{
+    unsigned changes = 0;
+
+    for (unsigned i = 0; i < VLC_DECODER_DROP_WINDOW_SAMPLES; i++)
+    {
+        now += FRAME_DURATION;
+        if (vlc_decoder_drop_Update(drop, now, now + margin))
+            changes++;
+    }
+    return changes;
+}
+
+static const vlc_tick_t early = VLC_TICK_FROM_MS(100);
+static const vlc_tick_t late = -VLC_TICK_FROM_MS(10);
+
+static void test_steady(void)
+{
+    struct vlc_decoder_drop drop;
+    vlc_decoder_drop_Init(&drop);
+
+    for (unsigned i = 0; i < 10; i++)
+        assert(queue_window(&drop, early) == 0);
+    assert(drop.level == VLC_DECODER_DROP_NONE);
+
+    /* A few late pictures are not enough to escalate */
+    for (unsigned i = 0; i < 10; i++)
+    {
+        now += FRAME_DURATION;
+        vlc_decoder_drop_Update(&drop, now, now + late);
+        assert(queue_window(&drop, early) == 0);
+    }
+    assert(drop.level == VLC_DECODER_DROP_NONE);
+}
+
+static void test_escalate(void)
+{
+    struct vlc_decoder_drop drop;
+    vlc_decoder_drop_Init(&drop);
+
+    /* One stage per late window, the window following an escalation being
+     * ignored */
+    for (int level = VLC_DECODER_DROP_NONREF; level <= VLC_DECODER_DROP_MAX;
+         level++)
+    {
+        assert(queue_window(&drop, late) == 1);
+        assert((int)drop.level == level);
+        assert(queue_window(&drop, late) == 0);
+        assert((int)drop.level == level);
+    }
+
+    /* Saturated */
+    assert(queue_window(&drop, late) == 0);
+    assert(drop.level == VLC_DECODER_DROP_MAX);
+    assert(drop.escalations == VLC_DECODER_DROP_MAX);
+
+    /* Windows without headroom do not release a stage */
+    for (unsigned i = 0; i < 10; i++)
+        assert(queue_window(&drop, 0) == 0);
+    assert(drop.level == VLC_DECODER_DROP_MAX);
+
+    /* Recover one stage every VLC_DECODER_DROP_RECOVER_MIN good windows */
+    for (int level = VLC_DECODER_DROP_MAX - 1; level >= VLC_DECODER_DROP_NONE;
+         level--)
+    {
+        for (unsigned i = 1; i < VLC_DECODER_DROP_RECOVER_MIN; i++)
+            assert(queue_window(&drop, early) == 0);
+        assert(queue_window(&drop, early) == 1);
+        assert((int)drop.level == level);
+    }
+    assert(drop.recoveries == VLC_DECODER_DROP_MAX);
+}
+
+static void test_hysteresis(void)
+{
+    struct vlc_decoder_drop drop;
+    vlc_decoder_drop_Init(&drop);
+
+    /* Escalate twice */
+    assert(queue_window(&drop, late) == 1);
+    assert(queue_window(&drop, late) == 0);
+    assert(queue_window(&drop, late) == 1);
+    assert(queue_window(&drop, late) == 0);
+    assert(drop.level == VLC_DECODER_DROP_BIDIR);
+
+    /* Oscillate: each immediate escalation after a recovery doubles the
+     * number of good windows needed to recover */
+    unsigned needed = VLC_DECODER_DROP_RECOVER_MIN;
+    for (unsigned i = 0; i < 8; i++)
+    {
+        for (unsigned j = 1; j < needed; j++)
+            assert(queue_window(&drop, early) == 0);
+        assert(queue_window(&drop, early) == 1);
+        assert(drop.level == VLC_DECODER_DROP_NONREF);
+
+        assert(queue_window(&drop, late) == 1);
+        assert(drop.level == VLC_DECODER_DROP_BIDIR);
+        assert(queue_window(&drop, late) == 0);
+
+        needed = __MIN(needed * 2, VLC_DECODER_DROP_RECOVER_MAX);
+        assert(drop.recover_windows == needed);
+    }
+
+    /* Back to the first stage, after which the count is reset */
+    for (unsigned j = 1; j < needed; j++)
+        assert(queue_window(&drop, early) == 0);
+    assert(queue_window(&drop, early) == 1);
+    for (unsigned j = 1; j < needed; j++)
+        assert(queue_window(&drop, early) == 0);
+    assert(queue_window(&drop, early) == 1);
+    assert(drop.level == VLC_DECODER_DROP_NONE);
+    assert(drop.recover_windows == VLC_DECODER_DROP_RECOVER_MIN);
+}
+
+static void test_window(void)
+{
+    struct vlc_decoder_drop drop;
+    vlc_decoder_drop_Init(&drop);
+
+    /* Few pictures (e.g. keyframes only), the window is closed by time */
+    for (unsigned i = 0; i <= 4; i++)
+    {
+        now += VLC_DECODER_DROP_WINDOW / 4;
+        bool changed = vlc_decoder_drop_Update(&drop, now, now + late);
+        assert(changed == (i == 4));
+    }
+    assert(drop.level == VLC_DECODER_DROP_NONREF);
+
+    /* Discontinuities restart the window, not the stage */
+    now += FRAME_DURATION;
+    vlc_decoder_drop_Update(&drop, now, now + late);
+    vlc_decoder_drop_Reset(&drop);
+    assert(drop.samples == 0 && drop.late == 0);
+    assert(drop.level == VLC_DECODER_DROP_NONREF);
+}
+
+int main(void)
+{
+    test_steady();
+    test_escalate();
+    test_hysteresis();
+    test_window();
+    return 0;
+}
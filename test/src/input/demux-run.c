@@ -53,6 +53,8 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    uint64_t packets;
+    uint64_t payload;
 #ifdef HAVE_DECODERS
     vlc_object_t *parent;
 #endif
@@ -107,6 +109,8 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(ctx, id);
+    ctx->packets++;
+    ctx->payload += block->i_buffer;
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -229,6 +233,8 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->packets = 0;
+    ctx->payload = 0;
 
     es_out_t *out = &ctx->out;
     out->cbs = &es_out_cbs;
@@ -335,6 +341,102 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     return val == VLC_DEMUXER_EOF ? 0 : -1;
 }
 
+static int demux_bench_stream(const struct vlc_run_args *args, stream_t *s,
+                              struct vlc_demux_bench *bench)
+{
+    const char *name = args->name;
+    if (name == NULL)
+        name = "any";
+
+    if (s == NULL)
+        return -1;
+
+    if (vlc_stream_GetSize(s, &bench->size))
+        bench->size = 0;
+
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    if (out == NULL)
+    {
+        vlc_stream_Delete(s);
+        return -1;
+    }
+
+    demux_t *demux = demux_New(VLC_OBJECT(s), name, "vlc://nop", s, out);
+    if (demux == NULL)
+    {
+        es_out_Delete(out);
+        vlc_stream_Delete(s);
+        debug("Error: cannot create demultiplexer: %s\n", name);
+        return -1;
+    }
+
+    char *module = var_GetString(demux, "module-name");
+    strlcpy(bench->module, module != NULL ? module : "", sizeof (bench->module));
+    free(module);
+
+    struct test_es_out_t *ctx = (struct test_es_out_t *) out;
+    uint64_t allocs = bench->get_allocs != NULL ? bench->get_allocs() : 0;
+    uint64_t frame_allocs = block_GetAllocCount();
+    vlc_tick_t start = vlc_tick_now();
+    int val;
+
+    while ((val = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS);
+
+    bench->demux_us = US_FROM_VLC_TICK(vlc_tick_now() - start);
+    bench->frame_allocs = block_GetAllocCount() - frame_allocs;
+    if (bench->get_allocs != NULL)
+        bench->allocs = bench->get_allocs() - allocs;
+    bench->packets = ctx->packets;
+    bench->payload = ctx->payload;
+
+    /* Seek latency: a seek followed by the first demux call */
+    bench->seek_us = 0;
+    bench->seeks_done = 0;
+    for (unsigned i = 0; i < bench->seeks; i++)
+    {
+        double position = (double)(i + 1) / (bench->seeks + 1);
+
+        start = vlc_tick_now();
+        if (demux_Control(demux, DEMUX_SET_POSITION, position, true))
+            continue;
+        demux_Demux(demux);
+        bench->seek_us += US_FROM_VLC_TICK(vlc_tick_now() - start);
+        bench->seeks_done++;
+    }
+
+    demux_Delete(demux);
+    es_out_Delete(out);
+
+    return val == VLC_DEMUXER_EOF ? 0 : -1;
+}
+
+int vlc_demux_bench_path(const struct vlc_run_args *args, const char *path,
+                         struct vlc_demux_bench *bench)
+{
+    char *url = vlc_path2uri(path, NULL);
+    if (url == NULL)
+    {
+        fprintf(stderr, "Error: cannot convert path to URL: %s\n", path);
+        return -1;
+    }
+
+    libvlc_instance_t *vlc = libvlc_create(args);
+    if (vlc == NULL)
+    {
+        free(url);
+        return -1;
+    }
+
+    stream_t *s = vlc_access_NewMRL(VLC_OBJECT(vlc->p_libvlc_int), url);
+    if (s == NULL)
+        fprintf(stderr, "Error: cannot create input stream: %s\n", url);
+
+    int ret = demux_bench_stream(args, s, bench);
+    libvlc_release(vlc);
+    free(url);
+    return ret;
+}
+
 int vlc_demux_process_url(const struct vlc_run_args *args, const char *url)
 {
     libvlc_instance_t *vlc = libvlc_create(args);
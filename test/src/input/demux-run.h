@@ -33,3 +33,24 @@ int vlc_demux_process_memory(const struct vlc_run_args *,
 int libvlc_demux_process_memory(libvlc_instance_t *vlc,
                                 const struct vlc_run_args *args,
                                 const unsigned char *buf, size_t length);
+
+struct vlc_demux_bench
+{
+    /* optional allocation counter, called around the demux loop */
+    uint64_t (*get_allocs)(void);
+    /* number of seeks to measure after the demux loop */
+    unsigned seeks;
+
+    char module[32];          /* selected demux module */
+    uint64_t size;            /* stream size in bytes */
+    uint64_t packets;         /* blocks sent to the ES output */
+    uint64_t payload;         /* bytes sent to the ES output */
+    uint64_t allocs;          /* allocations during the demux loop */
+    uint64_t frame_allocs;    /* frame buffers allocated by the demux loop */
+    uint64_t demux_us;        /* duration of the demux loop */
+    uint64_t seek_us;         /* cumulated duration of the seeks */
+    unsigned seeks_done;
+};
+
+int vlc_demux_bench_path(const struct vlc_run_args *, const char *path,
+                         struct vlc_demux_bench *bench);
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * picture.c: test the picture pixels copies
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+
+#include <assert.h>
+
+static uint8_t PixelValue(int plane, int x, int y)
+{
+    return (plane * 71 + x * 3 + y * 5) & 0xff;
+}
+
+static void pic_rsc_destroy(picture_t *pic)
+{
+    void **buffers = pic->p_sys;
+
+    for (int i = 0; i < pic->i_planes; i++)
+        free(buffers[i]);
+    free(buffers);
+}
+
+/* Picture with a larger pitch than the default one, and misaligned rows, so
+ * that the copies cannot be done in one block */
+static picture_t *NewPaddedPicture(const video_format_t *fmt)
+{
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+    assert(dsc != NULL);
+
+    void **buffers = calloc(PICTURE_PLANE_MAX, sizeof (*buffers));
+    assert(buffers != NULL);
+
+    picture_resource_t rsc = {
+        .p_sys = buffers,
+        .pf_destroy = pic_rsc_destroy,
+    };
+    for (unsigned i = 0; i < dsc->plane_count; i++)
+    {
+        rsc.p[i].i_lines = (fmt->i_height * dsc->p[i].h.num
+                            + dsc->p[i].h.den - 1) / dsc->p[i].h.den;
+        rsc.p[i].i_pitch = (fmt->i_width * dsc->p[i].w.num
+                            + dsc->p[i].w.den - 1) / dsc->p[i].w.den
+                         * dsc->pixel_size + 35;
+        buffers[i] = malloc(rsc.p[i].i_lines * rsc.p[i].i_pitch + 1);
+        assert(buffers[i] != NULL);
+        rsc.p[i].p_pixels = (uint8_t *)buffers[i] + 1;
+    }
+
+    picture_t *pic = picture_NewFromResource(fmt, &rsc);
+    assert(pic != NULL);
+    return pic;
+}
+
+static void FillPicture(picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+            for (int x = 0; x < p->i_pitch; x++)
+                p->p_pixels[y * p->i_pitch + x] = PixelValue(i, x, y);
+    }
+}
+
+static void CheckPicture(const picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        const plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_visible_lines; y++)
+            for (int x = 0; x < p->i_visible_pitch; x++)
+                assert(p->p_pixels[y * p->i_pitch + x] == PixelValue(i, x, y));
+    }
+}
+
+static void ClearPicture(picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+        memset(pic->p[i].p_pixels, 0, pic->p[i].i_lines * pic->p[i].i_pitch);
+}
+
+static void test_copy(vlc_object_t *obj, vlc_fourcc_t chroma,
+                      unsigned width, unsigned height)
+{
+    video_format_t fmt;
+    video_format_Init(&fmt, chroma);
+    video_format_Setup(&fmt, chroma, width, height, width, height, 1, 1);
+
+    fprintf(stderr, "testing: %ux%u %4.4s\n", width, height,
+            (const char *)&chroma);
+
+    picture_t *src = picture_NewFromFormat(&fmt);
+    picture_t *dst = picture_NewFromFormat(&fmt);
+    picture_t *padded = NewPaddedPicture(&fmt);
+    assert(src != NULL && dst != NULL);
+    FillPicture(src);
+
+    /* Same pitches: block copies */
+    picture_CopyPixels(dst, src);
+    CheckPicture(dst);
+
+    ClearPicture(dst);
+    for (int i = 0; i < src->i_planes; i++)
+        plane_CopyPixels(&dst->p[i], &src->p[i]);
+    CheckPicture(dst);
+
+    ClearPicture(dst);
+    picture_CopyPixelsThreaded(obj, dst, src);
+    CheckPicture(dst);
+
+    /* Different pitches and misaligned rows: line by line copies */
+    picture_CopyPixels(padded, src);
+    CheckPicture(padded);
+
+    ClearPicture(dst);
+    picture_CopyPixelsThreaded(obj, dst, padded);
+    CheckPicture(dst);
+
+    ClearPicture(padded);
+    for (int i = 0; i < src->i_planes; i++)
+        plane_CopyPixels(&padded->p[i], &src->p[i]);
+    CheckPicture(padded);
+
+    picture_Release(padded);
+    picture_Release(dst);
+    picture_Release(src);
+    video_format_Clean(&fmt);
+}
+
+int main(void)
+{
+    test_init();
+
+    const char *const args[] = { "--filter-threads=4" };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    /* Small pictures, with regular stores */
+    test_copy(obj, VLC_CODEC_I420, 64, 48);
+    test_copy(obj, VLC_CODEC_NV12, 66, 50);
+    /* Non-temporal stores */
+    test_copy(obj, VLC_CODEC_I420, 3840, 2160);
+    test_copy(obj, VLC_CODEC_RGBA, 1922, 1080);
+    /* Non-temporal stores on several threads */
+    test_copy(obj, VLC_CODEC_I420, 7680, 4319);
+    test_copy(obj, VLC_CODEC_I422_10L, 4096, 2161);
+
+    libvlc_release(vlc);
+    return 0;
+}
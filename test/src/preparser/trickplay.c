@@ -0,0 +1,250 @@
+/*****************************************************************************
+ * trickplay.c: test trickplay sprite sheets generation API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_preparser.h>
+#include <vlc_input_item.h>
+#include <vlc_modules.h>
+#include <vlc_fs.h>
+
+#include <errno.h>
+#include <sys/stat.h>
+
+#define MOCK_LENGTH_S 9
+#define MOCK_WIDTH 640
+#define MOCK_HEIGHT 480
+
+#define STRINGIFY_(x) #x
+#define STRINGIFY(x) STRINGIFY_(x)
+#define MOCK_URL "mock://video_track_count=1;" \
+                 "length="STRINGIFY(MOCK_LENGTH_S)"000000;" \
+                 "video_width="STRINGIFY(MOCK_WIDTH)";" \
+                 "video_height="STRINGIFY(MOCK_HEIGHT)
+
+#define INTERVAL_S 2
+#define TILE_WIDTH 64
+#define COLUMNS 2
+#define ROWS 2
+
+struct context
+{
+    char prefix[sizeof("/tmp/libvlc_XXXXXX")];
+    enum vlc_thumbnailer_format format;
+    const char *ext;
+
+    /* Start of the expected cues, in seconds */
+    const unsigned *starts;
+    size_t count;
+
+    vlc_sem_t sem;
+};
+
+static size_t sprite_count(const struct context *context)
+{
+    return (context->count + COLUMNS * ROWS - 1) / (COLUMNS * ROWS);
+}
+
+static void check_index(struct context *context)
+{
+    char *path;
+    int ret = asprintf(&path, "%s.vtt", context->prefix);
+    assert(ret > 0);
+
+    FILE *file = vlc_fopen(path, "r");
+    assert(file != NULL);
+
+    char line[256];
+    assert(fgets(line, sizeof(line), file) != NULL);
+    assert(strcmp(line, "WEBVTT\n") == 0);
+
+    const char *name = strrchr(context->prefix, '/') + 1;
+    size_t cues = 0;
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (strstr(line, " --> ") != NULL)
+        {
+            unsigned h1, m1, s1, ms1, h2, m2, s2, ms2;
+            ret = sscanf(line, "%u:%u:%u.%u --> %u:%u:%u.%u", &h1, &m1, &s1,
+                         &ms1, &h2, &m2, &s2, &ms2);
+            assert(ret == 8);
+            assert(cues < context->count);
+            assert(h1 == 0 && m1 == 0 && ms1 == 0);
+            assert(s1 == context->starts[cues]);
+            assert(h2 == 0 && m2 == 0 && ms2 == 0);
+            assert(s2 == (cues + 1 < context->count ? context->starts[cues + 1]
+                                                     : MOCK_LENGTH_S));
+
+            /* The payload references the sprite holding the tile */
+            assert(fgets(line, sizeof(line), file) != NULL);
+
+            size_t sprite = cues / (COLUMNS * ROWS);
+            size_t tile = cues % (COLUMNS * ROWS);
+            char *expected;
+            ret = asprintf(&expected, "%s-%zu.%s#xywh=%zu,%zu,%u,%u\n", name,
+                           sprite, context->ext, tile % COLUMNS * TILE_WIDTH,
+                           tile / COLUMNS * (TILE_WIDTH * 3 / 4), TILE_WIDTH,
+                           TILE_WIDTH * 3 / 4);
+            assert(ret > 0);
+            assert(strcmp(line, expected) == 0);
+            free(expected);
+            cues++;
+        }
+    }
+    assert(cues == context->count);
+
+    fclose(file);
+    unlink(path);
+    free(path);
+
+    for (size_t i = 0; i < sprite_count(context); ++i)
+    {
+        ret = asprintf(&path, "%s-%zu.%s", context->prefix, i, context->ext);
+        assert(ret > 0);
+
+        struct stat st;
+        ret = vlc_stat(path, &st);
+        assert(ret == 0 && st.st_size > 0);
+        unlink(path);
+        free(path);
+    }
+}
+
+static void on_ended(input_item_t *item, int status,
+                     const struct vlc_trickplay_report *report, void *data)
+{
+    struct context *context = data;
+    (void) item;
+
+    assert(status == VLC_SUCCESS);
+    assert(report->thumbnail_count == context->count);
+    assert(report->sprite_count == sprite_count(context));
+    assert(report->elapsed > 0);
+
+    fprintf(stderr, "trickplay: %.1f thumbnails/s\n",
+            report->thumbnail_count * (double) CLOCK_FREQ / report->elapsed);
+
+    check_index(context);
+    vlc_sem_post(&context->sem);
+}
+
+static void test_trickplay(vlc_preparser_t *preparser, struct context *context,
+                           const char *url, const unsigned *starts,
+                           size_t count)
+{
+    context->starts = starts;
+    context->count = count;
+    vlc_sem_init(&context->sem, 0);
+
+    const struct vlc_trickplay_arg arg = {
+        .interval = VLC_TICK_FROM_SEC(INTERVAL_S),
+        .tile_width = TILE_WIDTH,
+        .tile_height = 0,
+        .columns = COLUMNS,
+        .rows = ROWS,
+        .format = context->format,
+        .prefix = context->prefix,
+        .creat_mode = 0666,
+    };
+    static const struct vlc_trickplay_cbs cbs = {
+        .on_ended = on_ended,
+    };
+
+    input_item_t *item = input_item_New(url, "mock");
+    assert(item != NULL);
+
+    vlc_preparser_req_id req_id =
+        vlc_preparser_GenerateTrickplay(preparser, item, &arg, &cbs, context);
+    assert(req_id != VLC_PREPARSER_REQ_ID_INVALID);
+
+    vlc_sem_wait(&context->sem);
+
+    size_t cancelled = vlc_preparser_Cancel(preparser, req_id);
+    assert(cancelled == 0); /* Should not be cancelled and already processed */
+
+    input_item_Release(item);
+}
+
+int main(int argc, const char *argv[])
+{
+    test_init();
+    argc--;
+    argv++;
+
+    libvlc_instance_t *vlc = libvlc_new(argc, argv);
+    assert(vlc);
+
+    /* This test require a scaler, for the tiles */
+    if (!module_exists("swscale") && !module_exists("scale"))
+    {
+        fprintf(stderr, "skip: no \"swscale\" nor \"scale\" module\n");
+        goto skip;
+    }
+
+    struct context context;
+
+    if (vlc_preparser_GetBestThumbnailerFormat(&context.format,
+                                               &context.ext) != 0)
+    {
+        fprintf(stderr, "skip: no \"image encoder\" modules\n");
+        goto skip;
+    }
+
+    /* Use a temporary file name as prefix */
+    strcpy(context.prefix, "/tmp/libvlc_XXXXXX");
+    int fd = vlc_mkstemp(context.prefix);
+    if (fd == -1)
+    {
+        fprintf(stderr, "skip: vlc_mkstemp failed\n");
+        goto skip;
+    }
+    close(fd);
+    unlink(context.prefix);
+
+    const struct vlc_preparser_cfg cfg = {
+        .types = VLC_PREPARSER_TYPE_TRICKPLAY,
+        .max_thumbnailer_threads = 1,
+        .timeout = 0,
+    };
+    vlc_preparser_t *preparser = vlc_preparser_New(VLC_OBJECT(vlc->p_libvlc_int),
+                                                   &cfg);
+    assert(preparser != NULL);
+
+    /* Every frame is a keyframe: one thumbnail per interval */
+    static const unsigned starts[] = { 0, 2, 4, 6, 8 };
+    test_trickplay(preparser, &context, MOCK_URL, starts, ARRAY_SIZE(starts));
+
+    /* A keyframe every 4 seconds: the seeks to 2 and 6 seconds land on the
+     * same keyframes as the previous ones, and are merged with them */
+    static const unsigned sparse_starts[] = { 0, 4, 8 };
+    test_trickplay(preparser, &context,
+                   MOCK_URL ";video_keyframe_interval=4000000",
+                   sparse_starts, ARRAY_SIZE(sparse_starts));
+
+    vlc_preparser_Delete(preparser);
+    libvlc_release(vlc);
+    return 0;
+
+skip:
+    libvlc_release(vlc);
+    return 77;
+}
@@ -0,0 +1,1475 @@
+/**
+ * @file vlc-demux-bench.c
+ * @brief Demuxer throughput benchmark
+ */
+/*****************************************************************************
+ * Copyright © 2026 VideoLAN and VLC authors
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs demuxers over a corpus with a null ES output and prints one JSON
+ * object per input on the standard output, e.g.:
+ *
+ * {"file":"bench.ts","demux":"ts","bytes":...,"seconds":...,"mbps":...,
+ *  "packets":...,"packets_per_second":...,"allocs_per_packet":...,
+ *  "frame_allocs_per_packet":...,"seeks":...,"seek_latency_us":...}
+ *
+ * Without file arguments, a synthetic corpus is generated in a temporary
+ * directory: PCM audio in WAV, MP4, fragmented MP4, Matroska, Ogg and FLAC,
+ * MPEG audio in MPEG-TS, and H.264 video as an elementary stream, in MPEG-TS
+ * and in AVI.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include "src/input/demux-run.h"
+
+#define BENCH_RATE     48000
+#define BENCH_CHANNELS 2
+#define BENCH_SECONDS  40
+/* one PCM frame of s16 stereo */
+#define BENCH_FRAME    (2 * BENCH_CHANNELS)
+
+/* H.264 320x240, 25 fps, about 4 Mb/s */
+#define BENCH_VIDEO_WIDTH  320
+#define BENCH_VIDEO_HEIGHT 240
+#define BENCH_VIDEO_FPS    25
+#define BENCH_VIDEO_GOP    25
+#define BENCH_VIDEO_SIZE   20000
+#define BENCH_VIDEO_FRAMES (BENCH_VIDEO_FPS * BENCH_SECONDS)
+
+/*****************************************************************************
+ * Allocation counter
+ *****************************************************************************/
+static atomic_uint_fast64_t allocs;
+
+#ifdef __GLIBC__
+extern void *__libc_malloc(size_t);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+extern void *__libc_memalign(size_t, size_t);
+
+void *malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+/* vlc_frame_Alloc() and the picture buffers use the aligned allocators */
+void *memalign(size_t align, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_memalign(align, size);
+}
+
+void *aligned_alloc(size_t align, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void **ptr, size_t align, size_t size)
+{
+    if (align < sizeof (void *) || (align & (align - 1)) != 0)
+        return EINVAL;
+
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    void *p = __libc_memalign(align, size);
+    if (p == NULL)
+        return ENOMEM;
+    *ptr = p;
+    return 0;
+}
+
+static uint64_t get_allocs(void)
+{
+    return atomic_load_explicit(&allocs, memory_order_relaxed);
+}
+#else
+static uint64_t (*const get_allocs)(void) = NULL;
+#endif
+
+/*****************************************************************************
+ * Byte buffer helpers
+ *****************************************************************************/
+struct buf
+{
+    uint8_t *p;
+    size_t len;
+    size_t cap;
+    bool error;
+};
+
+static void buf_reserve(struct buf *b, size_t n)
+{
+    if (b->error || b->len + n <= b->cap)
+        return;
+
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + n)
+        cap *= 2;
+
+    uint8_t *p = realloc(b->p, cap);
+    if (p == NULL)
+    {
+        b->error = true;
+        return;
+    }
+    b->p = p;
+    b->cap = cap;
+}
+
+static void put_bytes(struct buf *b, const void *data, size_t n)
+{
+    buf_reserve(b, n);
+    if (b->error)
+        return;
+    if (data != NULL)
+        memcpy(&b->p[b->len], data, n);
+    else
+        memset(&b->p[b->len], 0, n);
+    b->len += n;
+}
+
+static void put8(struct buf *b, uint8_t v)
+{
+    put_bytes(b, &v, 1);
+}
+
+static void put16be(struct buf *b, uint16_t v)
+{
+    put8(b, v >> 8);
+    put8(b, v);
+}
+
+static void put24be(struct buf *b, uint32_t v)
+{
+    put8(b, v >> 16);
+    put16be(b, v);
+}
+
+static void put32be(struct buf *b, uint32_t v)
+{
+    put16be(b, v >> 16);
+    put16be(b, v);
+}
+
+static void put64be(struct buf *b, uint64_t v)
+{
+    put32be(b, v >> 32);
+    put32be(b, v);
+}
+
+static void put16le(struct buf *b, uint16_t v)
+{
+    put8(b, v);
+    put8(b, v >> 8);
+}
+
+static void put32le(struct buf *b, uint32_t v)
+{
+    put16le(b, v);
+    put16le(b, v >> 16);
+}
+
+static void put64le(struct buf *b, uint64_t v)
+{
+    put32le(b, v);
+    put32le(b, v >> 32);
+}
+
+static void set32be(struct buf *b, size_t offset, uint32_t v)
+{
+    if (b->error)
+        return;
+    b->p[offset] = v >> 24;
+    b->p[offset + 1] = v >> 16;
+    b->p[offset + 2] = v >> 8;
+    b->p[offset + 3] = v;
+}
+
+/* Deterministic, non-silent PCM payload */
+static void put_pcm(struct buf *b, uint64_t first_frame, unsigned frames)
+{
+    buf_reserve(b, (size_t)frames * BENCH_FRAME);
+    for (unsigned i = 0; i < frames && !b->error; i++)
+    {
+        uint32_t x = (uint32_t)(first_frame + i) * 2654435761u;
+        for (unsigned c = 0; c < BENCH_CHANNELS; c++)
+            put16le(b, x >> (16 - c * 8));
+    }
+}
+
+static uint32_t crc32_be(uint32_t crc, const uint8_t *p, size_t n)
+{
+    while (n--)
+    {
+        crc ^= (uint32_t)*(p++) << 24;
+        for (int i = 0; i < 8; i++)
+            crc = (crc << 1) ^ ((crc & 0x80000000) ? 0x04C11DB7 : 0);
+    }
+    return crc;
+}
+
+/*****************************************************************************
+ * WAV
+ *****************************************************************************/
+static void gen_wav(struct buf *b)
+{
+    const uint32_t frames = BENCH_RATE * BENCH_SECONDS;
+    const uint32_t data = frames * BENCH_FRAME;
+
+    put_bytes(b, "RIFF", 4);
+    put32le(b, 36 + data);
+    put_bytes(b, "WAVEfmt ", 8);
+    put32le(b, 16);
+    put16le(b, 1); /* WAVE_FORMAT_PCM */
+    put16le(b, BENCH_CHANNELS);
+    put32le(b, BENCH_RATE);
+    put32le(b, BENCH_RATE * BENCH_FRAME);
+    put16le(b, BENCH_FRAME);
+    put16le(b, 16);
+    put_bytes(b, "data", 4);
+    put32le(b, data);
+    put_pcm(b, 0, frames);
+}
+
+/*****************************************************************************
+ * MPEG-TS: one MPEG audio elementary stream with PCR
+ *****************************************************************************/
+#define TS_PMT_PID 0x100
+#define TS_ES_PID  0x101
+#define TS_VIDEO_PID 0x102
+
+static void ts_section(struct buf *b, uint16_t pid, const uint8_t *section,
+                       size_t size, uint8_t *cc)
+{
+    put8(b, 0x47);
+    put16be(b, 0x4000 | pid);
+    put8(b, 0x10 | ((*cc)++ & 0xf));
+    put8(b, 0); /* pointer field */
+    put_bytes(b, section, size);
+
+    uint32_t crc = crc32_be(0xffffffff, section, size);
+    put32be(b, crc);
+
+    buf_reserve(b, 188);
+    if (!b->error)
+    {
+        size_t used = 5 + size + 4;
+        memset(&b->p[b->len], 0xff, 188 - used);
+        b->len += 188 - used;
+    }
+}
+
+/* PAT and PMT of a single program with a single ES, also carrying the PCR */
+static void ts_psi(struct buf *b, uint16_t pid, uint8_t stream_type,
+                   uint8_t *cc_pat, uint8_t *cc_pmt)
+{
+    static const uint8_t pat[] = {
+        0x00, 0xb0, 13, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0x00, 0x01, 0xe0 | (TS_PMT_PID >> 8), TS_PMT_PID & 0xff,
+    };
+    const uint8_t pmt[] = {
+        0x02, 0xb0, 18, 0x00, 0x01, 0xc1, 0x00, 0x00,
+        0xe0 | (pid >> 8), pid & 0xff, 0xf0, 0x00,
+        stream_type, 0xe0 | (pid >> 8), pid & 0xff, 0xf0, 0x00,
+    };
+
+    ts_section(b, 0, pat, sizeof (pat), cc_pat);
+    ts_section(b, TS_PMT_PID, pmt, sizeof (pmt), cc_pmt);
+}
+
+static void ts_pes(struct buf *b, uint16_t pid, const uint8_t *pes,
+                   size_t size, uint64_t pcr_base, uint8_t *cc)
+{
+    bool first = true;
+
+    while (size > 0)
+    {
+        size_t header = 4;
+        size_t adaptation = first ? 8 : 0;
+        size_t payload = 188 - header - adaptation;
+
+        if (size < payload)
+        {
+            /* stuffing through the adaptation field */
+            adaptation = 188 - header - size;
+            payload = size;
+        }
+
+        put8(b, 0x47);
+        put16be(b, (first ? 0x4000 : 0) | pid);
+        put8(b, (adaptation ? 0x30 : 0x10) | ((*cc)++ & 0xf));
+
+        if (adaptation > 0)
+        {
+            put8(b, adaptation - 1);
+            if (adaptation > 1)
+            {
+                if (first)
+                {
+                    put8(b, 0x10); /* PCR flag */
+                    put32be(b, pcr_base >> 1);
+                    put8(b, ((pcr_base & 1) << 7) | 0x7e);
+                    put8(b, 0);
+                    adaptation -= 7;
+                }
+                else
+                {
+                    put8(b, 0);
+                    adaptation -= 1;
+                }
+                buf_reserve(b, adaptation - 1);
+                if (!b->error)
+                {
+                    memset(&b->p[b->len], 0xff, adaptation - 1);
+                    b->len += adaptation - 1;
+                }
+            }
+        }
+
+        put_bytes(b, pes, payload);
+        pes += payload;
+        size -= payload;
+        first = false;
+    }
+}
+
+static void gen_ts(struct buf *b)
+{
+    /* MPEG-1 Layer II 48kHz 192kbps stereo: 576 bytes per 1152 samples */
+    static const unsigned frame_size = 576;
+    static const unsigned frame_samples = 1152;
+    const unsigned frames = BENCH_RATE * BENCH_SECONDS / frame_samples;
+    uint8_t cc_pat = 0, cc_pmt = 0, cc_es = 0;
+    uint8_t pes[14 + 576];
+
+    for (unsigned i = 0; i < frames && !b->error; i++)
+    {
+        uint64_t pts = 90000 + (uint64_t)i * frame_samples * 90000 / BENCH_RATE;
+
+        if (i % 40 == 0)
+            ts_psi(b, TS_ES_PID, 0x03, &cc_pat, &cc_pmt);
+
+        /* PES header */
+        pes[0] = 0x00; pes[1] = 0x00; pes[2] = 0x01; pes[3] = 0xc0;
+        pes[4] = (8 + frame_size) >> 8;
+        pes[5] = (8 + frame_size) & 0xff;
+        pes[6] = 0x80;
+        pes[7] = 0x80; /* PTS only */
+        pes[8] = 5;
+        pes[9] = 0x21 | ((pts >> 29) & 0x0e);
+        pes[10] = pts >> 22;
+        pes[11] = 0x01 | ((pts >> 14) & 0xfe);
+        pes[12] = pts >> 7;
+        pes[13] = 0x01 | ((pts << 1) & 0xfe);
+
+        /* MPEG audio frame header, CRC-less, followed by dummy data */
+        uint8_t *frame = &pes[14];
+        frame[0] = 0xff; frame[1] = 0xfd; frame[2] = 0xa4; frame[3] = 0x04;
+        for (unsigned j = 4; j < frame_size; j++)
+            frame[j] = (i + j) * 31;
+
+        ts_pes(b, TS_ES_PID, pes, sizeof (pes), pts - 9000, &cc_es);
+    }
+}
+
+/*****************************************************************************
+ * ISO BMFF: PCM audio track, progressive or fragmented
+ *****************************************************************************/
+static size_t box_start(struct buf *b, const char *type)
+{
+    size_t offset = b->len;
+    put32be(b, 0);
+    put_bytes(b, type, 4);
+    return offset;
+}
+
+static size_t fullbox_start(struct buf *b, const char *type, uint8_t version,
+                            uint32_t flags)
+{
+    size_t offset = box_start(b, type);
+    put32be(b, ((uint32_t)version << 24) | flags);
+    return offset;
+}
+
+static void box_end(struct buf *b, size_t offset)
+{
+    set32be(b, offset, b->len - offset);
+}
+
+static void mp4_matrix(struct buf *b)
+{
+    static const uint32_t matrix[9] = {
+        0x10000, 0, 0, 0, 0x10000, 0, 0, 0, 0x40000000
+    };
+    for (unsigned i = 0; i < 9; i++)
+        put32be(b, matrix[i]);
+}
+
+static void mp4_moov(struct buf *b, uint32_t frames, bool fragmented,
+                     uint32_t chunk_frames, uint32_t chunks,
+                     uint32_t first_chunk_offset)
+{
+    size_t moov = box_start(b, "moov");
+
+    size_t box = fullbox_start(b, "mvhd", 0, 0);
+    put32be(b, 0); put32be(b, 0);
+    put32be(b, BENCH_RATE);
+    put32be(b, fragmented ? 0 : frames);
+    put32be(b, 0x10000); put16be(b, 0x100);
+    put_bytes(b, NULL, 10);
+    mp4_matrix(b);
+    put_bytes(b, NULL, 24);
+    put32be(b, 2);
+    box_end(b, box);
+
+    size_t trak = box_start(b, "trak");
+    box = fullbox_start(b, "tkhd", 0, 3);
+    put32be(b, 0); put32be(b, 0);
+    put32be(b, 1); put32be(b, 0);
+    put32be(b, fragmented ? 0 : frames);
+    put_bytes(b, NULL, 8);
+    put16be(b, 0); put16be(b, 0); put16be(b, 0x100); put16be(b, 0);
+    mp4_matrix(b);
+    put32be(b, 0); put32be(b, 0);
+    box_end(b, box);
+
+    size_t mdia = box_start(b, "mdia");
+    box = fullbox_start(b, "mdhd", 0, 0);
+    put32be(b, 0); put32be(b, 0);
+    put32be(b, BENCH_RATE);
+    put32be(b, fragmented ? 0 : frames);
+    put16be(b, 0x55c4); put16be(b, 0);
+    box_end(b, box);
+
+    box = fullbox_start(b, "hdlr", 0, 0);
+    put32be(b, 0);
+    put_bytes(b, "soun", 4);
+    put_bytes(b, NULL, 12);
+    put_bytes(b, "bench", 6);
+    box_end(b, box);
+
+    size_t minf = box_start(b, "minf");
+    box = fullbox_start(b, "smhd", 0, 0);
+    put32be(b, 0);
+    box_end(b, box);
+
+    size_t dinf = box_start(b, "dinf");
+    size_t dref = fullbox_start(b, "dref", 0, 0);
+    put32be(b, 1);
+    box = fullbox_start(b, "url ", 0, 1);
+    box_end(b, box);
+    box_end(b, dref);
+    box_end(b, dinf);
+
+    size_t stbl = box_start(b, "stbl");
+    size_t stsd = fullbox_start(b, "stsd", 0, 0);
+    put32be(b, 1);
+    box = box_start(b, "sowt");
+    put_bytes(b, NULL, 6);
+    put16be(b, 1);
+    put_bytes(b, NULL, 8);
+    put16be(b, BENCH_CHANNELS);
+    put16be(b, 16);
+    put32be(b, 0);
+    put32be(b, BENCH_RATE << 16);
+    box_end(b, box);
+    box_end(b, stsd);
+
+    box = fullbox_start(b, "stts", 0, 0);
+    if (fragmented)
+        put32be(b, 0);
+    else
+    {
+        put32be(b, 1);
+        put32be(b, frames);
+        put32be(b, 1);
+    }
+    box_end(b, box);
+
+    box = fullbox_start(b, "stsc", 0, 0);
+    if (fragmented)
+        put32be(b, 0);
+    else
+    {
+        put32be(b, 1);
+        put32be(b, 1);
+        put32be(b, chunk_frames);
+        put32be(b, 1);
+    }
+    box_end(b, box);
+
+    box = fullbox_start(b, "stsz", 0, 0);
+    put32be(b, fragmented ? 0 : BENCH_FRAME);
+    put32be(b, fragmented ? 0 : frames);
+    box_end(b, box);
+
+    box = fullbox_start(b, "stco", 0, 0);
+    put32be(b, fragmented ? 0 : chunks);
+    for (uint32_t i = 0; i < (fragmented ? 0 : chunks); i++)
+        put32be(b, first_chunk_offset + i * chunk_frames * BENCH_FRAME);
+    box_end(b, box);
+
+    box_end(b, stbl);
+    box_end(b, minf);
+    box_end(b, mdia);
+    box_end(b, trak);
+
+    if (fragmented)
+    {
+        size_t mvex = box_start(b, "mvex");
+        box = fullbox_start(b, "trex", 0, 0);
+        put32be(b, 1);
+        put32be(b, 1);
+        put32be(b, 1);
+        put32be(b, BENCH_FRAME);
+        put32be(b, 0);
+        box_end(b, box);
+        box_end(b, mvex);
+    }
+
+    box_end(b, moov);
+}
+
+static void mp4_ftyp(struct buf *b, bool fragmented)
+{
+    size_t box = box_start(b, "ftyp");
+    put_bytes(b, fragmented ? "iso6" : "isom", 4);
+    put32be(b, 0);
+    put_bytes(b, "isomiso6mp41", 12);
+    box_end(b, box);
+}
+
+static void gen_mp4(struct buf *b)
+{
+    const uint32_t chunk_frames = 1024;
+    const uint32_t chunks = BENCH_RATE * BENCH_SECONDS / chunk_frames;
+    const uint32_t frames = chunks * chunk_frames;
+
+    /* the moov size does not depend on the chunk offsets */
+    struct buf moov = { 0 };
+    mp4_moov(&moov, frames, false, chunk_frames, chunks, 0);
+    if (moov.error)
+    {
+        b->error = true;
+        return;
+    }
+
+    mp4_ftyp(b, false);
+    uint32_t offset = b->len + moov.len + 8;
+    free(moov.p);
+
+    mp4_moov(b, frames, false, chunk_frames, chunks, offset);
+    size_t mdat = box_start(b, "mdat");
+    put_pcm(b, 0, frames);
+    box_end(b, mdat);
+}
+
+static void gen_fmp4(struct buf *b)
+{
+    const uint32_t fragment_frames = BENCH_RATE / 2;
+    const uint32_t fragments = BENCH_SECONDS * 2;
+
+    mp4_ftyp(b, true);
+    mp4_moov(b, 0, true, 0, 0, 0);
+
+    for (uint32_t i = 0; i < fragments && !b->error; i++)
+    {
+        size_t moof = box_start(b, "moof");
+        size_t box = fullbox_start(b, "mfhd", 0, 0);
+        put32be(b, i + 1);
+        box_end(b, box);
+
+        size_t traf = box_start(b, "traf");
+        /* default-base-is-moof */
+        box = fullbox_start(b, "tfhd", 0, 0x020000);
+        put32be(b, 1);
+        box_end(b, box);
+        box = fullbox_start(b, "tfdt", 1, 0);
+        put64be(b, (uint64_t)i * fragment_frames);
+        box_end(b, box);
+        /* data-offset-present */
+        box = fullbox_start(b, "trun", 0, 0x000001);
+        put32be(b, fragment_frames);
+        size_t data_offset = b->len;
+        put32be(b, 0);
+        box_end(b, box);
+        box_end(b, traf);
+        box_end(b, moof);
+
+        set32be(b, data_offset, b->len - moof + 8);
+
+        size_t mdat = box_start(b, "mdat");
+        put_pcm(b, (uint64_t)i * fragment_frames, fragment_frames);
+        box_end(b, mdat);
+    }
+}
+
+/*****************************************************************************
+ * Matroska: PCM audio in SimpleBlocks
+ *****************************************************************************/
+static void ebml_id(struct buf *b, uint32_t id)
+{
+    if (id > 0xffffff)
+        put32be(b, id);
+    else if (id > 0xffff)
+        put24be(b, id);
+    else if (id > 0xff)
+        put16be(b, id);
+    else
+        put8(b, id);
+}
+
+/* 8-byte sizes, patched once the element is complete */
+static size_t ebml_start(struct buf *b, uint32_t id)
+{
+    ebml_id(b, id);
+    size_t offset = b->len;
+    put64be(b, 0);
+    return offset;
+}
+
+static void ebml_end(struct buf *b, size_t offset)
+{
+    if (b->error)
+        return;
+
+    uint64_t size = b->len - offset - 8;
+    b->p[offset] = 0x01;
+    for (int i = 7; i > 0; i--, size >>= 8)
+        b->p[offset + i] = size & 0xff;
+}
+
+static void ebml_uint(struct buf *b, uint32_t id, uint64_t value)
+{
+    ebml_id(b, id);
+    put8(b, 0x88);
+    put64be(b, value);
+}
+
+static void ebml_float(struct buf *b, uint32_t id, double value)
+{
+    union { double d; uint64_t u; } v = { .d = value };
+
+    ebml_id(b, id);
+    put8(b, 0x88);
+    put64be(b, v.u);
+}
+
+static void ebml_string(struct buf *b, uint32_t id, const char *str)
+{
+    size_t len = strlen(str);
+
+    ebml_id(b, id);
+    put8(b, 0x80 | len);
+    put_bytes(b, str, len);
+}
+
+static void gen_mkv(struct buf *b)
+{
+    const unsigned block_frames = 1024;
+    const unsigned blocks_per_cluster = 47;
+    const unsigned blocks = BENCH_RATE * BENCH_SECONDS / block_frames;
+
+    size_t elem = ebml_start(b, 0x1A45DFA3); /* EBML */
+    ebml_uint(b, 0x4286, 1);
+    ebml_uint(b, 0x42F7, 1);
+    ebml_uint(b, 0x42F2, 4);
+    ebml_uint(b, 0x42F3, 8);
+    ebml_string(b, 0x4282, "matroska");
+    ebml_uint(b, 0x4287, 4);
+    ebml_uint(b, 0x4285, 2);
+    ebml_end(b, elem);
+
+    size_t segment = ebml_start(b, 0x18538067);
+
+    elem = ebml_start(b, 0x1549A966); /* Info */
+    ebml_uint(b, 0x2AD7B1, 1000000); /* TimestampScale */
+    ebml_float(b, 0x4489, BENCH_SECONDS * 1000.); /* Duration */
+    ebml_string(b, 0x4D80, "vlc-demux-bench");
+    ebml_string(b, 0x5741, "vlc-demux-bench");
+    ebml_end(b, elem);
+
+    size_t tracks = ebml_start(b, 0x1654AE6B);
+    size_t entry = ebml_start(b, 0xAE);
+    ebml_uint(b, 0xD7, 1); /* TrackNumber */
+    ebml_uint(b, 0x73C5, 1); /* TrackUID */
+    ebml_uint(b, 0x83, 2); /* TrackType: audio */
+    ebml_string(b, 0x86, "A_PCM/INT/LIT");
+    elem = ebml_start(b, 0xE1); /* Audio */
+    ebml_float(b, 0xB5, BENCH_RATE);
+    ebml_uint(b, 0x9F, BENCH_CHANNELS);
+    ebml_uint(b, 0x6264, 16);
+    ebml_end(b, elem);
+    ebml_end(b, entry);
+    ebml_end(b, tracks);
+
+    for (unsigned i = 0; i < blocks && !b->error; i += blocks_per_cluster)
+    {
+        uint64_t cluster_ts = (uint64_t)i * block_frames * 1000 / BENCH_RATE;
+        size_t cluster = ebml_start(b, 0x1F43B675);
+        ebml_uint(b, 0xE7, cluster_ts);
+
+        for (unsigned j = i; j < i + blocks_per_cluster && j < blocks; j++)
+        {
+            uint64_t ts = (uint64_t)j * block_frames * 1000 / BENCH_RATE;
+
+            elem = ebml_start(b, 0xA3); /* SimpleBlock */
+            put8(b, 0x81); /* track 1 */
+            put16be(b, ts - cluster_ts);
+            put8(b, 0x80); /* keyframe */
+            put_pcm(b, (uint64_t)j * block_frames, block_frames);
+            ebml_end(b, elem);
+        }
+        ebml_end(b, cluster);
+    }
+
+    ebml_end(b, segment);
+}
+
+/*****************************************************************************
+ * Ogg: Opus framing with dummy CELT packets
+ *****************************************************************************/
+static void ogg_page(struct buf *b, uint8_t flags, uint64_t granule,
+                     uint32_t seqno, const uint8_t *const *packets,
+                     const size_t *sizes, unsigned count)
+{
+    size_t start = b->len;
+    unsigned segments = 0;
+
+    for (unsigned i = 0; i < count; i++)
+        segments += sizes[i] / 255 + 1;
+    if (segments > 255)
+    {
+        b->error = true;
+        return;
+    }
+
+    put_bytes(b, "OggS", 4);
+    put8(b, 0);
+    put8(b, flags);
+    put64le(b, granule);
+    put32le(b, 0x5EB5); /* serial */
+    put32le(b, seqno);
+    size_t crc_offset = b->len;
+    put32le(b, 0);
+    put8(b, segments);
+    for (unsigned i = 0; i < count; i++)
+    {
+        for (size_t size = sizes[i]; ; size -= 255)
+        {
+            put8(b, size >= 255 ? 255 : size);
+            if (size < 255)
+                break;
+        }
+    }
+    for (unsigned i = 0; i < count; i++)
+        put_bytes(b, packets[i], sizes[i]);
+
+    if (b->error)
+        return;
+
+    uint32_t crc = crc32_be(0, &b->p[start], b->len - start);
+    b->p[crc_offset] = crc;
+    b->p[crc_offset + 1] = crc >> 8;
+    b->p[crc_offset + 2] = crc >> 16;
+    b->p[crc_offset + 3] = crc >> 24;
+}
+
+static void gen_ogg(struct buf *b)
+{
+    /* 20ms CELT fullband stereo packets, 128kbps */
+    enum { PACKET_SIZE = 320, PACKET_SAMPLES = 960, PAGE_PACKETS = 50 };
+    static const uint8_t head[19] = {
+        'O', 'p', 'u', 's', 'H', 'e', 'a', 'd', 1, BENCH_CHANNELS,
+        0x38, 0x01, 0x80, 0xbb, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+    static const uint8_t tags[] = {
+        'O', 'p', 'u', 's', 'T', 'a', 'g', 's',
+        5, 0, 0, 0, 'b', 'e', 'n', 'c', 'h', 0, 0, 0, 0,
+    };
+    const unsigned pages = BENCH_RATE * BENCH_SECONDS
+                         / (PACKET_SAMPLES * PAGE_PACKETS);
+    uint8_t packet[PAGE_PACKETS][PACKET_SIZE];
+    const uint8_t *packets[PAGE_PACKETS];
+    size_t sizes[PAGE_PACKETS];
+    uint32_t seqno = 0;
+
+    packets[0] = head;
+    sizes[0] = sizeof (head);
+    ogg_page(b, 0x02, 0, seqno++, packets, sizes, 1);
+    packets[0] = tags;
+    sizes[0] = sizeof (tags);
+    ogg_page(b, 0x00, 0, seqno++, packets, sizes, 1);
+
+    for (unsigned i = 0; i < PAGE_PACKETS; i++)
+    {
+        packets[i] = packet[i];
+        sizes[i] = PACKET_SIZE;
+    }
+
+    for (unsigned i = 0; i < pages && !b->error; i++)
+    {
+        for (unsigned j = 0; j < PAGE_PACKETS; j++)
+        {
+            packet[j][0] = 0xfc; /* config 31, stereo, 1 frame */
+            for (unsigned k = 1; k < PACKET_SIZE; k++)
+                packet[j][k] = (i * PAGE_PACKETS + j + k) * 13;
+        }
+
+        uint64_t granule = (uint64_t)(i + 1) * PAGE_PACKETS * PACKET_SAMPLES;
+        ogg_page(b, i + 1 == pages ? 0x04 : 0x00, granule, seqno++,
+                 packets, sizes, PAGE_PACKETS);
+    }
+}
+
+/*****************************************************************************
+ * FLAC: verbatim subframes
+ *****************************************************************************/
+static uint8_t flac_crc8(const uint8_t *p, size_t n)
+{
+    uint8_t crc = 0;
+
+    while (n--)
+    {
+        crc ^= *(p++);
+        for (int i = 0; i < 8; i++)
+            crc = (crc << 1) ^ ((crc & 0x80) ? 0x07 : 0);
+    }
+    return crc;
+}
+
+static uint16_t flac_crc16(const uint8_t *p, size_t n)
+{
+    uint16_t crc = 0;
+
+    while (n--)
+    {
+        crc ^= (uint16_t)*(p++) << 8;
+        for (int i = 0; i < 8; i++)
+            crc = (crc << 1) ^ ((crc & 0x8000) ? 0x8005 : 0);
+    }
+    return crc;
+}
+
+static void flac_utf8(struct buf *b, uint32_t v)
+{
+    if (v < 0x80)
+        put8(b, v);
+    else if (v < 0x800)
+    {
+        put8(b, 0xc0 | (v >> 6));
+        put8(b, 0x80 | (v & 0x3f));
+    }
+    else
+    {
+        put8(b, 0xe0 | (v >> 12));
+        put8(b, 0x80 | ((v >> 6) & 0x3f));
+        put8(b, 0x80 | (v & 0x3f));
+    }
+}
+
+static void gen_flac(struct buf *b)
+{
+    const unsigned block_frames = 4096;
+    const unsigned blocks = BENCH_RATE * BENCH_SECONDS / block_frames;
+    const uint64_t total = (uint64_t)blocks * block_frames;
+
+    put_bytes(b, "fLaC", 4);
+    put8(b, 0x80); /* last metadata block, STREAMINFO */
+    put24be(b, 34);
+    put16be(b, block_frames);
+    put16be(b, block_frames);
+    put24be(b, 0);
+    put24be(b, 0);
+    /* 20 bits rate, 3 bits channels - 1, 5 bits bps - 1, 36 bits samples */
+    put64be(b, ((uint64_t)BENCH_RATE << 44)
+             | ((uint64_t)(BENCH_CHANNELS - 1) << 41)
+             | ((uint64_t)15 << 36) | total);
+    put_bytes(b, NULL, 16);
+
+    for (unsigned i = 0; i < blocks && !b->error; i++)
+    {
+        size_t start = b->len;
+
+        put16be(b, 0xfff8); /* fixed blocksize */
+        put8(b, 0xca); /* 4096 samples, 48kHz */
+        put8(b, ((BENCH_CHANNELS - 1) << 4) | 0x08); /* independent, 16 bits */
+        flac_utf8(b, i);
+        if (b->error)
+            return;
+        put8(b, flac_crc8(&b->p[start], b->len - start));
+
+        for (unsigned c = 0; c < BENCH_CHANNELS; c++)
+        {
+            put8(b, 0x02); /* verbatim */
+            for (unsigned j = 0; j < block_frames; j++)
+                put16be(b, ((uint32_t)(i * block_frames + j) * 2654435761u)
+                           >> (16 - c * 8));
+        }
+        if (b->error)
+            return;
+        put16be(b, flac_crc16(&b->p[start], b->len - start));
+    }
+}
+
+/*****************************************************************************
+ * H.264: Annex B access units, as an elementary stream, in MPEG-TS and AVI
+ *****************************************************************************/
+struct bitw
+{
+    uint8_t *p;
+    size_t len;
+    unsigned bits; /* pending bits in p[len] */
+};
+
+static void bitw_put(struct bitw *w, uint32_t v, unsigned n)
+{
+    while (n-- > 0)
+    {
+        if (w->bits == 0)
+            w->p[w->len] = 0;
+        w->p[w->len] |= ((v >> n) & 1) << (7 - w->bits);
+        if (++w->bits == 8)
+        {
+            w->bits = 0;
+            w->len++;
+        }
+    }
+}
+
+static void bitw_ue(struct bitw *w, uint32_t v)
+{
+    unsigned n = 0;
+    for (uint32_t t = v + 1; t > 1; t >>= 1)
+        n++;
+    bitw_put(w, 0, n);
+    bitw_put(w, v + 1, n + 1);
+}
+
+/* rbsp_trailing_bits(), returns the RBSP size */
+static size_t bitw_trailing(struct bitw *w)
+{
+    bitw_put(w, 1, 1);
+    if (w->bits > 0)
+        bitw_put(w, 0, 8 - w->bits);
+    return w->len;
+}
+
+/* Start code and NAL unit, with emulation prevention */
+static void h264_nal(struct buf *b, uint8_t header, const uint8_t *rbsp,
+                     size_t size)
+{
+    unsigned zeros = 0;
+
+    put32be(b, 1);
+    put8(b, header);
+    buf_reserve(b, size + size / 2);
+    for (size_t i = 0; i < size && !b->error; i++)
+    {
+        if (zeros >= 2 && rbsp[i] <= 3)
+        {
+            b->p[b->len++] = 3;
+            zeros = 0;
+        }
+        b->p[b->len++] = rbsp[i];
+        zeros = rbsp[i] == 0 ? zeros + 1 : 0;
+    }
+}
+
+/* Baseline profile, POC type 2, without VUI */
+static void h264_parameter_sets(struct buf *b)
+{
+    uint8_t rbsp[32];
+    struct bitw w = { .p = rbsp };
+
+    bitw_put(&w, 66, 8);   /* profile_idc */
+    bitw_put(&w, 0xc0, 8); /* constraint_set0/1 */
+    bitw_put(&w, 30, 8);   /* level_idc */
+    bitw_ue(&w, 0);        /* seq_parameter_set_id */
+    bitw_ue(&w, 1);        /* log2_max_frame_num_minus4 */
+    bitw_ue(&w, 2);        /* pic_order_cnt_type */
+    bitw_ue(&w, 1);        /* max_num_ref_frames */
+    bitw_put(&w, 0, 1);    /* gaps_in_frame_num_value_allowed_flag */
+    bitw_ue(&w, BENCH_VIDEO_WIDTH / 16 - 1);
+    bitw_ue(&w, BENCH_VIDEO_HEIGHT / 16 - 1);
+    bitw_put(&w, 1, 1);    /* frame_mbs_only_flag */
+    bitw_put(&w, 1, 1);    /* direct_8x8_inference_flag */
+    bitw_put(&w, 0, 1);    /* frame_cropping_flag */
+    bitw_put(&w, 0, 1);    /* vui_parameters_present_flag */
+    h264_nal(b, 0x67, rbsp, bitw_trailing(&w));
+
+    w = (struct bitw) { .p = rbsp };
+    bitw_ue(&w, 0);        /* pic_parameter_set_id */
+    bitw_ue(&w, 0);        /* seq_parameter_set_id */
+    bitw_put(&w, 0, 1);    /* entropy_coding_mode_flag */
+    bitw_put(&w, 0, 1);    /* bottom_field_pic_order_in_frame_present_flag */
+    bitw_ue(&w, 0);        /* num_slice_groups_minus1 */
+    bitw_ue(&w, 0);        /* num_ref_idx_l0_default_active_minus1 */
+    bitw_ue(&w, 0);        /* num_ref_idx_l1_default_active_minus1 */
+    bitw_put(&w, 0, 3);    /* weighted_pred_flag, weighted_bipred_idc */
+    bitw_ue(&w, 0);        /* pic_init_qp_minus26 (se) */
+    bitw_ue(&w, 0);        /* pic_init_qs_minus26 (se) */
+    bitw_ue(&w, 0);        /* chroma_qp_index_offset (se) */
+    bitw_put(&w, 1, 1);    /* deblocking_filter_control_present_flag */
+    bitw_put(&w, 0, 2);    /* constrained_intra_pred, redundant_pic_cnt */
+    h264_nal(b, 0x68, rbsp, bitw_trailing(&w));
+}
+
+/* One access unit: AUD, parameter sets and IDR slice every GOP, or P slice,
+ * with a deterministic slice payload */
+static void h264_access_unit(struct buf *b, unsigned i)
+{
+    const bool idr = i % BENCH_VIDEO_GOP == 0;
+    uint8_t *rbsp = malloc(BENCH_VIDEO_SIZE + 16);
+    if (rbsp == NULL)
+    {
+        b->error = true;
+        return;
+    }
+
+    static const uint8_t aud = 0xf0; /* any slice type, stop bit */
+    h264_nal(b, 0x09, &aud, 1);
+    if (idr)
+        h264_parameter_sets(b);
+
+    struct bitw w = { .p = rbsp };
+    bitw_ue(&w, 0);                     /* first_mb_in_slice */
+    bitw_ue(&w, idr ? 7 : 5);           /* slice_type: all I or all P */
+    bitw_ue(&w, 0);                     /* pic_parameter_set_id */
+    bitw_put(&w, i % BENCH_VIDEO_GOP, 5); /* frame_num */
+    if (idr)
+    {
+        bitw_ue(&w, (i / BENCH_VIDEO_GOP) & 1); /* idr_pic_id */
+        bitw_put(&w, 0, 2);   /* no_output_of_prior_pics, long_term_ref */
+    }
+    else
+    {
+        bitw_put(&w, 0, 2);   /* num_ref_idx_override, ref_pic_list_mod */
+        bitw_put(&w, 0, 1);   /* adaptive_ref_pic_marking_mode_flag */
+    }
+    bitw_ue(&w, 0);                     /* slice_qp_delta (se) */
+    bitw_ue(&w, 1);                     /* disable_deblocking_filter_idc */
+
+    uint32_t x = i * 2654435761u;
+    while (w.len < BENCH_VIDEO_SIZE)
+    {
+        x = x * 1664525u + 1013904223u;
+        bitw_put(&w, x >> 24, 8);
+    }
+    h264_nal(b, idr ? 0x65 : 0x41, rbsp, bitw_trailing(&w));
+    free(rbsp);
+}
+
+static void gen_h264(struct buf *b)
+{
+    for (unsigned i = 0; i < BENCH_VIDEO_FRAMES && !b->error; i++)
+        h264_access_unit(b, i);
+}
+
+static void gen_ts_h264(struct buf *b)
+{
+    uint8_t cc_pat = 0, cc_pmt = 0, cc_es = 0;
+    struct buf pes = { 0 };
+
+    for (unsigned i = 0; i < BENCH_VIDEO_FRAMES && !b->error; i++)
+    {
+        uint64_t pts = 90000 + (uint64_t)i * 90000 / BENCH_VIDEO_FPS;
+
+        if (i % BENCH_VIDEO_FPS == 0)
+            ts_psi(b, TS_VIDEO_PID, 0x1b, &cc_pat, &cc_pmt);
+
+        /* unbounded video PES, PTS only */
+        pes.len = 0;
+        put32be(&pes, 0x000001e0);
+        put16be(&pes, 0);
+        put8(&pes, 0x80);
+        put8(&pes, 0x80);
+        put8(&pes, 5);
+        put8(&pes, 0x21 | ((pts >> 29) & 0x0e));
+        put8(&pes, pts >> 22);
+        put8(&pes, 0x01 | ((pts >> 14) & 0xfe));
+        put8(&pes, pts >> 7);
+        put8(&pes, 0x01 | ((pts << 1) & 0xfe));
+        h264_access_unit(&pes, i);
+        if (pes.error)
+        {
+            b->error = true;
+            break;
+        }
+
+        ts_pes(b, TS_VIDEO_PID, pes.p, pes.len, pts - 9000, &cc_es);
+    }
+    free(pes.p);
+}
+
+static void set32le(struct buf *b, size_t offset, uint32_t v)
+{
+    if (b->error)
+        return;
+    b->p[offset] = v;
+    b->p[offset + 1] = v >> 8;
+    b->p[offset + 2] = v >> 16;
+    b->p[offset + 3] = v >> 24;
+}
+
+static size_t riff_start(struct buf *b, const char *fourcc, const char *type)
+{
+    put_bytes(b, fourcc, 4);
+    size_t offset = b->len;
+    put32le(b, 0);
+    if (type != NULL)
+        put_bytes(b, type, 4);
+    return offset;
+}
+
+static void riff_end(struct buf *b, size_t offset)
+{
+    set32le(b, offset, b->len - offset - 4);
+    if (b->len & 1)
+        put8(b, 0);
+}
+
+/* One H.264 video track, interleaved chunks and idx1 */
+static void gen_avi(struct buf *b)
+{
+    const uint32_t frames = BENCH_VIDEO_FRAMES;
+    size_t *sizes = malloc(frames * sizeof (*sizes));
+    if (sizes == NULL)
+    {
+        b->error = true;
+        return;
+    }
+
+    size_t riff = riff_start(b, "RIFF", "AVI ");
+    size_t hdrl = riff_start(b, "LIST", "hdrl");
+
+    size_t chunk = riff_start(b, "avih", NULL);
+    put32le(b, 1000000 / BENCH_VIDEO_FPS);
+    put32le(b, BENCH_VIDEO_SIZE * BENCH_VIDEO_FPS);
+    put32le(b, 0);
+    put32le(b, 0x10); /* AVIF_HASINDEX */
+    put32le(b, frames);
+    put32le(b, 0);
+    put32le(b, 1);
+    put32le(b, 2 * BENCH_VIDEO_SIZE);
+    put32le(b, BENCH_VIDEO_WIDTH);
+    put32le(b, BENCH_VIDEO_HEIGHT);
+    put_bytes(b, NULL, 16);
+    riff_end(b, chunk);
+
+    size_t strl = riff_start(b, "LIST", "strl");
+    chunk = riff_start(b, "strh", NULL);
+    put_bytes(b, "vidsH264", 8);
+    put32le(b, 0);
+    put32le(b, 0);
+    put32le(b, 0);
+    put32le(b, 1);
+    put32le(b, BENCH_VIDEO_FPS);
+    put32le(b, 0);
+    put32le(b, frames);
+    put32le(b, 2 * BENCH_VIDEO_SIZE);
+    put32le(b, UINT32_MAX);
+    put32le(b, 0);
+    put16le(b, 0); put16le(b, 0);
+    put16le(b, BENCH_VIDEO_WIDTH); put16le(b, BENCH_VIDEO_HEIGHT);
+    riff_end(b, chunk);
+
+    chunk = riff_start(b, "strf", NULL);
+    put32le(b, 40);
+    put32le(b, BENCH_VIDEO_WIDTH);
+    put32le(b, BENCH_VIDEO_HEIGHT);
+    put16le(b, 1);
+    put16le(b, 24);
+    put_bytes(b, "H264", 4);
+    put32le(b, BENCH_VIDEO_WIDTH * BENCH_VIDEO_HEIGHT * 3);
+    put_bytes(b, NULL, 16);
+    riff_end(b, chunk);
+    riff_end(b, strl);
+    riff_end(b, hdrl);
+
+    size_t movi = riff_start(b, "LIST", "movi");
+    for (uint32_t i = 0; i < frames && !b->error; i++)
+    {
+        chunk = riff_start(b, "00dc", NULL);
+        h264_access_unit(b, i);
+        sizes[i] = b->len - chunk - 4;
+        riff_end(b, chunk);
+    }
+    riff_end(b, movi);
+
+    /* idx1 offsets are relative to the "movi" fourcc */
+    size_t idx1 = riff_start(b, "idx1", NULL);
+    uint32_t offset = 4;
+    for (uint32_t i = 0; i < frames && !b->error; i++)
+    {
+        put_bytes(b, "00dc", 4);
+        put32le(b, i % BENCH_VIDEO_GOP == 0 ? 0x10 : 0); /* AVIIF_KEYFRAME */
+        put32le(b, offset);
+        put32le(b, sizes[i]);
+        offset += 8 + sizes[i] + (sizes[i] & 1);
+    }
+    riff_end(b, idx1);
+    riff_end(b, riff);
+    free(sizes);
+}
+
+/*****************************************************************************
+ * Corpus
+ *****************************************************************************/
+static const struct
+{
+    const char *name;
+    void (*generate)(struct buf *);
+} corpus[] = {
+    { "bench.wav",  gen_wav },
+    { "bench.ts",   gen_ts },
+    { "bench.mp4",  gen_mp4 },
+    { "bench.fmp4.mp4", gen_fmp4 },
+    { "bench.mkv",  gen_mkv },
+    { "bench.ogg",  gen_ogg },
+    { "bench.flac", gen_flac },
+    { "bench.h264", gen_h264 },
+    { "bench.h264.ts", gen_ts_h264 },
+    { "bench.avi",  gen_avi },
+};
+
+static char *corpus_write(const char *dir, size_t i)
+{
+    struct buf b = { 0 };
+    char *path;
+
+    if (asprintf(&path, "%s/%s", dir, corpus[i].name) == -1)
+        return NULL;
+
+    corpus[i].generate(&b);
+
+    FILE *stream = b.error ? NULL : fopen(path, "wb");
+    if (stream == NULL
+     || fwrite(b.p, 1, b.len, stream) != b.len)
+    {
+        fprintf(stderr, "Error: cannot generate %s\n", path);
+        if (stream != NULL)
+            fclose(stream);
+        free(b.p);
+        free(path);
+        return NULL;
+    }
+
+    fclose(stream);
+    free(b.p);
+    return path;
+}
+
+/*****************************************************************************
+ * Reporting
+ *****************************************************************************/
+static void json_string(const char *str)
+{
+    putchar('"');
+    for (; *str != '\0'; str++)
+    {
+        if (*str == '"' || *str == '\\')
+            printf("\\%c", *str);
+        else if ((unsigned char)*str < 0x20)
+            printf("\\u%04x", *str);
+        else
+            putchar(*str);
+    }
+    putchar('"');
+}
+
+static int bench_file(const struct vlc_run_args *args, const char *path,
+                      unsigned repeat, unsigned seeks)
+{
+    struct vlc_demux_bench best = { 0 };
+    int ret = -1;
+
+    /* keep the fastest run to limit the noise */
+    for (unsigned i = 0; i < repeat; i++)
+    {
+        struct vlc_demux_bench bench = {
+            .get_allocs = get_allocs,
+            .seeks = seeks,
+        };
+
+        if (vlc_demux_bench_path(args, path, &bench))
+            continue;
+        if (ret != 0 || bench.demux_us < best.demux_us)
+            best = bench;
+        ret = 0;
+    }
+
+    const char *file = strrchr(path, '/');
+    file = file != NULL ? file + 1 : path;
+
+    printf("{\"file\":");
+    json_string(file);
+
+    if (ret)
+    {
+        printf(",\"error\":true}\n");
+        return ret;
+    }
+
+    double seconds = best.demux_us / 1e6;
+    if (seconds <= 0.)
+        seconds = 1e-6;
+
+    printf(",\"demux\":");
+    json_string(best.module);
+    printf(",\"bytes\":%" PRIu64 ",\"seconds\":%.6f,\"mbps\":%.3f"
+           ",\"packets\":%" PRIu64 ",\"payload\":%" PRIu64
+           ",\"packets_per_second\":%.1f",
+           best.size, seconds, best.size / seconds / 1e6,
+           best.packets, best.payload, best.packets / seconds);
+
+    if (best.get_allocs != NULL && best.packets > 0)
+        printf(",\"allocs_per_packet\":%.3f",
+               (double)best.allocs / best.packets);
+    else
+        printf(",\"allocs_per_packet\":null");
+
+    if (best.packets > 0)
+        printf(",\"frame_allocs_per_packet\":%.3f",
+               (double)best.frame_allocs / best.packets);
+    else
+        printf(",\"frame_allocs_per_packet\":null");
+
+    printf(",\"seeks\":%u", best.seeks_done);
+    if (best.seeks_done > 0)
+        printf(",\"seek_latency_us\":%.1f",
+               (double)best.seek_us / best.seeks_done);
+    else
+        printf(",\"seek_latency_us\":null");
+    printf("}\n");
+    fflush(stdout);
+    return 0;
+}
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: [VLC_TARGET=demux] %s [-r repeat] [-s seeks] [-k dir] "
+            "[file...]\n"
+            " -r: number of runs per file, the fastest is reported\n"
+            " -s: number of seeks measured per file\n"
+            " -k: generate the corpus into dir and keep it\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+    struct vlc_run_args args;
+    vlc_run_args_init(&args);
+
+    unsigned repeat = 3, seeks = 8;
+    const char *keep = NULL;
+    int c;
+
+    while ((c = getopt(argc, argv, "r:s:k:h")) != -1)
+    {
+        switch (c)
+        {
+            case 'r':
+                repeat = strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seeks = strtoul(optarg, NULL, 0);
+                break;
+            case 'k':
+                keep = optarg;
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+    if (repeat == 0)
+        repeat = 1;
+
+    int ret = 0;
+
+    if (optind < argc)
+    {
+        for (int i = optind; i < argc; i++)
+            if (bench_file(&args, argv[i], repeat, seeks))
+                ret = 1;
+        return ret;
+    }
+
+    char tmpdir[] = "/tmp/vlc-demux-bench-XXXXXX";
+    const char *dir = keep;
+    if (dir != NULL)
+        mkdir(dir, 0700);
+    else
+    {
+        const char *tmp = mkdtemp(tmpdir);
+        if (tmp == NULL)
+        {
+            perror("mkdtemp");
+            return 1;
+        }
+        dir = tmp;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(corpus); i++)
+    {
+        char *path = corpus_write(dir, i);
+        if (path == NULL)
+        {
+            ret = 1;
+            continue;
+        }
+
+        if (bench_file(&args, path, repeat, seeks))
+            ret = 1;
+        if (keep == NULL)
+            unlink(path);
+        free(path);
+    }
+
+    if (keep == NULL)
+        rmdir(dir);
+    return ret;
+}